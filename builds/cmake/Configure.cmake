@@ -218,7 +218,7 @@ set(functions_list
     nanosleep
     poll
     posix_fadvise
-    pread pwrite
+    pread pwrite preadv
     pthread_cancel
     pthread_keycreate pthread_key_create
     pthread_mutexattr_setprotocol
@@ -26,106 +26,335 @@
  */
 
 #include "firebird.h"
+#include "../common/CRC32C.h"
+#include "../common/gdsassert.h"
 
-// Can be used only on x86 architectures
-// WARNING: With GCC must be compiled separately with -msse4.2 flag
+#include <atomic>
+#include <string.h>
+
+// Hardware kernels can be used only on x86 architectures
 #if defined(_M_IX86) || defined(_M_X64) || defined(__x86_64__) || defined(__i386__)
+#define CRC32C_X86
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
 
-// Disable SSE4.2 intrinsics for now due to GCC 14 compatibility issues
-#ifdef USE_SSE42_CRC32C
 #include <nmmintrin.h>
+#include <wmmintrin.h>
+
+// 64-bit crc32 instruction is required for PCLMUL kernel
+#if defined(_M_X64) || defined(__x86_64__)
+#define CRC32C_X64
+#endif
+
+#endif // architecture check
+
+// Hardware kernels are compiled for required instruction set using function
+// attributes, no special compiler flags are needed for this file
+#if defined(CRC32C_X86) && !defined(_MSC_VER)
+#define CRC32C_TARGET(isa) __attribute__((target(isa)))
 #else
-// Software CRC32C implementation
-static const unsigned int crc32c_table[256] = {
-    0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f,
-    0xe963a535, 0x9e6495a3, 0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
-    0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91, 0x1db71064, 0x6ab020f2,
-    0xf3b97148, 0x84be41de, 0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7,
-    0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9,
-    0xfa0f3d63, 0x8d080df5, 0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172,
-    0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b, 0x35b5a8fa, 0x42b2986c,
-    0xdbbbc9d6, 0xacbcf940, 0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59,
-    0x26d930ac, 0x51de003a, 0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423,
-    0xcfba9599, 0xb8bda50f, 0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
-    0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d, 0x76dc4190, 0x01db7106,
-    0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f, 0x9fbfe4a5, 0xe8b8d433,
-    0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818, 0x7f6a0dbb, 0x086d3d2d,
-    0x91646c97, 0xe6635c01, 0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e,
-    0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457, 0x65b0d9c6, 0x12b7e950,
-    0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65,
-    0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2, 0x4adfa541, 0x3dd895d7,
-    0xa4d1c46d, 0xd3d6f4fb, 0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0,
-    0x44042d73, 0x33031de5, 0xaa0a4c5f, 0xdd0d7cc9, 0x5005713c, 0x270241aa,
-    0xbe0b1010, 0xc90c2086, 0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
-    0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17, 0x2eb40d81,
-    0xb7bd5c3b, 0xc0ba6cad, 0xedb88320, 0x9abfb3b6, 0x03b6e20c, 0x74b1d29a,
-    0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683, 0xe3630b12, 0x94643b84,
-    0x0d6d6a3e, 0x7a6a5aa8, 0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1,
-    0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb,
-    0x196c3671, 0x6e6b06e7, 0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc,
-    0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5, 0xd6d6a3e8, 0xa1d1937e,
-    0x38d8c2c4, 0x4fdff252, 0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b,
-    0xd80d2bda, 0xaf0a1b4c, 0x36034af6, 0x41047a60, 0xdf60efc3, 0xa867df55,
-    0x316e8eef, 0x4669be79, 0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
-    0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f, 0xc5ba3bbe, 0xb2bd0b28,
-    0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7, 0xb5d0cf31, 0x2cd99e8b, 0x5bdeae1d,
-    0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a, 0x9c0906a9, 0xeb0e363f,
-    0x72076785, 0x05005713, 0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38,
-    0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21, 0x86d3d2d4, 0xf1d4e242,
-    0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777,
-    0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c, 0x8f659eff, 0xf862ae69,
-    0x616bffd3, 0x166ccf45, 0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2,
-    0xa7672661, 0xd06016f7, 0x4969474d, 0x3e6e77db, 0xaed16a4a, 0xd9d65adc,
-    0x40df0b66, 0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
-    0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693,
-    0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
-    0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
-};
+#define CRC32C_TARGET(isa)
 #endif
 
-unsigned int CRC32C(unsigned int length, const unsigned char* value)
+using namespace ScratchBird;
+
+namespace
 {
-	unsigned int hash_value = 0;
+	typedef unsigned int (*crc_func_t)(unsigned int crc, const UCHAR* p, size_t length);
+
+	const unsigned int CRC32C_POLY = 0x82F63B78;	// Castagnoli polynomial, reflected
+
+	// Software kernel, slice-by-8: table[k][n] is CRC of byte n followed by k zero bytes
+
+	struct SliceTables
+	{
+		constexpr SliceTables()
+			: table()
+		{
+			for (unsigned int n = 0; n < 256; n++)
+			{
+				unsigned int crc = n;
+				for (int bit = 0; bit < 8; bit++)
+					crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+
+				table[0][n] = crc;
+			}
+
+			for (unsigned int n = 0; n < 256; n++)
+			{
+				for (int k = 1; k < 8; k++)
+					table[k][n] = (table[k - 1][n] >> 8) ^ table[0][table[k - 1][n] & 0xFF];
+			}
+		}
+
+		unsigned int table[8][256];
+	};
+
+	constexpr SliceTables sliceTables;
+
+	unsigned int crcSoftware(unsigned int crc, const UCHAR* p, size_t length)
+	{
+		const auto& t = sliceTables.table;
+
+		for (; length >= 8; length -= 8, p += 8)
+		{
+			const unsigned int lo = crc ^
+				(p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int) p[3] << 24));
+			const unsigned int hi =
+				p[4] | (p[5] << 8) | (p[6] << 16) | ((unsigned int) p[7] << 24);
+
+			crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+				t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+		}
+
+		for (; length; length--)
+			crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+
+		return crc;
+	}
 
-#ifdef USE_SSE42_CRC32C
-	// Hardware SSE4.2 CRC32C implementation
-	if (length == 1)
-		return _mm_crc32_u8(hash_value, *value);
+#ifdef CRC32C_X86
 
-	if (length == 2)
-		return _mm_crc32_u16(hash_value, *(unsigned short*) value);
+	const unsigned int CPUID_SSE42 = 1 << 20;
+	const unsigned int CPUID_PCLMUL = 1 << 1;
 
-	while (length >= 4)
+	unsigned int readCpuFeatures()
 	{
-		hash_value = _mm_crc32_u32(hash_value, *(unsigned int*) value);
-		value += 4;
-		length -= 4;
+#ifdef _MSC_VER
+		// MS VC has its own definition of __cpuid
+		int flags[4];
+		__cpuid(flags, 1);
+		return flags[2];
+#else
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+			return 0;
+		return ecx;
+#endif
+	}
+
+	// cpuid is slow, especially in virtual machines
+	unsigned int cpuFeatures()
+	{
+		static const unsigned int features = readCpuFeatures();
+		return features;
+	}
+
+	// SSE4.2 kernel
+
+	CRC32C_TARGET("sse4.2")
+	unsigned int crcSse42(unsigned int crc, const UCHAR* p, size_t length)
+	{
+		for (; length && ((U_IPTR) p & 7); length--)
+			crc = _mm_crc32_u8(crc, *p++);
+
+#ifdef CRC32C_X64
+		FB_UINT64 crc64 = crc;
+		for (; length >= 8; length -= 8, p += 8)
+		{
+			FB_UINT64 value;
+			memcpy(&value, p, sizeof(value));
+			crc64 = _mm_crc32_u64(crc64, value);
+		}
+		crc = (unsigned int) crc64;
+#endif
+
+		for (; length >= 4; length -= 4, p += 4)
+		{
+			unsigned int value;
+			memcpy(&value, p, sizeof(value));
+			crc = _mm_crc32_u32(crc, value);
+		}
+
+		for (; length; length--)
+			crc = _mm_crc32_u8(crc, *p++);
+
+		return crc;
 	}
 
-	if (length >= 2)
+#ifdef CRC32C_X64
+
+	// PCLMUL kernel. Latency of crc32 instruction is 3 cycles while it may be
+	// issued every cycle, so data is processed as 3 independent streams and
+	// their CRC's are combined using carry-less multiplication:
+	// crc(A || B) = crc(A) * x^(8 * length(B)) mod P xor crc(B)
+
+	const size_t LONG_BLOCK = 2048;		// bytes per stream
+	const size_t SHORT_BLOCK = 256;
+
+	// Multiplication of reflected crc by K using carry-less multiply gives 64-bit
+	// product shifted by one bit, following crc32 of it multiplies it by x^32.
+	// So K = x^(8 * n - 33) mod P shifts crc by n bytes.
+	constexpr unsigned int shiftConstant(size_t bytes)
 	{
-		hash_value = _mm_crc32_u16(hash_value, *(unsigned short*) value);
-		value += 2;
-		length -= 2;
+		unsigned int k = 0x80000000;	// x^0
+		for (size_t n = 8 * bytes - 33; n; n--)
+			k = (k & 1) ? (k >> 1) ^ CRC32C_POLY : k >> 1;
+		return k;
 	}
 
-	if (length)
+	constexpr unsigned int LONG_SHIFT = shiftConstant(LONG_BLOCK);
+	constexpr unsigned int SHORT_SHIFT = shiftConstant(SHORT_BLOCK);
+
+	CRC32C_TARGET("sse4.2,pclmul")
+	inline FB_UINT64 crcShift(FB_UINT64 crc, unsigned int k)
 	{
-		hash_value = _mm_crc32_u8(hash_value, *value);
+		const __m128i product = _mm_clmulepi64_si128(
+			_mm_cvtsi32_si128((int) crc), _mm_cvtsi32_si128((int) k), 0);
+
+		return _mm_crc32_u64(0, (FB_UINT64) _mm_cvtsi128_si64(product));
 	}
+
+	CRC32C_TARGET("sse4.2,pclmul")
+	inline FB_UINT64 crcStreams(FB_UINT64 crc0, const UCHAR*& p, size_t& length,
+		const size_t block, const unsigned int k)
+	{
+		for (; length >= 3 * block; length -= 3 * block)
+		{
+			FB_UINT64 crc1 = 0;
+			FB_UINT64 crc2 = 0;
+
+			for (const UCHAR* const end = p + block; p < end; p += 8)
+			{
+				FB_UINT64 value0, value1, value2;
+				memcpy(&value0, p, sizeof(value0));
+				memcpy(&value1, p + block, sizeof(value1));
+				memcpy(&value2, p + 2 * block, sizeof(value2));
+
+				crc0 = _mm_crc32_u64(crc0, value0);
+				crc1 = _mm_crc32_u64(crc1, value1);
+				crc2 = _mm_crc32_u64(crc2, value2);
+			}
+
+			crc0 = crcShift(crc0, k) ^ crc1;
+			crc0 = crcShift(crc0, k) ^ crc2;
+
+			p += 2 * block;
+		}
+
+		return crc0;
+	}
+
+	CRC32C_TARGET("sse4.2,pclmul")
+	unsigned int crcPclmul(unsigned int crc, const UCHAR* p, size_t length)
+	{
+		for (; length && ((U_IPTR) p & 7); length--)
+			crc = _mm_crc32_u8(crc, *p++);
+
+		FB_UINT64 crc64 = crc;
+		crc64 = crcStreams(crc64, p, length, LONG_BLOCK, LONG_SHIFT);
+		crc64 = crcStreams(crc64, p, length, SHORT_BLOCK, SHORT_SHIFT);
+
+		return crcSse42((unsigned int) crc64, p, length);
+	}
+
+#endif // CRC32C_X64
+#endif // CRC32C_X86
+
+	const crc_func_t kernels[Crc32c::KERNEL_COUNT] =
+	{
+		crcSoftware,
+#ifdef CRC32C_X86
+		crcSse42,
+#else
+		crcSoftware,
+#endif
+#ifdef CRC32C_X64
+		crcPclmul
 #else
-	// Software CRC32C implementation
-	hash_value = ~hash_value;
-	while (length > 0)
+		crcSoftware
+#endif
+	};
+
+	const char* const kernelNames[Crc32c::KERNEL_COUNT] =
 	{
-		hash_value = crc32c_table[(hash_value ^ *value) & 0xff] ^ (hash_value >> 8);
-		++value;
-		--length;
+		"slice-by-8",
+		"sse4.2",
+		"sse4.2+pclmul"
+	};
+
+	// The best kernel is chosen on the first call, there is no dependency
+	// on initialization order of static objects
+	unsigned int crcResolve(unsigned int crc, const UCHAR* p, size_t length);
+
+	std::atomic<crc_func_t> crcKernel(crcResolve);
+
+	unsigned int crcResolve(unsigned int crc, const UCHAR* p, size_t length)
+	{
+		const crc_func_t kernel = kernels[Crc32c::getKernel()];
+		crcKernel.store(kernel, std::memory_order_relaxed);
+		return kernel(crc, p, length);
 	}
-	hash_value = ~hash_value;
+
+} // anonymous namespace
+
+
+unsigned int CRC32C(unsigned int length, const unsigned char* value)
+{
+	return Crc32c::update(0, value, length);
+}
+
+
+namespace ScratchBird {
+
+unsigned int Crc32c::update(unsigned int crc, const void* data, size_t length)
+{
+	return crcKernel.load(std::memory_order_relaxed)(crc, static_cast<const UCHAR*>(data), length);
+}
+
+unsigned int Crc32c::update(Kernel kernel, unsigned int crc, const void* data, size_t length)
+{
+	fb_assert(isSupported(kernel));
+
+	const crc_func_t func = isSupported(kernel) ? kernels[kernel] : crcSoftware;
+	return func(crc, static_cast<const UCHAR*>(data), length);
+}
+
+bool Crc32c::isSupported(Kernel kernel)
+{
+	switch (kernel)
+	{
+	case KERNEL_SOFTWARE:
+		return true;
+
+#ifdef CRC32C_X86
+	case KERNEL_SSE42:
+		return (cpuFeatures() & CPUID_SSE42) != 0;
 #endif
 
-	return hash_value;
+#ifdef CRC32C_X64
+	case KERNEL_PCLMUL:
+		return (cpuFeatures() & (CPUID_SSE42 | CPUID_PCLMUL)) == (CPUID_SSE42 | CPUID_PCLMUL);
+#endif
+
+	default:
+		return false;
+	}
 }
 
-#endif // architecture check
+Crc32c::Kernel Crc32c::getKernel()
+{
+	if (isSupported(KERNEL_PCLMUL))
+		return KERNEL_PCLMUL;
+
+	if (isSupported(KERNEL_SSE42))
+		return KERNEL_SSE42;
+
+	return KERNEL_SOFTWARE;
+}
+
+bool Crc32c::isAccelerated()
+{
+	return getKernel() != KERNEL_SOFTWARE;
+}
+
+const char* Crc32c::getKernelName(Kernel kernel)
+{
+	return (kernel < KERNEL_COUNT) ? kernelNames[kernel] : "unknown";
+}
+
+} // namespace ScratchBird
@@ -0,0 +1,75 @@
+/*
+ *	PROGRAM:	Common Library
+ *	MODULE:		CRC32C.h
+ *	DESCRIPTION:	CRC32C (Castagnoli) calculation
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by Dmitry Sibiryakov
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2015 Dmitry Sibiryakov
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef COMMON_CRC32C_H
+#define COMMON_CRC32C_H
+
+#include <stddef.h>
+
+// Raw CRC32C of the data - zero initial value and no final inversion, i.e. the
+// same value as calculated by SSE4.2 crc32 instruction. Used for hashing.
+unsigned int CRC32C(unsigned int length, const unsigned char* value);
+
+namespace ScratchBird
+{
+
+// CRC32C calculation with the best kernel supported by CPU. Kernel is chosen
+// once at runtime, all kernels produce the same result.
+class Crc32c
+{
+public:
+	enum Kernel
+	{
+		KERNEL_SOFTWARE,	// slice-by-8 tables
+		KERNEL_SSE42,		// crc32 instruction
+		KERNEL_PCLMUL,		// crc32 instruction in 3 streams combined using carry-less multiply
+		KERNEL_COUNT
+	};
+
+	// Continue raw CRC32C calculation
+	static unsigned int update(unsigned int crc, const void* data, size_t length);
+
+	// Standard (iSCSI) CRC32C checksum, previous checksum may be passed to continue the stream
+	static unsigned int checksum(const void* data, size_t length, unsigned int prev = 0)
+	{
+		return ~update(~prev, data, length);
+	}
+
+	// Whether CRC32C is calculated by hardware and is cheap enough to be used as hash
+	static bool isAccelerated();
+
+	static Kernel getKernel();
+	static bool isSupported(Kernel kernel);
+	static const char* getKernelName(Kernel kernel);
+
+	// Calculate using given kernel, for testing and benchmarking
+	static unsigned int update(Kernel kernel, unsigned int crc, const void* data, size_t length);
+};
+
+} // namespace ScratchBird
+
+#endif // COMMON_CRC32C_H
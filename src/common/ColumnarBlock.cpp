@@ -0,0 +1,779 @@
+/*
+ *	PROGRAM:		Common Access Method
+ *	MODULE:			ColumnarBlock.cpp
+ *	DESCRIPTION:	Batch of message rows stored by columns
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by ScratchBird Development Team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2025 ScratchBird Development Team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): _______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../common/ColumnarBlock.h"
+#include "../common/Lz4Block.h"
+
+#include <string.h>
+
+using namespace ScratchBird;
+
+namespace
+{
+	// Body shorter than that isn't worth compressing
+	const ULONG MIN_COMPRESS_LENGTH = 64;
+
+	// LZ4 can't expand the data more than that
+	const ULONG MAX_LZ4_RATIO = 255;
+
+	// Dictionary indexes are two bytes at most
+	const ULONG MAX_DICTIONARY = MAX_USHORT + 1;
+
+	inline ULONG getIndexWidth(ULONG entries)
+	{
+		return entries <= 1 ? 0 : entries <= MAX_UCHAR + 1 ? 1 : 2;
+	}
+
+	inline ULONG getVarintLength(FB_UINT64 value)
+	{
+		ULONG length = 1;
+
+		while (value >= 0x80)
+		{
+			value >>= 7;
+			length++;
+		}
+
+		return length;
+	}
+
+	inline FB_UINT64 zigzag(FB_UINT64 delta)
+	{
+		return (delta << 1) ^ (FB_UINT64) ((SINT64) delta >> 63);
+	}
+
+	inline FB_UINT64 unzigzag(FB_UINT64 value)
+	{
+		return (value >> 1) ^ (0 - (value & 1));
+	}
+
+	SINT64 getInteger(const UCHAR* address, UCHAR width)
+	{
+		switch (width)
+		{
+			case sizeof(SSHORT):
+			{
+				SSHORT value;
+				memcpy(&value, address, sizeof(value));
+				return value;
+			}
+
+			case sizeof(SLONG):
+			{
+				SLONG value;
+				memcpy(&value, address, sizeof(value));
+				return value;
+			}
+
+			default:
+			{
+				SINT64 value;
+				memcpy(&value, address, sizeof(value));
+				return value;
+			}
+		}
+	}
+
+	void putInteger(UCHAR* address, UCHAR width, SINT64 value)
+	{
+		switch (width)
+		{
+			case sizeof(SSHORT):
+			{
+				const SSHORT n = (SSHORT) value;
+				memcpy(address, &n, sizeof(n));
+				break;
+			}
+
+			case sizeof(SLONG):
+			{
+				const SLONG n = (SLONG) value;
+				memcpy(address, &n, sizeof(n));
+				break;
+			}
+
+			default:
+				memcpy(address, &value, sizeof(value));
+				break;
+		}
+	}
+
+	inline bool isNull(const UCHAR* nulls, ULONG n)
+	{
+		return nulls && (nulls[n >> 3] & (1 << (n & 7)));
+	}
+}
+
+
+// ColumnarBlock
+
+void ColumnarBlock::setLayout(Layout& layout, const dsc* value, const dsc* indicator)
+{
+	fb_assert(indicator->dsc_dtype == dtype_short);
+
+	layout.offset = (ULONG) (IPTR) value->dsc_address;
+	layout.nullOffset = (ULONG) (IPTR) indicator->dsc_address;
+	layout.length = value->dsc_length;
+	layout.kind = KIND_FIXED;
+	layout.width = 0;
+
+	switch (value->dsc_dtype)
+	{
+		case dtype_varying:
+			layout.kind = KIND_VARYING;
+			break;
+
+		case dtype_cstring:
+			layout.kind = KIND_CSTRING;
+			break;
+
+		case dtype_short:
+		case dtype_long:
+		case dtype_int64:
+		case dtype_sql_date:
+		case dtype_sql_time:
+			layout.width = (UCHAR) value->dsc_length;
+			break;
+	}
+}
+
+void ColumnarBlock::putVarint(UCharBuffer& buffer, FB_UINT64 value)
+{
+	while (value >= 0x80)
+	{
+		buffer.add((UCHAR) (value | 0x80));
+		value >>= 7;
+	}
+
+	buffer.add((UCHAR) value);
+}
+
+bool ColumnarBlock::getVarint(const UCHAR*& ptr, const UCHAR* end, FB_UINT64& value)
+{
+	value = 0;
+
+	for (unsigned shift = 0; shift < 64; shift += 7)
+	{
+		if (ptr >= end)
+			return false;
+
+		const UCHAR c = *ptr++;
+		value |= (FB_UINT64) (c & 0x7F) << shift;
+
+		if (!(c & 0x80))
+			return true;
+	}
+
+	return false;
+}
+
+
+// ColumnarEncoder
+
+ColumnarEncoder::ColumnarEncoder(MemoryPool& pool, const dsc* desc, FB_SIZE_T count)
+	: PermanentStorage(pool),
+	  m_columns(pool),
+	  m_body(pool),
+	  m_entries(pool),
+	  m_indexes(pool),
+	  m_hash(pool),
+	  m_rows(0),
+	  m_length(0)
+{
+	fb_assert(count % 2 == 0);
+
+	for (FB_SIZE_T i = 0; i + 1 < count; i += 2)
+		setLayout(m_columns.add().layout, &desc[i], &desc[i + 1]);
+}
+
+void ColumnarEncoder::add(const UCHAR* message)
+{
+	const ULONG row = m_rows++;
+
+	for (auto& column : m_columns)
+	{
+		const Layout& layout = column.layout;
+
+		if (!(row & 7))
+			column.nulls.add(0);
+
+		SSHORT flag;
+		memcpy(&flag, message + layout.nullOffset, sizeof(flag));
+
+		if (flag)
+		{
+			column.nulls[row >> 3] |= (UCHAR) (1 << (row & 7));
+			column.nullCount++;
+			continue;
+		}
+
+		const UCHAR* const value = message + layout.offset;
+		ULONG length = layout.length;
+
+		switch (layout.kind)
+		{
+			case KIND_VARYING:
+			{
+				USHORT n;
+				memcpy(&n, value, sizeof(n));
+				length = MIN(n, layout.length - sizeof(USHORT));
+				column.starts.add(column.values.getCount());
+				column.values.add(value + sizeof(USHORT), length);
+				break;
+			}
+
+			case KIND_CSTRING:
+				length = (ULONG) strnlen(reinterpret_cast<const char*>(value), layout.length - 1);
+				column.starts.add(column.values.getCount());
+				column.values.add(value, length);
+				break;
+
+			default:
+				column.values.add(value, length);
+				break;
+		}
+
+		m_length += length;
+	}
+}
+
+void ColumnarEncoder::build(UCharBuffer& image, bool compress)
+{
+	m_body.clear();
+
+	for (const auto& column : m_columns)
+		putColumn(column, m_body);
+
+	const ULONG bodyLength = m_body.getCount();
+
+	image.clear();
+	image.add(VERSION);
+	image.add(0);
+	putVarint(image, m_rows);
+	putVarint(image, bodyLength);
+
+	const FB_SIZE_T header = image.getCount();
+
+	if (compress && bodyLength >= MIN_COMPRESS_LENGTH)
+	{
+		// The image should be shorter than the body itself
+
+		UCHAR* const output = image.getBuffer(header + bodyLength - 1) + header;
+		const ULONG length = Lz4Block::pack(bodyLength, m_body.begin(), bodyLength - 1, output);
+
+		if (length)
+		{
+			image[1] |= FLAG_LZ4;
+			image.shrink(header + length);
+			clear();
+			return;
+		}
+
+		image.shrink(header);
+	}
+
+	image.add(m_body.begin(), bodyLength);
+	clear();
+}
+
+void ColumnarEncoder::clear()
+{
+	for (auto& column : m_columns)
+	{
+		column.nullCount = 0;
+		column.nulls.clear();
+		column.values.clear();
+		column.starts.clear();
+	}
+
+	m_rows = 0;
+	m_length = 0;
+}
+
+// Returns length and address of the n-th value that isn't NULL
+ULONG ColumnarEncoder::getValue(const Column& column, ULONG n, const UCHAR** address) const
+{
+	if (column.layout.kind == KIND_FIXED)
+	{
+		*address = column.values.begin() + n * column.layout.length;
+		return column.layout.length;
+	}
+
+	const ULONG start = column.starts[n];
+	const ULONG end = (n + 1 < column.starts.getCount()) ? column.starts[n + 1] : column.values.getCount();
+
+	*address = column.values.begin() + start;
+	return end - start;
+}
+
+ULONG ColumnarEncoder::getPlainLength(const Column& column) const
+{
+	if (column.layout.kind == KIND_FIXED)
+		return column.values.getCount();
+
+	ULONG length = column.values.getCount();
+
+	for (ULONG n = 0; n < column.starts.getCount(); n++)
+	{
+		const UCHAR* address;
+		length += getVarintLength(getValue(column, n, &address));
+	}
+
+	return length;
+}
+
+ULONG ColumnarEncoder::getDeltaLength(const Column& column) const
+{
+	const ULONG count = m_rows - column.nullCount;
+	const UCHAR width = column.layout.width;
+	const UCHAR* value = column.values.begin();
+
+	SINT64 last = 0;
+	ULONG length = 0;
+
+	for (ULONG n = 0; n < count; n++, value += width)
+	{
+		const SINT64 current = getInteger(value, width);
+		length += getVarintLength(zigzag((FB_UINT64) current - (FB_UINT64) last));
+		last = current;
+	}
+
+	return length;
+}
+
+// Fills m_entries and m_indexes, false if there are too many distinct values
+bool ColumnarEncoder::makeDictionary(const Column& column)
+{
+	const ULONG count = m_rows - column.nullCount;
+
+	ULONG size = 16;
+	while (size < count * 2)
+		size <<= 1;
+
+	const ULONG mask = size - 1;
+	ULONG* const hash = m_hash.getBuffer(size, false);
+	memset(hash, 0, size * sizeof(ULONG));
+
+	m_entries.clear();
+	ULONG* const indexes = m_indexes.getBuffer(count, false);
+
+	for (ULONG n = 0; n < count; n++)
+	{
+		const UCHAR* address;
+		const ULONG length = getValue(column, n, &address);
+
+		// FNV-1a
+		ULONG h = 2166136261U;
+		for (ULONG i = 0; i < length; i++)
+			h = (h ^ address[i]) * 16777619U;
+
+		// Slots keep entry numbers plus one, zero is free
+
+		for (ULONG slot = h & mask; ; slot = (slot + 1) & mask)
+		{
+			if (!hash[slot])
+			{
+				if (m_entries.getCount() >= MAX_DICTIONARY)
+					return false;
+
+				m_entries.add(n);
+				hash[slot] = m_entries.getCount();
+				indexes[n] = hash[slot] - 1;
+				break;
+			}
+
+			const UCHAR* entry;
+			const ULONG entryLength = getValue(column, m_entries[hash[slot] - 1], &entry);
+
+			if (entryLength == length && !memcmp(entry, address, length))
+			{
+				indexes[n] = hash[slot] - 1;
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+void ColumnarEncoder::putPlain(const Column& column, ULONG n, UCharBuffer& body) const
+{
+	const UCHAR* address;
+	const ULONG length = getValue(column, n, &address);
+
+	if (column.layout.kind != KIND_FIXED)
+		putVarint(body, length);
+
+	body.add(address, length);
+}
+
+void ColumnarEncoder::putColumn(const Column& column, UCharBuffer& body)
+{
+	const ULONG count = m_rows - column.nullCount;
+	const UCHAR width = column.layout.width;
+
+	// Pick the shortest encoding
+
+	UCHAR encoding = ENCODING_PLAIN;
+	ULONG length = getPlainLength(column);
+
+	if (width && count > 1)
+	{
+		const ULONG deltaLength = getDeltaLength(column);
+
+		if (deltaLength < length)
+		{
+			encoding = ENCODING_DELTA;
+			length = deltaLength;
+		}
+	}
+
+	if (count > 1 && makeDictionary(column))
+	{
+		const ULONG entries = m_entries.getCount();
+		ULONG dictionaryLength = getVarintLength(entries) + count * getIndexWidth(entries);
+
+		for (ULONG i = 0; i < entries && dictionaryLength < length; i++)
+		{
+			const UCHAR* address;
+			const ULONG entryLength = getValue(column, m_entries[i], &address);
+			dictionaryLength += entryLength + (column.layout.kind == KIND_FIXED ? 0 : getVarintLength(entryLength));
+		}
+
+		if (dictionaryLength < length)
+		{
+			encoding = ENCODING_DICTIONARY;
+			length = dictionaryLength;
+		}
+	}
+
+	// Header of the column and the NULL bitmap
+
+	const ULONG nullLength = column.nullCount ? (m_rows + 7) / 8 : 0;
+
+	body.add(encoding | (column.nullCount ? ENCODING_NULLS : 0));
+	putVarint(body, nullLength + length);
+
+	if (nullLength)
+		body.add(column.nulls.begin(), nullLength);
+
+	switch (encoding)
+	{
+		case ENCODING_PLAIN:
+			if (column.layout.kind == KIND_FIXED)
+				body.add(column.values.begin(), column.values.getCount());
+			else
+			{
+				for (ULONG n = 0; n < count; n++)
+					putPlain(column, n, body);
+			}
+			break;
+
+		case ENCODING_DELTA:
+		{
+			const UCHAR* value = column.values.begin();
+			SINT64 last = 0;
+
+			for (ULONG n = 0; n < count; n++, value += width)
+			{
+				const SINT64 current = getInteger(value, width);
+				putVarint(body, zigzag((FB_UINT64) current - (FB_UINT64) last));
+				last = current;
+			}
+			break;
+		}
+
+		case ENCODING_DICTIONARY:
+		{
+			const ULONG entries = m_entries.getCount();
+			putVarint(body, entries);
+
+			for (ULONG i = 0; i < entries; i++)
+				putPlain(column, m_entries[i], body);
+
+			const ULONG indexWidth = getIndexWidth(entries);
+
+			for (ULONG n = 0; n < count && indexWidth; n++)
+			{
+				const ULONG index = m_indexes[n];
+				body.add((UCHAR) index);
+
+				if (indexWidth > 1)
+					body.add((UCHAR) (index >> 8));
+			}
+			break;
+		}
+	}
+}
+
+
+// ColumnarDecoder
+
+ColumnarDecoder::ColumnarDecoder(MemoryPool& pool, const dsc* desc, FB_SIZE_T count)
+	: PermanentStorage(pool),
+	  m_columns(pool),
+	  m_body(pool),
+	  m_rows(0),
+	  m_row(0),
+	  m_length(0)
+{
+	fb_assert(count % 2 == 0);
+
+	for (FB_SIZE_T i = 0; i + 1 < count; i += 2)
+		setLayout(m_columns.add().layout, &desc[i], &desc[i + 1]);
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+		m_length = MAX(m_length, (ULONG) (IPTR) desc[i].dsc_address + desc[i].dsc_length);
+}
+
+bool ColumnarDecoder::open(const UCHAR* image, ULONG length)
+{
+	m_rows = m_row = 0;
+
+	const UCHAR* ptr = image;
+	const UCHAR* const end = image + length;
+
+	if (length < 2 || ptr[0] != VERSION || (ptr[1] & ~FLAG_LZ4))
+		return false;
+
+	const bool compressed = (ptr[1] & FLAG_LZ4);
+	ptr += 2;
+
+	FB_UINT64 rows, bodyLength;
+
+	if (!getVarint(ptr, end, rows) || !getVarint(ptr, end, bodyLength) || rows > MAX_ULONG)
+		return false;
+
+	const ULONG imageLength = end - ptr;
+
+	if (compressed)
+	{
+		if (bodyLength > (FB_UINT64) imageLength * MAX_LZ4_RATIO)
+			return false;
+
+		UCHAR* const body = m_body.getBuffer((ULONG) bodyLength, false);
+
+		if (!Lz4Block::unpack(imageLength, ptr, (ULONG) bodyLength, body))
+			return false;
+
+		ptr = body;
+	}
+	else if (bodyLength != imageLength)
+		return false;
+
+	const UCHAR* const bodyEnd = ptr + bodyLength;
+	m_rows = (ULONG) rows;
+
+	for (auto& column : m_columns)
+	{
+		if (!openColumn(column, ptr, bodyEnd))
+		{
+			m_rows = 0;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ColumnarDecoder::openColumn(Column& column, const UCHAR*& ptr, const UCHAR* end)
+{
+	FB_UINT64 length;
+
+	if (ptr >= end)
+		return false;
+
+	const UCHAR encoding = *ptr++;
+
+	if (!getVarint(ptr, end, length) || length > (FB_UINT64) (end - ptr))
+		return false;
+
+	column.encoding = encoding & ENCODING_MASK;
+	column.nulls = NULL;
+	column.ptr = ptr;
+	column.end = ptr + length;
+	column.last = 0;
+	column.entries.clear();
+
+	ptr = column.end;
+
+	if (encoding & ENCODING_NULLS)
+	{
+		const ULONG nullLength = (m_rows + 7) / 8;
+
+		if (nullLength > length)
+			return false;
+
+		column.nulls = column.ptr;
+		column.ptr += nullLength;
+	}
+
+	switch (column.encoding)
+	{
+		case ENCODING_PLAIN:
+			break;
+
+		case ENCODING_DELTA:
+			if (!column.layout.width)
+				return false;
+			break;
+
+		case ENCODING_DICTIONARY:
+		{
+			FB_UINT64 entries;
+
+			if (!getVarint(column.ptr, column.end, entries) || entries > MAX_DICTIONARY)
+				return false;
+
+			Entry* const entry = column.entries.getBuffer((ULONG) entries, false);
+
+			for (ULONG i = 0; i < entries; i++)
+			{
+				if (!getPlain(column, entry[i]))
+					return false;
+			}
+			break;
+		}
+
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+// Reads the value in PLAIN form and checks it fits the message
+bool ColumnarDecoder::getPlain(Column& column, Entry& entry) const
+{
+	const Layout& layout = column.layout;
+	FB_UINT64 length = layout.length;
+
+	if (layout.kind != KIND_FIXED)
+	{
+		if (!getVarint(column.ptr, column.end, length))
+			return false;
+
+		const ULONG limit = layout.length - (layout.kind == KIND_VARYING ? sizeof(USHORT) : 1);
+
+		if (length > limit)
+			return false;
+	}
+
+	if (length > (FB_UINT64) (column.end - column.ptr))
+		return false;
+
+	entry.address = column.ptr;
+	entry.length = (ULONG) length;
+	column.ptr += length;
+
+	return true;
+}
+
+bool ColumnarDecoder::next(UCHAR* message)
+{
+	if (m_row >= m_rows)
+		return false;
+
+	const ULONG row = m_row++;
+
+	memset(message, 0, m_length);
+
+	for (auto& column : m_columns)
+	{
+		const Layout& layout = column.layout;
+		UCHAR* const value = message + layout.offset;
+
+		const SSHORT flag = isNull(column.nulls, row) ? -1 : 0;
+		memcpy(message + layout.nullOffset, &flag, sizeof(flag));
+
+		if (flag)
+			continue;
+
+		Entry entry;
+
+		switch (column.encoding)
+		{
+			case ENCODING_PLAIN:
+				if (!getPlain(column, entry))
+					return false;
+				break;
+
+			case ENCODING_DICTIONARY:
+			{
+				const ULONG entries = column.entries.getCount();
+				const ULONG width = getIndexWidth(entries);
+				ULONG index = 0;
+
+				if (column.ptr + width > column.end)
+					return false;
+
+				if (width)
+					index = *column.ptr++;
+
+				if (width > 1)
+					index |= (ULONG) *column.ptr++ << 8;
+
+				if (index >= entries)
+					return false;
+
+				entry = column.entries[index];
+				break;
+			}
+
+			case ENCODING_DELTA:
+			{
+				FB_UINT64 delta;
+
+				if (!getVarint(column.ptr, column.end, delta))
+					return false;
+
+				column.last = (SINT64) ((FB_UINT64) column.last + unzigzag(delta));
+				putInteger(value, layout.width, column.last);
+				continue;
+			}
+		}
+
+		switch (layout.kind)
+		{
+			case KIND_VARYING:
+			{
+				const USHORT n = (USHORT) entry.length;
+				memcpy(value, &n, sizeof(n));
+				memcpy(value + sizeof(USHORT), entry.address, entry.length);
+				break;
+			}
+
+			default:
+				// The terminator of the cstring is there already
+				memcpy(value, entry.address, entry.length);
+				break;
+		}
+	}
+
+	return true;
+}
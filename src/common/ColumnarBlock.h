@@ -0,0 +1,200 @@
+/*
+ *	PROGRAM:		Common Access Method
+ *	MODULE:			ColumnarBlock.h
+ *	DESCRIPTION:	Batch of message rows stored by columns
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by ScratchBird Development Team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2025 ScratchBird Development Team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): _______________________________________.
+ *
+ */
+
+#ifndef COMMON_COLUMNAR_BLOCK_H
+#define COMMON_COLUMNAR_BLOCK_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/objects_array.h"
+#include "../common/dsc.h"
+
+namespace ScratchBird {
+
+// Batch of rows of a message laid out by columns, as the remote protocol
+// sends them in reply to op_fetch_columnar. The message format is the DSQL
+// one: pairs of the value and its NULL indicator.
+//
+// The block is a header (version, flags, count of rows, length of the body)
+// followed by the body, column after column. Column starts with the byte of
+// its encoding and the length of its data, then goes the NULL bitmap if the
+// column has NULLs and then the values of the rows that aren't NULL:
+//	PLAIN		values as they are, strings are prefixed by the length
+//	DICTIONARY	distinct values in the PLAIN form and the index of the value
+//				of every row, one or two bytes wide
+//	DELTA		integers as zigzag varints of the difference from the value
+//				of the previous row
+// The encoder picks the shortest one for every column and compresses the body
+// with LZ4 when asked and when it pays. Values keep the byte order of the host,
+// so the blocks are exchanged between the peers of the same byte order only.
+
+class ColumnarBlock
+{
+public:
+	static constexpr UCHAR VERSION = 1;
+
+	// Header flags
+	static constexpr UCHAR FLAG_LZ4 = 1;
+
+	// Column encodings
+	static constexpr UCHAR ENCODING_PLAIN = 0;
+	static constexpr UCHAR ENCODING_DICTIONARY = 1;
+	static constexpr UCHAR ENCODING_DELTA = 2;
+	static constexpr UCHAR ENCODING_MASK = 0x0F;
+	static constexpr UCHAR ENCODING_NULLS = 0x80;	// bitmap of NULLs follows
+
+protected:
+	enum Kind : UCHAR
+	{
+		KIND_FIXED,		// fixed length value
+		KIND_VARYING,	// length word and the string
+		KIND_CSTRING	// null terminated string
+	};
+
+	struct Layout
+	{
+		ULONG offset;		// of the value in the message
+		ULONG nullOffset;	// of the NULL indicator
+		USHORT length;		// of the value in the message
+		Kind kind;
+		UCHAR width;		// of the integer the DELTA encoding applies to, zero otherwise
+	};
+
+	static void setLayout(Layout& layout, const dsc* value, const dsc* indicator);
+
+	static void putVarint(UCharBuffer& buffer, FB_UINT64 value);
+	static bool getVarint(const UCHAR*& ptr, const UCHAR* end, FB_UINT64& value);
+};
+
+
+class ColumnarEncoder : public PermanentStorage, private ColumnarBlock
+{
+public:
+	ColumnarEncoder(MemoryPool& pool, const dsc* desc, FB_SIZE_T count);
+
+	void add(const UCHAR* message);
+
+	ULONG getCount() const
+	{
+		return m_rows;
+	}
+
+	// Length of the values added so far, before encoding
+	ULONG getLength() const
+	{
+		return m_length;
+	}
+
+	// Makes the block of the rows added and starts the next one
+	void build(UCharBuffer& image, bool compress);
+
+	void clear();
+
+private:
+	struct Column
+	{
+		explicit Column(MemoryPool& pool)
+			: nullCount(0), nulls(pool), values(pool), starts(pool)
+		{ }
+
+		Layout layout;
+		ULONG nullCount;
+		UCharBuffer nulls;
+		Array<UCHAR> values;
+		Array<ULONG> starts;	// of the strings in values
+	};
+
+	ULONG getValue(const Column& column, ULONG n, const UCHAR** address) const;
+	ULONG getPlainLength(const Column& column) const;
+	ULONG getDeltaLength(const Column& column) const;
+	bool makeDictionary(const Column& column);
+
+	void putPlain(const Column& column, ULONG n, UCharBuffer& body) const;
+	void putColumn(const Column& column, UCharBuffer& body);
+
+	ObjectsArray<Column> m_columns;
+	UCharBuffer m_body;
+	Array<ULONG> m_entries;		// value numbers of the dictionary entries
+	Array<ULONG> m_indexes;		// dictionary index of every value
+	Array<ULONG> m_hash;
+	ULONG m_rows;
+	ULONG m_length;
+};
+
+
+class ColumnarDecoder : public PermanentStorage, private ColumnarBlock
+{
+public:
+	ColumnarDecoder(MemoryPool& pool, const dsc* desc, FB_SIZE_T count);
+
+	// Validates the block, false if it's corrupt
+	bool open(const UCHAR* image, ULONG length);
+
+	ULONG getCount() const
+	{
+		return m_rows;
+	}
+
+	// Puts the next row into the message, false if there are no more rows
+	// or the block is corrupt
+	bool next(UCHAR* message);
+
+private:
+	struct Entry
+	{
+		const UCHAR* address;
+		ULONG length;
+	};
+
+	struct Column
+	{
+		explicit Column(MemoryPool& pool)
+			: entries(pool)
+		{ }
+
+		Layout layout;
+		UCHAR encoding;
+		const UCHAR* nulls;
+		const UCHAR* ptr;
+		const UCHAR* end;
+		SINT64 last;
+		Array<Entry> entries;
+	};
+
+	bool openColumn(Column& column, const UCHAR*& ptr, const UCHAR* end);
+	bool getPlain(Column& column, Entry& entry) const;
+
+	ObjectsArray<Column> m_columns;
+	UCharBuffer m_body;
+	ULONG m_rows;
+	ULONG m_row;
+	ULONG m_length;		// of the message
+};
+
+} // namespace ScratchBird
+
+#endif // COMMON_COLUMNAR_BLOCK_H
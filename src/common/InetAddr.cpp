@@ -80,6 +80,16 @@ InetAddr::InetAddr(const sockaddr_in6* addr)
     memcpy(addr_bytes, &addr->sin6_addr, 16);
 }
 
+InetAddr::InetAddr(InetFamily addr_family, const UCHAR* bytes)
+    : family(addr_family)
+{
+    if (family != INET_IPV4 && family != INET_IPV6)
+        invalid_address();
+
+    memset(addr_bytes, 0, sizeof(addr_bytes));
+    memcpy(addr_bytes, bytes, getSize());
+}
+
 void InetAddr::parseAddress(const char* addr_string)
 {
     if (!addr_string)
@@ -51,6 +51,7 @@ public:
     InetAddr(const sockaddr* addr);
     InetAddr(const sockaddr_in* addr);
     InetAddr(const sockaddr_in6* addr);
+    InetAddr(InetFamily family, const UCHAR* bytes);   // stored format, see makeIndexKey()
 
     // Assignment and conversion
     InetAddr& operator=(const char* addr_string);
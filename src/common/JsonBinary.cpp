@@ -0,0 +1,1246 @@
+/*
+ *	PROGRAM:		JSON Data Type
+ *	MODULE:			JsonBinary.cpp
+ *	DESCRIPTION:	Binary JSON image with indexed path access
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by ScratchBird Development Team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2025 ScratchBird Development Team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): _______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../common/JsonBinary.h"
+#include "../common/gdsassert.h"
+
+#include <algorithm>
+#include <string.h>
+
+// SSE2 is always present on x64, the scanner doesn't need a runtime check
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+using namespace ScratchBird;
+
+namespace
+{
+	const unsigned SCAN_BLOCK = 16;
+
+#ifdef JSON_SSE2
+	inline unsigned firstBit(unsigned mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return index;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+#endif
+
+	inline bool isSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
+
+	// Length of the run of string characters to be copied as is, i.e. not a
+	// quote, backslash or control character
+	ULONG plainRun(const char* ptr, const char* end)
+	{
+		const char* const start = ptr;
+
+#ifdef JSON_SSE2
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		const __m128i control = _mm_set1_epi8(0x1F);
+
+		for (; end - ptr >= (ptrdiff_t) SCAN_BLOCK; ptr += SCAN_BLOCK)
+		{
+			const __m128i chunk = _mm_loadu_si128((const __m128i*) ptr);
+
+			// Unsigned c <= 0x1F is the same as min(c, 0x1F) == c
+			const __m128i special = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+				_mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk));
+
+			const unsigned mask = _mm_movemask_epi8(special);
+
+			if (mask)
+				return (ULONG) (ptr - start) + firstBit(mask);
+		}
+#endif
+
+		while (ptr < end && *ptr != '"' && *ptr != '\\' && (UCHAR) *ptr >= 0x20)
+			ptr++;
+
+		return (ULONG) (ptr - start);
+	}
+
+	// Length of the whitespace run, pretty printed documents have long ones
+	ULONG spaceRun(const char* ptr, const char* end)
+	{
+		const char* const start = ptr;
+
+#ifdef JSON_SSE2
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i tab = _mm_set1_epi8('\t');
+		const __m128i lf = _mm_set1_epi8('\n');
+		const __m128i cr = _mm_set1_epi8('\r');
+
+		for (; end - ptr >= (ptrdiff_t) SCAN_BLOCK; ptr += SCAN_BLOCK)
+		{
+			const __m128i chunk = _mm_loadu_si128((const __m128i*) ptr);
+
+			const __m128i blank = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr)));
+
+			const unsigned mask = ~_mm_movemask_epi8(blank) & 0xFFFF;
+
+			if (mask)
+				return (ULONG) (ptr - start) + firstBit(mask);
+		}
+#endif
+
+		while (ptr < end && isSpace(*ptr))
+			ptr++;
+
+		return (ULONG) (ptr - start);
+	}
+
+	void putULong(Array<UCHAR>& image, ULONG value)
+	{
+		image.add((const UCHAR*) &value, sizeof(ULONG));
+	}
+
+	void setULong(Array<UCHAR>& image, FB_SIZE_T offset, ULONG value)
+	{
+		memcpy(image.begin() + offset, &value, sizeof(ULONG));
+	}
+
+	ULONG readULong(const UCHAR* ptr)
+	{
+		ULONG value;
+		memcpy(&value, ptr, sizeof(ULONG));
+		return value;
+	}
+
+	int compareKeys(const UCHAR* key1, ULONG length1, const UCHAR* key2, ULONG length2)
+	{
+		const int result = memcmp(key1, key2, MIN(length1, length2));
+
+		if (result)
+			return result;
+
+		return (length1 == length2) ? 0 : (length1 < length2 ? -1 : 1);
+	}
+
+	template <typename Offsets>
+	void putArray(Array<UCHAR>& image, const Offsets& offsets, const Array<UCHAR>& data)
+	{
+		image.add(JSON_ARRAY);
+		putULong(image, offsets.getCount());
+		putULong(image, offsets.getCount() * sizeof(ULONG) + data.getCount());
+
+		for (const auto offset : offsets)
+			putULong(image, offset);
+
+		image.add(data.begin(), data.getCount());
+	}
+
+	template <typename Members>
+	void putObject(Array<UCHAR>& image, const Members& members, const Array<UCHAR>& data)
+	{
+		image.add(JSON_OBJECT);
+		putULong(image, members.getCount());
+		putULong(image, members.getCount() * sizeof(JsonValue::Member) + data.getCount());
+
+		for (const auto& member : members)
+		{
+			putULong(image, member.key);
+			putULong(image, member.value);
+		}
+
+		image.add(data.begin(), data.getCount());
+	}
+
+	// Key of the object member being written to the data
+	ULONG putKey(Array<UCHAR>& data, const char* key, ULONG length)
+	{
+		const ULONG offset = data.getCount();
+		putULong(data, length);
+		data.add((const UCHAR*) key, length);
+		return offset;
+	}
+
+
+	class Parser
+	{
+	public:
+		Parser(MemoryPool& pool, const char* text, ULONG length)
+			: m_pool(pool), m_text(text), m_ptr(text), m_end(text + length)
+		{}
+
+		bool parseDocument(Array<UCHAR>& image)
+		{
+			skipSpaces();
+
+			if (!parseValue(image, 0))
+				return false;
+
+			skipSpaces();
+			return (m_ptr == m_end);
+		}
+
+		ULONG getOffset() const
+		{
+			return (ULONG) (m_ptr - m_text);
+		}
+
+	private:
+		void skipSpaces()
+		{
+			m_ptr += spaceRun(m_ptr, m_end);
+		}
+
+		bool parseValue(Array<UCHAR>& image, unsigned depth);
+		bool parseArray(Array<UCHAR>& image, unsigned depth);
+		bool parseObject(Array<UCHAR>& image, unsigned depth);
+		bool parseNumber(Array<UCHAR>& image);
+		bool parseString(Array<UCHAR>& image);
+		bool parseLiteral(const char* word, ULONG length);
+		bool parseHex(ULONG& code);
+
+		MemoryPool& m_pool;
+		const char* const m_text;
+		const char* m_ptr;
+		const char* const m_end;
+	};
+
+	bool Parser::parseValue(Array<UCHAR>& image, unsigned depth)
+	{
+		if (m_ptr >= m_end || depth > JsonBinary::MAX_DEPTH)
+			return false;
+
+		switch (*m_ptr)
+		{
+			case '{':
+				return parseObject(image, depth);
+
+			case '[':
+				return parseArray(image, depth);
+
+			case '"':
+			{
+				image.add(JSON_STRING);
+				return parseString(image);
+			}
+
+			case 't':
+				image.add(JSON_TRUE);
+				return parseLiteral("true", 4);
+
+			case 'f':
+				image.add(JSON_FALSE);
+				return parseLiteral("false", 5);
+
+			case 'n':
+				image.add(JSON_NULL);
+				return parseLiteral("null", 4);
+
+			default:
+				return parseNumber(image);
+		}
+	}
+
+	bool Parser::parseArray(Array<UCHAR>& image, unsigned depth)
+	{
+		fb_assert(*m_ptr == '[');
+		m_ptr++;
+
+		HalfStaticArray<ULONG, 16> offsets(m_pool);
+		Array<UCHAR> data(m_pool);
+
+		skipSpaces();
+
+		if (m_ptr < m_end && *m_ptr == ']')
+			m_ptr++;
+		else
+		{
+			while (true)
+			{
+				skipSpaces();
+				offsets.add(data.getCount());
+
+				if (!parseValue(data, depth + 1))
+					return false;
+
+				skipSpaces();
+
+				if (m_ptr >= m_end)
+					return false;
+
+				if (*m_ptr++ == ']')
+					break;
+
+				if (m_ptr[-1] != ',')
+				{
+					m_ptr--;
+					return false;
+				}
+			}
+		}
+
+		putArray(image, offsets, data);
+		return true;
+	}
+
+	bool Parser::parseObject(Array<UCHAR>& image, unsigned depth)
+	{
+		fb_assert(*m_ptr == '{');
+		m_ptr++;
+
+		HalfStaticArray<JsonValue::Member, 16> members(m_pool);
+		Array<UCHAR> data(m_pool);
+
+		skipSpaces();
+
+		if (m_ptr < m_end && *m_ptr == '}')
+			m_ptr++;
+		else
+		{
+			while (true)
+			{
+				skipSpaces();
+
+				if (m_ptr >= m_end || *m_ptr != '"')
+					return false;
+
+				JsonValue::Member member;
+				member.key = data.getCount();
+
+				if (!parseString(data))
+					return false;
+
+				skipSpaces();
+
+				if (m_ptr >= m_end || *m_ptr != ':')
+					return false;
+
+				m_ptr++;
+				skipSpaces();
+
+				member.value = data.getCount();
+
+				if (!parseValue(data, depth + 1))
+					return false;
+
+				members.add(member);
+				skipSpaces();
+
+				if (m_ptr >= m_end)
+					return false;
+
+				if (*m_ptr++ == '}')
+					break;
+
+				if (m_ptr[-1] != ',')
+				{
+					m_ptr--;
+					return false;
+				}
+			}
+		}
+
+		const UCHAR* const base = data.begin();
+
+		auto compareMembers = [base](const JsonValue::Member& m1, const JsonValue::Member& m2)
+		{
+			return compareKeys(base + m1.key + sizeof(ULONG), readULong(base + m1.key),
+				base + m2.key + sizeof(ULONG), readULong(base + m2.key)) < 0;
+		};
+
+		std::stable_sort(members.begin(), members.end(), compareMembers);
+
+		// The last of the duplicate keys wins, values of the others stay in
+		// the data unreferenced
+		FB_SIZE_T count = 0;
+
+		for (FB_SIZE_T i = 0; i < members.getCount(); i++)
+		{
+			if (i + 1 < members.getCount() && !compareMembers(members[i], members[i + 1]))
+				continue;
+
+			members[count++] = members[i];
+		}
+
+		members.shrink(count);
+
+		putObject(image, members, data);
+		return true;
+	}
+
+	bool Parser::parseNumber(Array<UCHAR>& image)
+	{
+		const char* const start = m_ptr;
+
+		auto digits = [this]()
+		{
+			const char* const first = m_ptr;
+
+			while (m_ptr < m_end && *m_ptr >= '0' && *m_ptr <= '9')
+				m_ptr++;
+
+			return (m_ptr > first);
+		};
+
+		if (m_ptr < m_end && *m_ptr == '-')
+			m_ptr++;
+
+		if (m_ptr < m_end && *m_ptr == '0')
+			m_ptr++;
+		else if (!digits())
+			return false;
+
+		if (m_ptr < m_end && *m_ptr == '.')
+		{
+			m_ptr++;
+
+			if (!digits())
+				return false;
+		}
+
+		if (m_ptr < m_end && (*m_ptr == 'e' || *m_ptr == 'E'))
+		{
+			m_ptr++;
+
+			if (m_ptr < m_end && (*m_ptr == '+' || *m_ptr == '-'))
+				m_ptr++;
+
+			if (!digits())
+				return false;
+		}
+
+		JsonBinary::putScalar(image, JSON_NUMBER, start, (ULONG) (m_ptr - start));
+		return true;
+	}
+
+	// Unescaped string as ULONG length and bytes
+	bool Parser::parseString(Array<UCHAR>& image)
+	{
+		fb_assert(*m_ptr == '"');
+		m_ptr++;
+
+		const FB_SIZE_T lengthOffset = image.getCount();
+		putULong(image, 0);
+
+		while (true)
+		{
+			const ULONG run = plainRun(m_ptr, m_end);
+			image.add((const UCHAR*) m_ptr, run);
+			m_ptr += run;
+
+			if (m_ptr >= m_end || (UCHAR) *m_ptr < 0x20)
+				return false;
+
+			if (*m_ptr++ == '"')
+				break;
+
+			// Escape sequence
+			if (m_ptr >= m_end)
+				return false;
+
+			const char c = *m_ptr++;
+
+			switch (c)
+			{
+				case '"':
+				case '\\':
+				case '/':
+					image.add(c);
+					break;
+
+				case 'b':
+					image.add('\b');
+					break;
+
+				case 'f':
+					image.add('\f');
+					break;
+
+				case 'n':
+					image.add('\n');
+					break;
+
+				case 'r':
+					image.add('\r');
+					break;
+
+				case 't':
+					image.add('\t');
+					break;
+
+				case 'u':
+				{
+					ULONG code;
+
+					if (!parseHex(code))
+						return false;
+
+					if (code >= 0xD800 && code <= 0xDBFF)
+					{
+						// Surrogate pair
+						ULONG low;
+
+						if (m_end - m_ptr < 2 || m_ptr[0] != '\\' || m_ptr[1] != 'u')
+							return false;
+
+						m_ptr += 2;
+
+						if (!parseHex(low) || low < 0xDC00 || low > 0xDFFF)
+							return false;
+
+						code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+					}
+					else if (code >= 0xDC00 && code <= 0xDFFF)
+						return false;
+
+					// UTF-8 encoding
+					if (code < 0x80)
+						image.add((UCHAR) code);
+					else if (code < 0x800)
+					{
+						image.add((UCHAR) (0xC0 | (code >> 6)));
+						image.add((UCHAR) (0x80 | (code & 0x3F)));
+					}
+					else if (code < 0x10000)
+					{
+						image.add((UCHAR) (0xE0 | (code >> 12)));
+						image.add((UCHAR) (0x80 | ((code >> 6) & 0x3F)));
+						image.add((UCHAR) (0x80 | (code & 0x3F)));
+					}
+					else
+					{
+						image.add((UCHAR) (0xF0 | (code >> 18)));
+						image.add((UCHAR) (0x80 | ((code >> 12) & 0x3F)));
+						image.add((UCHAR) (0x80 | ((code >> 6) & 0x3F)));
+						image.add((UCHAR) (0x80 | (code & 0x3F)));
+					}
+					break;
+				}
+
+				default:
+					m_ptr--;
+					return false;
+			}
+		}
+
+		setULong(image, lengthOffset, (ULONG) (image.getCount() - lengthOffset - sizeof(ULONG)));
+		return true;
+	}
+
+	bool Parser::parseHex(ULONG& code)
+	{
+		if (m_end - m_ptr < 4)
+			return false;
+
+		code = 0;
+
+		for (int i = 0; i < 4; i++)
+		{
+			const char c = *m_ptr++;
+			code <<= 4;
+
+			if (c >= '0' && c <= '9')
+				code |= c - '0';
+			else if (c >= 'a' && c <= 'f')
+				code |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F')
+				code |= c - 'A' + 10;
+			else
+				return false;
+		}
+
+		return true;
+	}
+
+	bool Parser::parseLiteral(const char* word, ULONG length)
+	{
+		if ((ULONG) (m_end - m_ptr) < length || memcmp(m_ptr, word, length))
+			return false;
+
+		m_ptr += length;
+		return true;
+	}
+
+
+	// Steps of the path: $.name."quoted name"[index][*]
+	class PathReader
+	{
+	public:
+		PathReader(const char* path, ULONG length)
+			: wildcard(false), m_ptr(path), m_end(path + length), m_error(false)
+		{
+			if (m_ptr < m_end && *m_ptr == '$')
+				m_ptr++;
+			else
+				m_error = true;
+		}
+
+		bool next()
+		{
+			if (m_error || m_ptr >= m_end)
+				return false;
+
+			wildcard = false;
+
+			if (*m_ptr == '.')
+			{
+				m_ptr++;
+				member = true;
+
+				if (m_ptr < m_end && *m_ptr == '"')
+				{
+					key = ++m_ptr;
+
+					while (m_ptr < m_end && *m_ptr != '"')
+						m_ptr++;
+
+					if (m_ptr >= m_end)
+						return fail();
+
+					keyLength = (ULONG) (m_ptr++ - key);
+				}
+				else
+				{
+					key = m_ptr;
+
+					while (m_ptr < m_end && *m_ptr != '.' && *m_ptr != '[')
+						m_ptr++;
+
+					keyLength = (ULONG) (m_ptr - key);
+
+					if (!keyLength)
+						return fail();
+				}
+
+				return true;
+			}
+
+			if (*m_ptr == '[')
+			{
+				m_ptr++;
+				member = false;
+				index = 0;
+
+				if (m_ptr < m_end && *m_ptr == '*')
+				{
+					if (++m_ptr >= m_end || *m_ptr++ != ']')
+						return fail();
+
+					wildcard = true;
+					return true;
+				}
+
+				const char* const start = m_ptr;
+
+				for (; m_ptr < m_end && *m_ptr >= '0' && *m_ptr <= '9'; m_ptr++)
+				{
+					if (index > (MAX_ULONG - 9) / 10)
+						return fail();
+
+					index = index * 10 + (*m_ptr - '0');
+				}
+
+				if (m_ptr == start || m_ptr >= m_end || *m_ptr++ != ']')
+					return fail();
+
+				return true;
+			}
+
+			return fail();
+		}
+
+		bool atEnd() const
+		{
+			return m_ptr >= m_end;
+		}
+
+		bool failed() const
+		{
+			return m_error;
+		}
+
+		bool member;
+		bool wildcard;
+		const char* key;
+		ULONG keyLength;
+		ULONG index;
+
+	private:
+		bool fail()
+		{
+			m_error = true;
+			return false;
+		}
+
+		const char* m_ptr;
+		const char* const m_end;
+		bool m_error;
+	};
+
+	void escapeText(string& result, const char* text, ULONG length)
+	{
+		static const char HEX[] = "0123456789abcdef";
+
+		result += '"';
+
+		for (const char* const end = text + length; text < end; )
+		{
+			const ULONG run = plainRun(text, end);
+			result.append(text, run);
+			text += run;
+
+			if (text >= end)
+				break;
+
+			const char c = *text++;
+
+			switch (c)
+			{
+				case '"':
+					result += "\\\"";
+					break;
+
+				case '\\':
+					result += "\\\\";
+					break;
+
+				case '\b':
+					result += "\\b";
+					break;
+
+				case '\f':
+					result += "\\f";
+					break;
+
+				case '\n':
+					result += "\\n";
+					break;
+
+				case '\r':
+					result += "\\r";
+					break;
+
+				case '\t':
+					result += "\\t";
+					break;
+
+				default:
+					result += "\\u00";
+					result += HEX[(c >> 4) & 0xF];
+					result += HEX[c & 0xF];
+					break;
+			}
+		}
+
+		result += '"';
+	}
+
+	bool setValue(MemoryPool& pool, const JsonValue& node, PathReader& path, const JsonValue& value,
+		Array<UCHAR>& image)
+	{
+		if (!path.next())
+		{
+			if (path.failed())
+				return false;
+
+			image.add(value.getImage(), value.getLength());
+			return true;
+		}
+
+		// The wildcard refers to many values, there is no single one to replace
+		if (path.wildcard)
+			return false;
+
+		// The missing member or element is created only at the end of the path
+		const bool last = path.atEnd();
+		Array<UCHAR> data(pool);
+
+		if (path.member)
+		{
+			if (node.getType() != JSON_OBJECT)
+				return false;
+
+			const char* const key = path.key;
+			const ULONG keyLength = path.keyLength;
+
+			bool found;
+			const ULONG position = node.searchMember(key, keyLength, found);
+
+			if (!found && !last)
+				return false;
+
+			HalfStaticArray<JsonValue::Member, 16> members(pool);
+			const ULONG count = node.getCount();
+
+			for (ULONG i = 0; i <= count; i++)
+			{
+				JsonValue::Member member;
+
+				if (i == position && !found)
+				{
+					member.key = putKey(data, key, keyLength);
+					member.value = data.getCount();
+					data.add(value.getImage(), value.getLength());
+					members.add(member);
+				}
+
+				if (i == count)
+					break;
+
+				const char* memberKey;
+				ULONG memberKeyLength;
+				JsonValue child;
+				node.getMember(i, memberKey, memberKeyLength, child);
+
+				member.key = putKey(data, memberKey, memberKeyLength);
+				member.value = data.getCount();
+
+				if (i == position && found)
+				{
+					if (!setValue(pool, child, path, value, data))
+						return false;
+				}
+				else
+					data.add(child.getImage(), child.getLength());
+
+				members.add(member);
+			}
+
+			putObject(image, members, data);
+			return true;
+		}
+
+		if (node.getType() != JSON_ARRAY)
+			return false;
+
+		const ULONG count = node.getCount();
+		const ULONG index = path.index;
+
+		if (index >= count && !last)
+			return false;
+
+		HalfStaticArray<ULONG, 16> offsets(pool);
+
+		for (ULONG i = 0; i < count; i++)
+		{
+			const JsonValue child = node.getElement(i);
+			offsets.add(data.getCount());
+
+			if (i == index)
+			{
+				if (!setValue(pool, child, path, value, data))
+					return false;
+			}
+			else
+				data.add(child.getImage(), child.getLength());
+		}
+
+		if (index >= count)
+		{
+			offsets.add(data.getCount());
+			data.add(value.getImage(), value.getLength());
+		}
+
+		putArray(image, offsets, data);
+		return true;
+	}
+
+	void collectValues(const JsonValue& node, PathReader path, HalfStaticArray<JsonValue, 16>& values)
+	{
+		JsonValue current = node;
+
+		while (path.next())
+		{
+			if (path.member)
+			{
+				if (current.getType() != JSON_OBJECT ||
+					!current.findMember(path.key, path.keyLength, current))
+				{
+					return;
+				}
+			}
+			else if (path.wildcard)
+			{
+				if (current.getType() != JSON_ARRAY)
+					return;
+
+				// Every element continues with its own copy of the rest of the path
+				for (ULONG i = 0; i < current.getCount(); i++)
+					collectValues(current.getElement(i), path, values);
+
+				return;
+			}
+			else
+			{
+				if (current.getType() != JSON_ARRAY || path.index >= current.getCount())
+					return;
+
+				current = current.getElement(path.index);
+			}
+		}
+
+		values.add(current);
+	}
+}	// namespace
+
+
+namespace ScratchBird {
+
+// JsonValue implementation
+
+ULONG JsonValue::getULong(const UCHAR* ptr)
+{
+	return readULong(ptr);
+}
+
+ULONG JsonValue::getLength() const
+{
+	switch (getType())
+	{
+		case JSON_NUMBER:
+		case JSON_STRING:
+			return 1 + sizeof(ULONG) + getULong(m_ptr + 1);
+
+		case JSON_ARRAY:
+		case JSON_OBJECT:
+			return 1 + 2 * sizeof(ULONG) + getULong(m_ptr + 1 + sizeof(ULONG));
+
+		default:
+			return 1;
+	}
+}
+
+void JsonValue::getText(const char*& text, ULONG& length) const
+{
+	fb_assert(getType() == JSON_NUMBER || getType() == JSON_STRING);
+
+	length = getULong(m_ptr + 1);
+	text = (const char*) m_ptr + 1 + sizeof(ULONG);
+}
+
+ULONG JsonValue::getCount() const
+{
+	fb_assert(!isScalar());
+	return getULong(m_ptr + 1);
+}
+
+const UCHAR* JsonValue::getData() const
+{
+	const ULONG entrySize = (getType() == JSON_ARRAY) ? sizeof(ULONG) : sizeof(Member);
+	return getTable() + getCount() * entrySize;
+}
+
+JsonValue::Member JsonValue::getMemberEntry(ULONG index) const
+{
+	Member member;
+	memcpy(&member, getTable() + index * sizeof(Member), sizeof(Member));
+	return member;
+}
+
+JsonValue JsonValue::getElement(ULONG index) const
+{
+	fb_assert(getType() == JSON_ARRAY && index < getCount());
+	return JsonValue(getData() + getULong(getTable() + index * sizeof(ULONG)));
+}
+
+ULONG JsonValue::searchMember(const char* key, ULONG keyLength, bool& found) const
+{
+	fb_assert(getType() == JSON_OBJECT);
+
+	const UCHAR* const data = getData();
+	ULONG low = 0, high = getCount();
+
+	found = false;
+
+	while (low < high)
+	{
+		const ULONG middle = (low + high) / 2;
+		const UCHAR* const memberKey = data + getMemberEntry(middle).key;
+
+		const int result = compareKeys(memberKey + sizeof(ULONG), getULong(memberKey),
+			(const UCHAR*) key, keyLength);
+
+		if (result < 0)
+			low = middle + 1;
+		else if (result > 0)
+			high = middle;
+		else
+		{
+			found = true;
+			return middle;
+		}
+	}
+
+	return low;
+}
+
+bool JsonValue::findMember(const char* key, ULONG keyLength, JsonValue& value) const
+{
+	bool found;
+	const ULONG position = searchMember(key, keyLength, found);
+
+	if (found)
+		value = JsonValue(getData() + getMemberEntry(position).value);
+
+	return found;
+}
+
+void JsonValue::getMember(ULONG index, const char*& key, ULONG& keyLength, JsonValue& value) const
+{
+	fb_assert(getType() == JSON_OBJECT && index < getCount());
+
+	const UCHAR* const data = getData();
+	const Member member = getMemberEntry(index);
+
+	keyLength = getULong(data + member.key);
+	key = (const char*) data + member.key + sizeof(ULONG);
+	value = JsonValue(data + member.value);
+}
+
+bool JsonValue::extract(const char* path, ULONG pathLength, JsonValue& value) const
+{
+	PathReader reader(path, pathLength);
+	JsonValue current = *this;
+
+	while (reader.next())
+	{
+		if (reader.wildcard)
+			return false;
+
+		if (reader.member)
+		{
+			if (current.getType() != JSON_OBJECT ||
+				!current.findMember(reader.key, reader.keyLength, current))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			if (current.getType() != JSON_ARRAY || reader.index >= current.getCount())
+				return false;
+
+			current = current.getElement(reader.index);
+		}
+	}
+
+	if (reader.failed())
+		return false;
+
+	value = current;
+	return true;
+}
+
+void JsonValue::toText(string& result) const
+{
+	switch (getType())
+	{
+		case JSON_NULL:
+			result += "null";
+			break;
+
+		case JSON_FALSE:
+			result += "false";
+			break;
+
+		case JSON_TRUE:
+			result += "true";
+			break;
+
+		case JSON_NUMBER:
+		case JSON_STRING:
+		{
+			const char* text;
+			ULONG length;
+			getText(text, length);
+
+			if (getType() == JSON_NUMBER)
+				result.append(text, length);
+			else
+				escapeText(result, text, length);
+			break;
+		}
+
+		case JSON_ARRAY:
+		{
+			result += '[';
+
+			for (ULONG i = 0; i < getCount(); i++)
+			{
+				if (i)
+					result += ',';
+
+				getElement(i).toText(result);
+			}
+
+			result += ']';
+			break;
+		}
+
+		case JSON_OBJECT:
+		{
+			result += '{';
+
+			for (ULONG i = 0; i < getCount(); i++)
+			{
+				const char* key;
+				ULONG keyLength;
+				JsonValue value;
+				getMember(i, key, keyLength, value);
+
+				if (i)
+					result += ',';
+
+				escapeText(result, key, keyLength);
+				result += ':';
+				value.toText(result);
+			}
+
+			result += '}';
+			break;
+		}
+	}
+}
+
+void JsonValue::toPlainText(string& result) const
+{
+	if (getType() == JSON_STRING)
+	{
+		const char* text;
+		ULONG length;
+		getText(text, length);
+
+		result.append(text, length);
+	}
+	else
+		toText(result);
+}
+
+
+// JsonBinary implementation
+
+bool JsonBinary::parse(MemoryPool& pool, const char* text, ULONG length, Array<UCHAR>& image,
+	ULONG* errorOffset)
+{
+	Parser parser(pool, text, length);
+	const FB_SIZE_T start = image.getCount();
+
+	if (parser.parseDocument(image))
+		return true;
+
+	image.shrink(start);
+
+	if (errorOffset)
+		*errorOffset = parser.getOffset();
+
+	return false;
+}
+
+bool JsonBinary::validate(const char* text, ULONG length)
+{
+	MemoryPool& pool = *getDefaultMemoryPool();
+	Array<UCHAR> image(pool);
+	return parse(pool, text, length, image);
+}
+
+bool JsonBinary::set(MemoryPool& pool, const JsonValue& root, const char* path, ULONG pathLength,
+	const JsonValue& value, Array<UCHAR>& image)
+{
+	PathReader reader(path, pathLength);
+	const FB_SIZE_T start = image.getCount();
+
+	if (setValue(pool, root, reader, value, image))
+		return true;
+
+	image.shrink(start);
+	return false;
+}
+
+bool JsonBinary::extractAll(MemoryPool& pool, const JsonValue& root, const char* path,
+	ULONG pathLength, Array<UCHAR>& image)
+{
+	PathReader reader(path, pathLength);
+
+	// Check the whole path first, the steps not reached in the document
+	// would be never looked at
+	PathReader check(reader);
+
+	while (check.next())
+		;
+
+	if (check.failed())
+		return false;
+
+	HalfStaticArray<JsonValue, 16> values(pool);
+	collectValues(root, reader, values);
+
+	HalfStaticArray<ULONG, 16> offsets(pool);
+	Array<UCHAR> data(pool);
+
+	for (const auto& value : values)
+	{
+		offsets.add(data.getCount());
+		data.add(value.getImage(), value.getLength());
+	}
+
+	putArray(image, offsets, data);
+	return true;
+}
+
+bool JsonBinary::hasWildcard(const char* path, ULONG pathLength)
+{
+	PathReader reader(path, pathLength);
+
+	while (reader.next())
+	{
+		if (reader.wildcard)
+			return true;
+	}
+
+	return false;
+}
+
+void JsonBinary::putScalar(Array<UCHAR>& image, JsonType type, const char* text, ULONG length)
+{
+	fb_assert(type == JSON_NUMBER || type == JSON_STRING);
+
+	image.add((UCHAR) type);
+	putULong(image, length);
+	image.add((const UCHAR*) text, length);
+}
+
+} // namespace ScratchBird
@@ -0,0 +1,167 @@
+/*
+ *	PROGRAM:		JSON Data Type
+ *	MODULE:			JsonBinary.h
+ *	DESCRIPTION:	Binary JSON image with indexed path access
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by ScratchBird Development Team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2025 ScratchBird Development Team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): _______________________________________.
+ *
+ */
+
+#ifndef SB_JSON_BINARY_H
+#define SB_JSON_BINARY_H
+
+#include "../common/classes/array.h"
+#include "../common/classes/fb_string.h"
+
+namespace ScratchBird {
+
+enum JsonType
+{
+	JSON_NULL = 0,
+	JSON_FALSE = 1,
+	JSON_TRUE = 2,
+	JSON_NUMBER = 3,
+	JSON_STRING = 4,
+	JSON_ARRAY = 5,
+	JSON_OBJECT = 6
+};
+
+// Value inside of the binary JSON image. Every value starts with its type
+// byte and is followed by:
+//
+//	null, false, true:	nothing
+//	number, string:		ULONG length, text (numbers as written, strings unescaped)
+//	array:				ULONG count, ULONG size, ULONG offsets[count], elements
+//	object:				ULONG count, ULONG size, Member members[count], data
+//
+// where size is the length of everything after it. Object members are sorted
+// by key bytes (shorter first when one is a prefix of another) and refer to
+// the key (ULONG length, bytes) and the value placed in the data. Offsets are
+// relative to the end of the table. So the member is found with a binary
+// search and the element is addressed directly, the path of depth N costs
+// O(N * log keys). ULONGs are unaligned and in the native byte order.
+class JsonValue
+{
+public:
+	struct Member
+	{
+		ULONG key;
+		ULONG value;
+	};
+
+	JsonValue()
+		: m_ptr(NULL)
+	{}
+
+	explicit JsonValue(const UCHAR* ptr)
+		: m_ptr(ptr)
+	{}
+
+	bool isEmpty() const
+	{
+		return !m_ptr;
+	}
+
+	JsonType getType() const
+	{
+		return (JsonType) *m_ptr;
+	}
+
+	bool isScalar() const
+	{
+		return getType() < JSON_ARRAY;
+	}
+
+	// Length of the value image
+	ULONG getLength() const;
+
+	const UCHAR* getImage() const
+	{
+		return m_ptr;
+	}
+
+	// Number or string text
+	void getText(const char*& text, ULONG& length) const;
+
+	// Array elements or object members
+	ULONG getCount() const;
+
+	JsonValue getElement(ULONG index) const;
+	bool findMember(const char* key, ULONG keyLength, JsonValue& value) const;
+	void getMember(ULONG index, const char*& key, ULONG& keyLength, JsonValue& value) const;
+
+	// Position of the member with the key or the one to insert it before
+	ULONG searchMember(const char* key, ULONG keyLength, bool& found) const;
+
+	// Lookup by the path: $, .name, ."quoted name", [index]. The path with
+	// the [*] wildcard refers to many values, see JsonBinary::extractAll().
+	bool extract(const char* path, ULONG pathLength, JsonValue& value) const;
+
+	void toText(string& result) const;
+
+	// Strings unquoted, other values as JSON text, i.e. what JSON_EXTRACT
+	// returns and JSON_CONTAINS compares
+	void toPlainText(string& result) const;
+
+private:
+	static ULONG getULong(const UCHAR* ptr);
+
+	const UCHAR* getTable() const
+	{
+		return m_ptr + 1 + 2 * sizeof(ULONG);
+	}
+
+	const UCHAR* getData() const;
+	Member getMemberEntry(ULONG index) const;
+
+	const UCHAR* m_ptr;
+};
+
+class JsonBinary
+{
+public:
+	static const unsigned MAX_DEPTH = 256;
+
+	// Parse the text into the image. On error returns false and the offset of
+	// the wrong character.
+	static bool parse(MemoryPool& pool, const char* text, ULONG length, Array<UCHAR>& image,
+		ULONG* errorOffset = NULL);
+	static bool validate(const char* text, ULONG length);
+
+	// Copy of the image with the value at the path replaced. The missing
+	// object member is added, the array index past the end appends. Returns
+	// false if the path is wrong or its parent doesn't exist.
+	static bool set(MemoryPool& pool, const JsonValue& root, const char* path, ULONG pathLength,
+		const JsonValue& value, Array<UCHAR>& image);
+
+	// Array of all the values matching the path where [*] stands for every
+	// array element, in the document order. Returns false if the path is wrong.
+	static bool extractAll(MemoryPool& pool, const JsonValue& root, const char* path,
+		ULONG pathLength, Array<UCHAR>& image);
+	static bool hasWildcard(const char* path, ULONG pathLength);
+
+	// Append the image of the number or string
+	static void putScalar(Array<UCHAR>& image, JsonType type, const char* text, ULONG length);
+};
+
+} // namespace ScratchBird
+
+#endif // SB_JSON_BINARY_H
@@ -0,0 +1,265 @@
+/*
+ *	PROGRAM:		Common Access Method
+ *	MODULE:			Lz4Block.cpp
+ *	DESCRIPTION:	LZ4 block format codec
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by ScratchBird Development Team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2025 ScratchBird Development Team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): _______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../common/Lz4Block.h"
+
+#include <string.h>
+
+using namespace ScratchBird;
+
+// LZ4 block format, see https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+//
+// The image is a sequence of {token, literals, offset, match} groups. High nibble of
+// the token is the number of literals, low nibble is the match length minus 4. Value 15
+// means the length continues in the following bytes, each 255 adds to it until a byte
+// less than 255. Offset is a two-byte little-endian distance back to the match source.
+// The last group has literals only, the last 5 bytes of the data are always literals
+// and a match can't start closer than 12 bytes to the end of data.
+
+namespace
+{
+	const unsigned LZ_MIN_MATCH = 4;
+	const unsigned LZ_LAST_LITERALS = 5;
+	const unsigned LZ_MF_LIMIT = 12;
+	const unsigned LZ_MAX_OFFSET = MAX_USHORT;
+	const unsigned LZ_RUN_MASK = 15;
+
+	const unsigned LZ_HASH_BITS = 12;
+	const unsigned LZ_SKIP_TRIGGER = 6;	// speed up scanning of incompressible data
+
+	inline ULONG lzRead32(const UCHAR* p)
+	{
+		ULONG value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	inline unsigned lzHash(ULONG sequence)
+	{
+		return (sequence * 2654435761U) >> (32 - LZ_HASH_BITS);
+	}
+
+	// Put the length extension bytes, the first LZ_RUN_MASK is in the token already
+	inline UCHAR* lzPutLength(UCHAR* output, ULONG length)
+	{
+		for (length -= LZ_RUN_MASK; length >= MAX_UCHAR; length -= MAX_UCHAR)
+			*output++ = MAX_UCHAR;
+
+		*output++ = (UCHAR) length;
+		return output;
+	}
+
+	inline bool lzGetLength(const UCHAR*& input, const UCHAR* const end, ULONG& length)
+	{
+		if (length == LZ_RUN_MASK)
+		{
+			UCHAR c;
+
+			do
+			{
+				if (input >= end)
+					return false;
+
+				c = *input++;
+				length += c;
+			} while (c == MAX_UCHAR);
+		}
+
+		return true;
+	}
+}
+
+ULONG Lz4Block::pack(ULONG inLength, const UCHAR* input, ULONG outLength, UCHAR* output)
+{
+/**************************************
+ *
+ *	Compress a string using LZ4, greedy parsing.
+ *	Return the image length or zero if it doesn't fit the output.
+ *
+ **************************************/
+	const auto output_start = output;
+	const auto output_end = output + outLength;
+
+	ULONG table[1 << LZ_HASH_BITS];
+	memset(table, 0, sizeof(table));
+
+	const auto end = input + inLength;
+	const auto match_limit = end - MIN(inLength, LZ_LAST_LITERALS);
+	const auto search_limit = end - MIN(inLength, LZ_MF_LIMIT);
+
+	auto anchor = input;
+	auto p = input + 1;
+	unsigned misses = 0;
+
+	while (p < search_limit)
+	{
+		const ULONG sequence = lzRead32(p);
+		const unsigned hash = lzHash(sequence);
+		auto ref = input + table[hash];
+		table[hash] = p - input;
+
+		if (ref >= p || p - ref > LZ_MAX_OFFSET || lzRead32(ref) != sequence)
+		{
+			p += 1 + (misses++ >> LZ_SKIP_TRIGGER);
+			continue;
+		}
+
+		misses = 0;
+
+		// Extend the match backwards over pending literals and then forwards
+
+		while (p > anchor && ref > input && p[-1] == ref[-1])
+		{
+			p--;
+			ref--;
+		}
+
+		auto q = p + LZ_MIN_MATCH;
+		for (auto r = ref + LZ_MIN_MATCH; q < match_limit && *q == *r; q++, r++)
+			;
+
+		const ULONG literals = p - anchor;
+		const ULONG match = q - p - LZ_MIN_MATCH;
+
+		// token, literals with their length, offset and match length
+		if (output + 1 + literals + literals / MAX_UCHAR + 1 + sizeof(USHORT) +
+			match / MAX_UCHAR + 1 > output_end)
+		{
+			return 0;
+		}
+
+		UCHAR* const token = output++;
+		*token = (UCHAR) (MIN(literals, LZ_RUN_MASK) << 4);
+
+		if (literals >= LZ_RUN_MASK)
+			output = lzPutLength(output, literals);
+
+		memcpy(output, anchor, literals);
+		output += literals;
+
+		const ULONG offset = p - ref;
+		*output++ = (UCHAR) offset;
+		*output++ = (UCHAR) (offset >> 8);
+
+		*token |= (UCHAR) MIN(match, LZ_RUN_MASK);
+
+		if (match >= LZ_RUN_MASK)
+			output = lzPutLength(output, match);
+
+		// Register a position inside the match to improve the next search
+
+		if (q - 2 > p)
+			table[lzHash(lzRead32(q - 2))] = q - 2 - input;
+
+		anchor = p = q;
+	}
+
+	// Last literals
+
+	const ULONG literals = end - anchor;
+
+	if (output + 1 + literals + literals / MAX_UCHAR + 1 > output_end)
+		return 0;
+
+	*output++ = (UCHAR) (MIN(literals, LZ_RUN_MASK) << 4);
+
+	if (literals >= LZ_RUN_MASK)
+		output = lzPutLength(output, literals);
+
+	memcpy(output, anchor, literals);
+	output += literals;
+
+	return output - output_start;
+}
+
+bool Lz4Block::unpack(ULONG inLength, const UCHAR* input, ULONG outLength, UCHAR* output)
+{
+/**************************************
+ *
+ *	Decompress LZ4 image into a buffer of the original length.
+ *	Anything after the image is ignored.
+ *
+ **************************************/
+	const auto output_start = output;
+	const auto output_end = output + outLength;
+	const auto end = input + inLength;
+
+	while (true)
+	{
+		if (input >= end)
+			return false;
+
+		const UCHAR token = *input++;
+
+		ULONG literals = token >> 4;
+		if (!lzGetLength(input, end, literals))
+			return false;
+
+		if (literals > (ULONG) (end - input) || literals > (ULONG) (output_end - output))
+			return false;
+
+		memcpy(output, input, literals);
+		output += literals;
+		input += literals;
+
+		if (output == output_end)
+			return true;
+
+		if (input + sizeof(USHORT) > end)
+			return false;
+
+		const ULONG offset = input[0] | (input[1] << 8);
+		input += sizeof(USHORT);
+
+		ULONG match = token & LZ_RUN_MASK;
+		if (!lzGetLength(input, end, match))
+			return false;
+
+		match += LZ_MIN_MATCH;
+
+		if (!offset || offset > (ULONG) (output - output_start) ||
+			match > (ULONG) (output_end - output))
+		{
+			return false;
+		}
+
+		const UCHAR* ref = output - offset;
+
+		if (offset >= match)
+		{
+			memcpy(output, ref, match);
+			output += match;
+		}
+		else
+		{
+			// Overlapped match repeats the last offset bytes
+			for (const auto stop = output + match; output < stop;)
+				*output++ = *ref++;
+		}
+	}
+}
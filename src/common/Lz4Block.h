@@ -0,0 +1,50 @@
+/*
+ *	PROGRAM:		Common Access Method
+ *	MODULE:			Lz4Block.h
+ *	DESCRIPTION:	LZ4 block format codec
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by ScratchBird Development Team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2025 ScratchBird Development Team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): _______________________________________.
+ *
+ */
+
+#ifndef COMMON_LZ4_BLOCK_H
+#define COMMON_LZ4_BLOCK_H
+
+#include "firebird.h"
+
+namespace ScratchBird {
+
+// Raw LZ4 block, without a frame and without the length of original data.
+// Users keep the length themselves: records prefix the image with it,
+// the remote protocol has it in the block header.
+class Lz4Block
+{
+public:
+	// Returns length of the image or zero if the image doesn't fit into outLength
+	static ULONG pack(ULONG inLength, const UCHAR* input, ULONG outLength, UCHAR* output);
+
+	// Unpacks exactly outLength bytes, returns false if the image is corrupt
+	static bool unpack(ULONG inLength, const UCHAR* input, ULONG outLength, UCHAR* output);
+};
+
+} // namespace ScratchBird
+
+#endif // COMMON_LZ4_BLOCK_H
@@ -104,26 +104,17 @@ template<typename T>
 bool Range<T>::contains(const Range<T>& other) const {
     if (isEmpty() || other.isEmpty()) return false;
     
-    // Check if this range contains other's bounds
-    if (!other.isLowerInfinite()) {
-        if (!contains(other.lower)) {
-            // Special case: if other's lower bound is not included,
-            // we might still contain it if our bounds match exactly
-            if (!(other.isLowerIncluded() == false && 
-                  !isLowerInfinite() && lower == other.lower && isLowerIncluded())) {
-                return false;
-            }
-        }
+    // Other's lower bound must not be below ours, an exclusive bound
+    // is past the value it's made of
+    if (!isLowerInfinite()) {
+        if (other.isLowerInfinite() || other.lower < lower) return false;
+        if (other.lower == lower && !isLowerIncluded() && other.isLowerIncluded()) return false;
     }
     
-    if (!other.isUpperInfinite()) {
-        if (!contains(other.upper)) {
-            // Special case for upper bound
-            if (!(other.isUpperIncluded() == false && 
-                  !isUpperInfinite() && upper == other.upper && isUpperIncluded())) {
-                return false;
-            }
-        }
+    // Same for the upper bound
+    if (!isUpperInfinite()) {
+        if (other.isUpperInfinite() || other.upper > upper) return false;
+        if (other.upper == upper && !isUpperIncluded() && other.isUpperIncluded()) return false;
     }
     
     return true;
@@ -151,6 +142,52 @@ bool Range<T>::overlaps(const Range<T>& other) const {
     return true;
 }
 
+template<typename T>
+bool Range<T>::isStrictlyLeft(const Range<T>& other) const {
+    if (isEmpty() || other.isEmpty()) return false;
+    if (isUpperInfinite() || other.isLowerInfinite()) return false;
+
+    return upper < other.lower ||
+           (upper == other.lower && (!isUpperIncluded() || !other.isLowerIncluded()));
+}
+
+template<typename T>
+bool Range<T>::isStrictlyRight(const Range<T>& other) const {
+    return other.isStrictlyLeft(*this);
+}
+
+template<typename T>
+bool Range<T>::operator==(const Range<T>& other) const {
+    if (isEmpty() || other.isEmpty()) return isEmpty() == other.isEmpty();
+    if (flags != other.flags) return false;
+
+    return (isLowerInfinite() || lower == other.lower) &&
+           (isUpperInfinite() || upper == other.upper);
+}
+
+template<typename T>
+bool Range<T>::operator<(const Range<T>& other) const {
+    // Empty range sorts first, then ranges are ordered by the lower bound
+    // and by the upper one (PostgreSQL order)
+    if (isEmpty() || other.isEmpty()) return isEmpty() && !other.isEmpty();
+
+    if (isLowerInfinite() != other.isLowerInfinite()) return isLowerInfinite();
+    if (!isLowerInfinite()) {
+        if (lower < other.lower) return true;
+        if (other.lower < lower) return false;
+        if (isLowerIncluded() != other.isLowerIncluded()) return isLowerIncluded();
+    }
+
+    if (isUpperInfinite() != other.isUpperInfinite()) return other.isUpperInfinite();
+    if (!isUpperInfinite()) {
+        if (upper < other.upper) return true;
+        if (other.upper < upper) return false;
+        if (isUpperIncluded() != other.isUpperIncluded()) return other.isUpperIncluded();
+    }
+
+    return false;
+}
+
 template<typename T>
 void Range<T>::toString(string& result) const {
     if (isEmpty()) {
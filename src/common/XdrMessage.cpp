@@ -0,0 +1,623 @@
+/*
+ *	PROGRAM:		External Data Representation
+ *	MODULE:			XdrMessage.cpp
+ *	DESCRIPTION:	Message level XDR codec driven by a per-format plan
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by ScratchBird Development Team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2025 ScratchBird Development Team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): _______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../common/XdrMessage.h"
+#include "../common/gdsassert.h"
+
+#include <string.h>
+
+// SSE2 is always present on x64, the loops don't need a runtime check
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XDR_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace ScratchBird;
+
+namespace
+{
+	// Size of the buffer the words are converted in
+	const ULONG STAGING_SIZE = 4096;
+
+	// Longer strings are moved directly between the message and the stream
+	const ULONG DIRECT_SIZE = 1024;
+
+	const SCHAR filler[4] = {0, 0, 0, 0};
+
+	inline ULONG padded(ULONG length)
+	{
+		return (length + 3) & ~3u;
+	}
+
+	inline bool isNull(const UCHAR* nulls, FB_SIZE_T n)
+	{
+		return nulls && (nulls[n >> 3] & (1 << (n & 7)));
+	}
+
+	inline bool swapNeeded(XdrMessagePlan::ByteOrder order)
+	{
+#ifndef WORDS_BIGENDIAN
+		return order == XdrMessagePlan::ORDER_XDR;
+#else
+		return false;
+#endif
+	}
+
+	// Output buffer of the encoder. Words are stored in the host order and the
+	// ones put since the last opaque chunk are swapped together before it.
+
+	class Staging
+	{
+	public:
+		Staging(xdr_t* xdrs, bool swap)
+			: m_xdrs(xdrs), m_swap(swap), m_length(0), m_plain(0)
+		{ }
+
+		bool putWord(SLONG value)
+		{
+			if (m_length + sizeof(SLONG) > STAGING_SIZE && !flush())
+				return false;
+
+			memcpy(m_buffer + m_length, &value, sizeof(SLONG));
+			m_length += sizeof(SLONG);
+			return true;
+		}
+
+		// Room for the number of words put by the caller
+		UCHAR* reserveWords(ULONG count)
+		{
+			const ULONG length = count * sizeof(SLONG);
+
+			if (m_length + length > STAGING_SIZE && !flush())
+				return NULL;
+
+			UCHAR* const ptr = m_buffer + m_length;
+			m_length += length;
+			return ptr;
+		}
+
+		bool putBytes(const UCHAR* data, ULONG length)
+		{
+			const ULONG fill = padded(length) - length;
+
+			if (length > DIRECT_SIZE)
+			{
+				return flush() &&
+					m_xdrs->x_putbytes(reinterpret_cast<const SCHAR*>(data), length) &&
+					(!fill || m_xdrs->x_putbytes(filler, fill));
+			}
+
+			if (m_length + length + fill > STAGING_SIZE && !flush())
+				return false;
+
+			swapPending();
+
+			memcpy(m_buffer + m_length, data, length);
+			memset(m_buffer + m_length + length, 0, fill);
+			m_length += length + fill;
+			m_plain = m_length;
+			return true;
+		}
+
+		bool flush()
+		{
+			swapPending();
+
+			const ULONG length = m_length;
+			m_length = m_plain = 0;
+
+			return !length || m_xdrs->x_putbytes(reinterpret_cast<const SCHAR*>(m_buffer), length);
+		}
+
+	private:
+		void swapPending()
+		{
+			if (m_swap && m_length > m_plain)
+				XdrMessagePlan::swapWords(m_buffer + m_plain, (m_length - m_plain) / sizeof(SLONG));
+
+			m_plain = m_length;
+		}
+
+		xdr_t* const m_xdrs;
+		const bool m_swap;
+		ULONG m_length;
+		ULONG m_plain;		// start of the words not swapped yet
+		UCHAR m_buffer[STAGING_SIZE];
+	};
+}
+
+
+XdrMessagePlan::XdrMessagePlan(MemoryPool& pool, const dsc* desc, FB_SIZE_T count, unsigned step)
+	: PermanentStorage(pool),
+	  m_items(pool),
+	  m_elements(pool),
+	  m_valid(true)
+{
+	fb_assert(step);
+
+	for (FB_SIZE_T n = 0; n < count; n += step)
+	{
+		const dsc& d = desc[n];
+
+		Item item;
+		item.offset = (ULONG) (IPTR) d.dsc_address;
+		item.length = d.dsc_length;
+		item.type = ITEM_WORDS;
+		item.elements = 0;
+		item.first = (USHORT) m_elements.getCount();
+
+		// Elements are listed in the order xdr_datum() puts them to the stream
+
+		switch (d.dsc_dtype)
+		{
+		case dtype_dbkey:
+		case dtype_text:
+		case dtype_boolean:
+			item.type = ITEM_OPAQUE;
+			break;
+
+		case dtype_varying:
+			item.type = ITEM_VARYING;
+			m_valid = d.dsc_length >= sizeof(USHORT);
+			break;
+
+		case dtype_cstring:
+			item.type = ITEM_CSTRING;
+			m_valid = d.dsc_length >= 1;
+			break;
+
+		case dtype_short:
+			addElement(item, 0, ELEMENT_SHORT);
+			break;
+
+		case dtype_sql_time:
+		case dtype_sql_date:
+		case dtype_long:
+		case dtype_real:
+			addElement(item, 0);
+			break;
+
+		case dtype_sql_time_tz:
+			addElement(item, 0);
+			addElement(item, 4, ELEMENT_SHORT);
+			break;
+
+		case dtype_ex_time_tz:
+			addElement(item, 0);
+			addElement(item, 4, ELEMENT_SHORT);
+			addElement(item, 6, ELEMENT_SHORT);
+			break;
+
+		case dtype_double:
+			addElement(item, (UCHAR) (FB_LONG_DOUBLE_FIRST * sizeof(SLONG)));
+			addElement(item, (UCHAR) (FB_LONG_DOUBLE_SECOND * sizeof(SLONG)));
+			break;
+
+		case dtype_dec64:
+			addElement(item, 4);
+			addElement(item, 0);
+			break;
+
+		case dtype_dec128:
+			addElement(item, 12);
+			addElement(item, 8);
+			addElement(item, 4);
+			addElement(item, 0);
+			break;
+
+		case dtype_int128:
+#ifndef WORDS_BIGENDIAN
+			addElement(item, 12);
+			addElement(item, 8);
+			addElement(item, 4);
+			addElement(item, 0);
+#else
+			addElement(item, 0);
+			addElement(item, 4);
+			addElement(item, 8);
+			addElement(item, 12);
+#endif
+			break;
+
+		case dtype_int64:
+#ifndef WORDS_BIGENDIAN
+			addElement(item, 4);
+			addElement(item, 0);
+#else
+			addElement(item, 0);
+			addElement(item, 4);
+#endif
+			break;
+
+		case dtype_timestamp:
+		case dtype_array:
+		case dtype_quad:
+		case dtype_blob:
+			addElement(item, 0);
+			addElement(item, 4);
+			break;
+
+		case dtype_timestamp_tz:
+			addElement(item, 0);
+			addElement(item, 4);
+			addElement(item, 8, ELEMENT_SHORT);
+			break;
+
+		case dtype_ex_timestamp_tz:
+			addElement(item, 0);
+			addElement(item, 4);
+			addElement(item, 8, ELEMENT_SHORT);
+			addElement(item, 10, ELEMENT_SHORT);
+			break;
+
+		default:
+			m_valid = false;
+		}
+
+		if (!m_valid)
+			return;
+
+		m_items.add(item);
+	}
+}
+
+
+void XdrMessagePlan::addElement(Item& item, UCHAR offset, ElementType type)
+{
+	const unsigned size = (type == ELEMENT_SHORT) ? sizeof(SSHORT) : sizeof(SLONG);
+
+	if (offset + size > item.length)
+		m_valid = false;
+
+	Element element;
+	element.offset = offset;
+	element.type = type;
+	m_elements.add(element);
+
+	item.elements++;
+}
+
+
+ULONG XdrMessagePlan::getWireLength(const Item& item, ByteOrder order) const
+{
+	switch (item.type)
+	{
+	case ITEM_WORDS:
+		return (order == ORDER_RAW) ? padded(item.length) : item.elements * sizeof(SLONG);
+
+	case ITEM_OPAQUE:
+		return padded(item.length);
+
+	default:
+		// Only the length word, the string itself is read separately
+		return sizeof(SLONG);
+	}
+}
+
+
+bool_t XdrMessagePlan::encode(xdr_t* xdrs, const UCHAR* message, const UCHAR* nulls, ByteOrder order) const
+{
+/**************************************
+ *
+ *	e n c o d e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Put the message to the stream.
+ *
+ **************************************/
+	fb_assert(m_valid);
+
+	Staging staging(xdrs, swapNeeded(order));
+
+	for (FB_SIZE_T n = 0; n < m_items.getCount(); n++)
+	{
+		if (isNull(nulls, n))
+			continue;
+
+		const Item& item = m_items[n];
+		const UCHAR* const p = message + item.offset;
+
+		switch (item.type)
+		{
+		case ITEM_WORDS:
+			if (order == ORDER_RAW)
+			{
+				if (!staging.putBytes(p, item.length))
+					return FALSE;
+			}
+			else
+			{
+				UCHAR* ptr = staging.reserveWords(item.elements);
+				if (!ptr)
+					return FALSE;
+
+				const Element* element = m_elements.begin() + item.first;
+				for (const Element* const end = element + item.elements; element < end; ++element)
+				{
+					if (element->type == ELEMENT_SHORT)
+					{
+						SSHORT value;
+						memcpy(&value, p + element->offset, sizeof(SSHORT));
+						const SLONG word = value;
+						memcpy(ptr, &word, sizeof(SLONG));
+					}
+					else
+						memcpy(ptr, p + element->offset, sizeof(SLONG));
+
+					ptr += sizeof(SLONG);
+				}
+			}
+			break;
+
+		case ITEM_OPAQUE:
+			if (!staging.putBytes(p, item.length))
+				return FALSE;
+			break;
+
+		case ITEM_VARYING:
+			{
+				USHORT length;
+				memcpy(&length, p, sizeof(USHORT));
+
+				if (!staging.putWord((SSHORT) length) ||
+					!staging.putBytes(p + sizeof(USHORT), MIN((USHORT) (item.length - sizeof(USHORT)), length)))
+				{
+					return FALSE;
+				}
+			}
+			break;
+
+		case ITEM_CSTRING:
+			{
+				const UCHAR* const end = static_cast<const UCHAR*>(memchr(p, 0, item.length - 1));
+				const USHORT length = end ? (USHORT) (end - p) : (USHORT) (item.length - 1);
+
+				if (!staging.putWord((SSHORT) length) || !staging.putBytes(p, length))
+					return FALSE;
+			}
+			break;
+		}
+	}
+
+	return staging.flush();
+}
+
+
+bool_t XdrMessagePlan::decode(xdr_t* xdrs, UCHAR* message, const UCHAR* nulls, ByteOrder order) const
+{
+/**************************************
+ *
+ *	d e c o d e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Get the message from the stream. Items of the known wire length
+ *	up to the length word of the next string are read at once, then
+ *	their words are swapped and scattered to the message.
+ *
+ **************************************/
+	fb_assert(m_valid);
+
+	const bool swap = swapNeeded(order);
+	const FB_SIZE_T count = m_items.getCount();
+
+	UCHAR buffer[STAGING_SIZE];
+	ULONG skip = 0;		// padding of the string read directly
+	FB_SIZE_T n = 0;
+
+	while (n < count || skip)
+	{
+		// Collect the segment
+
+		ULONG length = skip;
+		FB_SIZE_T end = n;
+
+		for (; end < count; end++)
+		{
+			if (isNull(nulls, end))
+				continue;
+
+			const Item& item = m_items[end];
+			const ULONG size = getWireLength(item, order);
+
+			if (length + size > STAGING_SIZE || (item.type == ITEM_OPAQUE && item.length > DIRECT_SIZE))
+				break;
+
+			length += size;
+
+			if (item.type == ITEM_VARYING || item.type == ITEM_CSTRING)
+			{
+				end++;
+				break;
+			}
+		}
+
+		if (length && !xdrs->x_getbytes(reinterpret_cast<SCHAR*>(buffer), length))
+			return FALSE;
+
+		// Swap the words between the opaque items
+
+		if (swap)
+		{
+			ULONG pos = skip, start = skip;
+
+			for (FB_SIZE_T i = n; i < end; i++)
+			{
+				if (isNull(nulls, i))
+					continue;
+
+				const Item& item = m_items[i];
+
+				if (item.type == ITEM_OPAQUE)
+				{
+					swapWords(buffer + start, (pos - start) / sizeof(SLONG));
+					pos += padded(item.length);
+					start = pos;
+				}
+				else
+					pos += getWireLength(item, order);
+			}
+
+			swapWords(buffer + start, (pos - start) / sizeof(SLONG));
+		}
+
+		// Scatter the items
+
+		const UCHAR* ptr = buffer + skip;
+		skip = 0;
+
+		for (; n < end; n++)
+		{
+			if (isNull(nulls, n))
+				continue;
+
+			const Item& item = m_items[n];
+			UCHAR* const p = message + item.offset;
+
+			switch (item.type)
+			{
+			case ITEM_WORDS:
+				if (order == ORDER_RAW)
+				{
+					memcpy(p, ptr, item.length);
+					ptr += padded(item.length);
+				}
+				else
+				{
+					const Element* element = m_elements.begin() + item.first;
+					for (const Element* const last = element + item.elements; element < last; ++element)
+					{
+						if (element->type == ELEMENT_SHORT)
+						{
+							SLONG word;
+							memcpy(&word, ptr, sizeof(SLONG));
+							const SSHORT value = (SSHORT) word;
+							memcpy(p + element->offset, &value, sizeof(SSHORT));
+						}
+						else
+							memcpy(p + element->offset, ptr, sizeof(SLONG));
+
+						ptr += sizeof(SLONG);
+					}
+				}
+				break;
+
+			case ITEM_OPAQUE:
+				memcpy(p, ptr, item.length);
+				ptr += padded(item.length);
+				break;
+
+			case ITEM_VARYING:
+				{
+					SLONG word;
+					memcpy(&word, ptr, sizeof(SLONG));
+					ptr += sizeof(SLONG);
+
+					const USHORT length = (USHORT) (SSHORT) word;
+					memcpy(p, &length, sizeof(USHORT));
+
+					const USHORT size = item.length - sizeof(USHORT);
+					const USHORT data = MIN(size, length);
+
+					if (data && !xdrs->x_getbytes(reinterpret_cast<SCHAR*>(p + sizeof(USHORT)), data))
+						return FALSE;
+
+					if (size > length)
+						memset(p + sizeof(USHORT) + length, 0, size - length);
+
+					skip = padded(data) - data;
+				}
+				break;
+
+			case ITEM_CSTRING:
+				{
+					SLONG word;
+					memcpy(&word, ptr, sizeof(SLONG));
+					ptr += sizeof(SLONG);
+
+					const USHORT length = (USHORT) (SSHORT) word;
+
+					if (length > item.length - 1)
+						return FALSE;
+
+					if (length && !xdrs->x_getbytes(reinterpret_cast<SCHAR*>(p), length))
+						return FALSE;
+
+					p[length] = 0;
+					skip = padded(length) - length;
+				}
+				break;
+			}
+		}
+
+		// Long opaque item goes directly to the message
+
+		if (n < count && !skip && length == 0)
+		{
+			const Item& item = m_items[n];
+			fb_assert(item.type == ITEM_OPAQUE);
+
+			if (!xdrs->x_getbytes(reinterpret_cast<SCHAR*>(message + item.offset), item.length))
+				return FALSE;
+
+			skip = padded(item.length) - item.length;
+			n++;
+		}
+	}
+
+	return TRUE;
+}
+
+
+void XdrMessagePlan::swapWords(UCHAR* data, ULONG count)
+{
+#ifdef XDR_SSE2
+	for (; count >= 4; count -= 4, data += 4 * sizeof(SLONG))
+	{
+		__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+
+		// Swap the bytes of the halves, then the halves of the words
+		value = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+		value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+		value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(data), value);
+	}
+#endif
+
+	for (; count; count--, data += sizeof(SLONG))
+	{
+		ULONG word;
+		memcpy(&word, data, sizeof(ULONG));
+		word = (word >> 24) | ((word >> 8) & 0xFF00) | ((word << 8) & 0xFF0000) | (word << 24);
+		memcpy(data, &word, sizeof(ULONG));
+	}
+}
@@ -0,0 +1,117 @@
+/*
+ *	PROGRAM:		External Data Representation
+ *	MODULE:			XdrMessage.h
+ *	DESCRIPTION:	Message level XDR codec driven by a per-format plan
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by ScratchBird Development Team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2025 ScratchBird Development Team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): _______________________________________.
+ *
+ */
+
+#ifndef SB_XDR_MESSAGE_H
+#define SB_XDR_MESSAGE_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/dsc.h"
+#include "../common/xdr.h"
+
+namespace ScratchBird {
+
+// Plan of the message format compiled once: every item is reduced to the
+// 32 bit words it's sent as, so the whole message is converted in one pass
+// through a staging buffer with a single stream call per chunk instead of a
+// few calls per item. Numeric words are byte swapped in runs by the vector
+// loop. The wire image is the same as xdr_datum() produces for every item.
+//
+// When the plan is built with the step of 2, it covers the values of the
+// value / NULL indicator pairs, as the packed messages need.
+class XdrMessagePlan : public PermanentStorage
+{
+public:
+	enum ByteOrder
+	{
+		ORDER_XDR,		// network byte order
+		ORDER_LOCAL,	// words in the host order, see xdr_t::x_local
+		ORDER_RAW		// values as they are in memory padded to 4 bytes,
+						// only between the peers of the same byte order
+	};
+
+	XdrMessagePlan(MemoryPool& pool, const dsc* desc, FB_SIZE_T count, unsigned step = 1);
+
+	// False if the format has items the plan can't map
+	bool isValid() const
+	{
+		return m_valid;
+	}
+
+	FB_SIZE_T getCount() const
+	{
+		return m_items.getCount();
+	}
+
+	// Items having the bit set in the nulls bitmap are skipped
+	bool_t encode(xdr_t* xdrs, const UCHAR* message, const UCHAR* nulls, ByteOrder order) const;
+	bool_t decode(xdr_t* xdrs, UCHAR* message, const UCHAR* nulls, ByteOrder order) const;
+
+	// Byte swap of the 32 bit words in place
+	static void swapWords(UCHAR* data, ULONG count);
+
+private:
+	enum ItemType : UCHAR
+	{
+		ITEM_WORDS,		// sequence of elements
+		ITEM_OPAQUE,	// bytes padded to 4
+		ITEM_VARYING,	// length word and bytes
+		ITEM_CSTRING	// the same for the null terminated string
+	};
+
+	enum ElementType : UCHAR
+	{
+		ELEMENT_LONG,	// 32 bit word
+		ELEMENT_SHORT	// 16 bit value widened to the word
+	};
+
+	struct Element
+	{
+		UCHAR offset;	// within the item
+		ElementType type;
+	};
+
+	struct Item
+	{
+		ULONG offset;		// within the message
+		USHORT length;		// of the value in the message
+		ItemType type;
+		UCHAR elements;		// count of them for ITEM_WORDS
+		USHORT first;		// of the elements
+	};
+
+	void addElement(Item& item, UCHAR offset, ElementType type = ELEMENT_LONG);
+	ULONG getWireLength(const Item& item, ByteOrder order) const;
+
+	Array<Item> m_items;
+	Array<Element> m_elements;
+	bool m_valid;
+};
+
+} // namespace ScratchBird
+
+#endif // SB_XDR_MESSAGE_H
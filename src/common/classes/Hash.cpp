@@ -22,20 +22,11 @@
 
 #include "firebird.h"
 #include "../common/classes/Hash.h"
+#include "../common/CRC32C.h"
 #include "../common/dsc.h"
 
-#if defined(_M_IX86) || defined(_M_X64) || defined(__x86_64__) || defined(__i386__)
-#ifdef _MSC_VER
-#include <intrin.h>
-#else
-#include <cpuid.h>
-#endif
-#endif
-
 using namespace ScratchBird;
 
-unsigned int CRC32C(unsigned int length, const unsigned char* value);
-
 namespace
 {
 	typedef unsigned int (*hash_func_t)(unsigned int length, const UCHAR* value);
@@ -73,36 +64,8 @@ namespace
 		return hash_value;
 	}
 
-#if defined(_M_IX86) || defined(_M_X64) || defined(__x86_64__) || defined(__i386__)
-
-	bool SSE4_2Supported()
-	{
-#ifdef _MSC_VER
-		const int bit_SSE4_2 = 1 << 20;
-		// MS VC has its own definition of __cpuid
-		int flags[4];
-		__cpuid(flags, 1);
-		return (flags[2] & bit_SSE4_2) != 0;
-#else
-#if defined(__clang__) && !defined(bit_SSE4_2)
-		const int bit_SSE4_2 = bit_SSE42;
-#endif
-
-		// GCC - its own
-		unsigned int eax,ebx,ecx,edx;
-		__cpuid(1, eax, ebx, ecx, edx);
-		return (ecx & bit_SSE4_2) != 0;
-#endif
-	}
-
-	hash_func_t internalHash = SSE4_2Supported() ? CRC32C : basicHash;
-
-#else	// architecture check
-
-	hash_func_t internalHash = basicHash;
-
-#endif	// architecture check
-
+	// Software CRC32C is too slow for hashing of short keys
+	hash_func_t internalHash = Crc32c::isAccelerated() ? CRC32C : basicHash;
 }
 
 unsigned int InternalHash::hash(unsigned int length, const UCHAR* value)
@@ -392,6 +392,28 @@ void Config::checkValues()
 		}
 	}
 
+	strVal = values[KEY_CACHE_POLICY].strVal;
+	if (strVal)
+	{
+		NoCaseString cachePolicy(strVal);
+		if (cachePolicy != "LRU" && cachePolicy != "2Q")
+		{
+			// user-provided value is invalid - fail to default
+			values[KEY_CACHE_POLICY] = defaults[KEY_CACHE_POLICY];
+		}
+	}
+
+	strVal = values[KEY_RECORD_COMPRESSION].strVal;
+	if (strVal)
+	{
+		NoCaseString recordCompression(strVal);
+		if (recordCompression != "RLE" && recordCompression != "LZ4")
+		{
+			// user-provided value is invalid - fail to default
+			values[KEY_RECORD_COMPRESSION] = defaults[KEY_RECORD_COMPRESSION];
+		}
+	}
+
 	strVal = values[KEY_SERVER_MODE].strVal;
 	if (strVal && !fb_utils::bootBuild())
 	{
@@ -426,6 +448,20 @@ void Config::checkValues()
 
 	checkIntForLoBound(KEY_PARALLEL_WORKERS, 1, true);
 	checkIntForHiBound(KEY_PARALLEL_WORKERS, values[KEY_MAX_PARALLEL_WORKERS].intVal, false);
+
+	checkIntForLoBound(KEY_ASYNC_IO_DEPTH, 1, true);
+	checkIntForHiBound(KEY_ASYNC_IO_DEPTH, 4096, false);
+
+	checkIntForLoBound(KEY_READ_AHEAD, 0, true);
+	checkIntForHiBound(KEY_READ_AHEAD, 4096, false);
+
+	checkIntForLoBound(KEY_CACHE_PARTITIONS, 0, true);
+	checkIntForHiBound(KEY_CACHE_PARTITIONS, 64, false);
+
+	checkIntForLoBound(KEY_HASH_JOIN_MEMORY_LIMIT, 0, true);
+	checkIntForLoBound(KEY_HASH_AGGREGATE_MEMORY_LIMIT, 0, true);
+
+	checkIntForLoBound(KEY_STATEMENT_CACHE_LIMIT, 0, true);
 }
 
 
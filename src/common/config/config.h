@@ -218,6 +218,15 @@ enum ConfigKey
 	KEY_PARALLEL_WORKERS,
 	KEY_MAX_PARALLEL_WORKERS,
 	KEY_OPTIMIZE_FOR_FIRST_ROWS,
+	KEY_ASYNC_IO,
+	KEY_ASYNC_IO_DEPTH,
+	KEY_READ_AHEAD,
+	KEY_CACHE_POLICY,
+	KEY_CACHE_PARTITIONS,
+	KEY_RECORD_COMPRESSION,
+	KEY_HASH_JOIN_MEMORY_LIMIT,
+	KEY_HASH_AGGREGATE_MEMORY_LIMIT,
+	KEY_STATEMENT_CACHE_LIMIT,
 	MAX_CONFIG_KEY		// keep it last
 };
 
@@ -331,7 +340,16 @@ constexpr ConfigEntry entries[MAX_CONFIG_KEY] =
 	{TYPE_INTEGER,	"MaxStatementCacheSize",	false,	2 * 1048576},	// bytes
 	{TYPE_INTEGER,	"ParallelWorkers",			true,	1},
 	{TYPE_INTEGER,	"MaxParallelWorkers",		true,	1},
-	{TYPE_BOOLEAN,	"OptimizeForFirstRows",		false,	false}
+	{TYPE_BOOLEAN,	"OptimizeForFirstRows",		false,	false},
+	{TYPE_STRING,	"AsyncIO",					true,	"Auto"},	// asynchronous page I/O engine
+	{TYPE_INTEGER,	"AsyncIODepth",				true,	128},		// requests in flight
+	{TYPE_INTEGER,	"ReadAhead",				false,	256},		// pages
+	{TYPE_STRING,	"CacheReplacementPolicy",	false,	"LRU"},		// page cache replacement policy
+	{TYPE_INTEGER,	"CachePartitions",			false,	0},			// 0 - choose automatically
+	{TYPE_STRING,	"RecordCompression",		false,	"RLE"},		// record compression method
+	{TYPE_INTEGER,	"HashJoinMemoryLimit",		false,	64 * 1048576},	// bytes
+	{TYPE_INTEGER,	"HashAggregateMemoryLimit",	false,	64 * 1048576},	// bytes
+	{TYPE_INTEGER,	"StatementCacheLimit",		false,	0}			// bytes
 };
 
 
@@ -655,6 +673,24 @@ public:
 	CONFIG_GET_GLOBAL_INT(getMaxParallelWorkers, KEY_MAX_PARALLEL_WORKERS);
 
 	CONFIG_GET_PER_DB_BOOL(getOptimizeForFirstRows, KEY_OPTIMIZE_FOR_FIRST_ROWS);
+
+	CONFIG_GET_GLOBAL_STR(getAsyncIO, KEY_ASYNC_IO);
+
+	CONFIG_GET_GLOBAL_INT(getAsyncIODepth, KEY_ASYNC_IO_DEPTH);
+
+	CONFIG_GET_PER_DB_INT(getReadAhead, KEY_READ_AHEAD);
+
+	CONFIG_GET_PER_DB_STR(getCacheReplacementPolicy, KEY_CACHE_POLICY);
+
+	CONFIG_GET_PER_DB_INT(getCachePartitions, KEY_CACHE_PARTITIONS);
+
+	CONFIG_GET_PER_DB_STR(getRecordCompression, KEY_RECORD_COMPRESSION);
+
+	CONFIG_GET_PER_DB_KEY(FB_UINT64, getHashJoinMemoryLimit, KEY_HASH_JOIN_MEMORY_LIMIT, getInt);
+
+	CONFIG_GET_PER_DB_KEY(FB_UINT64, getHashAggregateMemoryLimit, KEY_HASH_AGGREGATE_MEMORY_LIMIT, getInt);
+
+	CONFIG_GET_PER_DB_KEY(FB_UINT64, getStatementCacheLimit, KEY_STATEMENT_CACHE_LIMIT, getInt);
 };
 
 // Implementation of interface to access master configuration file
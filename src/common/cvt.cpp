@@ -61,6 +61,7 @@
 #include "../common/TimeZones.h"
 #include "../common/UInt128.h"
 #include "../common/InetAddr.h"
+#include "../common/JsonBinary.h"
 
 
 #ifdef HAVE_SYS_TYPES_H
@@ -2533,8 +2534,15 @@ void CVT_move_common(const dsc* from, dsc* to, DecimalStatus decSt, Callbacks* c
 		case dtype_cstring:
 		case dtype_text:
 			{
+				// Reject the text not being a JSON document
+				USHORT strtype_unused;
+				UCHAR* ptr;
+				const USHORT len = CVT_get_string_ptr_common(from, &strtype_unused, &ptr, NULL, 0, decSt, cb);
+
+				if (!JsonBinary::validate(reinterpret_cast<const char*>(ptr), len))
+					CVT_conversion_error(from, cb->err);
+
 				// For now, store JSON as a BLOB-like structure
-				// Full JSON implementation would require JSON parsing and validation
 				memcpy(to->dsc_address, from->dsc_address, MIN(from->dsc_length, to->dsc_length));
 			}
 			return;
@@ -4477,14 +4485,10 @@ void CVT_inet_to_text(const dsc* from, dsc* to, ScratchBird::Callbacks* cb)
 	InetFamily family = (InetFamily) inet_bytes[0];
 	
 	try {
-		InetAddr addr;
 		// Reconstruct InetAddr from stored format
 		if (family == INET_IPV4 || family == INET_IPV6) {
-			// Create temporary buffer with proper format
-			UCHAR temp_buf[17];
-			temp_buf[0] = family;
-			memcpy(temp_buf + 1, inet_bytes + 1, 16);
-			
+			InetAddr addr(family, inet_bytes + 1);
+
 			// Convert to string representation
 			string result;
 			addr.toString(result);
@@ -4526,11 +4530,7 @@ void CVT_cidr_to_text(const dsc* from, dsc* to, ScratchBird::Callbacks* cb)
 		// Reconstruct CidrBlock from stored format
 		if (family == INET_IPV4 || family == INET_IPV6) {
 			// Create InetAddr from stored address bytes
-			UCHAR temp_addr_buf[17];
-			temp_addr_buf[0] = family;
-			memcpy(temp_addr_buf + 1, cidr_bytes + 1, 16);
-			
-			InetAddr addr;  // Reconstruct from bytes
+			InetAddr addr(family, cidr_bytes + 1);
 			CidrBlock cidr(addr, prefix_length);
 			
 			// Convert to string representation
@@ -4606,10 +4606,11 @@ ScratchBird::InetAddr CVT_get_inet(const dsc* desc, ScratchBird::Callbacks* cb)
 			{
 				const UCHAR* inet_bytes = (const UCHAR*) desc->dsc_address;
 				InetFamily family = (InetFamily) inet_bytes[0];
+				if (family != INET_IPV4 && family != INET_IPV6)
+					CVT_conversion_error(desc, cb->err);
+
 				// Reconstruct InetAddr from stored format
-				InetAddr addr;
-				// Implementation would reconstruct from binary format
-				return addr;
+				return InetAddr(family, inet_bytes + 1);
 			}
 
 		case dtype_varying:
@@ -4655,9 +4656,11 @@ ScratchBird::CidrBlock CVT_get_cidr(const dsc* desc, ScratchBird::Callbacks* cb)
 				const UCHAR* cidr_bytes = (const UCHAR*) desc->dsc_address;
 				InetFamily family = (InetFamily) cidr_bytes[0];
 				int prefix_length = cidr_bytes[17];
+				if (family != INET_IPV4 && family != INET_IPV6)
+					CVT_conversion_error(desc, cb->err);
+
 				// Reconstruct CidrBlock from stored format
-				InetAddr addr;  // Would reconstruct from bytes
-				return CidrBlock(addr, prefix_length);
+				return CidrBlock(InetAddr(family, cidr_bytes + 1), prefix_length);
 			}
 
 		case dtype_varying:
@@ -271,6 +271,14 @@ public:
 	bool mutexLockCond();
 	void mutexUnlock();
 
+#ifdef HAVE_SHARED_MUTEX_SECTION
+	// Additional mutexes placed by the owner into the shared memory
+	void mutexInit(struct mtx* mutex);
+	void mutexLock(struct mtx* mutex);
+	bool mutexLockCond(struct mtx* mutex);
+	void mutexUnlock(struct mtx* mutex);
+#endif
+
 	int eventInit(event_t* event);
 	void eventFini(event_t* event);
 	SLONG eventClear(event_t* event);
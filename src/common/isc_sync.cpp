@@ -1387,95 +1387,9 @@ SharedMemoryBase::SharedMemoryBase(const TEXT* filename, ULONG length, IpcObject
 		if (callback->initialize(this, true))
 		{
 #ifdef HAVE_SHARED_MUTEX_SECTION
-
-#if (defined(HAVE_PTHREAD_MUTEXATTR_SETPROTOCOL) || defined(USE_ROBUST_MUTEX)) && defined(LINUX)
-// glibc in linux does not conform to the posix standard. When there is no RT kernel,
-// ENOTSUP is returned not by pthread_mutexattr_setprotocol(), but by
-// pthread_mutex_init(). Use a hack to deal with this broken error reporting.
-#define BUGGY_LINUX_MUTEX
-#endif
-
-			int state = 0;
-
-#ifdef BUGGY_LINUX_MUTEX
-			static volatile bool staticBugFlag = false;
-
-			do
-			{
-				bool bugFlag = staticBugFlag;
-#endif
-
-				pthread_mutexattr_t mattr;
-
-				PTHREAD_ERR_RAISE(pthread_mutexattr_init(&mattr));
-#ifdef PTHREAD_PROCESS_SHARED
-				if (!isSandboxed())
-					PTHREAD_ERR_RAISE(pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED));
-#else
-#error Your system must support PTHREAD_PROCESS_SHARED to use pthread shared futex in ScratchBird.
-#endif
-
-#ifdef HAVE_PTHREAD_MUTEXATTR_SETPROTOCOL
-#ifdef BUGGY_LINUX_MUTEX
-				if (!bugFlag)
-				{
-#endif
-					int protocolRc = pthread_mutexattr_setprotocol(&mattr, PTHREAD_PRIO_INHERIT);
-					if (protocolRc && (protocolRc != ENOTSUP))
-					{
-						iscLogStatus("Pthread Error", (Arg::Gds(isc_sys_request) <<
-							"pthread_mutexattr_setprotocol" << Arg::Unix(protocolRc)).value());
-					}
-#ifdef BUGGY_LINUX_MUTEX
-				}
-#endif
-#endif // HAVE_PTHREAD_MUTEXATTR_SETPROTOCOL
-
-#ifdef USE_ROBUST_MUTEX
-#ifdef BUGGY_LINUX_MUTEX
-				if (!bugFlag)
-				{
-#endif
-					LOG_PTHREAD_ERROR(pthread_mutexattr_setrobust_np(&mattr, PTHREAD_MUTEX_ROBUST_NP));
-#ifdef BUGGY_LINUX_MUTEX
-				}
-#endif
+			mutexInit(sh_mem_mutex);
 #endif
 
-				memset(sh_mem_mutex->mtx_mutex, 0, sizeof(*(sh_mem_mutex->mtx_mutex)));
-				//int state = LOG_PTHREAD_ERROR(pthread_mutex_init(sh_mem_mutex->mtx_mutex, &mattr));
-				state = pthread_mutex_init(sh_mem_mutex->mtx_mutex, &mattr);
-
-				if (state
-#ifdef BUGGY_LINUX_MUTEX
-					&& (state != ENOTSUP || bugFlag)
-#endif
-					)
-				{
-					iscLogStatus("Pthread Error", (Arg::Gds(isc_sys_request) <<
-						"pthread_mutex_init" << Arg::Unix(state)).value());
-				}
-
-				LOG_PTHREAD_ERROR(pthread_mutexattr_destroy(&mattr));
-
-#ifdef BUGGY_LINUX_MUTEX
-				if (state == ENOTSUP && !bugFlag)
-				{
-					staticBugFlag = true;
-					continue;
-				}
-
-			} while (false);
-#endif
-
-			if (state)
-			{
-				callback->mutexBug(state, "pthread_mutex_init");
-				system_call_failed::raise("pthread_mutex_init", state);
-			}
-
-#endif // HAVE_SHARED_MUTEX_SECTION
-
 			mainLock->unlock();
 			if (!mainLock->setlock(&statusVector, FileLock::FLM_SHARED))
 			{
@@ -2753,21 +2667,170 @@ void SharedMemoryBase::mutexLock()
 
 	int state = ISC_mutex_lock(sh_mem_mutex);
 
+	if (state != 0)
+	{
+		sh_mem_callback->mutexBug(state, "mutexLock");
+	}
+
+#else // POSIX SHARED MUTEX
+
+	mutexLock(sh_mem_mutex);
+
+#endif // os-dependent choice
+}
+
+
+bool SharedMemoryBase::mutexLockCond()
+{
+#if defined(WIN_NT)
+
+	return ISC_mutex_lock_cond(sh_mem_mutex) == 0;
+
 #else // POSIX SHARED MUTEX
 
-	int state = pthread_mutex_lock(sh_mem_mutex->mtx_mutex);
+	return mutexLockCond(sh_mem_mutex);
+
+#endif // os-dependent choice
+
+}
+
+
+void SharedMemoryBase::mutexUnlock()
+{
+#if defined(WIN_NT)
+
+	int state = ISC_mutex_unlock(sh_mem_mutex);
+
+	if (state != 0)
+	{
+		sh_mem_callback->mutexBug(state, "mutexUnlock");
+	}
+
+#else // POSIX SHARED MUTEX
+
+	mutexUnlock(sh_mem_mutex);
+
+#endif // os-dependent choice
+}
+
+
+#ifdef HAVE_SHARED_MUTEX_SECTION
+
+#if (defined(HAVE_PTHREAD_MUTEXATTR_SETPROTOCOL) || defined(USE_ROBUST_MUTEX)) && defined(LINUX)
+// glibc in linux does not conform to the posix standard. When there is no RT kernel,
+// ENOTSUP is returned not by pthread_mutexattr_setprotocol(), but by
+// pthread_mutex_init(). Use a hack to deal with this broken error reporting.
+#define BUGGY_LINUX_MUTEX
+#endif
+
+void SharedMemoryBase::mutexInit(mtx* mutex)
+{
+/**************************************
+ *
+ *	m u t e x I n i t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Initialize a process-shared mutex living in the mapped file.
+ *	Besides the header one, the callback may place more of them
+ *	in its own memory when initializing it.
+ *
+ **************************************/
+	int state = 0;
+
+#ifdef BUGGY_LINUX_MUTEX
+	static volatile bool staticBugFlag = false;
+
+	do
+	{
+		bool bugFlag = staticBugFlag;
+#endif
+
+		pthread_mutexattr_t mattr;
+
+		PTHREAD_ERR_RAISE(pthread_mutexattr_init(&mattr));
+#ifdef PTHREAD_PROCESS_SHARED
+		if (!isSandboxed())
+			PTHREAD_ERR_RAISE(pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED));
+#else
+#error Your system must support PTHREAD_PROCESS_SHARED to use pthread shared futex in ScratchBird.
+#endif
+
+#ifdef HAVE_PTHREAD_MUTEXATTR_SETPROTOCOL
+#ifdef BUGGY_LINUX_MUTEX
+		if (!bugFlag)
+		{
+#endif
+			int protocolRc = pthread_mutexattr_setprotocol(&mattr, PTHREAD_PRIO_INHERIT);
+			if (protocolRc && (protocolRc != ENOTSUP))
+			{
+				iscLogStatus("Pthread Error", (Arg::Gds(isc_sys_request) <<
+					"pthread_mutexattr_setprotocol" << Arg::Unix(protocolRc)).value());
+			}
+#ifdef BUGGY_LINUX_MUTEX
+		}
+#endif
+#endif // HAVE_PTHREAD_MUTEXATTR_SETPROTOCOL
+
+#ifdef USE_ROBUST_MUTEX
+#ifdef BUGGY_LINUX_MUTEX
+		if (!bugFlag)
+		{
+#endif
+			LOG_PTHREAD_ERROR(pthread_mutexattr_setrobust_np(&mattr, PTHREAD_MUTEX_ROBUST_NP));
+#ifdef BUGGY_LINUX_MUTEX
+		}
+#endif
+#endif
+
+		memset(mutex->mtx_mutex, 0, sizeof(*(mutex->mtx_mutex)));
+		//int state = LOG_PTHREAD_ERROR(pthread_mutex_init(mutex->mtx_mutex, &mattr));
+		state = pthread_mutex_init(mutex->mtx_mutex, &mattr);
+
+		if (state
+#ifdef BUGGY_LINUX_MUTEX
+			&& (state != ENOTSUP || bugFlag)
+#endif
+			)
+		{
+			iscLogStatus("Pthread Error", (Arg::Gds(isc_sys_request) <<
+				"pthread_mutex_init" << Arg::Unix(state)).value());
+		}
+
+		LOG_PTHREAD_ERROR(pthread_mutexattr_destroy(&mattr));
+
+#ifdef BUGGY_LINUX_MUTEX
+		if (state == ENOTSUP && !bugFlag)
+		{
+			staticBugFlag = true;
+			continue;
+		}
+
+	} while (false);
+#endif
+
+	if (state)
+	{
+		sh_mem_callback->mutexBug(state, "pthread_mutex_init");
+		system_call_failed::raise("pthread_mutex_init", state);
+	}
+}
+
+
+void SharedMemoryBase::mutexLock(mtx* mutex)
+{
+	int state = pthread_mutex_lock(mutex->mtx_mutex);
 #ifdef USE_ROBUST_MUTEX
 	if (state == EOWNERDEAD)
 	{
 		// We always perform check for dead process
 		// Therefore may safely mark mutex as recovered
-		LOG_PTHREAD_ERROR(pthread_mutex_consistent_np(sh_mem_mutex->mtx_mutex));
+		LOG_PTHREAD_ERROR(pthread_mutex_consistent_np(mutex->mtx_mutex));
 		state = 0;
 	}
 #endif
 
-#endif // os-dependent choice
-
 	if (state != 0)
 	{
 		sh_mem_callback->mutexBug(state, "mutexLock");
@@ -2775,42 +2838,25 @@ void SharedMemoryBase::mutexLock()
 }
 
 
-bool SharedMemoryBase::mutexLockCond()
+bool SharedMemoryBase::mutexLockCond(mtx* mutex)
 {
-#if defined(WIN_NT)
-
-	return ISC_mutex_lock_cond(sh_mem_mutex) == 0;
-
-#else // POSIX SHARED MUTEX
-
-	int state = pthread_mutex_trylock(sh_mem_mutex->mtx_mutex);
+	int state = pthread_mutex_trylock(mutex->mtx_mutex);
 #ifdef USE_ROBUST_MUTEX
 	if (state == EOWNERDEAD)
 	{
 		// We always perform check for dead process
 		// Therefore may safely mark mutex as recovered
-		LOG_PTHREAD_ERROR(pthread_mutex_consistent_np(sh_mem_mutex->mtx_mutex));
+		LOG_PTHREAD_ERROR(pthread_mutex_consistent_np(mutex->mtx_mutex));
 		state = 0;
 	}
 #endif
 	return state == 0;
-
-#endif // os-dependent choice
-
 }
 
 
-void SharedMemoryBase::mutexUnlock()
+void SharedMemoryBase::mutexUnlock(mtx* mutex)
 {
-#if defined(WIN_NT)
-
-	int state = ISC_mutex_unlock(sh_mem_mutex);
-
-#else // POSIX SHARED MUTEX
-
-	int state = pthread_mutex_unlock(sh_mem_mutex->mtx_mutex);
-
-#endif // os-dependent choice
+	int state = pthread_mutex_unlock(mutex->mtx_mutex);
 
 	if (state != 0)
 	{
@@ -2818,6 +2864,8 @@ void SharedMemoryBase::mutexUnlock()
 	}
 }
 
+#endif // HAVE_SHARED_MUTEX_SECTION
+
 
 SharedMemoryBase::~SharedMemoryBase()
 {
@@ -64,6 +64,7 @@ struct array_range
 static const UCHAR* compile(const UCHAR*, sdl_arg*);
 static ISC_STATUS error(CheckStatusWrapper* status_vector, const Arg::StatusVector& v);
 static bool execute(sdl_arg*);
+static const UCHAR* get_bound(const UCHAR*, const UCHAR*, USHORT, const SLONG*, SLONG*);
 static const UCHAR* get_range(const UCHAR*, array_range*, SLONG*, SLONG*);
 
 inline SSHORT get_word(const UCHAR*& ptr)
@@ -113,6 +114,109 @@ const int op_scalar		= 12;
 */
 
 
+bool SDL_box(const UCHAR* sdl, const Ods::InternalArrayDesc* desc, const SLONG* variables,
+			 SLONG* lower, SLONG* upper)
+{
+/**************************************
+ *
+ *	S D L _ b o x
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check whether a slice is a box of the array walked in storage
+ *	order, as the client library generates for row major arrays:
+ *	one loop stepping by one per dimension, outermost first, around
+ *	a single element subscripted by the loop variables. If so,
+ *	return the bounds of the box, so that it may be moved by runs of
+ *	the last dimension rather than element by element.
+ *
+ **************************************/
+	UCHAR loops[MAX_ARRAY_DIMENSIONS];
+	const USHORT dimensions = desc->iad_dimensions;
+	USHORT n;
+	DSC junk;
+
+	const UCHAR* p = sdl;
+
+	if (*p++ != isc_sdl_version1 || !dimensions || dimensions > MAX_ARRAY_DIMENSIONS)
+		return false;
+
+	for (bool header = true; header;)
+	{
+		switch (*p)
+		{
+		case isc_sdl_struct:
+			p++;
+			for (n = *p++; n; --n)
+			{
+				if (!(p = sdl_desc(p, &junk)))
+					return false;
+			}
+			break;
+
+		case isc_sdl_fid:
+		case isc_sdl_rid:
+			p += 3;
+			break;
+
+		case isc_sdl_field:
+		case isc_sdl_schema:
+		case isc_sdl_relation:
+			p++;
+			n = *p++;
+			p += n;
+			break;
+
+		default:
+			header = false;
+			break;
+		}
+	}
+
+	for (n = 0; n < dimensions; n++)
+	{
+		const UCHAR op = *p++;
+		if (op != isc_sdl_do1 && op != isc_sdl_do2)
+			return false;
+
+		loops[n] = *p++;
+
+		if (op == isc_sdl_do1)
+			lower[n] = 1;
+		else if (!(p = get_bound(p, loops, n + 1, variables, &lower[n])))
+			return false;
+
+		if (!(p = get_bound(p, loops, n + 1, variables, &upper[n])))
+			return false;
+
+		const Ods::InternalArrayDesc::iad_repeat& range = desc->iad_rpt[n];
+		if (lower[n] > upper[n] || lower[n] < range.iad_lower || upper[n] > range.iad_upper)
+			return false;
+
+		for (USHORT i = 0; i < n; i++)
+		{
+			if (loops[i] == loops[n])
+				return false;
+		}
+	}
+
+	if (*p++ != isc_sdl_element || *p++ != 1 || *p++ != isc_sdl_scalar || *p++ != 0 ||
+		*p++ != dimensions)
+	{
+		return false;
+	}
+
+	for (n = 0; n < dimensions; n++)
+	{
+		if (*p++ != isc_sdl_variable || *p++ != loops[n])
+			return false;
+	}
+
+	return *p == isc_sdl_eoc;
+}
+
+
 SLONG SDL_compute_subscript(CheckStatusWrapper* status_vector,
 							const Ods::InternalArrayDesc* desc,
 							USHORT dimensions,
@@ -643,6 +747,51 @@ static bool execute(sdl_arg* arg)
 }
 
 
+static const UCHAR* get_bound(const UCHAR* sdl, const UCHAR* loops, USHORT count,
+							  const SLONG* variables, SLONG* value)
+{
+/**************************************
+ *
+ *	g e t _ b o u n d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Evaluate a loop bound of a box slice. It must be a literal
+ *	or a variable that isn't set by the enclosing loops.
+ *
+ **************************************/
+	const UCHAR* p = sdl;
+
+	switch (*p++)
+	{
+	case isc_sdl_variable:
+		for (const UCHAR* const end = loops + count; loops < end; ++loops)
+		{
+			if (*loops == *p)
+				return NULL;
+		}
+		*value = variables[*p++];
+		return p;
+
+	case isc_sdl_tiny_integer:
+		*value = (SCHAR) * p++;
+		return p;
+
+	case isc_sdl_short_integer:
+		*value = (SSHORT) (p[0] | (p[1] << 8));
+		return p + 2;
+
+	case isc_sdl_long_integer:
+		*value = (SLONG) (p[0] | (p[1] << 8) | ((SLONG) p[2] << 16) | ((SLONG) p[3] << 24));
+		return p + 4;
+
+	default:
+		return NULL;
+	}
+}
+
+
 static const UCHAR* get_range(const UCHAR* sdl, array_range* arg,
 							  SLONG* min, SLONG* max)
 {
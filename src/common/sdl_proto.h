@@ -31,6 +31,7 @@ namespace Ods {
 struct sdl_info;
 struct array_alice;
 
+bool	SDL_box(const UCHAR*, const Ods::InternalArrayDesc*, const SLONG*, SLONG*, SLONG*);
 SLONG	SDL_compute_subscript(ScratchBird::CheckStatusWrapper*, const Ods::InternalArrayDesc*, USHORT, const SLONG*);
 ISC_STATUS SDL_info(ScratchBird::CheckStatusWrapper*, const UCHAR*, sdl_info*, SLONG*);
 int		SDL_walk(ScratchBird::CheckStatusWrapper*, const UCHAR*, UCHAR*, Ods::InternalArrayDesc*, SLONG*,
@@ -0,0 +1,146 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/CRC32C.h"
+#include <chrono>
+#include <vector>
+
+using namespace ScratchBird;
+
+
+BOOST_AUTO_TEST_SUITE(CRC32CSuite)
+
+// Bit-wise reference implementation
+static unsigned int referenceCrc(unsigned int crc, const UCHAR* p, size_t length)
+{
+	while (length--)
+	{
+		crc ^= *p++;
+		for (int bit = 0; bit < 8; bit++)
+			crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : crc >> 1;
+	}
+
+	return crc;
+}
+
+static std::vector<UCHAR> testData(size_t length)
+{
+	std::vector<UCHAR> data(length);
+	unsigned int seed = 12345;
+
+	for (auto& c : data)
+	{
+		seed = seed * 1103515245 + 12345;
+		c = (UCHAR) (seed >> 16);
+	}
+
+	return data;
+}
+
+
+BOOST_AUTO_TEST_SUITE(CRC32CFunctionalTests)
+
+BOOST_AUTO_TEST_CASE(KnownValuesTest)
+{
+	// Test vectors from RFC 3720 (iSCSI)
+	UCHAR buffer[32];
+
+	memset(buffer, 0, sizeof(buffer));
+	BOOST_TEST(Crc32c::checksum(buffer, sizeof(buffer)) == 0x8A9136AAu);
+
+	memset(buffer, 0xFF, sizeof(buffer));
+	BOOST_TEST(Crc32c::checksum(buffer, sizeof(buffer)) == 0x62A8AB43u);
+
+	for (unsigned int i = 0; i < sizeof(buffer); i++)
+		buffer[i] = i;
+	BOOST_TEST(Crc32c::checksum(buffer, sizeof(buffer)) == 0x46DD794Eu);
+
+	for (unsigned int i = 0; i < sizeof(buffer); i++)
+		buffer[i] = sizeof(buffer) - 1 - i;
+	BOOST_TEST(Crc32c::checksum(buffer, sizeof(buffer)) == 0x113FDB5Cu);
+
+	BOOST_TEST(Crc32c::checksum("123456789", 9) == 0xE3069283u);
+}
+
+BOOST_AUTO_TEST_CASE(KernelsTest)
+{
+	const auto data = testData(70000);
+	const size_t lengths[] = {0, 1, 2, 3, 4, 7, 8, 9, 15, 255, 767, 768, 769,
+		6143, 6144, 6145, 8192, 32768, 65536, 69000};
+
+	for (int k = 0; k < Crc32c::KERNEL_COUNT; k++)
+	{
+		const auto kernel = static_cast<Crc32c::Kernel>(k);
+		if (!Crc32c::isSupported(kernel))
+			continue;
+
+		for (size_t offset = 0; offset < 8; offset++)
+		{
+			for (const auto length : lengths)
+			{
+				BOOST_TEST(Crc32c::update(kernel, 0x12345678, &data[offset], length) ==
+					referenceCrc(0x12345678, &data[offset], length));
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(StreamTest)
+{
+	const auto data = testData(10000);
+	const unsigned int expected = Crc32c::checksum(data.data(), data.size());
+
+	unsigned int crc = 0;
+	for (size_t pos = 0; pos < data.size(); pos += 1000)
+		crc = Crc32c::checksum(&data[pos], 1000, crc);
+
+	BOOST_TEST(crc == expected);
+
+	// Raw value used as hash
+	BOOST_TEST(CRC32C(data.size(), data.data()) == referenceCrc(0, data.data(), data.size()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// CRC32CFunctionalTests
+
+
+// Throughput of every kernel supported by CPU, run explicitly:
+// common_test --run_test=CRC32CSuite/CRC32CPerformanceTests
+BOOST_AUTO_TEST_SUITE(CRC32CPerformanceTests, *boost::unit_test::disabled())
+
+BOOST_AUTO_TEST_CASE(ThroughputTest)
+{
+	const size_t sizes[] = {64, 1024, 8192, 65536};
+	const size_t TOTAL = 1024 * 1024 * 1024;
+
+	for (const auto size : sizes)
+	{
+		const auto data = testData(size);
+		unsigned int expected = 0;
+
+		for (int k = 0; k < Crc32c::KERNEL_COUNT; k++)
+		{
+			const auto kernel = static_cast<Crc32c::Kernel>(k);
+			if (!Crc32c::isSupported(kernel))
+				continue;
+
+			unsigned int crc = 0;
+			const auto start = std::chrono::steady_clock::now();
+
+			for (size_t done = 0; done < TOTAL; done += size)
+				crc = Crc32c::update(kernel, crc, data.data(), size);
+
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+			BOOST_TEST_MESSAGE(Crc32c::getKernelName(kernel) << ", " << size << " bytes blocks: " <<
+				(unsigned) (TOTAL / elapsed.count() / 1048576) << " MB/s");
+
+			if (kernel == Crc32c::KERNEL_SOFTWARE)
+				expected = crc;
+			else
+				BOOST_TEST(crc == expected);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// CRC32CPerformanceTests
+
+BOOST_AUTO_TEST_SUITE_END()	// CRC32CSuite
@@ -0,0 +1,257 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/ColumnarBlock.h"
+#include <string.h>
+#include <vector>
+
+using namespace ScratchBird;
+
+
+BOOST_AUTO_TEST_SUITE(ColumnarBlockSuite)
+
+// DSQL message: every value is followed by its NULL indicator
+
+class TestMessage
+{
+public:
+	TestMessage()
+		: length(0)
+	{
+		add(dtype_long, sizeof(SLONG));			// sequence, DELTA
+		add(dtype_varying, 22, 2);				// few distinct strings, DICTIONARY
+		add(dtype_int64, sizeof(SINT64));		// random, PLAIN
+		add(dtype_short, sizeof(SSHORT));		// mostly NULL
+		add(dtype_cstring, 9, 1);
+		add(dtype_text, 6, 1);					// constant
+		add(dtype_double, sizeof(double));
+		add(dtype_sql_date, sizeof(SLONG));		// descending
+	}
+
+	void fill(std::vector<UCHAR>& message, ULONG row) const
+	{
+		static const char* const names[] = {"alpha", "beta", "", "gamma delta epsilon"};
+
+		message.assign(length, 0);
+		ULONG seed = row * 2654435761U + 1;
+
+		setLong(message, 0, (SLONG) (1000 + row * 3));
+
+		const char* const name = names[row % 4];
+		const USHORT n = (USHORT) strlen(name);
+		memcpy(&message[offsets[1]], &n, sizeof(n));
+		memcpy(&message[offsets[1] + 2], name, n);
+
+		const SINT64 big = (SINT64) ((FB_UINT64) seed * seed);
+		memcpy(&message[offsets[2]], &big, sizeof(big));
+
+		if (row % 5 == 0)
+		{
+			const SSHORT s = (SSHORT) (row - 30000);
+			memcpy(&message[offsets[3]], &s, sizeof(s));
+		}
+		else
+			setNull(message, 3);
+
+		snprintf((char*) &message[offsets[4]], 9, "%u", seed % 100000000);
+		memcpy(&message[offsets[5]], "CONST ", 6);
+
+		if (row % 7 == 3)
+			setNull(message, 6);
+		else
+		{
+			const double d = row / 7.0;
+			memcpy(&message[offsets[6]], &d, sizeof(d));
+		}
+
+		setLong(message, 7, (SLONG) (60000 - row));
+	}
+
+	std::vector<dsc> descs;
+	std::vector<ULONG> offsets;
+	ULONG length;
+
+private:
+	void add(UCHAR dtype, USHORT size, ULONG alignment = 0)
+	{
+		if (!alignment)
+			alignment = size;
+
+		length = FB_ALIGN(length, alignment);
+
+		dsc desc;
+		desc.clear();
+		desc.dsc_dtype = dtype;
+		desc.dsc_length = size;
+		desc.dsc_address = (UCHAR*) (IPTR) length;
+		descs.push_back(desc);
+		offsets.push_back(length);
+
+		length = FB_ALIGN(length + size, sizeof(SSHORT));
+
+		desc.dsc_dtype = dtype_short;
+		desc.dsc_length = sizeof(SSHORT);
+		desc.dsc_address = (UCHAR*) (IPTR) length;
+		descs.push_back(desc);
+
+		length += sizeof(SSHORT);
+	}
+
+	void setLong(std::vector<UCHAR>& message, unsigned n, SLONG value) const
+	{
+		memcpy(&message[offsets[n]], &value, sizeof(value));
+	}
+
+	void setNull(std::vector<UCHAR>& message, unsigned n) const
+	{
+		const SSHORT flag = -1;
+		memcpy(&message[(IPTR) descs[n * 2 + 1].dsc_address], &flag, sizeof(flag));
+	}
+};
+
+static ULONG roundTrip(const TestMessage& test, ULONG rows, bool compress)
+{
+	ColumnarEncoder encoder(*getDefaultMemoryPool(), test.descs.data(), (FB_SIZE_T) test.descs.size());
+	std::vector<std::vector<UCHAR> > messages(rows);
+
+	for (ULONG row = 0; row < rows; row++)
+	{
+		test.fill(messages[row], row);
+		encoder.add(messages[row].data());
+	}
+
+	BOOST_TEST(encoder.getCount() == rows);
+
+	UCharBuffer image;
+	encoder.build(image, compress);
+	BOOST_TEST(encoder.getCount() == 0u);
+
+	ColumnarDecoder decoder(*getDefaultMemoryPool(), test.descs.data(), (FB_SIZE_T) test.descs.size());
+	BOOST_REQUIRE(decoder.open(image.begin(), image.getCount()));
+	BOOST_TEST(decoder.getCount() == rows);
+
+	std::vector<UCHAR> decoded(test.length, 0xFF);
+
+	for (ULONG row = 0; row < rows; row++)
+	{
+		BOOST_REQUIRE(decoder.next(decoded.data()));
+		BOOST_TEST((decoded == messages[row]));
+	}
+
+	BOOST_TEST(!decoder.next(decoded.data()));
+
+	return image.getCount();
+}
+
+
+BOOST_AUTO_TEST_SUITE(ColumnarBlockTests)
+
+BOOST_AUTO_TEST_CASE(RoundTripTest)
+{
+	const TestMessage test;
+
+	for (const ULONG rows : {0u, 1u, 2u, 9u, 100u, 1000u})
+	{
+		for (const bool compress : {false, true})
+			roundTrip(test, rows, compress);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(SizeTest)
+{
+	// Encodings and compression make the block a lot shorter than the messages
+
+	const TestMessage test;
+	const ULONG rows = 1000;
+
+	const ULONG plain = roundTrip(test, rows, false);
+	const ULONG compressed = roundTrip(test, rows, true);
+
+	BOOST_TEST(plain < rows * test.length / 2);
+	BOOST_TEST(compressed < plain);
+}
+
+BOOST_AUTO_TEST_CASE(DictionaryTest)
+{
+	// More distinct values than one byte indexes can address
+
+	dsc descs[2];
+	descs[0].clear();
+	descs[0].dsc_dtype = dtype_varying;
+	descs[0].dsc_length = 8;
+	descs[1].clear();
+	descs[1].dsc_dtype = dtype_short;
+	descs[1].dsc_length = sizeof(SSHORT);
+	descs[1].dsc_address = (UCHAR*) (IPTR) 8;
+
+	ColumnarEncoder encoder(*getDefaultMemoryPool(), descs, 2);
+	std::vector<std::vector<UCHAR> > messages;
+
+	for (ULONG row = 0; row < 3000; row++)
+	{
+		std::vector<UCHAR> message(10, 0);
+		const USHORT n = 3;
+		memcpy(&message[0], &n, sizeof(n));
+		snprintf((char*) &message[2], 6, "%03u", row % 700);
+		message[5] = 0;
+
+		messages.push_back(message);
+		encoder.add(message.data());
+	}
+
+	UCharBuffer image;
+	encoder.build(image, false);
+	BOOST_TEST(image.getCount() < 3000u * 4);
+
+	ColumnarDecoder decoder(*getDefaultMemoryPool(), descs, 2);
+	BOOST_REQUIRE(decoder.open(image.begin(), image.getCount()));
+
+	std::vector<UCHAR> decoded(10);
+
+	for (const auto& message : messages)
+	{
+		BOOST_REQUIRE(decoder.next(decoded.data()));
+		BOOST_TEST((decoded == message));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(CorruptTest)
+{
+	const TestMessage test;
+	ColumnarEncoder encoder(*getDefaultMemoryPool(), test.descs.data(), (FB_SIZE_T) test.descs.size());
+
+	std::vector<UCHAR> message;
+	for (ULONG row = 0; row < 50; row++)
+	{
+		test.fill(message, row);
+		encoder.add(message.data());
+	}
+
+	UCharBuffer image;
+	encoder.build(image, true);
+
+	ColumnarDecoder decoder(*getDefaultMemoryPool(), test.descs.data(), (FB_SIZE_T) test.descs.size());
+	std::vector<UCHAR> decoded(test.length);
+
+	// Truncated block
+
+	for (ULONG length = 0; length < image.getCount(); length++)
+		BOOST_TEST(!decoder.open(image.begin(), length));
+
+	// Damaged bytes never make the decoder go out of bounds
+
+	for (ULONG pos = 0; pos < image.getCount(); pos++)
+	{
+		std::vector<UCHAR> damaged(image.begin(), image.end());
+		damaged[pos] ^= 0x5A;
+
+		if (decoder.open(damaged.data(), (ULONG) damaged.size()))
+		{
+			while (decoder.next(decoded.data()))
+				;
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// ColumnarBlockTests
+
+BOOST_AUTO_TEST_SUITE_END()	// ColumnarBlockSuite
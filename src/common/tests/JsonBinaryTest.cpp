@@ -0,0 +1,168 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/JsonBinary.h"
+#include <string>
+
+using namespace ScratchBird;
+
+
+BOOST_AUTO_TEST_SUITE(JsonBinarySuite)
+
+static std::string toText(const Array<UCHAR>& image)
+{
+	string result;
+	JsonValue(image.begin()).toText(result);
+	return result.c_str();
+}
+
+static std::string roundTrip(const char* text)
+{
+	Array<UCHAR> image(*getDefaultMemoryPool());
+
+	if (!JsonBinary::parse(*getDefaultMemoryPool(), text, strlen(text), image))
+		return "error";
+
+	return toText(image);
+}
+
+static std::string extract(const char* text, const char* path)
+{
+	Array<UCHAR> image(*getDefaultMemoryPool());
+	BOOST_REQUIRE(JsonBinary::parse(*getDefaultMemoryPool(), text, strlen(text), image));
+
+	JsonValue value;
+	if (!JsonValue(image.begin()).extract(path, strlen(path), value))
+		return "none";
+
+	string result;
+	value.toText(result);
+	return result.c_str();
+}
+
+static std::string set(const char* text, const char* path, const char* valueText)
+{
+	MemoryPool& pool = *getDefaultMemoryPool();
+	Array<UCHAR> image(pool), value(pool), result(pool);
+
+	BOOST_REQUIRE(JsonBinary::parse(pool, text, strlen(text), image));
+	BOOST_REQUIRE(JsonBinary::parse(pool, valueText, strlen(valueText), value));
+
+	if (!JsonBinary::set(pool, JsonValue(image.begin()), path, strlen(path), JsonValue(value.begin()), result))
+		return "failed";
+
+	return toText(result);
+}
+
+static std::string extractAll(const char* text, const char* path)
+{
+	MemoryPool& pool = *getDefaultMemoryPool();
+	Array<UCHAR> image(pool), result(pool);
+
+	BOOST_REQUIRE(JsonBinary::parse(pool, text, strlen(text), image));
+
+	if (!JsonBinary::extractAll(pool, JsonValue(image.begin()), path, strlen(path), result))
+		return "failed";
+
+	return toText(result);
+}
+
+static const char* const DOCUMENT =
+	"{\"user\": {\"name\": \"Ann\", \"tags\": [\"a\", \"b\", {\"deep\": 7}]}, \"a b\": 3}";
+
+
+BOOST_AUTO_TEST_SUITE(JsonParserTests)
+
+BOOST_AUTO_TEST_CASE(RoundTripTest)
+{
+	// Keys are sorted, the last duplicate wins, escapes are decoded
+	BOOST_TEST(roundTrip(" { \"b\" : 1, \"a\" : [true, false, null, -1.5e+3, \"x\\ny\\u00e9\\ud83d\\ude00\"] , \"b\": 2 } ") ==
+		"{\"a\":[true,false,null,-1.5e+3,\"x\\ny\xC3\xA9\xF0\x9F\x98\x80\"],\"b\":2}");
+
+	BOOST_TEST(roundTrip("{\"k\": \"a string longer than the scanner block with \\\"quotes\\\" inside\", \"z\": {}, \"y\": []}") ==
+		"{\"k\":\"a string longer than the scanner block with \\\"quotes\\\" inside\",\"y\":[],\"z\":{}}");
+
+	BOOST_TEST(roundTrip("0") == "0");
+	BOOST_TEST(roundTrip("\"\"") == "\"\"");
+}
+
+BOOST_AUTO_TEST_CASE(InvalidTextTest)
+{
+	const char* const texts[] = {"", "{", "[1,]", "{\"a\" 1}", "01", "1.", "-", "tru", "\"abc",
+		"\"\\x\"", "[1 2]", "{\"a\":1,}", "\"\\ud800\"", "\"a\tb\"", "{} {}"};
+
+	for (const auto text : texts)
+		BOOST_TEST(!JsonBinary::validate(text, strlen(text)), text);
+
+	const std::string deep = std::string(JsonBinary::MAX_DEPTH + 2, '[') + std::string(JsonBinary::MAX_DEPTH + 2, ']');
+	BOOST_TEST(!JsonBinary::validate(deep.c_str(), deep.length()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// JsonParserTests
+
+
+BOOST_AUTO_TEST_SUITE(JsonPathTests)
+
+BOOST_AUTO_TEST_CASE(ExtractTest)
+{
+	BOOST_TEST(extract(DOCUMENT, "$.user.name") == "\"Ann\"");
+	BOOST_TEST(extract(DOCUMENT, "$.user.tags[2].deep") == "7");
+	BOOST_TEST(extract(DOCUMENT, "$.\"a b\"") == "3");
+	BOOST_TEST(extract(DOCUMENT, "$") == roundTrip(DOCUMENT));
+
+	BOOST_TEST(extract(DOCUMENT, "$.user.tags[3]") == "none");
+	BOOST_TEST(extract(DOCUMENT, "$.user[0]") == "none");
+	BOOST_TEST(extract(DOCUMENT, "user") == "none");
+}
+
+BOOST_AUTO_TEST_CASE(LargeArrayTest)
+{
+	std::string text = "[";
+
+	for (int i = 0; i < 1000; i++)
+	{
+		if (i)
+			text += ",\n                ";
+
+		text += "{\"id\": " + std::to_string(i) + ", \"value\": \"number " + std::to_string(i) + "\"}";
+	}
+
+	text += "]";
+
+	BOOST_TEST(extract(text.c_str(), "$[999].value") == "\"number 999\"");
+}
+
+BOOST_AUTO_TEST_CASE(SetTest)
+{
+	BOOST_TEST(set(DOCUMENT, "$.user.name", "\"Bob\"") ==
+		"{\"a b\":3,\"user\":{\"name\":\"Bob\",\"tags\":[\"a\",\"b\",{\"deep\":7}]}}");
+
+	BOOST_TEST(set(DOCUMENT, "$.user.age", "42") ==
+		"{\"a b\":3,\"user\":{\"age\":42,\"name\":\"Ann\",\"tags\":[\"a\",\"b\",{\"deep\":7}]}}");
+
+	BOOST_TEST(set(DOCUMENT, "$.user.tags[5]", "1") ==
+		"{\"a b\":3,\"user\":{\"name\":\"Ann\",\"tags\":[\"a\",\"b\",{\"deep\":7},1]}}");
+
+	BOOST_TEST(set(DOCUMENT, "$.user.tags[2].deep", "[]") ==
+		"{\"a b\":3,\"user\":{\"name\":\"Ann\",\"tags\":[\"a\",\"b\",{\"deep\":[]}]}}");
+
+	BOOST_TEST(set(DOCUMENT, "$.missing.name", "1") == "failed");
+	BOOST_TEST(set(DOCUMENT, "$.user.tags[*]", "1") == "failed");
+}
+
+BOOST_AUTO_TEST_CASE(WildcardTest)
+{
+	BOOST_TEST(extractAll(DOCUMENT, "$.user.tags[*]") == "[\"a\",\"b\",{\"deep\":7}]");
+	BOOST_TEST(extractAll(DOCUMENT, "$.user.tags[*].deep") == "[7]");
+	BOOST_TEST(extractAll("[{\"v\": [1, 2]}, {\"v\": [3]}, {\"w\": 4}]", "$[*].v[*]") == "[1,2,3]");
+	BOOST_TEST(extractAll(DOCUMENT, "$.user.name") == "[\"Ann\"]");
+	BOOST_TEST(extractAll(DOCUMENT, "$.user.name[*]") == "[]");
+	BOOST_TEST(extractAll(DOCUMENT, "$.missing[*].x[") == "failed");
+
+	BOOST_TEST(extract(DOCUMENT, "$.user.tags[*]") == "none");
+	BOOST_TEST(JsonBinary::hasWildcard("$.a[*].b", 8));
+	BOOST_TEST(!JsonBinary::hasWildcard("$.a[1].b", 8));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// JsonPathTests
+
+BOOST_AUTO_TEST_SUITE_END()	// JsonBinarySuite
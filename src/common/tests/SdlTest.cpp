@@ -0,0 +1,147 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/ods.h"
+#include "../common/sdl.h"
+#include "../common/sdl_proto.h"
+#include <vector>
+
+using namespace ScratchBird;
+
+
+BOOST_AUTO_TEST_SUITE(SdlSuite)
+BOOST_AUTO_TEST_SUITE(SdlBoxTests)
+
+// INTEGER [1:3, 0:4]
+class ArrayDesc
+{
+public:
+	ArrayDesc()
+	{
+		memset(buffer, 0, sizeof(buffer));
+		desc()->iad_dimensions = 2;
+		desc()->iad_rpt[0].iad_lower = 1;
+		desc()->iad_rpt[0].iad_upper = 3;
+		desc()->iad_rpt[0].iad_length = 5;
+		desc()->iad_rpt[1].iad_lower = 0;
+		desc()->iad_rpt[1].iad_upper = 4;
+		desc()->iad_rpt[1].iad_length = 1;
+	}
+
+	Ods::InternalArrayDesc* desc()
+	{
+		return reinterpret_cast<Ods::InternalArrayDesc*>(buffer);
+	}
+
+private:
+	SLONG buffer[IAD_LEN(2) / sizeof(SLONG) + 1];
+};
+
+// The slice description the client library generates for a row major array
+static std::vector<UCHAR> boxSdl(SLONG lower0, SLONG upper0, SLONG lower1, SLONG upper1)
+{
+	return {
+		isc_sdl_version1,
+		isc_sdl_struct, 1, blr_long, 0,
+		isc_sdl_relation, 1, 'T',
+		isc_sdl_field, 1, 'A',
+		isc_sdl_do2, 0, isc_sdl_tiny_integer, (UCHAR) lower0, isc_sdl_tiny_integer, (UCHAR) upper0,
+		isc_sdl_do2, 1, isc_sdl_tiny_integer, (UCHAR) lower1, isc_sdl_tiny_integer, (UCHAR) upper1,
+		isc_sdl_element, 1, isc_sdl_scalar, 0, 2, isc_sdl_variable, 0, isc_sdl_variable, 1,
+		isc_sdl_eoc
+	};
+}
+
+BOOST_AUTO_TEST_CASE(RowMajorTest)
+{
+	ArrayDesc array;
+	SLONG variables[64] = {0};
+	SLONG lower[MAX_ARRAY_DIMENSIONS], upper[MAX_ARRAY_DIMENSIONS];
+
+	const auto sdl = boxSdl(2, 3, 1, 4);
+	BOOST_TEST(SDL_box(sdl.data(), array.desc(), variables, lower, upper));
+	BOOST_TEST(lower[0] == 2);
+	BOOST_TEST(upper[0] == 3);
+	BOOST_TEST(lower[1] == 1);
+	BOOST_TEST(upper[1] == 4);
+
+	// Implicit lower bound 1, upper bound taken from a parameter
+
+	const UCHAR sdl2[] = {
+		isc_sdl_version1,
+		isc_sdl_struct, 1, blr_long, 0,
+		isc_sdl_do1, 0, isc_sdl_variable, 5,
+		isc_sdl_do2, 1, isc_sdl_tiny_integer, 0, isc_sdl_tiny_integer, 4,
+		isc_sdl_element, 1, isc_sdl_scalar, 0, 2, isc_sdl_variable, 0, isc_sdl_variable, 1,
+		isc_sdl_eoc
+	};
+
+	variables[5] = 3;
+	BOOST_TEST(SDL_box(sdl2, array.desc(), variables, lower, upper));
+	BOOST_TEST(lower[0] == 1);
+	BOOST_TEST(upper[0] == 3);
+}
+
+BOOST_AUTO_TEST_CASE(NotBoxTest)
+{
+	ArrayDesc array;
+	SLONG variables[64] = {0};
+	SLONG lower[MAX_ARRAY_DIMENSIONS], upper[MAX_ARRAY_DIMENSIONS];
+
+	// Out of the array bounds, left to SDL_walk() to report
+
+	BOOST_TEST(!SDL_box(boxSdl(0, 3, 0, 4).data(), array.desc(), variables, lower, upper));
+	BOOST_TEST(!SDL_box(boxSdl(1, 3, 0, 5).data(), array.desc(), variables, lower, upper));
+
+	// Empty loop
+
+	BOOST_TEST(!SDL_box(boxSdl(3, 2, 0, 4).data(), array.desc(), variables, lower, upper));
+
+	// Column major order
+
+	const UCHAR transposed[] = {
+		isc_sdl_version1,
+		isc_sdl_do2, 1, isc_sdl_tiny_integer, 0, isc_sdl_tiny_integer, 4,
+		isc_sdl_do2, 0, isc_sdl_tiny_integer, 1, isc_sdl_tiny_integer, 3,
+		isc_sdl_element, 1, isc_sdl_scalar, 0, 2, isc_sdl_variable, 0, isc_sdl_variable, 1,
+		isc_sdl_eoc
+	};
+
+	BOOST_TEST(!SDL_box(transposed, array.desc(), variables, lower, upper));
+
+	// Inner bound depending on the outer loop
+
+	const UCHAR triangle[] = {
+		isc_sdl_version1,
+		isc_sdl_do2, 0, isc_sdl_tiny_integer, 1, isc_sdl_tiny_integer, 3,
+		isc_sdl_do2, 1, isc_sdl_tiny_integer, 0, isc_sdl_variable, 0,
+		isc_sdl_element, 1, isc_sdl_scalar, 0, 2, isc_sdl_variable, 0, isc_sdl_variable, 1,
+		isc_sdl_eoc
+	};
+
+	BOOST_TEST(!SDL_box(triangle, array.desc(), variables, lower, upper));
+
+	// Step other than one
+
+	const UCHAR stepped[] = {
+		isc_sdl_version1,
+		isc_sdl_do2, 0, isc_sdl_tiny_integer, 1, isc_sdl_tiny_integer, 3,
+		isc_sdl_do3, 1, isc_sdl_tiny_integer, 0, isc_sdl_tiny_integer, 4, isc_sdl_tiny_integer, 2,
+		isc_sdl_element, 1, isc_sdl_scalar, 0, 2, isc_sdl_variable, 0, isc_sdl_variable, 1,
+		isc_sdl_eoc
+	};
+
+	BOOST_TEST(!SDL_box(stepped, array.desc(), variables, lower, upper));
+
+	// Single element
+
+	const UCHAR scalar[] = {
+		isc_sdl_version1,
+		isc_sdl_element, 1, isc_sdl_scalar, 0, 2, isc_sdl_tiny_integer, 1, isc_sdl_tiny_integer, 0,
+		isc_sdl_eoc
+	};
+
+	BOOST_TEST(!SDL_box(scalar, array.desc(), variables, lower, upper));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// SdlBoxTests
+BOOST_AUTO_TEST_SUITE_END()	// SdlSuite
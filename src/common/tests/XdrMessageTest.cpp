@@ -0,0 +1,292 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/XdrMessage.h"
+#include "../common/xdr_proto.h"
+#include <string.h>
+#include <vector>
+
+using namespace ScratchBird;
+
+
+BOOST_AUTO_TEST_SUITE(XdrMessageSuite)
+
+static const ULONG STREAM_SIZE = 16384;
+
+// Message of all kinds of items, including the long ones bypassing the staging buffer
+
+class TestMessage
+{
+public:
+	TestMessage()
+		: length(0)
+	{
+		add(dtype_short, sizeof(SSHORT));
+		add(dtype_long, sizeof(SLONG));
+		add(dtype_text, 5, 1);
+		add(dtype_int64, sizeof(SINT64));
+		add(dtype_varying, 12, 2);
+		add(dtype_double, sizeof(double));
+		add(dtype_timestamp_tz, sizeof(ISC_TIMESTAMP_TZ));
+		add(dtype_boolean, 1, 1);
+		add(dtype_int128, 16, 8);
+		add(dtype_dec128, 16, 8);
+		add(dtype_cstring, 9, 1);
+		add(dtype_text, 2000, 1);
+		add(dtype_ex_time_tz, 8, 4);
+		add(dtype_varying, 1502, 2);
+		add(dtype_blob, sizeof(ISC_QUAD));
+		add(dtype_real, sizeof(float));
+	}
+
+	// Random values with the proper strings
+	void fill(std::vector<UCHAR>& message, ULONG seed) const
+	{
+		message.assign(length, 0);
+
+		for (auto& byte : message)
+		{
+			seed = seed * 1103515245 + 12345;
+			byte = (UCHAR) (seed >> 16);
+		}
+
+		for (const auto& desc : descs)
+		{
+			UCHAR* const p = message.data() + (IPTR) desc.dsc_address;
+
+			if (desc.dsc_dtype == dtype_varying)
+			{
+				const USHORT n = (USHORT) (seed++ % (desc.dsc_length - 1));
+				memcpy(p, &n, sizeof(USHORT));
+			}
+			else if (desc.dsc_dtype == dtype_cstring)
+				p[seed++ % desc.dsc_length] = 0;
+		}
+	}
+
+	std::vector<dsc> descs;
+	ULONG length;
+
+private:
+	void add(UCHAR dtype, USHORT size, ULONG alignment = 0)
+	{
+		if (!alignment)
+			alignment = size > 8 ? 8 : size;
+
+		length = FB_ALIGN(length, alignment);
+
+		dsc desc;
+		desc.clear();
+		desc.dsc_dtype = dtype;
+		desc.dsc_length = size;
+		desc.dsc_address = (UCHAR*) (IPTR) length;
+		descs.push_back(desc);
+
+		length += size;
+	}
+};
+
+static inline bool isNull(const UCHAR* nulls, size_t n)
+{
+	return nulls && (nulls[n >> 3] & (1 << (n & 7)));
+}
+
+static ULONG referenceEncode(const TestMessage& test, std::vector<UCHAR>& message, const UCHAR* nulls,
+	std::vector<UCHAR>& stream, bool local)
+{
+	stream.assign(STREAM_SIZE, 0);
+
+	xdr_t xdrs;
+	xdrs.create((SCHAR*) stream.data(), STREAM_SIZE, XDR_ENCODE);
+	xdrs.x_local = local;
+
+	for (size_t n = 0; n < test.descs.size(); n++)
+	{
+		if (!isNull(nulls, n))
+			BOOST_REQUIRE(xdr_datum(&xdrs, &test.descs[n], message.data()));
+	}
+
+	return STREAM_SIZE - xdrs.x_handy;
+}
+
+static void referenceDecode(const TestMessage& test, std::vector<UCHAR>& message, const UCHAR* nulls,
+	std::vector<UCHAR>& stream, ULONG length, bool local)
+{
+	message.assign(test.length, 0);
+
+	xdr_t xdrs;
+	xdrs.create((SCHAR*) stream.data(), length, XDR_DECODE);
+	xdrs.x_local = local;
+
+	for (size_t n = 0; n < test.descs.size(); n++)
+	{
+		if (!isNull(nulls, n))
+			BOOST_REQUIRE(xdr_datum(&xdrs, &test.descs[n], message.data()));
+	}
+
+	BOOST_TEST(xdrs.x_handy == 0u);
+}
+
+static ULONG planEncode(const XdrMessagePlan& plan, const std::vector<UCHAR>& message, const UCHAR* nulls,
+	std::vector<UCHAR>& stream, XdrMessagePlan::ByteOrder order)
+{
+	stream.assign(STREAM_SIZE, 0);
+
+	xdr_t xdrs;
+	xdrs.create((SCHAR*) stream.data(), STREAM_SIZE, XDR_ENCODE);
+	BOOST_REQUIRE(plan.encode(&xdrs, message.data(), nulls, order));
+
+	return STREAM_SIZE - xdrs.x_handy;
+}
+
+static void planDecode(const XdrMessagePlan& plan, size_t size, std::vector<UCHAR>& message, const UCHAR* nulls,
+	std::vector<UCHAR>& stream, ULONG length, XdrMessagePlan::ByteOrder order)
+{
+	message.assign(size, 0);
+
+	xdr_t xdrs;
+	xdrs.create((SCHAR*) stream.data(), length, XDR_DECODE);
+	BOOST_REQUIRE(plan.decode(&xdrs, message.data(), nulls, order));
+
+	BOOST_TEST(xdrs.x_handy == 0u);
+}
+
+// Message having only the bytes the stream carries, others are zero
+static void normalize(const TestMessage& test, std::vector<UCHAR>& message)
+{
+	std::vector<UCHAR> stream;
+	const ULONG length = referenceEncode(test, message, NULL, stream, false);
+	referenceDecode(test, message, NULL, stream, length, false);
+}
+
+
+BOOST_AUTO_TEST_SUITE(XdrMessageTests)
+
+BOOST_AUTO_TEST_CASE(SwapTest)
+{
+	for (ULONG count = 0; count < 11; count++)
+	{
+		std::vector<UCHAR> data, expected;
+
+		for (ULONG i = 0; i < count * 4; i++)
+			data.push_back((UCHAR) i);
+
+		for (ULONG i = 0; i < count * 4; i++)
+			expected.push_back((UCHAR) (i ^ 3));
+
+		XdrMessagePlan::swapWords(data.data(), count);
+		BOOST_TEST((data == expected));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(EncodeTest)
+{
+	const TestMessage test;
+	XdrMessagePlan plan(*getDefaultMemoryPool(), test.descs.data(), (FB_SIZE_T) test.descs.size());
+	BOOST_REQUIRE(plan.isValid());
+
+	const UCHAR someNulls[2] = {0x25, 0x90};
+	const UCHAR* const nullMaps[] = {NULL, someNulls};
+
+	for (ULONG seed = 1; seed < 20; seed++)
+	{
+		for (const auto nulls : nullMaps)
+		{
+			for (const bool local : {false, true})
+			{
+				const auto order = local ? XdrMessagePlan::ORDER_LOCAL : XdrMessagePlan::ORDER_XDR;
+
+				std::vector<UCHAR> message, expectedStream, stream;
+				test.fill(message, seed);
+
+				// The same stream as the items mapped one by one
+
+				const ULONG expectedLength = referenceEncode(test, message, nulls, expectedStream, local);
+				const ULONG length = planEncode(plan, message, nulls, stream, order);
+
+				BOOST_TEST(length == expectedLength);
+				BOOST_TEST((stream == expectedStream));
+
+				// And the same message from it
+
+				std::vector<UCHAR> expected, decoded;
+				referenceDecode(test, expected, nulls, stream, length, local);
+				planDecode(plan, test.length, decoded, nulls, stream, length, order);
+
+				BOOST_TEST((decoded == expected));
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(RawTest)
+{
+	const TestMessage test;
+	XdrMessagePlan plan(*getDefaultMemoryPool(), test.descs.data(), (FB_SIZE_T) test.descs.size());
+
+	for (ULONG seed = 1; seed < 20; seed++)
+	{
+		std::vector<UCHAR> message, stream, decoded;
+		test.fill(message, seed);
+		normalize(test, message);
+
+		const ULONG length = planEncode(plan, message, NULL, stream, XdrMessagePlan::ORDER_RAW);
+		planDecode(plan, test.length, decoded, NULL, stream, length, XdrMessagePlan::ORDER_RAW);
+
+		BOOST_TEST((decoded == message));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(PackedTest)
+{
+	// Values interleaved with NULL indicators, the plan takes every second item
+
+	const TestMessage test;
+	std::vector<dsc> descs;
+
+	for (const auto& desc : test.descs)
+	{
+		descs.push_back(desc);
+		descs.push_back(desc);
+	}
+
+	XdrMessagePlan packed(*getDefaultMemoryPool(), descs.data(), (FB_SIZE_T) descs.size(), 2);
+	BOOST_TEST(packed.getCount() == test.descs.size());
+
+	const UCHAR nulls[2] = {0x42, 0x01};
+	std::vector<UCHAR> message, expectedStream, stream;
+	test.fill(message, 7);
+
+	const ULONG expectedLength = referenceEncode(test, message, nulls, expectedStream, false);
+	BOOST_TEST(planEncode(packed, message, nulls, stream, XdrMessagePlan::ORDER_XDR) == expectedLength);
+	BOOST_TEST((stream == expectedStream));
+}
+
+BOOST_AUTO_TEST_CASE(InvalidTest)
+{
+	dsc desc;
+	desc.clear();
+	desc.dsc_dtype = dtype_cstring;
+	desc.dsc_length = 4;
+
+	XdrMessagePlan plan(*getDefaultMemoryPool(), &desc, 1);
+	BOOST_REQUIRE(plan.isValid());
+
+	// Longer string than the item can hold
+
+	std::vector<UCHAR> stream(8, 0), message(4, 0);
+	const SLONG length = htonl(6);
+	memcpy(stream.data(), &length, sizeof(length));
+
+	xdr_t xdrs;
+	xdrs.create((SCHAR*) stream.data(), 8, XDR_DECODE);
+	BOOST_TEST(!plan.decode(&xdrs, message.data(), NULL, XdrMessagePlan::ORDER_XDR));
+
+	// Unknown data type
+
+	desc.dsc_dtype = dtype_unknown;
+	BOOST_TEST(!XdrMessagePlan(*getDefaultMemoryPool(), &desc, 1).isValid());
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// XdrMessageTests
+
+BOOST_AUTO_TEST_SUITE_END()	// XdrMessageSuite
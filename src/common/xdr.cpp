@@ -185,20 +185,22 @@ bool_t xdr_datum( xdr_t* xdrs, const dsc* desc, UCHAR* buffer)
 
 	case dtype_varying:
 		{
+			// Message layout has the 16 bit length, not the one of struct vary
+
 			fb_assert(desc->dsc_length >= sizeof(USHORT));
-			vary* v = reinterpret_cast<vary*>(p);
-			if (!xdr_short(xdrs, reinterpret_cast<SSHORT*>(&v->vary_length)))
+			USHORT* const length = reinterpret_cast<USHORT*>(p);
+			SCHAR* const string = reinterpret_cast<SCHAR*>(p + sizeof(USHORT));
+			if (!xdr_short(xdrs, reinterpret_cast<SSHORT*>(length)))
 			{
 				return FALSE;
 			}
-			if (!xdr_opaque(xdrs, v->vary_string,
-							MIN((USHORT) (desc->dsc_length - 2), v->vary_length)))
+			if (!xdr_opaque(xdrs, string, MIN((USHORT) (desc->dsc_length - 2), *length)))
 			{
 				return FALSE;
 			}
-			if (xdrs->x_op == XDR_DECODE && desc->dsc_length - 2 > v->vary_length)
+			if (xdrs->x_op == XDR_DECODE && desc->dsc_length - 2 > *length)
 			{
-				memset(v->vary_string + v->vary_length, 0, desc->dsc_length - 2 - v->vary_length);
+				memset(string + *length, 0, desc->dsc_length - 2 - *length);
 			}
 		}
 		break;
@@ -69,9 +69,11 @@ public:
 		return "avg";
 	}
 
+	// tempImpure holds only the argument type and the result of aggExecute,
+	// so the per-group state is still the impure at impureOffset
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_HASHABLE_STATE;
 	}
 
 	virtual ScratchBird::string internalPrint(NodePrinter& printer) const;
@@ -138,7 +140,7 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_HASHABLE_STATE;
 	}
 
 	virtual ScratchBird::string internalPrint(NodePrinter& printer) const;
@@ -169,7 +171,7 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_HASHABLE_STATE;
 	}
 
 	virtual ScratchBird::string internalPrint(NodePrinter& printer) const;
@@ -200,7 +202,7 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_HASHABLE_STATE;
 	}
 
 	virtual ScratchBird::string internalPrint(NodePrinter& printer) const;
@@ -38,10 +38,10 @@ DsqlStatementCache::DsqlStatementCache(MemoryPool& o, Attachment* attachment)
 	: PermanentStorage(o),
 	  map(o),
 	  activeStatementList(o),
-	  inactiveStatementList(o)
+	  inactiveStatementList(o),
+	  database(attachment->att_database)
 {
-	const auto dbb = attachment->att_database;
-	maxCacheSize = dbb->dbb_config->getMaxStatementCacheSize();
+	maxCacheSize = database->dbb_config->getMaxStatementCacheSize();
 }
 
 DsqlStatementCache::~DsqlStatementCache()
@@ -99,7 +99,7 @@ RefPtr<DsqlStatement> DsqlStatementCache::getStatement(thread_db* tdbb, const st
 
 			entry->active = true;
 
-			cacheSize -= entry->size;
+			removeSize(entry->size);
 
 			activeStatementList.splice(activeStatementList.end(), inactiveStatementList, entry);
 		}
@@ -174,7 +174,7 @@ void DsqlStatementCache::removeStatement(thread_db* tdbb, DsqlStatement* stateme
 			else
 			{
 				inactiveStatementList.erase(entry);
-				cacheSize -= entry->size;
+				removeSize(entry->size);
 			}
 
 			map.remove(entry->key);
@@ -198,9 +198,9 @@ void DsqlStatementCache::statementGoingInactive(ScratchBird::RefStrPtr& key)
 
 	inactiveStatementList.splice(inactiveStatementList.end(), activeStatementList, entry);
 
-	cacheSize += entry->size;
+	addSize(entry->size);
 
-	if (cacheSize > maxCacheSize)
+	if (cacheSize > maxCacheSize || cacheSize > database->getStatementCacheQuota())
 		shrink();
 }
 
@@ -223,7 +223,7 @@ void DsqlStatementCache::purge(thread_db* tdbb, bool releaseLock)
 		activeStatementList.clear();
 		inactiveStatementList.clear();
 
-		cacheSize = 0;
+		removeSize(cacheSize);
 	}
 
 	if (!lock)
@@ -312,18 +312,37 @@ void DsqlStatementCache::buildVerifyKey(thread_db* tdbb, string& key, bool isInt
 	}
 }
 
+void DsqlStatementCache::addSize(unsigned size)
+{
+	database->incStatementCacheUsage(size, size && !cacheSize);
+	cacheSize += size;
+}
+
+void DsqlStatementCache::removeSize(unsigned size)
+{
+	fb_assert(cacheSize >= size);
+
+	database->decStatementCacheUsage(size, size && cacheSize == size);
+	cacheSize -= size;
+}
+
 void DsqlStatementCache::shrink()
 {
 #ifdef DSQL_STATEMENT_CACHE_DEBUG
 	printf("DsqlStatementCache::shrink() - cacheSize: %u, maxCacheSize: %u\n\n", cacheSize, maxCacheSize);
 #endif
 
-	while (cacheSize > maxCacheSize && !inactiveStatementList.isEmpty())
+	// Unused statements of this attachment are evicted also when all attachments
+	// together hold more than the database-wide limit and this one holds more
+	// than its share of it
+
+	while ((cacheSize > maxCacheSize || cacheSize > database->getStatementCacheQuota()) &&
+		!inactiveStatementList.isEmpty())
 	{
 		const auto& front = inactiveStatementList.front();
 		front.dsqlStatement->resetCacheKey();
 		map.remove(front.key);
-		cacheSize -= front.size;
+		removeSize(front.size);
 		inactiveStatementList.erase(inactiveStatementList.begin());
 	}
 
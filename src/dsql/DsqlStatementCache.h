@@ -36,6 +36,7 @@ namespace Jrd {
 
 
 class Attachment;
+class Database;
 class DsqlStatement;
 class Lock;
 class thread_db;
@@ -122,6 +123,8 @@ private:
 		USHORT clientDialect, bool isInternalRequest);
 
 	void buildVerifyKey(thread_db* tdbb, ScratchBird::string& key, bool isInternalRequest);
+	void addSize(unsigned size);
+	void removeSize(unsigned size);
 	void shrink();
 	void ensureLockIsCreated(thread_db* tdbb);
 
@@ -138,6 +141,7 @@ private:
 	ScratchBird::DoublyLinkedList<StatementEntry> activeStatementList;
 	ScratchBird::DoublyLinkedList<StatementEntry> inactiveStatementList;
 	ScratchBird::AutoPtr<Lock> lock;
+	Database* const database;
 	unsigned maxCacheSize = 0;
 	unsigned cacheSize = 0;
 };
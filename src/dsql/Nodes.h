@@ -947,6 +947,11 @@ public:
 	static const unsigned CAP_WANTS_AGG_CALLS		= 0x04;
 	// wants winPass call in a window
 	static const unsigned CAP_WANTS_WIN_PASS_CALL	= 0x08;
+	// keeps its per-group state in the impure_value_ex at impureOffset, so the
+	// state may be saved and restored per group when aggregating by hash; any
+	// other impure it uses (e.g. tempImpure of AVG) may only hold data common to
+	// all groups or scratch space of a single aggExecute call
+	static const unsigned CAP_HASHABLE_STATE		= 0x10;
 
 protected:
 	struct AggInfo
@@ -63,7 +63,9 @@ struct TraceCounts
 		BACKVERSION_READS,
 		FRAGMENT_READS,
 		RPT_READS,
-		IMGC
+		IMGC,
+		IMAGE_BYTES,
+		PACKED_BYTES
 	};
 
 	ntrace_relation_t	trc_relation_id;	// Relation ID
@@ -81,7 +83,11 @@ struct PerformanceInfo
 		FETCHES = 0,
 		READS,
 		MARKS,
-		WRITES
+		WRITES,
+		PREFETCH_HITS,
+		PREFETCH_MISSES,
+		PROBATION_HITS,
+		GHOST_HITS
 	};
 
 	ISC_INT64 pin_time;				// Total operation time in milliseconds
@@ -264,6 +264,10 @@ Jrd::Attachment::Attachment(MemoryPool* pool, Database* dbb, JProvider* provider
 	  att_system_schema_search_path(FB_NEW_POOL(*pool) AnyRef<ObjectsArray<MetaString>>(*pool)),
 	  att_link_manager(nullptr),
 	  att_parallel_workers(0),
+	  att_prefetch_last(0),
+	  att_prefetch_next(0),
+	  att_prefetch_run(0),
+	  att_prefetch_window(0),
 	  att_repl_appliers(*pool),
 	  att_utility(UTIL_NONE),
 	  att_procedures(*pool),
@@ -686,6 +686,12 @@ public:
 
 	PageToBufferMap* att_bdb_cache;			// managed in CCH, created in att_pool, freed with it
 
+	// Sequential access detection for read-ahead, managed in CCH
+	ULONG att_prefetch_last;				// last page read from disk
+	ULONG att_prefetch_next;				// first page not yet requested for read-ahead
+	USHORT att_prefetch_run;				// number of consecutive pages read
+	USHORT att_prefetch_window;				// current read-ahead window, pages
+
 	ScratchBird::RefPtr<ScratchBird::IReplicatedSession> att_replicator;
 	ScratchBird::AutoPtr<Replication::TableMatcher> att_repl_matcher;
 	ScratchBird::Array<Applier*> att_repl_appliers;
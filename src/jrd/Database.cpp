@@ -619,6 +619,8 @@ namespace Jrd
 		delete entry;
 
 		fb_assert(m_tempCacheUsage == 0);
+		fb_assert(m_stmtCacheUsage == 0);
+		fb_assert(m_stmtCacheHolders == 0);
 	}
 
 	LockManager* Database::GlobalObjectHolder::getLockManager()
@@ -682,6 +684,40 @@ namespace Jrd
 		m_tempCacheUsage.fetch_sub(size);
 	}
 
+	void Database::GlobalObjectHolder::incStatementCacheUsage(FB_SIZE_T size, bool firstStatement)
+	{
+		if (firstStatement)
+			++m_stmtCacheHolders;
+
+		m_stmtCacheUsage.fetch_add(size);
+	}
+
+	void Database::GlobalObjectHolder::decStatementCacheUsage(FB_SIZE_T size, bool lastStatement)
+	{
+		fb_assert(m_stmtCacheUsage >= size);
+
+		m_stmtCacheUsage.fetch_sub(size);
+
+		if (lastStatement)
+		{
+			fb_assert(m_stmtCacheHolders);
+			--m_stmtCacheHolders;
+		}
+	}
+
+	// While the cached statements exceed StatementCacheLimit, every attachment
+	// caching some may keep an equal share of it. Attachments above their share
+	// evict their least recently used statements, the others keep theirs.
+
+	FB_UINT64 Database::GlobalObjectHolder::getStatementCacheQuota() const
+	{
+		if (!m_stmtCacheLimit || m_stmtCacheUsage <= m_stmtCacheLimit)
+			return MAX_UINT64;
+
+		const ULONG holders = m_stmtCacheHolders;
+		return holders ? m_stmtCacheLimit / holders : 0;
+	}
+
 	GlobalPtr<Database::GlobalObjectHolder::DbIdHash>
 		Database::GlobalObjectHolder::g_hashTable;
 	GlobalPtr<Mutex> Database::GlobalObjectHolder::g_mutex;
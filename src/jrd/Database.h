@@ -232,6 +232,7 @@ const ULONG DBB_sweep_starting			= 0x80000L;		// Auto-sweep is starting
 const ULONG DBB_creating				= 0x100000L;		// Database creation is in progress
 const ULONG DBB_shared					= 0x200000L;	// Database object is shared among connections
 const ULONG DBB_restoring				= 0x400000L;	// Database restore is in progress
+const ULONG DBB_lz_records				= 0x800000L;	// Records are written using LZ4 compression
 
 //
 // dbb_ast_flags
@@ -313,6 +314,10 @@ class Database : public pool_alloc<type_dbb>
 		bool incTempCacheUsage(FB_SIZE_T size);
 		void decTempCacheUsage(FB_SIZE_T size);
 
+		void incStatementCacheUsage(FB_SIZE_T size, bool firstStatement);
+		void decStatementCacheUsage(FB_SIZE_T size, bool lastStatement);
+		FB_UINT64 getStatementCacheQuota() const;
+
 	private:
 		const ScratchBird::string m_id;
 		const ScratchBird::RefPtr<const ScratchBird::Config> m_config;
@@ -323,6 +328,9 @@ class Database : public pool_alloc<type_dbb>
 		ScratchBird::Mutex m_mutex;
 		std::atomic<FB_UINT64> m_tempCacheUsage;		// total size of in-memory temp space chunks (see TempSpace class)
 		const FB_UINT64 m_tempCacheLimit;
+		std::atomic<FB_UINT64> m_stmtCacheUsage;		// total size of unused statements cached by attachments (see DsqlStatementCache class)
+		std::atomic<ULONG> m_stmtCacheHolders;			// number of attachments caching unused statements
+		const FB_UINT64 m_stmtCacheLimit;
 
 		explicit GlobalObjectHolder(const ScratchBird::string& id,
 									const ScratchBird::PathName& filename,
@@ -330,7 +338,10 @@ class Database : public pool_alloc<type_dbb>
 			: m_id(getPool(), id), m_config(config),
 			  m_replConfig(Replication::Config::get(filename)),
 			  m_tempCacheUsage(0),
-			  m_tempCacheLimit(m_config->getTempCacheLimit())
+			  m_tempCacheLimit(m_config->getTempCacheLimit()),
+			  m_stmtCacheUsage(0),
+			  m_stmtCacheHolders(0),
+			  m_stmtCacheLimit(m_config->getStatementCacheLimit())
 		{}
 	};
 
@@ -479,10 +490,8 @@ public:
 	USHORT dbb_max_records;				// max record per data page
 	USHORT dbb_max_idx;					// max number of indexes on a root page
 
-#ifdef SUPERSERVER_V2
 	USHORT dbb_prefetch_sequence;		// sequence to pace frequency of prefetch requests
 	USHORT dbb_prefetch_pages;			// prefetch pages per request
-#endif
 
 	ScratchBird::PathName dbb_filename;	// filename string
 	ScratchBird::PathName dbb_database_name;	// database visible name (file name or alias)
@@ -720,6 +729,21 @@ public:
 		dbb_gblobj_holder->decTempCacheUsage(size);
 	}
 
+	void incStatementCacheUsage(FB_SIZE_T size, bool firstStatement)
+	{
+		dbb_gblobj_holder->incStatementCacheUsage(size, firstStatement);
+	}
+
+	void decStatementCacheUsage(FB_SIZE_T size, bool lastStatement)
+	{
+		dbb_gblobj_holder->decStatementCacheUsage(size, lastStatement);
+	}
+
+	FB_UINT64 getStatementCacheQuota() const
+	{
+		return dbb_gblobj_holder->getStatementCacheQuota();
+	}
+
 	bool isRestoring() const
 	{
 		return dbb_flags & DBB_restoring;
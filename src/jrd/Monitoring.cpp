@@ -1014,6 +1014,8 @@ void Monitoring::putDatabase(thread_db* tdbb, SnapshotData::DumpRecord& record)
 
 	record.storeInteger(f_mon_db_repl_mode, dbb->dbb_replica_mode);
 
+	record.storeInteger(f_mon_db_cache_policy, dbb->dbb_bcb->bcb_policy);
+
 	// statistics
 	const int stat_id = fb_utils::genUniqueId();
 	record.storeGlobalId(f_mon_db_stat_id, getGlobalId(stat_id));
@@ -1426,6 +1428,8 @@ void Monitoring::putStatistics(SnapshotData::DumpRecord& record, const RuntimeSt
 	record.storeInteger(f_mon_io_page_writes, statistics.getValue(RuntimeStatistics::PAGE_WRITES));
 	record.storeInteger(f_mon_io_page_fetches, statistics.getValue(RuntimeStatistics::PAGE_FETCHES));
 	record.storeInteger(f_mon_io_page_marks, statistics.getValue(RuntimeStatistics::PAGE_MARKS));
+	record.storeInteger(f_mon_io_page_probation_hits, statistics.getValue(RuntimeStatistics::PAGE_PROBATION_HITS));
+	record.storeInteger(f_mon_io_page_ghost_hits, statistics.getValue(RuntimeStatistics::PAGE_GHOST_HITS));
 	record.write();
 
 	// logical I/O statistics (global)
@@ -1447,6 +1451,8 @@ void Monitoring::putStatistics(SnapshotData::DumpRecord& record, const RuntimeSt
 	record.storeInteger(f_mon_rec_frg_reads, statistics.getValue(RuntimeStatistics::RECORD_FRAGMENT_READS));
 	record.storeInteger(f_mon_rec_rpt_reads, statistics.getValue(RuntimeStatistics::RECORD_RPT_READS));
 	record.storeInteger(f_mon_rec_imgc, statistics.getValue(RuntimeStatistics::RECORD_IMGC));
+	record.storeInteger(f_mon_rec_image_bytes, statistics.getValue(RuntimeStatistics::RECORD_IMAGE_BYTES));
+	record.storeInteger(f_mon_rec_packed_bytes, statistics.getValue(RuntimeStatistics::RECORD_PACKED_BYTES));
 	record.write();
 
 	// logical I/O statistics (table wise)
@@ -1481,6 +1487,8 @@ void Monitoring::putStatistics(SnapshotData::DumpRecord& record, const RuntimeSt
 		record.storeInteger(f_mon_rec_frg_reads, (*iter).getCounter(RuntimeStatistics::RECORD_FRAGMENT_READS));
 		record.storeInteger(f_mon_rec_rpt_reads, (*iter).getCounter(RuntimeStatistics::RECORD_RPT_READS));
 		record.storeInteger(f_mon_rec_imgc, (*iter).getCounter(RuntimeStatistics::RECORD_IMGC));
+		record.storeInteger(f_mon_rec_image_bytes, (*iter).getCounter(RuntimeStatistics::RECORD_IMAGE_BYTES));
+		record.storeInteger(f_mon_rec_packed_bytes, (*iter).getCounter(RuntimeStatistics::RECORD_PACKED_BYTES));
 		record.write();
 	}
 }
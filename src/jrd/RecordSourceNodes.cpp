@@ -2119,12 +2119,40 @@ RecordSource* AggregateSourceNode::compile(thread_db* tdbb, Optimizer* opt, bool
 		rse->firstRows = true;
 	}
 
+	// Unless the groups are expected to come in order, they may be aggregated
+	// by hash rather than by sorting the input. The optimizer decides that
+	// based on the number of groups fitting into the memory limit.
+
+	rse->rse_hash_groups = 0;
+
+	if (group && !groupOrder && !rse->rse_aggregate &&
+		HashAggregateStream::isHashable(tdbb, csb, &group->expressions, map))
+	{
+		const FB_UINT64 memoryLimit = tdbb->getDatabase()->dbb_config->getHashAggregateMemoryLimit();
+
+		if (memoryLimit)
+		{
+			rse->rse_hash_groups = (double) memoryLimit /
+				HashAggregateStream::getGroupLength(tdbb, csb, stream, &group->expressions, map);
+		}
+	}
+
 	RecordSource* const nextRsb = opt->compile(rse, &deliverStack);
 
 	// allocate and optimize the record source block
 
-	AggregatedStream* const rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) AggregatedStream(tdbb, csb,
-		stream, (group ? &group->expressions : NULL), map, nextRsb);
+	RecordSource* rsb;
+
+	if (rse->rse_hash_groups)
+	{
+		rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) HashAggregateStream(tdbb, csb,
+			stream, &group->expressions, map, nextRsb);
+	}
+	else
+	{
+		rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) AggregatedStream(tdbb, csb,
+			stream, (group ? &group->expressions : NULL), map, nextRsb);
+	}
 
 	if (rse->rse_aggregate)
 	{
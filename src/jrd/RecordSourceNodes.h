@@ -582,6 +582,7 @@ private:
 
 public:
 	bool dsqlWindow;
+	bool groupOrder = false;	// parent relies on the groups coming in order
 };
 
 class UnionSourceNode final : public TypedNode<RecordSourceNode, RecordSourceNode::TYPE_UNION>
@@ -835,6 +836,7 @@ public:
 		obj->rse_sorted = rse_sorted;
 		obj->rse_projection = rse_projection;
 		obj->rse_aggregate = rse_aggregate;
+		obj->rse_hash_groups = rse_hash_groups;
 		obj->rse_plan = rse_plan;
 		obj->rse_invariants = rse_invariants;
 		obj->flags = flags;
@@ -920,6 +922,7 @@ public:
 	NestConst<SortNode> rse_sorted;
 	NestConst<SortNode> rse_projection;
 	NestConst<SortNode> rse_aggregate;	// singleton aggregate for optimizing to index
+	double rse_hash_groups = 0;			// max groups to aggregate by hash instead of sorting
 	NestConst<PlanNode> rse_plan;		// user-specified access plan
 	NestConst<VarInvariantArray> rse_invariants; // Invariant nodes bound to top-level RSE
 	ScratchBird::Array<NestConst<RecordSourceNode> > rse_relations;
@@ -31,6 +31,10 @@ using namespace ScratchBird;
 
 namespace Jrd {
 
+static_assert((int) PerformanceInfo::GHOST_HITS == (int) RuntimeStatistics::PAGE_GHOST_HITS &&
+	(int) PerformanceInfo::GHOST_HITS + 1 == (int) RuntimeStatistics::RECORD_FIRST_ITEM,
+	"PerformanceInfo::PageCounters doesn't match RuntimeStatistics page counters");
+
 GlobalPtr<RuntimeStatistics> RuntimeStatistics::dummy;
 
 void RuntimeStatistics::findAndBumpRelValue(const StatType index, SLONG relation_id, SINT64 delta)
@@ -58,6 +58,10 @@ public:
 		PAGE_READS,
 		PAGE_MARKS,
 		PAGE_WRITES,
+		PAGE_PREFETCH_HITS,		// fetches satisfied by pages read ahead
+		PAGE_PREFETCH_MISSES,	// pages requested for read-ahead but read synchronously
+		PAGE_PROBATION_HITS,	// fetches satisfied by 2Q probation que
+		PAGE_GHOST_HITS,		// reads of pages recently evicted from 2Q probation que
 		RECORD_FIRST_ITEM,
 		RECORD_SEQ_READS = RECORD_FIRST_ITEM,
 		RECORD_IDX_READS,
@@ -74,7 +78,9 @@ public:
 		RECORD_FRAGMENT_READS,
 		RECORD_RPT_READS,
 		RECORD_IMGC,
-		RECORD_LAST_ITEM = RECORD_IMGC,
+		RECORD_IMAGE_BYTES,		// bytes of records written to data pages, before compression
+		RECORD_PACKED_BYTES,	// ... and after it
+		RECORD_LAST_ITEM = RECORD_PACKED_BYTES,
 		TOTAL_ITEMS		// last
 	};
 
@@ -34,6 +34,7 @@
 #include "../common/classes/VaryStr.h"
 #include "../common/classes/Hash.h"
 #include "../common/classes/Uuid.h"
+#include "../common/JsonBinary.h"
 #include "../jrd/SysFunction.h"
 #include "../jrd/DataTypeUtil.h"
 #include "../include/fb_blk.h"
@@ -248,6 +249,7 @@ void setParamsRsaSign(DataTypeUtilBase*, const SysFunction*, int argsCount, dsc*
 void setParamsRsaVerify(DataTypeUtilBase*, const SysFunction*, int argsCount, dsc** args);
 void setParamsUnicodeVal(DataTypeUtilBase* dataTypeUtil, const SysFunction* function, int argsCount, dsc** args);
 void setParamsUuidToChar(DataTypeUtilBase* dataTypeUtil, const SysFunction* function, int argsCount, dsc** args);
+void setParamsJson(DataTypeUtilBase* dataTypeUtil, const SysFunction* function, int argsCount, dsc** args);
 
 // generic make functions
 void makeDbkeyResult(DataTypeUtilBase* dataTypeUtil, const SysFunction* function, dsc* result, int argsCount, const dsc** args);
@@ -299,6 +301,7 @@ void makeUuidToChar(DataTypeUtilBase* dataTypeUtil, const SysFunction* function,
 // JSON make functions
 void makeJsonResult(DataTypeUtilBase* dataTypeUtil, const SysFunction* function, dsc* result, int argsCount, const dsc** args);
 void makeJsonTextResult(DataTypeUtilBase* dataTypeUtil, const SysFunction* function, dsc* result, int argsCount, const dsc** args);
+void makeJsonExtract(DataTypeUtilBase* dataTypeUtil, const SysFunction* function, dsc* result, int argsCount, const dsc** args);
 
 // generic stdmath function
 dsc* evlStdMath(thread_db* tdbb, const SysFunction* function, const NestValueArray& args, impure_value* impure);
@@ -363,6 +366,7 @@ dsc* evlUuidToChar(thread_db* tdbb, const SysFunction* function, const NestValue
 // JSON functions
 dsc* evlJsonValid(thread_db* tdbb, const SysFunction* function, const NestValueArray& args, impure_value* impure);
 dsc* evlJsonExtract(thread_db* tdbb, const SysFunction* function, const NestValueArray& args, impure_value* impure);
+dsc* evlJsonContains(thread_db* tdbb, const SysFunction* function, const NestValueArray& args, impure_value* impure);
 dsc* evlJsonObject(thread_db* tdbb, const SysFunction* function, const NestValueArray& args, impure_value* impure);
 dsc* evlJsonArray(thread_db* tdbb, const SysFunction* function, const NestValueArray& args, impure_value* impure);
 dsc* evlJsonSet(thread_db* tdbb, const SysFunction* function, const NestValueArray& args, impure_value* impure);
@@ -971,6 +975,13 @@ void setParamsUuidToChar(DataTypeUtilBase*, const SysFunction*, int argsCount, d
 }
 
 
+void setParamsJson(DataTypeUtilBase*, const SysFunction*, int argsCount, dsc** args)
+{
+	for (int i = 0; i < argsCount; ++i)
+		setParamVarying(args[i], ttype_utf8);
+}
+
+
 void makeDbkeyResult(DataTypeUtilBase*, const SysFunction*, dsc* result,
 	int argsCount, const dsc** args)
 {
@@ -1980,14 +1991,15 @@ void makeUuidToChar(DataTypeUtilBase*, const SysFunction* function, dsc* result,
 
 // JSON make functions
 
-void makeJsonResult(DataTypeUtilBase*, const SysFunction* function, dsc* result,
+void makeJsonResult(DataTypeUtilBase* dataTypeUtil, const SysFunction* function, dsc* result,
 	int argsCount, const dsc** args)
 {
 	fb_assert(argsCount >= function->minArgCount);
 
 	// JSON results are variable-length text with UTF8 encoding
 	result->makeVarying(0, ttype_utf8);
-	
+	result->dsc_length = dataTypeUtil->fixLength(result, MAX_STR_SIZE) + static_cast<USHORT>(sizeof(USHORT));
+
 	// Check if any arguments are nullable
 	bool nullable = false;
 	for (int i = 0; i < argsCount; i++)
@@ -2024,6 +2036,27 @@ void makeJsonTextResult(DataTypeUtilBase*, const SysFunction* function, dsc* res
 }
 
 
+void makeJsonExtract(DataTypeUtilBase* dataTypeUtil, const SysFunction* function, dsc* result,
+	int argsCount, const dsc** args)
+{
+	fb_assert(argsCount == function->minArgCount);
+
+	const dsc* value = args[0];
+
+	result->makeVarying(0, ttype_utf8);
+
+	// NULL is returned also when nothing is found at the path
+	result->setNullable(true);
+
+	// The extracted text is never longer than the document, so the result
+	// of VARCHAR document fits into the index key when the document does
+	const ULONG length = value->isText() ?
+		dataTypeUtil->convertLength(value, result) : MAX_STR_SIZE;
+
+	result->dsc_length = dataTypeUtil->fixLength(result, length) + static_cast<USHORT>(sizeof(USHORT));
+}
+
+
 dsc* evlStdMath(thread_db* tdbb, const SysFunction* function, const NestValueArray& args,
 	impure_value* impure)
 {
@@ -7085,7 +7118,8 @@ const SysFunction SysFunction::functions[] =
 		
 		// JSON functions
 		{"JSON_ARRAY", 0, -1, true, NULL, makeJsonResult, evlJsonArray, NULL},
-		{"JSON_EXTRACT", 2, 2, true, NULL, makeJsonTextResult, evlJsonExtract, NULL},
+		{"JSON_CONTAINS", 3, 3, true, setParamsJson, makeBooleanResult, evlJsonContains, NULL},
+		{"JSON_EXTRACT", 2, 2, true, setParamsJson, makeJsonExtract, evlJsonExtract, NULL},
 		{"JSON_MERGE", 2, -1, true, NULL, makeJsonResult, evlJsonMerge, NULL},
 		{"JSON_OBJECT", 0, -1, true, NULL, makeJsonResult, evlJsonObject, NULL},
 		{"JSON_SET", 3, 3, true, NULL, makeJsonResult, evlJsonSet, NULL},
@@ -7105,8 +7139,75 @@ const SysFunction SysFunction::functions[] =
 	};
 
 
+namespace {
+
 // JSON function implementations
 
+// Binary image of the JSON text argument
+void parseJsonArg(thread_db* tdbb, const SysFunction* function, const dsc* value, Array<UCHAR>& image)
+{
+	const string text = MOV_make_string2(tdbb, value, ttype_utf8);
+	ULONG errorOffset;
+
+	if (!JsonBinary::parse(*tdbb->getDefaultPool(), text.c_str(), text.length(), image, &errorOffset))
+	{
+		string message;
+		message.printf("Invalid JSON text at offset %u in %s", errorOffset, function->name);
+
+		status_exception::raise(Arg::Gds(isc_expression_eval_err) << Arg::Str(message));
+	}
+}
+
+// Binary image of the SQL value stored into JSON
+void makeJsonValue(thread_db* tdbb, const SysFunction* function, const dsc* value, Array<UCHAR>& image)
+{
+	if (!value)
+	{
+		image.add(JSON_NULL);
+		return;
+	}
+
+	if (value->dsc_dtype == dtype_json)
+	{
+		parseJsonArg(tdbb, function, value, image);
+		return;
+	}
+
+	if (value->isBoolean())
+	{
+		image.add(MOV_get_boolean(value) ? JSON_TRUE : JSON_FALSE);
+		return;
+	}
+
+	const string text = MOV_make_string2(tdbb, value, ttype_utf8);
+
+	// Numbers not representable in JSON, e.g. infinities, become strings
+	if (value->isNumeric() &&
+		JsonBinary::parse(*tdbb->getDefaultPool(), text.c_str(), text.length(), image))
+	{
+		if (JsonValue(image.begin()).getType() == JSON_NUMBER)
+			return;
+
+		image.clear();
+	}
+
+	JsonBinary::putScalar(image, JSON_STRING, text.c_str(), text.length());
+}
+
+// Text of the JSON value into the impure area
+dsc* makeJsonText(thread_db* tdbb, const JsonValue& value, impure_value* impure)
+{
+	string result;
+	value.toText(result);
+
+	dsc resultDesc;
+	resultDesc.makeText(result.length(), ttype_utf8, (UCHAR*) result.c_str());
+	EVL_make_value(tdbb, &resultDesc, impure);
+
+	return &impure->vlu_desc;
+}
+
+
 dsc* evlJsonValid(thread_db* tdbb, const SysFunction* function, const NestValueArray& args,
 	impure_value* impure)
 {
@@ -7118,34 +7219,8 @@ dsc* evlJsonValid(thread_db* tdbb, const SysFunction* function, const NestValueA
 	if (request->req_flags & req_null)	// return NULL if value is NULL
 		return NULL;
 
-	// Simple JSON validation - check for basic JSON structure
-	string jsonStr = MOV_make_string2(tdbb, value, ttype_utf8);
-	
-	// Basic JSON validation logic
-	bool isValid = false;
-	if (!jsonStr.empty())
-	{
-		const char* str = jsonStr.c_str();
-		int len = jsonStr.length();
-		
-		// Skip whitespace
-		int start = 0, end = len - 1;
-		while (start < len && isspace(str[start])) start++;
-		while (end >= 0 && isspace(str[end])) end--;
-		
-		if (start <= end)
-		{
-			char first = str[start];
-			char last = str[end];
-			
-			// Check for basic JSON structures
-			isValid = ((first == '{' && last == '}') ||  // Object
-					   (first == '[' && last == ']') ||  // Array
-					   (first == '"' && last == '"') ||  // String
-					   (jsonStr == "true" || jsonStr == "false" || jsonStr == "null") ||  // Literals
-					   (isdigit(first) || first == '-'));  // Number
-		}
-	}
+	const string jsonStr = MOV_make_string2(tdbb, value, ttype_utf8);
+	const bool isValid = JsonBinary::validate(jsonStr.c_str(), jsonStr.length());
 
 	impure->vlu_misc.vlu_uchar = isValid ? FB_TRUE : FB_FALSE;
 	impure->vlu_desc.makeBoolean(&impure->vlu_misc.vlu_uchar);
@@ -7169,100 +7244,102 @@ dsc* evlJsonExtract(thread_db* tdbb, const SysFunction* function, const NestValu
 	if (request->req_flags & req_null)
 		return NULL;
 
-	string jsonStr = MOV_make_string2(tdbb, jsonValue, ttype_utf8);
-	string pathStr = MOV_make_string2(tdbb, pathValue, ttype_utf8);
+	MemoryPool& pool = *tdbb->getDefaultPool();
+	Array<UCHAR> image(pool);
+	parseJsonArg(tdbb, function, jsonValue, image);
 
-	// Simple JSON path extraction (simplified implementation)
-	string result;
-	
-	// For demo purposes, implement basic property extraction for objects
-	if (pathStr.length() > 2 && pathStr[0] == '$' && pathStr[1] == '.')
+	const string pathStr = MOV_make_string2(tdbb, pathValue, ttype_utf8);
+
+	// The path with wildcards returns the array of the values found
+	if (JsonBinary::hasWildcard(pathStr.c_str(), pathStr.length()))
 	{
-		string propName = pathStr.substr(2);
-		
-		// Look for "propName": in the JSON string
-		string searchPattern = "\"" + propName + "\"";
-		size_t pos = jsonStr.find(searchPattern);
-		
-		if (pos != string::npos)
+		Array<UCHAR> values(pool);
+
+		if (!JsonBinary::extractAll(pool, JsonValue(image.begin()), pathStr.c_str(), pathStr.length(), values) ||
+			!JsonValue(values.begin()).getCount())
 		{
-			// Find the colon after the property name
-			size_t colonPos = jsonStr.find(':', pos);
-			if (colonPos != string::npos)
-			{
-				// Skip whitespace after colon
-				size_t valueStart = colonPos + 1;
-				while (valueStart < jsonStr.length() && isspace(jsonStr[valueStart]))
-					valueStart++;
-				
-				if (valueStart < jsonStr.length())
-				{
-					char firstChar = jsonStr[valueStart];
-					size_t valueEnd = valueStart;
-					
-					if (firstChar == '"')
-					{
-						// String value - find closing quote
-						valueEnd = jsonStr.find('"', valueStart + 1);
-						if (valueEnd != string::npos)
-						{
-							result = jsonStr.substr(valueStart + 1, valueEnd - valueStart - 1);
-						}
-					}
-					else if (firstChar == '{' || firstChar == '[')
-					{
-						// Object or array - simple bracket counting
-						int bracketCount = 0;
-						char closingBracket = (firstChar == '{') ? '}' : ']';
-						
-						for (size_t i = valueStart; i < jsonStr.length(); i++)
-						{
-							if (jsonStr[i] == firstChar) bracketCount++;
-							else if (jsonStr[i] == closingBracket) bracketCount--;
-							
-							if (bracketCount == 0)
-							{
-								valueEnd = i;
-								break;
-							}
-						}
-						
-						if (valueEnd > valueStart)
-						{
-							result = jsonStr.substr(valueStart, valueEnd - valueStart + 1);
-						}
-					}
-					else
-					{
-						// Primitive value - find end (comma, }, or ])
-						for (size_t i = valueStart; i < jsonStr.length(); i++)
-						{
-							if (jsonStr[i] == ',' || jsonStr[i] == '}' || jsonStr[i] == ']')
-							{
-								valueEnd = i - 1;
-								break;
-							}
-						}
-						
-						if (valueEnd >= valueStart)
-						{
-							result = jsonStr.substr(valueStart, valueEnd - valueStart + 1);
-							// Trim whitespace
-							while (!result.empty() && isspace(result.back()))
-								result.pop_back();
-						}
-					}
-				}
-			}
+			return NULL;
 		}
+
+		return makeJsonText(tdbb, JsonValue(values.begin()), impure);
 	}
 
-	if (result.empty())
+	JsonValue result;
+	if (!JsonValue(image.begin()).extract(pathStr.c_str(), pathStr.length(), result))
 		return NULL;
 
-	dsc resultDesc;
-	resultDesc.makeText(result.length(), ttype_utf8, (UCHAR*)result.c_str());
-	EVL_make_value(tdbb, &resultDesc, impure);
+	// Strings are returned unquoted, other values as JSON text
+	if (result.getType() == JSON_STRING)
+	{
+		const char* text;
+		ULONG length;
+		result.getText(text, length);
+
+		dsc resultDesc;
+		resultDesc.makeText(length, ttype_utf8, (UCHAR*) text);
+		EVL_make_value(tdbb, &resultDesc, impure);
+
+		return &impure->vlu_desc;
+	}
+
+	return makeJsonText(tdbb, result, impure);
+}
+
+
+// Membership test. With the wildcard path the values found are compared, otherwise
+// the value at the path or its elements if it's an array. Strings are compared
+// unquoted, other values as JSON text, the same way the multi-valued index over
+// JSON_EXTRACT(<document>, <path>) keys them.
+dsc* evlJsonContains(thread_db* tdbb, const SysFunction* function, const NestValueArray& args,
+	impure_value* impure)
+{
+	fb_assert(args.getCount() == 3);
+
+	Request* request = tdbb->getRequest();
+
+	const dsc* jsonValue = EVL_expr(tdbb, request, args[0]);
+	if (request->req_flags & req_null)
+		return NULL;
+
+	const dsc* pathValue = EVL_expr(tdbb, request, args[1]);
+	if (request->req_flags & req_null)
+		return NULL;
+
+	const dsc* value = EVL_expr(tdbb, request, args[2]);
+	if (request->req_flags & req_null)
+		return NULL;
+
+	MemoryPool& pool = *tdbb->getDefaultPool();
+	Array<UCHAR> image(pool), values(pool);
+	parseJsonArg(tdbb, function, jsonValue, image);
+
+	const string pathStr = MOV_make_string2(tdbb, pathValue, ttype_utf8);
+
+	if (!JsonBinary::extractAll(pool, JsonValue(image.begin()), pathStr.c_str(), pathStr.length(), values))
+		return NULL;
+
+	JsonValue candidates(values.begin());
+
+	if (!JsonBinary::hasWildcard(pathStr.c_str(), pathStr.length()) && candidates.getCount())
+	{
+		const JsonValue found = candidates.getElement(0);
+
+		if (found.getType() == JSON_ARRAY)
+			candidates = found;
+	}
+
+	const string target = MOV_make_string2(tdbb, value, ttype_utf8);
+	bool contains = false;
+
+	for (ULONG i = 0; i < candidates.getCount() && !contains; i++)
+	{
+		string text;
+		candidates.getElement(i).toPlainText(text);
+		contains = (text == target);
+	}
+
+	impure->vlu_misc.vlu_uchar = contains ? FB_TRUE : FB_FALSE;
+	impure->vlu_desc.makeBoolean(&impure->vlu_misc.vlu_uchar);
 
 	return &impure->vlu_desc;
 }
@@ -7414,20 +7491,28 @@ dsc* evlJsonSet(thread_db* tdbb, const SysFunction* function, const NestValueArr
 		return NULL;
 
 	const dsc* newValue = EVL_expr(tdbb, request, args[2]);
-	bool newValueIsNull = (request->req_flags & req_null);
+	if (request->req_flags & req_null)
+		newValue = NULL;
 
-	string jsonStr = MOV_make_string2(tdbb, jsonValue, ttype_utf8);
-	string pathStr = MOV_make_string2(tdbb, pathValue, ttype_utf8);
-	
-	// Simplified JSON_SET implementation
-	// For demo, we'll just return the original JSON with a comment
-	string result = jsonStr + " /* SET " + pathStr + " */";
+	MemoryPool& pool = *tdbb->getDefaultPool();
 
-	dsc resultDesc;
-	resultDesc.makeText(result.length(), ttype_utf8, (UCHAR*)result.c_str());
-	EVL_make_value(tdbb, &resultDesc, impure);
+	Array<UCHAR> image(pool);
+	parseJsonArg(tdbb, function, jsonValue, image);
 
-	return &impure->vlu_desc;
+	Array<UCHAR> valueImage(pool);
+	makeJsonValue(tdbb, function, newValue, valueImage);
+
+	const string pathStr = MOV_make_string2(tdbb, pathValue, ttype_utf8);
+
+	// The document is returned unchanged if the path has no parent in it
+	Array<UCHAR> result(pool);
+	if (!JsonBinary::set(pool, JsonValue(image.begin()), pathStr.c_str(), pathStr.length(),
+			JsonValue(valueImage.begin()), result))
+	{
+		return makeJsonText(tdbb, JsonValue(image.begin()), impure);
+	}
+
+	return makeJsonText(tdbb, JsonValue(result.begin()), impure);
 }
 
 
@@ -7800,6 +7885,8 @@ dsc* evlInetMerge(thread_db* tdbb, const SysFunction* function, const NestValueA
 		return NULL;
 	}
 }
+} // anonymous namespace
+
 
 
 const SysFunction* SysFunction::lookup(const MetaName& name)
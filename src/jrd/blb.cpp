@@ -88,6 +88,7 @@ static ArrayField* find_array(jrd_tra*, const bid*);
 static BlobFilter* find_filter(thread_db*, SSHORT, SSHORT);
 //static blob_page* get_next_page(thread_db*, blb*, WIN *);
 //static void insert_page(thread_db*, blb*);
+static bool move_box(const UCHAR*, const Ods::InternalArrayDesc*, const SLONG*, UCHAR*, array_slice*);
 static void move_from_string(Jrd::thread_db*, const dsc*, dsc*, jrd_rel*, Record*, USHORT);
 static void move_to_string(Jrd::thread_db*, dsc*, dsc*);
 static void slice_callback(array_slice*, ULONG, dsc*);
@@ -951,11 +952,14 @@ SLONG blb::get_slice(thread_db* tdbb,
 	arg.slice_high_water = data + length;
 	arg.slice_base = data + offset;
 
-	ISC_STATUS status = SDL_walk(tdbb->tdbb_status_vector, sdl,
-								 data, desc, variables, slice_callback, &arg);
+	if (!move_box(sdl, desc, variables, data, &arg))
+	{
+		ISC_STATUS status = SDL_walk(tdbb->tdbb_status_vector, sdl,
+									 data, desc, variables, slice_callback, &arg);
 
-	if (status) {
-		ERR_punt();
+		if (status) {
+			ERR_punt();
+		}
 	}
 
 	return (SLONG) (arg.slice_count * arg.slice_element_length);
@@ -1860,7 +1864,8 @@ void blb::put_slice(thread_db*	tdbb,
 	SLONG variables[64];
 	memcpy(variables, param, MIN(sizeof(variables), param_length));
 
-	if (SDL_walk(tdbb->tdbb_status_vector, sdl, array->arr_data, &array_desc->arr_desc,
+	if (!move_box(sdl, &array_desc->arr_desc, variables, array->arr_data, &arg) &&
+		SDL_walk(tdbb->tdbb_status_vector, sdl, array->arr_data, &array_desc->arr_desc,
 				 variables, slice_callback, &arg))
 	{
 		ERR_punt();
@@ -2398,10 +2403,8 @@ blob_page* blb::get_next_page(thread_db* tdbb, WIN* window)
 	}
 
 	SET_TDBB(tdbb);
-#ifdef SUPERSERVER_V2
 	Database* dbb = tdbb->getDatabase();
 	ULONG pages[PREFETCH_MAX_PAGES];
-#endif
 
 	const vcl& vector = *blb_pages;
 
@@ -2409,10 +2412,9 @@ blob_page* blb::get_next_page(thread_db* tdbb, WIN* window)
 	// Level 1 blobs are much easier -- page number is in vector.
 	if (blb_level == 1)
 	{
-#ifdef SUPERSERVER_V2
 		// Perform prefetch of blob level 1 data pages.
 
-		if (!(blb_sequence % dbb->dbb_prefetch_sequence))
+		if (dbb->dbb_prefetch_sequence && !(blb_sequence % dbb->dbb_prefetch_sequence))
 		{
 			USHORT sequence = blb_sequence;
 			USHORT i = 0;
@@ -2421,9 +2423,9 @@ blob_page* blb::get_next_page(thread_db* tdbb, WIN* window)
 				 pages[i++] = vector[sequence++];
 			}
 
-			CCH_PREFETCH(tdbb, pages, i);
+			CCH_PREFETCH(tdbb, window, pages, i);
 		}
-#endif
+
 		window->win_page = vector[blb_sequence];
 		page = (blob_page*) CCH_FETCH(tdbb, window, LCK_read, pag_blob);
 	}
@@ -2431,11 +2433,11 @@ blob_page* blb::get_next_page(thread_db* tdbb, WIN* window)
 	{
 		window->win_page = vector[blb_sequence / blb_pointers];
 		page = (blob_page*) CCH_FETCH(tdbb, window, LCK_read, pag_blob);
-#ifdef SUPERSERVER_V2
+
 		// Perform prefetch of blob level 2 data pages.
 
 		USHORT sequence = blb_sequence % blb_pointers;
-		if (!(sequence % dbb->dbb_prefetch_sequence))
+		if (dbb->dbb_prefetch_sequence && !(sequence % dbb->dbb_prefetch_sequence))
 		{
 			ULONG abs_sequence = blb_sequence;
 			USHORT i = 0;
@@ -2446,9 +2448,9 @@ blob_page* blb::get_next_page(thread_db* tdbb, WIN* window)
 				abs_sequence++;
 			}
 
-			CCH_PREFETCH(tdbb, pages, i);
+			CCH_PREFETCH(tdbb, window, pages, i);
 		}
-#endif
+
 		page = (blob_page*) CCH_HANDOFF(tdbb, window,
 										page->blp_page[blb_sequence % blb_pointers],
 										LCK_read, pag_blob);
@@ -2574,6 +2576,111 @@ void blb::insert_page(thread_db* tdbb)
 }
 
 
+static bool move_box(const UCHAR* sdl, const Ods::InternalArrayDesc* desc, const SLONG* variables,
+					 UCHAR* array, array_slice* arg)
+{
+/**************************************
+ *
+ *      m o v e _ b o x
+ *
+ **************************************
+ *
+ * Functional description
+ *      Move a slice that is a box of the array (see SDL_box) by runs
+ *      of its last dimension rather than calling slice_callback() for
+ *      every element. This is only possible when the slice elements
+ *      have the same fixed length type as the array elements, so
+ *      MOV_move() would just copy them. Return false if the slice
+ *      has to be walked.
+ *
+ **************************************/
+	const dsc element = desc->iad_rpt[0].iad_desc;
+	const dsc* const slice_desc = &arg->slice_desc;
+
+	if (slice_desc->dsc_dtype != element.dsc_dtype ||
+		slice_desc->dsc_length != element.dsc_length ||
+		slice_desc->dsc_scale != element.dsc_scale ||
+		slice_desc->dsc_sub_type != element.dsc_sub_type ||
+		element.dsc_length != desc->iad_element_length ||
+		DTYPE_IS_TEXT(element.dsc_dtype) || DTYPE_IS_BLOB_OR_QUAD(element.dsc_dtype))
+	{
+		return false;
+	}
+
+	SLONG lower[MAX_ARRAY_DIMENSIONS], upper[MAX_ARRAY_DIMENSIONS];
+
+	if (!SDL_box(sdl, desc, variables, lower, upper))
+		return false;
+
+	const USHORT last = desc->iad_dimensions - 1;
+
+	if (desc->iad_rpt[last].iad_length != 1)
+		return false;
+
+	const ULONG element_length = desc->iad_element_length;
+	const ULONG run_count = upper[last] - lower[last] + 1;
+	const ULONG run_length = run_count * element_length;
+
+	FB_UINT64 runs = 1;
+	for (USHORT n = 0; n < last; n++)
+		runs *= upper[n] - lower[n] + 1;
+
+	// Let SDL_walk() report a slice buffer that is too short
+
+	if (runs * run_length > (FB_UINT64) (arg->slice_end - slice_desc->dsc_address))
+		return false;
+
+	SLONG subscripts[MAX_ARRAY_DIMENSIONS];
+	memcpy(subscripts, lower, sizeof(SLONG) * desc->iad_dimensions);
+
+	BLOB_PTR* slice = slice_desc->dsc_address;
+
+	while (runs--)
+	{
+		SLONG subscript = 0;
+		for (USHORT n = 0; n <= last; n++)
+			subscript += (subscripts[n] - desc->iad_rpt[n].iad_lower) * desc->iad_rpt[n].iad_length;
+
+		BLOB_PTR* const run = array + (IPTR) element.dsc_address + subscript * element_length;
+
+		if (arg->slice_direction == array_slice::slc_writing_array)
+		{
+			// Zero the gap between the high-water mark and the run, as slice_callback() does
+
+			const SLONG gap = run - arg->slice_high_water;
+			if (gap > 0)
+				memset(const_cast<BLOB_PTR*>(arg->slice_high_water), 0, gap);
+
+			memcpy(run, slice, run_length);
+
+			if (run + run_length > arg->slice_high_water)
+				arg->slice_high_water = run + run_length;
+		}
+		else if (run < arg->slice_high_water)
+		{
+			// Elements starting above the high-water mark are skipped by SDL_walk()
+
+			const ULONG count = MIN(run_length,
+				(ULONG) (arg->slice_high_water - run) + element_length - 1) / element_length;
+
+			memcpy(slice, run, count * element_length);
+			arg->slice_count += count;
+		}
+
+		slice += run_length;
+
+		// The outer dimensions advance like an odometer
+
+		for (int n = last - 1; n >= 0 && ++subscripts[n] > upper[n]; n--)
+			subscripts[n] = lower[n];
+	}
+
+	arg->slice_desc.dsc_address = slice;
+
+	return true;
+}
+
+
 static void move_from_string(thread_db* tdbb, const dsc* from_desc, dsc* to_desc,
 							 jrd_rel* relation, Record* record, USHORT fieldId)
 {
@@ -28,8 +28,10 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#include <algorithm>
 #include "memory_routines.h"
 #include "../common/TimeZoneUtil.h"
+#include "../common/JsonBinary.h"
 #include "../common/classes/vector.h"
 #include "../common/classes/VaryStr.h"
 #include <stdio.h>
@@ -46,6 +48,8 @@
 #include "../jrd/cch.h"
 #include "../jrd/sort.h"
 #include "../jrd/val.h"
+#include "../jrd/SysFunction.h"
+#include "../dsql/ExprNodes.h"
 #include "../common/gdsassert.h"
 #include "../jrd/btr_proto.h"
 #include "../jrd/cch_proto.h"
@@ -170,6 +174,16 @@ namespace
 
 	typedef HalfStaticArray<IndexJumpNode, 32> JumpNodeList;
 
+	// Header of the multi-valued index key kept by IndexKey: length, nulls, flags
+	const FB_SIZE_T ELEMENT_HEADER_SIZE = sizeof(USHORT) + sizeof(USHORT) + sizeof(UCHAR);
+
+	// Order of the multi-valued index keys of a record, used only to find duplicates
+	int compareElementKeys(const UCHAR* data1, USHORT length1, const UCHAR* data2, USHORT length2)
+	{
+		const int result = memcmp(data1, data2, MIN(length1, length2));
+		return result ? result : (int) length1 - (int) length2;
+	}
+
 	struct FastLoadLevel
 	{
 		temporary_key key;
@@ -487,6 +501,28 @@ IndexExpression::IndexExpression(thread_db* tdbb, index_desc* idx)
 	m_request->req_rpb[0].rpb_number.setValid(true);
 }
 
+bool IndexExpression::isMultiValued(const index_desc* idx)
+{
+	if (!(idx->idx_flags & idx_expression) || !idx->idx_expression)
+		return false;
+
+	const auto funcNode = nodeAs<SysFuncCallNode>(idx->idx_expression);
+
+	if (!funcNode || !funcNode->function || strcmp(funcNode->function->name, "JSON_EXTRACT") ||
+		funcNode->args->items.getCount() != 2)
+	{
+		return false;
+	}
+
+	const auto pathNode = nodeAs<LiteralNode>(funcNode->args->items[1]);
+
+	if (!pathNode || pathNode->litDesc.dsc_dtype != dtype_text)
+		return false;
+
+	return JsonBinary::hasWildcard((const char*) pathNode->litDesc.dsc_address,
+		pathNode->litDesc.dsc_length);
+}
+
 IndexExpression::~IndexExpression()
 {
 	if (m_request)
@@ -567,6 +603,9 @@ idx_e IndexKey::compose(Record* record)
 
 				desc_ptr = m_expression->evaluate(record);
 				// Multi-byte text descriptor is returned already adjusted.
+
+				if (m_multiValued)
+					return composeElements(desc_ptr);
 			}
 			else
 			{
@@ -702,6 +741,175 @@ idx_e IndexKey::compose(Record* record)
 	return idx_e_ok;
 }
 
+bool IndexKey::next()
+{
+	if (!m_multiValued || m_element + 1 >= m_elementOffsets.getCount())
+		return false;
+
+	loadElement(++m_element);
+	return true;
+}
+
+bool IndexKey::contains(const IndexKey& other) const
+{
+	if (!m_multiValued)
+		return *this == other;
+
+	FB_SIZE_T low = 0, high = m_elementOffsets.getCount();
+
+	while (low < high)
+	{
+		const FB_SIZE_T middle = (low + high) / 2;
+
+		USHORT length;
+		const UCHAR* const data = getElement(middle, length);
+
+		const int result = compareElementKeys(data, length,
+			other.m_key.key_data, other.m_key.key_length);
+
+		if (result < 0)
+			low = middle + 1;
+		else if (result > 0)
+			high = middle;
+		else
+			return true;
+	}
+
+	return false;
+}
+
+idx_e IndexKey::composeElements(const dsc* desc)
+{
+	// The expression returns the JSON array of the values found at the path,
+	// each one is keyed the way JSON_CONTAINS compares it. The record without
+	// values is indexed with the NULL key.
+
+	const auto maxKeyLength = m_tdbb->getDatabase()->getMaxIndexKeyLength();
+	const auto tail = m_index->idx_rpt;
+	const bool descending = (m_index->idx_flags & idx_descending);
+	const USHORT textType = m_index->idx_expression_desc.getTextType();
+
+	MemoryPool& pool = *m_tdbb->getDefaultPool();
+	Array<UCHAR> image(pool);
+
+	if (desc)
+	{
+		const string text = MOV_make_string2(m_tdbb, desc, textType);
+
+		if (!JsonBinary::parse(pool, text.c_str(), text.length(), image))
+			JsonBinary::putScalar(image, JSON_STRING, text.c_str(), text.length());
+	}
+
+	m_elementKeys.clear();
+	m_elementOffsets.clear();
+
+	const JsonValue values(image.begin());
+	const ULONG count = image.isEmpty() ? 0 : (values.getType() == JSON_ARRAY) ? values.getCount() : 1;
+
+	for (ULONG i = 0; i < count; i++)
+	{
+		const JsonValue value = (values.getType() == JSON_ARRAY) ? values.getElement(i) : values;
+
+		string text;
+		value.toPlainText(text);
+
+		dsc valueDesc;
+		valueDesc.makeText(text.length(), textType, (UCHAR*) text.c_str());
+
+		m_key.key_flags = key_empty;
+		m_key.key_nulls = 0;
+		compress(m_tdbb, &valueDesc, 0, &m_key, tail->idx_itype, descending, m_keyType, nullptr);
+
+		if (m_key.key_length >= maxKeyLength)
+			return idx_e_keytoobig;
+
+		if (descending)
+			BTR_complement_key(&m_key);
+
+		storeElement();
+	}
+
+	if (!count)
+	{
+		m_key.key_flags = key_empty;
+		m_key.key_nulls = 1;
+		compress(m_tdbb, nullptr, 0, &m_key, tail->idx_itype, descending, m_keyType, nullptr);
+
+		if (descending)
+			BTR_complement_key(&m_key);
+
+		storeElement();
+	}
+
+	// Sort the keys and remove duplicates, every key is put into the index once
+
+	std::sort(m_elementOffsets.begin(), m_elementOffsets.end(),
+		[this] (ULONG offset1, ULONG offset2)
+		{
+			USHORT length1, length2;
+			const UCHAR* const data1 = getElementAt(offset1, length1);
+			const UCHAR* const data2 = getElementAt(offset2, length2);
+
+			return compareElementKeys(data1, length1, data2, length2) < 0;
+		});
+
+	FB_SIZE_T unique = 0;
+
+	for (FB_SIZE_T n = 0; n < m_elementOffsets.getCount(); n++)
+	{
+		if (unique)
+		{
+			USHORT length1, length2;
+			const UCHAR* const data1 = getElement(unique - 1, length1);
+			const UCHAR* const data2 = getElement(n, length2);
+
+			if (!compareElementKeys(data1, length1, data2, length2))
+				continue;
+		}
+
+		m_elementOffsets[unique++] = m_elementOffsets[n];
+	}
+
+	m_elementOffsets.shrink(unique);
+
+	m_element = 0;
+	loadElement(m_element);
+
+	return idx_e_ok;
+}
+
+void IndexKey::storeElement()
+{
+	m_elementOffsets.add(m_elementKeys.getCount());
+
+	const USHORT length = m_key.key_length;
+	const USHORT nulls = m_key.key_nulls;
+
+	m_elementKeys.add((const UCHAR*) &length, sizeof(USHORT));
+	m_elementKeys.add((const UCHAR*) &nulls, sizeof(USHORT));
+	m_elementKeys.add(m_key.key_flags);
+	m_elementKeys.add(m_key.key_data, length);
+}
+
+void IndexKey::loadElement(FB_SIZE_T n)
+{
+	const UCHAR* const ptr = m_elementKeys.begin() + m_elementOffsets[n];
+
+	memcpy(&m_key.key_length, ptr, sizeof(USHORT));
+	memcpy(&m_key.key_nulls, ptr + sizeof(USHORT), sizeof(USHORT));
+	m_key.key_flags = ptr[2 * sizeof(USHORT)];
+	memcpy(m_key.key_data, ptr + ELEMENT_HEADER_SIZE, m_key.key_length);
+}
+
+const UCHAR* IndexKey::getElementAt(ULONG offset, USHORT& length) const
+{
+	const UCHAR* const ptr = m_elementKeys.begin() + offset;
+
+	memcpy(&length, ptr, sizeof(USHORT));
+	return ptr + ELEMENT_HEADER_SIZE;
+}
+
+
 
 // IndexScanListIterator class
 
@@ -1217,6 +1425,10 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
 				pointer = page->btr_nodes + page->btr_jump_size;
 				prefix = 0;
+
+				// Read the next leaf page while this one is scanned
+				if (page->btr_sibling)
+					CCH_PREFETCH(tdbb, &window, &page->btr_sibling, 1);
 			}
 		}
 		else
@@ -1268,6 +1480,11 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 
 				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
 				endPointer = (UCHAR*) page + page->btr_length;
+
+				// Read the next leaf page while this one is scanned
+				if (page->btr_sibling)
+					CCH_PREFETCH(tdbb, &window, &page->btr_sibling, 1);
+
 				pointer = page->btr_nodes + page->btr_jump_size;
 				pointer = node.readNode(pointer, true);
 
@@ -373,6 +373,10 @@ public:
 
 	dsc* evaluate(Record* record) const;
 
+	// Index over JSON_EXTRACT(<document>, <path with [*] wildcards>) has a key
+	// per value found rather than the one of the whole result
+	static bool isMultiValued(const index_desc* idx);
+
 private:
 	thread_db* const m_tdbb;
 	ValueExprNode* m_expression = nullptr;
@@ -389,7 +393,8 @@ public:
 	IndexKey(thread_db* tdbb, jrd_rel* relation, index_desc* idx)
 		: m_tdbb(tdbb), m_relation(relation), m_index(idx),
 		  m_keyType((idx->idx_flags & idx_unique) ? INTL_KEY_UNIQUE : INTL_KEY_SORT),
-		  m_segments(idx->idx_count), m_expression(m_localExpression)
+		  m_segments(idx->idx_count), m_expression(m_localExpression),
+		  m_multiValued(IndexExpression::isMultiValued(idx))
 	{
 		fb_assert(m_index->idx_count);
 	}
@@ -397,7 +402,8 @@ public:
 	IndexKey(thread_db* tdbb, jrd_rel* relation, index_desc* idx, AutoIndexExpression& expr)
 		: m_tdbb(tdbb), m_relation(relation), m_index(idx),
 		  m_keyType((idx->idx_flags & idx_unique) ? INTL_KEY_UNIQUE : INTL_KEY_SORT),
-		  m_segments(idx->idx_count), m_expression(expr)
+		  m_segments(idx->idx_count), m_expression(expr),
+		  m_multiValued(IndexExpression::isMultiValued(idx))
 	{
 		fb_assert(m_index->idx_count);
 	}
@@ -405,7 +411,8 @@ public:
 	IndexKey(thread_db* tdbb, jrd_rel* relation, index_desc* idx,
 			 USHORT keyType, USHORT segments)
 		: m_tdbb(tdbb), m_relation(relation), m_index(idx),
-		  m_keyType(keyType), m_segments(segments), m_expression(m_localExpression)
+		  m_keyType(keyType), m_segments(segments), m_expression(m_localExpression),
+		  m_multiValued(IndexExpression::isMultiValued(idx))
 	{
 		fb_assert(m_index->idx_count && m_segments && m_segments <= m_index->idx_count);
 	}
@@ -413,19 +420,29 @@ public:
 	IndexKey(thread_db* tdbb, jrd_rel* relation, index_desc* idx,
 			 USHORT keyType, USHORT segments, AutoIndexExpression& expr)
 		: m_tdbb(tdbb), m_relation(relation), m_index(idx),
-		  m_keyType(keyType), m_segments(segments), m_expression(expr)
+		  m_keyType(keyType), m_segments(segments), m_expression(expr),
+		  m_multiValued(IndexExpression::isMultiValued(idx))
 	{
 		fb_assert(m_index->idx_count && m_segments && m_segments <= m_index->idx_count);
 	}
 
 	IndexKey(const IndexKey& other)
 		: m_tdbb(other.m_tdbb), m_relation(other.m_relation), m_index(other.m_index),
-		  m_keyType(other.m_keyType), m_segments(other.m_segments), m_expression(other.m_expression)
+		  m_keyType(other.m_keyType), m_segments(other.m_segments), m_expression(other.m_expression),
+		  m_multiValued(other.m_multiValued)
 	{
 	}
 
 	idx_e compose(Record* record);
 
+	// Multi-valued index has many keys per record: compose() makes all of them
+	// and sets the first one current, next() moves to the following one.
+	// Duplicate keys are made once.
+	bool next();
+
+	// Whether any key of the record equals to the current key of the other one
+	bool contains(const IndexKey& other) const;
+
 	operator temporary_key*()
 	{
 		return &m_key;
@@ -477,6 +494,22 @@ private:
 	temporary_key m_key;
 	AutoIndexExpression& m_expression;
 	AutoIndexExpression m_localExpression;
+
+	// Keys of multi-valued index: USHORT length, USHORT nulls, UCHAR flags, data
+	const bool m_multiValued;
+	ScratchBird::Array<UCHAR> m_elementKeys;
+	ScratchBird::Array<ULONG> m_elementOffsets;
+	FB_SIZE_T m_element = 0;
+
+	idx_e composeElements(const dsc* desc);
+	void storeElement();
+	void loadElement(FB_SIZE_T n);
+	const UCHAR* getElementAt(ULONG offset, USHORT& length) const;
+
+	const UCHAR* getElement(FB_SIZE_T n, USHORT& length) const
+	{
+		return getElementAt(m_elementOffsets[n], length);
+	}
 };
 
 // List scan iterator
@@ -64,6 +64,8 @@
 #include "../common/utils_proto.h"
 #include "../jrd/PageToBufferMap.h"
 
+#include <thread>
+
 #ifndef CDS_UNAVAILABLE
 // Use lock-free lists in hash table implementation
 #define HASH_USE_CDS_LIST
@@ -90,11 +92,6 @@ using namespace ScratchBird;
 IMPLEMENT_TRACE_ROUTINE(cch_trace, "CCH")
 #endif
 
-#ifdef SUPERSERVER_V2
-#define CACHE_READER
-#endif
-
-
 static inline void PAGE_LOCK_RELEASE(thread_db* tdbb, BufferControl* bcb, Lock* lock)
 {
 	if (!(bcb->bcb_flags & BCB_exclusive))
@@ -132,7 +129,8 @@ static int blocking_ast_bdb(void*);
 static void prefetch_epilogue(Prefetch*, FbStatusVector *);
 static void prefetch_init(Prefetch*, thread_db*);
 static void prefetch_io(Prefetch*, FbStatusVector *);
-static void prefetch_prologue(Prefetch*, SLONG *);
+static bool prefetch_prologue(Prefetch*);
+static void prefetch_reference(thread_db*, BufferDesc*, bool);
 #endif
 static void cacheBuffer(Attachment* att, BufferDesc* bdb);
 static void check_precedence(thread_db*, WIN*, PageNumber);
@@ -154,37 +152,41 @@ static bool set_diff_page(thread_db*, BufferDesc*);
 static void clear_dirty_flag_and_nbak_state(thread_db*, BufferDesc*);
 
 static BufferDesc* get_dirty_buffer(thread_db*);
+static void get_victim_ques(BufferPartition*, QUE*);
+static ULONG get_partition_count(const Database*, ULONG, bool);
 
 
-static inline void insertDirty(BufferControl* bcb, BufferDesc* bdb)
+static inline void insertDirty(BufferDesc* bdb)
 {
 	if (bdb->bdb_dirty.que_forward != &bdb->bdb_dirty)
 		return;
 
-	Sync dirtySync(&bcb->bcb_syncDirtyBdbs, "insertDirty");
+	BufferPartition* const partition = bdb->bdb_partition;
+	Sync dirtySync(&partition->bpt_syncDirtyBdbs, "insertDirty");
 	dirtySync.lock(SYNC_EXCLUSIVE);
 
 	if (bdb->bdb_dirty.que_forward != &bdb->bdb_dirty)
 		return;
 
-	bcb->bcb_dirty_count++;
-	QUE_INSERT(bcb->bcb_dirty, bdb->bdb_dirty);
+	partition->bpt_dirty_count++;
+	QUE_INSERT(partition->bpt_dirty, bdb->bdb_dirty);
 }
 
-static inline void removeDirty(BufferControl* bcb, BufferDesc* bdb)
+static inline void removeDirty(BufferDesc* bdb)
 {
 	if (bdb->bdb_dirty.que_forward == &bdb->bdb_dirty)
 		return;
 
-	Sync dirtySync(&bcb->bcb_syncDirtyBdbs, "removeDirty");
+	BufferPartition* const partition = bdb->bdb_partition;
+	Sync dirtySync(&partition->bpt_syncDirtyBdbs, "removeDirty");
 	dirtySync.lock(SYNC_EXCLUSIVE);
 
 	if (bdb->bdb_dirty.que_forward == &bdb->bdb_dirty)
 		return;
 
-	fb_assert(bcb->bcb_dirty_count > 0);
+	fb_assert(partition->bpt_dirty_count > 0);
 
-	bcb->bcb_dirty_count--;
+	partition->bpt_dirty_count--;
 	QUE_DELETE(bdb->bdb_dirty);
 	QUE_INIT(bdb->bdb_dirty);
 }
@@ -194,11 +196,21 @@ static void flushAll(thread_db* tdbb, USHORT flush_flag);
 static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, FB_SIZE_T count);
 
 static void recentlyUsed(BufferDesc* bdb);
-static void requeueRecentlyUsed(BufferControl* bcb);
+static void requeueRecentlyUsed(BufferPartition* partition);
+static void lru_admit(BufferPartition* partition, BufferDesc* bdb, bool probation);
+static void lru_append(BufferPartition* partition, BufferDesc* bdb);
+static void lru_remove(BufferPartition* partition, BufferDesc* bdb);
+static bool ghost_check(BufferControl* bcb, const PageNumber& page);
+static void ghost_remember(BufferControl* bcb, const PageNumber& page);
 
 
 const ULONG MIN_BUFFER_SEGMENT = 65536;
 
+// 2Q: part of the cache given to probation que and number of evicted
+// pages remembered, as suggested by 2Q authors (Kin = 25%, Kout = 50%)
+const ULONG PROBATION_SHARE = 4;
+const ULONG GHOST_SHARE = 2;
+
 // Given pointer a field in the block, find the block
 
 #define BLOCK(fld_ptr, type, fld) (type*)((SCHAR*) fld_ptr - offsetof(type, fld))
@@ -249,9 +261,12 @@ class BCBHashTable
 #endif
 
 public:
-	BCBHashTable(MemoryPool& pool, ULONG count) :
+	// Pages of a cache partition share the low bits of the page number,
+	// shift is used to skip them when choosing the hash slot
+	BCBHashTable(MemoryPool& pool, ULONG count, ULONG shift = 0) :
 		m_pool(pool),
 		m_count(0),
+		m_shift(shift),
 		m_chains(nullptr)
 	{
 		resize(count);
@@ -276,11 +291,12 @@ public:
 private:
 	ULONG hash(const PageNumber& pageno) const
 	{
-		return pageno.getPageNum() % m_count;
+		return (pageno.getPageNum() >> m_shift) % m_count;
 	}
 
 	MemoryPool& m_pool;
 	ULONG m_count;
+	const ULONG m_shift;
 	chain_type* m_chains;
 };
 
@@ -308,14 +324,15 @@ void CCH_clean_page(thread_db* tdbb, PageNumber page)
 		return;
 
 	BufferControl* bcb = dbb->dbb_bcb;
+	BufferPartition* const partition = bcb->getPartition(page);
 	BufferDesc* bdb = NULL;
 	{
 #ifndef HASH_USE_CDS_LIST
-		Sync bcbSync(&bcb->bcb_syncObject, "CCH_clean_page");
+		Sync bcbSync(&partition->bpt_syncHash, "CCH_clean_page");
 		bcbSync.lock(SYNC_SHARED);
 #endif
 
-		bdb = bcb->bcb_hashTable->find(page);
+		bdb = partition->bpt_hashTable->find(page);
 		if (!bdb)
 			return;
 
@@ -344,21 +361,20 @@ void CCH_clean_page(thread_db* tdbb, PageNumber page)
 		bdb->bdb_mark_transaction = 0;
 
 		if (!(bdb->bdb_bcb->bcb_flags & BCB_keep_pages))
-			removeDirty(dbb->dbb_bcb, bdb);
+			removeDirty(bdb);
 
 		bdb->bdb_flags &= ~(BDB_must_write | BDB_system_dirty | BDB_db_dirty);
 		clear_dirty_flag_and_nbak_state(tdbb, bdb);
 	}
 
 	{
-		Sync lruSync(&bcb->bcb_syncLRU, "CCH_release");
+		Sync lruSync(&partition->bpt_syncLRU, "CCH_release");
 		lruSync.lock(SYNC_EXCLUSIVE);
 
 		if (bdb->bdb_flags & BDB_lru_chained)
-			requeueRecentlyUsed(bcb);
+			requeueRecentlyUsed(partition);
 
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+		lru_append(partition, bdb);
 	}
 
 	bdb->release(tdbb, true);
@@ -756,7 +772,7 @@ pag* CCH_fake(thread_db* tdbb, WIN* window, int wait)
 	fb_assert((bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) == 0);
 	fb_assert(bdb->bdb_page == window->win_page);
 
-	bdb->bdb_flags &= BDB_lru_chained;	// yes, clear all except BDB_lru_chained
+	bdb->bdb_flags &= BDB_lru_flags;	// yes, clear all except LRU state
 	bdb->bdb_flags |= (BDB_writer | BDB_faked);
 	bdb->bdb_scan_count = 0;
 
@@ -819,6 +835,10 @@ pag* CCH_fetch(thread_db* tdbb, WIN* window, int lock_type, SCHAR page_type, int
 		return NULL;			// latch or lock timeout
 	}
 
+#ifdef CACHE_READER
+	prefetch_reference(tdbb, bdb, lockState == lsLocked);
+#endif
+
 	adjust_scan_count(window, lockState == lsLocked);
 
 	// Validate the fetched page matches the expected type
@@ -1098,34 +1118,30 @@ void CCH_forget_page(thread_db* tdbb, WIN* window)
 		dbb->dbb_flags &= ~DBB_suspend_bgio;
 
 	clear_dirty_flag_and_nbak_state(tdbb, bdb);
-	BufferControl* bcb = dbb->dbb_bcb;
+	BufferPartition* const partition = bdb->bdb_partition;
 
-	removeDirty(bcb, bdb);
+	removeDirty(bdb);
 
 	// remove from LRU list
 	{
-		SyncLockGuard lruSync(&bcb->bcb_syncLRU, SYNC_EXCLUSIVE, FB_FUNCTION);
-		requeueRecentlyUsed(bcb);
-		QUE_DELETE(bdb->bdb_in_use);
+		SyncLockGuard lruSync(&partition->bpt_syncLRU, SYNC_EXCLUSIVE, FB_FUNCTION);
+		requeueRecentlyUsed(partition);
+		lru_remove(partition, bdb);
 	}
 
 	// remove from hash table and put into empty list
-#ifndef HASH_USE_CDS_LIST
 	{
-		SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_EXCLUSIVE, FB_FUNCTION);
-		bcb->bcb_hashTable->remove(bdb);
-		QUE_INSERT(bcb->bcb_empty, bdb->bdb_que);
-		bcb->bcb_inuse--;
+#ifndef HASH_USE_CDS_LIST
+		SyncLockGuard hashSync(&partition->bpt_syncHash, SYNC_EXCLUSIVE, FB_FUNCTION);
+#endif
+		partition->bpt_hashTable->remove(bdb);
 	}
-#else
-	bcb->bcb_hashTable->remove(bdb);
 
 	{
-		SyncLockGuard syncEmpty(&bcb->bcb_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
-		QUE_INSERT(bcb->bcb_empty, bdb->bdb_que);
-		bcb->bcb_inuse--;
+		SyncLockGuard syncEmpty(&partition->bpt_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
+		QUE_INSERT(partition->bpt_empty, bdb->bdb_que);
+		partition->bpt_inuse--;
 	}
-#endif
 
 	bdb->bdb_flags = 0;
 
@@ -1156,7 +1172,12 @@ void CCH_fini(thread_db* tdbb)
 	if (!bcb)
 		return;
 
-	delete bcb->bcb_hashTable;
+	for (BufferPartition* const partition : bcb->bcb_partitions)
+	{
+		delete partition->bpt_hashTable;
+		delete partition;
+	}
+	bcb->bcb_partitions.clear();
 
 	for (auto blk : bcb->bcb_bdbBlocks)
 	{
@@ -1411,12 +1432,14 @@ void CCH_get_related(thread_db* tdbb, PageNumber page, PagesArray &lowPages)
 	Database* dbb = tdbb->getDatabase();
 	BufferControl* bcb = dbb->dbb_bcb;
 
+	BufferPartition* const partition = bcb->getPartition(page);
+
 #ifndef HASH_USE_CDS_LIST
-	Sync bcbSync(&bcb->bcb_syncObject, "CCH_get_related");
+	Sync bcbSync(&partition->bpt_syncHash, "CCH_get_related");
 	bcbSync.lock(SYNC_SHARED);
 #endif
 
-	BufferDesc* bdb = bcb->bcb_hashTable->find(page);
+	BufferDesc* bdb = partition->bpt_hashTable->find(page);
 #ifndef HASH_USE_CDS_LIST
 	bcbSync.unlock();
 #endif
@@ -1534,6 +1557,10 @@ pag* CCH_handoff(thread_db*	tdbb, WIN* window, ULONG page, int lock, SCHAR page_
 			bdb->downgrade(SYNC_SHARED);
 	}
 
+#ifdef CACHE_READER
+	prefetch_reference(tdbb, bdb, must_read == lsLocked);
+#endif
+
 	adjust_scan_count(window, must_read == lsLocked);
 
 	// Validate the fetched page matches the expected type
@@ -1579,14 +1606,30 @@ void CCH_init(thread_db* tdbb, ULONG number)
 
 	const ULONG count = number;
 
-	// Allocate and initialize buffers control block
+	// Allocate and initialize buffers control block and cache partitions
+
+	const ULONG partitions = get_partition_count(dbb, number, shared);
+	ULONG shift = 0;
+	while ((1u << shift) < partitions)
+		shift++;
+
 	BufferControl* bcb = BufferControl::create(dbb);
+	bcb->bcb_partition_mask = partitions - 1;
+
+	for (ULONG i = 0; i < partitions; i++)
+		bcb->bcb_partitions.add(FB_NEW_POOL(*bcb->bcb_bufferpool) BufferPartition(i));
+
 	while (true)
 	{
 		try
 		{
-			bcb->bcb_hashTable = FB_NEW_POOL(*bcb->bcb_bufferpool)
-				BCBHashTable(*bcb->bcb_bufferpool, number);
+			for (BufferPartition* const partition : bcb->bcb_partitions)
+			{
+				delete partition->bpt_hashTable;
+				partition->bpt_hashTable = nullptr;
+				partition->bpt_hashTable = FB_NEW_POOL(*bcb->bcb_bufferpool)
+					BCBHashTable(*bcb->bcb_bufferpool, number / partitions, shift);
+			}
 			break;
 		}
 		catch (const ScratchBird::Exception& ex)
@@ -1606,11 +1649,6 @@ void CCH_init(thread_db* tdbb, ULONG number)
 	bcb->bcb_flags = shared ? BCB_exclusive : 0;
 	//bcb->bcb_flags = BCB_exclusive;	// TODO detect real state using LM
 
-	QUE_INIT(bcb->bcb_in_use);
-	QUE_INIT(bcb->bcb_dirty);
-	bcb->bcb_dirty_count = 0;
-	QUE_INIT(bcb->bcb_empty);
-
 	// initialization of memory is system-specific
 
 	bcb->bcb_count = memory_init(tdbb, bcb, number);
@@ -1619,6 +1657,14 @@ void CCH_init(thread_db* tdbb, ULONG number)
 	if (bcb->bcb_count < MIN_PAGE_BUFFERS)
 		ERR_post(Arg::Gds(isc_cache_too_small));
 
+	// Choose page replacement policy
+
+	if (NoCaseString(dbb->dbb_config->getCacheReplacementPolicy()) == "2Q")
+	{
+		bcb->bcb_policy = CACHE_POLICY_2Q;
+		bcb->bcb_ghosts.grow(bcb->bcb_count / GHOST_SHARE);
+	}
+
 	// Log if requested number of page buffers could not be allocated.
 
 	if (count != bcb->bcb_count)
@@ -1641,21 +1687,31 @@ void CCH_init2(thread_db* tdbb)
 	ScratchBird::MutexEnsureUnlock guard(bcb->bcb_threadStartup, FB_FUNCTION);
 	guard.enter();
 
-	if (!(bcb->bcb_flags & BCB_exclusive) || (bcb->bcb_flags & (BCB_cache_writer | BCB_writer_start)))
+	if (!(bcb->bcb_flags & BCB_exclusive))
 		return;
 
 #ifdef CACHE_READER
-	if (gds__thread_start(cache_reader, dbb, THREAD_high, 0, 0))
+	if (dbb->dbb_prefetch_pages && !(bcb->bcb_flags & BCB_cache_reader))
 	{
-		ERR_bugcheck_msg("cannot start thread");
-	}
+		// Reader could fail to initialize last time, finish it
+		bcb->bcb_reader_fini.waitForCompletion();
+
+		try
+		{
+			bcb->bcb_reader_fini.run(bcb);
+		}
+		catch (const Exception&)
+		{
+			ERR_bugcheck_msg("cannot start cache reader thread");
+		}
 
-	{ // scope
-		Database::Checkout dcoHolder(dbb, FB_FUNCTION);
-		dbb->dbb_reader_init.enter();
+		bcb->bcb_reader_init.enter();
 	}
 #endif
 
+	if (bcb->bcb_flags & (BCB_cache_writer | BCB_writer_start))
+		return;
+
 	const Attachment* att = tdbb->getAttachment();
 	if (!(dbb->dbb_flags & DBB_read_only) && !(att->att_flags & ATT_security_db))
 	{
@@ -1759,7 +1815,7 @@ void CCH_mark(thread_db* tdbb, WIN* window, bool mark_system, bool must_write)
 	bdb->bdb_flags |= newFlags;
 
 	if (!(tdbb->tdbb_flags & TDBB_sweeper) || (bdb->bdb_flags & BDB_system_dirty))
-		insertDirty(bcb, bdb);
+		insertDirty(bdb);
 
 	bdb->bdb_flags |= BDB_marked | BDB_dirty;
 }
@@ -1847,8 +1903,7 @@ void CCH_precedence(thread_db* tdbb, WIN* window, PageNumber page)
 }
 
 
-#ifdef CACHE_READER
-void CCH_prefetch(thread_db* tdbb, SLONG* pages, SSHORT count)
+void CCH_prefetch(thread_db* tdbb, USHORT pageSpaceId, const ULONG* pages, USHORT count)
 {
 /**************************************
  *
@@ -1858,75 +1913,54 @@ void CCH_prefetch(thread_db* tdbb, SLONG* pages, SSHORT count)
  *
  * Functional description
  *	Given a vector of pages, set corresponding bits
- *	in global prefetch bitmap. Initiate an asynchronous
- *	I/O and get the cache reader reading in our behalf
- *	as well.
+ *	in global prefetch bitmap and get the cache reader
+ *	reading them in our behalf. Zero page numbers
+ *	are ignored, pages of temporary page spaces
+ *	are not prefetched.
  *
  **************************************/
+#ifdef CACHE_READER
 	SET_TDBB(tdbb);
-	Database* dbb = tdbb->getDatabase();
-	BufferControl* bcb = dbb->dbb_bcb;
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
 
-	if (!count || !(bcb->bcb_flags & BCB_cache_reader))
+	if (!count || pageSpaceId != DB_PAGE_SPACE || !(bcb->bcb_flags & BCB_cache_reader))
 	{
 		// Caller isn't really serious.
 		return;
 	}
 
-	// Switch default pool to permanent pool for setting bits in prefetch bitmap.
-	Jrd::ContextPoolHolder context(tdbb, bcb->bcb_bufferpool);
-
 	// The global prefetch bitmap is the key to the I/O coalescense mechanism which dovetails
 	// all thread prefetch requests to minimize sequential I/O requests.
 	// It also enables multipage I/O by implicitly sorting page vector requests.
 
-	SLONG first_page = 0;
-	for (const SLONG* const end = pages + count; pages < end;)
+	bool found = false;
+	for (const ULONG* const end = pages + count; pages < end; pages++)
 	{
-		const SLONG page = *pages++;
-		if (page)
+		const ULONG page = *pages;
+		if (!page)
+			continue;
+
+		// Don't bother cache reader with pages which are in cache already
 		{
-			SBM_set(tdbb, &bcb->bcb_prefetch, page);
-			if (!first_page)
-				first_page = page;
+			const PageNumber pageNum(DB_PAGE_SPACE, page);
+			BufferPartition* const partition = bcb->getPartition(pageNum);
+#ifndef HASH_USE_CDS_LIST
+			SyncLockGuard bcbSync(&partition->bpt_syncHash, SYNC_SHARED, FB_FUNCTION);
+#endif
+			if (partition->bpt_hashTable->find(pageNum))
+				continue;
 		}
-	}
-
-	// Not likely that the caller's page vector was empty but check anyway.
 
-	if (first_page)
-	{
-		prf prefetch;
-
-		prefetch_init(&prefetch, tdbb);
-		prefetch_prologue(&prefetch, &first_page);
-		prefetch_io(&prefetch, tdbb->tdbb_status_vector);
-		prefetch_epilogue(&prefetch, tdbb->tdbb_status_vector);
+		MutexLockGuard guard(bcb->bcb_prefetchMutex, FB_FUNCTION);
+		PBM_SET(bcb->bcb_bufferpool, &bcb->bcb_prefetch, page);
+		found = true;
 	}
-}
-
-
-bool CCH_prefetch_pages(thread_db* tdbb)
-{
-/**************************************
- *
- *	C C H _ p r e f e t c h _ p a g e s
- *
- **************************************
- *
- * Functional description
- *	Check the prefetch bitmap for a set
- *	of pages and read them into the cache.
- *
- **************************************/
-
-	// Placeholder to be implemented when predictive prefetch is
-	// enabled. This is called by VIO/garbage_collector() when it
-	// is idle to help satisfy the prefetch demand.
 
-	return false;
-}
+	if (found && !(bcb->bcb_flags & BCB_reader_active))
+		bcb->bcb_reader_sem.release();
 #endif // CACHE_READER
+}
 
 
 bool set_diff_page(thread_db* tdbb, BufferDesc* bdb)
@@ -2073,7 +2107,7 @@ void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 
 			if (!write_buffer(tdbb, bdb, bdb->bdb_page, false, tdbb->tdbb_status_vector, true))
 			{
-				insertDirty(bcb, bdb);
+				insertDirty(bdb);
 				CCH_unwind(tdbb, true);
 			}
 		}
@@ -2117,23 +2151,32 @@ void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 				if (window->win_flags & WIN_garbage_collector)
 					bdb->bdb_flags &= ~BDB_garbage_collect;
 
-				{ // bcb_syncLRU scope
-					Sync lruSync(&bcb->bcb_syncLRU, "CCH_release");
+				{ // bpt_syncLRU scope
+					BufferPartition* const partition = bdb->bdb_partition;
+					Sync lruSync(&partition->bpt_syncLRU, "CCH_release");
 					lruSync.lock(SYNC_EXCLUSIVE);
 
 					if (bdb->bdb_flags & BDB_lru_chained)
 					{
-						requeueRecentlyUsed(bcb);
+						requeueRecentlyUsed(partition);
 					}
 
-					QUE_DELETE(bdb->bdb_in_use);
-					QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+					// 2Q recycles probation buffers used by large scans and
+					// leaves frequently used pages where they are
+
+					if (bcb->bcb_policy != CACHE_POLICY_2Q)
+						lru_append(partition, bdb);
+					else if (bdb->bdb_probation)
+					{
+						bdb->bdb_flags |= BDB_large_scan;
+						lru_append(partition, bdb);
+					}
 				}
 
 				if ((bcb->bcb_flags & BCB_cache_writer) &&
 					(bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) )
 				{
-					insertDirty(bcb, bdb);
+					insertDirty(bdb);
 
 					bcb->bcb_flags |= BCB_free_pending;
 					if (!(bcb->bcb_flags & BCB_writer_active))
@@ -2232,9 +2275,9 @@ void CCH_shutdown(thread_db* tdbb)
 	if (bcb->bcb_flags & BCB_cache_reader)
 	{
 		bcb->bcb_flags &= ~BCB_cache_reader;
-		dbb->dbb_reader_sem.release();
-		dbb->dbb_reader_fini.enter();
+		bcb->bcb_reader_sem.release(); // Wake up running thread
 	}
+	bcb->bcb_reader_fini.waitForCompletion();
 #endif
 
 	// Wait for cache writer startup to complete
@@ -2669,19 +2712,20 @@ static void flushDirty(thread_db* tdbb, SLONG transaction_mask, const bool sys_o
 	BufferControl* bcb = dbb->dbb_bcb;
 	ScratchBird::HalfStaticArray<BufferDesc*, 1024> flush;
 
+	for (BufferPartition* const partition : bcb->bcb_partitions)
 	{  // dirtySync scope
-		Sync dirtySync(&bcb->bcb_syncDirtyBdbs, "flushDirty");
+		Sync dirtySync(&partition->bpt_syncDirtyBdbs, "flushDirty");
 		dirtySync.lock(SYNC_EXCLUSIVE);
 
-		QUE que_inst = bcb->bcb_dirty.que_forward, next;
-		for (; que_inst != &bcb->bcb_dirty; que_inst = next)
+		QUE que_inst = partition->bpt_dirty.que_forward, next;
+		for (; que_inst != &partition->bpt_dirty; que_inst = next)
 		{
 			next = que_inst->que_forward;
 			BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_dirty);
 
 			if (!(bdb->bdb_flags & BDB_dirty))
 			{
-				removeDirty(bcb, bdb);
+				removeDirty(bdb);
 				continue;
 			}
 
@@ -2707,7 +2751,12 @@ static void flushAll(thread_db* tdbb, USHORT flush_flag)
 	SET_TDBB(tdbb);
 	Database* dbb = tdbb->getDatabase();
 	BufferControl* bcb = dbb->dbb_bcb;
-	ScratchBird::HalfStaticArray<BufferDesc*, 1024> flush(bcb->bcb_dirty_count);
+
+	SLONG dirty_count = 0;
+	for (const BufferPartition* const partition : bcb->bcb_partitions)
+		dirty_count += partition->bpt_dirty_count;
+
+	ScratchBird::HalfStaticArray<BufferDesc*, 1024> flush(dirty_count);
 
 	const bool all_flag = (flush_flag & FLUSH_ALL) != 0;
 	const bool sweep_flag = (flush_flag & FLUSH_SWEEP) != 0;
@@ -2863,145 +2912,132 @@ void BufferControl::cache_reader(BufferControl* bcb)
  *
  * Functional description
  *	Prefetch pages into cache for sequential scans.
- *	Use asynchronous I/O to keep two prefetch requests
- *	busy at a time.
+ *	Use asynchronous I/O to keep several prefetch
+ *	requests busy at a time.
  *
  **************************************/
-	Database* dbb = bcb->bcb_database;
-	Database::SyncGuard dsGuard(dbb);
-
 	FbLocalStatus status_vector;
+	Database* const dbb = bcb->bcb_database;
+	bool started = false;
 
-	// Establish a thread context.
-	ThreadContextHolder tdbb(status_vector);
-
-	// Dummy attachment needed for lock owner identification.
-	tdbb->setDatabase(dbb);
-	Jrd::Attachment* const attachment = Attachment::create(dbb, nullptr);
-	tdbb->setAttachment(attachment);
-	attachment->att_filename = dbb->dbb_filename;
-	Jrd::ContextPoolHolder context(tdbb, bcb->bcb_bufferpool);
+	try
+	{
+		UserId user;
+		user.setUserName("Cache Reader");
 
-	// This try block is specifically to protect the LCK_init call: if
-	// LCK_init fails we won't be able to accomplish anything anyway, so
-	// return, unlike the other try blocks further down the page.
+		Jrd::Attachment* const attachment = Jrd::Attachment::create(dbb, nullptr);
+		RefPtr<SysStableAttachment> sAtt(FB_NEW SysStableAttachment(attachment));
+		attachment->setStable(sAtt);
+		attachment->att_filename = dbb->dbb_filename;
+		attachment->att_user = &user;
 
-	BufferControl* bcb = NULL;
+		BackgroundContextHolder tdbb(dbb, attachment, &status_vector, FB_FUNCTION);
+		Jrd::Attachment::UseCountHolder use(attachment);
 
-	try {
+		// Set up several prefetch control blocks to keep multiple prefetch
+		// requests active at a time. Requests are completed in the order
+		// they were started.
 
-		LCK_init(tdbb, LCK_OWNER_attachment);
-		TRA_init(attachment);
-		bcb = dbb->dbb_bcb;
-		bcb->bcb_flags |= BCB_cache_reader;
-		dbb->dbb_reader_init.post();	// Notify our creator that we have started
-	}
-	catch (const ScratchBird::Exception& ex)
-	{
-		ex.stuffException(status_vector);
-		iscDbLogStatus(dbb->dbb_filename.c_str(), status_vector);
-		return 0;
-	}
+		Prefetch prefetches[PREFETCH_MAX_REQUESTS];
+		for (auto& prefetch : prefetches)
+			prefetch_init(&prefetch, tdbb);
 
-	try {
+		try
+		{
+			LCK_init(tdbb, LCK_OWNER_attachment);
+			PAG_header(tdbb, true);
+			PAG_attachment_id(tdbb);
+			TRA_init(attachment);
 
-	// Set up dual prefetch control blocks to keep multiple prefetch
-	// requests active at a time. Also helps to prevent the cache reader
-	// from becoming dedicated or locked into a single request's prefetch demands.
+			Monitoring::publishAttachment(tdbb);
 
-	prf prefetch1, prefetch2;
-	prefetch_init(&prefetch1, tdbb);
-	prefetch_init(&prefetch2, tdbb);
+			sAtt->initDone();
 
-	while (bcb->bcb_flags & BCB_cache_reader)
-	{
-		bcb->bcb_flags |= BCB_reader_active;
-		bool found = false;
-		SLONG starting_page = -1;
-		prf* next_prefetch = &prefetch1;
+			bcb->bcb_flags |= BCB_cache_reader;
 
-		if (dbb->dbb_flags & DBB_suspend_bgio)
-		{
-			Database::Checkout dcoHolder(dbb, FB_FUNCTION);
-			dbb->dbb_reader_sem.tryEnter(10);
-			continue;
-		}
+			// Notify our creator that we have started
+			started = true;
+			bcb->bcb_reader_init.release();
 
-		// Make a pass thru the global prefetch bitmap looking for something
-		// to read. When the entire bitmap has been scanned and found to be
-		// empty then wait for new requests.
+			unsigned next = 0, oldest = 0;
 
-		do {
-			if (!(prefetch1.prf_flags & PRF_active) &&
-				SBM_next(bcb->bcb_prefetch, &starting_page, RSE_get_forward))
+			while (bcb->bcb_flags & BCB_cache_reader)
 			{
-				found = true;
-				prefetch_prologue(&prefetch1, &starting_page);
-				prefetch_io(&prefetch1, status_vector);
-			}
+				bcb->bcb_flags |= BCB_reader_active;
 
-			if (!(prefetch2.prf_flags & PRF_active) &&
-				SBM_next(bcb->bcb_prefetch, &starting_page, RSE_get_forward))
-			{
-				found = true;
-				prefetch_prologue(&prefetch2, &starting_page);
-				prefetch_io(&prefetch2, status_vector);
-			}
+				if (dbb->dbb_flags & DBB_suspend_bgio)
+				{
+					EngineCheckout cout(tdbb, FB_FUNCTION);
+					bcb->bcb_reader_sem.tryEnter(10);
+					continue;
+				}
 
-			prf* post_prefetch = next_prefetch;
-			next_prefetch = (post_prefetch == &prefetch1) ? &prefetch2 : &prefetch1;
+				// Start new requests while there are free prefetch blocks
+				// and pages waiting in the prefetch bitmap
 
-			if (post_prefetch->prf_flags & PRF_active)
-				prefetch_epilogue(post_prefetch, status_vector);
+				while (!(prefetches[next].prf_flags & PRF_active) &&
+					prefetch_prologue(&prefetches[next]))
+				{
+					prefetch_io(&prefetches[next], &status_vector);
 
-			if (found)
-			{
-				// If the cache writer or garbage collector is idle, put
-				// them to work prefetching pages.
-#ifdef CACHE_WRITER
-				if ((bcb->bcb_flags & BCB_cache_writer) && !(bcb->bcb_flags & BCB_writer_active))
-					dbb_writer_sem.release();
-#endif
-#ifdef GARBAGE_THREAD
-				if ((dbb->dbb_flags & DBB_garbage_collector) && !(dbb->dbb_flags & DBB_gc_active))
-					dbb->dbb_gc_sem.release();
-#endif
-			}
-		} while (prefetch1.prf_flags & PRF_active || prefetch2.prf_flags & PRF_active);
+					if (prefetches[next].prf_flags & PRF_active)
+						next = (next + 1) % PREFETCH_MAX_REQUESTS;
+				}
 
-		// If there's more work to do voluntarily ask to be rescheduled.
-		// Otherwise, wait for event notification.
-		BufferDesc* bdb;
-		if (found)
-			JRD_reschedule(tdbb, true);
-		else if (bcb->bcb_flags & BCB_free_pending && (bdb = get_dirty_buffer(tdbb)))
-		{
-			// In our spare time, help writer clean the cache.
+				// Stall on the oldest request, the rest keep running meanwhile
+
+				if (prefetches[oldest].prf_flags & PRF_active)
+				{
+					prefetch_epilogue(&prefetches[oldest], &status_vector);
+					oldest = (oldest + 1) % PREFETCH_MAX_REQUESTS;
+					attachment->mergeStats();
+					continue;
+				}
 
-			write_buffer(tdbb, bdb, bdb->bdb_page, true, status_vector, true);
+				bcb->bcb_flags &= ~BCB_reader_active;
+				EngineCheckout cout(tdbb, FB_FUNCTION);
+				bcb->bcb_reader_sem.tryEnter(10);
+			}
 		}
-		else
+		catch (const ScratchBird::Exception& ex)
 		{
-			bcb->bcb_flags &= ~BCB_reader_active;
-			Database::Checkout dcoHolder(dbb, FB_FUNCTION);
-			dbb->dbb_reader_sem.tryEnter(10);
+			ex.stuffException(&status_vector);
+			iscDbLogStatus(dbb->dbb_filename.c_str(), &status_vector);
+			// continue execution to clean up
 		}
-		bcb = dbb->dbb_bcb;
-	}
 
-	LCK_fini(tdbb, LCK_OWNER_attachment);
-	Jrd::Attachment::destroy(attachment);	// no need saving warning error strings here
-	tdbb->setAttachment(NULL);
-	bcb->bcb_flags &= ~BCB_cache_reader;
-	dbb->dbb_reader_fini.post();
+		// Requests still in progress are reading into latched buffers.
+		// Wait for them and give the buffers up without using their contents.
+
+		for (auto& prefetch : prefetches)
+		{
+			if (prefetch.prf_flags & PRF_active)
+			{
+				prefetch.prf_piob.piob_wait = TRUE;
+				PIO_status(tdbb, &prefetch.prf_piob, &status_vector);
+
+				for (USHORT i = 0; i < prefetch.prf_page_count; i++)
+					prefetch.prf_bdbs[i]->release(tdbb, true);
+
+				prefetch.prf_flags &= ~PRF_active;
+			}
+		}
 
+		Monitoring::cleanupAttachment(tdbb);
+		attachment->releaseLocks(tdbb);
+		LCK_fini(tdbb, LCK_OWNER_attachment);
+
+		attachment->releaseRelations(tdbb);
 	}	// try
 	catch (const ScratchBird::Exception& ex)
 	{
-		ex.stuffException(status_vector);
-		iscDbLogStatus(dbb->dbb_filename.c_str(), status_vector);
+		bcb->exceptionHandler(ex, cache_reader);
 	}
-	return 0;
+
+	bcb->bcb_flags &= ~(BCB_cache_reader | BCB_reader_active);
+
+	if (!started)
+		bcb->bcb_reader_init.release();
 }
 #endif
 
@@ -3055,9 +3091,6 @@ void BufferControl::cache_writer(BufferControl* bcb)
 			while (bcb->bcb_flags & BCB_cache_writer)
 			{
 				bcb->bcb_flags |= BCB_writer_active;
-#ifdef CACHE_READER
-				SLONG starting_page = -1;
-#endif
 
 				if (dbb->dbb_flags & DBB_suspend_bgio)
 				{
@@ -3091,19 +3124,6 @@ void BufferControl::cache_writer(BufferControl* bcb)
 
 				if ((bcb->bcb_flags & BCB_free_pending) || dbb->dbb_flush_cycle)
 					JRD_reschedule(tdbb, true);
-#ifdef CACHE_READER
-				else if (SBM_next(bcb->bcb_prefetch, &starting_page, RSE_get_forward))
-				{
-					// Prefetch some pages in our spare time and in the process
-					// garbage collect the prefetch bitmap.
-					prf prefetch;
-
-					prefetch_init(&prefetch, tdbb);
-					prefetch_prologue(&prefetch, &starting_page);
-					prefetch_io(&prefetch, status_vector);
-					prefetch_epilogue(&prefetch, status_vector);
-				}
-#endif
 				else
 				{
 					bcb->bcb_flags &= ~BCB_writer_active;
@@ -3220,12 +3240,14 @@ static void check_precedence(thread_db* tdbb, WIN* window, PageNumber page)
 
 	// Start by finding the buffer containing the high priority page
 
+	BufferPartition* const partition = bcb->getPartition(page);
+
 #ifndef HASH_USE_CDS_LIST
-	Sync bcbSync(&bcb->bcb_syncObject, FB_FUNCTION);
+	Sync bcbSync(&partition->bpt_syncHash, FB_FUNCTION);
 	bcbSync.lock(SYNC_SHARED);
 #endif
 
-	BufferDesc* high = bcb->bcb_hashTable->find(page);
+	BufferDesc* high = partition->bpt_hashTable->find(page);
 #ifndef HASH_USE_CDS_LIST
 	bcbSync.unlock();
 #endif
@@ -3589,11 +3611,18 @@ static bool expand_buffers(thread_db* tdbb, ULONG number)
 	if (number <= bcb->bcb_count)
 		return false;
 
-	// Expand hash table only if there is no concurrent attachments
+	// Expand hash tables only if there is no concurrent attachments
 	if ((tdbb->getAttachment()->att_flags & ATT_exclusive) || !(bcb->bcb_flags & BCB_exclusive))
-		bcb->bcb_hashTable->resize(number);
+	{
+		for (BufferPartition* const partition : bcb->bcb_partitions)
+		{
+#ifndef HASH_USE_CDS_LIST
+			SyncLockGuard hashSync(&partition->bpt_syncHash, SYNC_EXCLUSIVE, FB_FUNCTION);
+#endif
+			partition->bpt_hashTable->resize(number / bcb->bcb_partitions.getCount());
+		}
+	}
 
-	SyncLockGuard syncEmpty(&bcb->bcb_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
 	ULONG allocated = memory_init(tdbb, bcb, number - bcb->bcb_count);
 
 	bcb->bcb_count += allocated;
@@ -3611,113 +3640,161 @@ static BufferDesc* get_dirty_buffer(thread_db* tdbb)
 	SET_TDBB(tdbb);
 	Database* dbb = tdbb->getDatabase();
 	BufferControl* bcb = dbb->dbb_bcb;
-	int walk = bcb->bcb_free_minimum;
-	int chained = walk;
+	bool requeued = false;
 
-	Sync lruSync(&bcb->bcb_syncLRU, FB_FUNCTION);
-	lruSync.lock(SYNC_SHARED);
+	// Look at the tail of every cache partition
 
-	for (QUE que_inst = bcb->bcb_in_use.que_backward;
-		 que_inst != &bcb->bcb_in_use; que_inst = que_inst->que_backward)
+	for (BufferPartition* const partition : bcb->bcb_partitions)
 	{
-		BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
+		int walk = partition->bpt_free_minimum;
+		int chained = walk;
 
-		if (bdb->bdb_flags & BDB_lru_chained)
+		Sync lruSync(&partition->bpt_syncLRU, FB_FUNCTION);
+		lruSync.lock(SYNC_SHARED);
+
+		QUE lru_ques[2];
+		get_victim_ques(partition, lru_ques);
+
+		for (const QUE lru : lru_ques)
 		{
-			if (!--chained)
+			for (QUE que_inst = lru->que_backward; que_inst != lru; que_inst = que_inst->que_backward)
+			{
+				BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
+
+				if (bdb->bdb_flags & BDB_lru_chained)
+				{
+					if (!--chained)
+						break;
+					continue;
+				}
+
+				if (bdb->bdb_use_count || (bdb->bdb_flags & BDB_free_pending))
+					continue;
+
+				if (bdb->bdb_flags & BDB_db_dirty)
+				{
+					//tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES); shouldn't it be here?
+					return bdb;
+				}
+
+				if (!--walk)
+					break;
+			}
+
+			if (!chained || !walk)
 				break;
-			continue;
 		}
 
-		if (bdb->bdb_use_count || (bdb->bdb_flags & BDB_free_pending))
-			continue;
-
-		if (bdb->bdb_flags & BDB_db_dirty)
+		if (!chained)
 		{
-			//tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES); shouldn't it be here?
-			return bdb;
+			lruSync.unlock();
+			lruSync.lock(SYNC_EXCLUSIVE);
+			requeueRecentlyUsed(partition);
+			requeued = true;
 		}
-
-		if (!--walk)
-			break;
 	}
 
-	if (!chained)
-	{
-		lruSync.unlock();
-		lruSync.lock(SYNC_EXCLUSIVE);
-		requeueRecentlyUsed(bcb);
-	}
-	else
+	if (!requeued)
 		bcb->bcb_flags &= ~BCB_free_pending;
 
 	return NULL;
 }
 
 
-static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
+static void get_victim_ques(BufferPartition* partition, QUE* lru_ques)
 {
 /**************************************
  * Function description:
- *       Get candidate for preemption
+ *       Return LRU que's in the order they are searched for
+ *       a buffer to reuse. 2Q prefers buffers from probation que
+ *       while it holds more than its share of the cache.
+ *       bpt_syncLRU must be locked.
+ **************************************/
+
+	const bool probation = (partition->bpt_probation_count > partition->bpt_count / PROBATION_SHARE);
+
+	lru_ques[0] = probation ? &partition->bpt_probation : &partition->bpt_in_use;
+	lru_ques[1] = probation ? &partition->bpt_in_use : &partition->bpt_probation;
+}
+
+
+static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferPartition* partition)
+{
+/**************************************
+ * Function description:
+ *       Get candidate for preemption from the given cache partition
  *       Found page buffer must have SYNC_EXCLUSIVE lock.
  **************************************/
 
-	int walk = bcb->bcb_free_minimum;
+	BufferControl* const bcb = tdbb->getDatabase()->dbb_bcb;
+	int walk = partition->bpt_free_minimum;
 	BufferDesc* bdb = nullptr;
 
-	Sync lruSync(&bcb->bcb_syncLRU, FB_FUNCTION);
-	if (bcb->bcb_lru_chain.load() != NULL)
+	Sync lruSync(&partition->bpt_syncLRU, FB_FUNCTION);
+	if (partition->bpt_lru_chain.load() != NULL)
 	{
 		lruSync.lock(SYNC_EXCLUSIVE);
-		requeueRecentlyUsed(bcb);
+		requeueRecentlyUsed(partition);
 		lruSync.downgrade(SYNC_SHARED);
 	}
 	else
 		lruSync.lock(SYNC_SHARED);
 
-	for (QUE que_inst = bcb->bcb_in_use.que_backward;
-		 que_inst != &bcb->bcb_in_use;
-		 que_inst = que_inst->que_backward)
+	QUE lru_ques[2];
+	get_victim_ques(partition, lru_ques);
+
+	for (const QUE lru : lru_ques)
 	{
-		bdb = nullptr;
+		for (QUE que_inst = lru->que_backward; que_inst != lru; que_inst = que_inst->que_backward)
+		{
+			bdb = nullptr;
 
-		// get the oldest buffer as the least recently used -- note
-		// that since there are no empty buffers this queue cannot be empty
+			// get the oldest buffer as the least recently used -- note
+			// that since there are no empty buffers this queue cannot be empty
 
-		if (bcb->bcb_in_use.que_forward == &bcb->bcb_in_use)
-			BUGCHECK(213);	// msg 213 insufficient cache size
+			if (lru->que_forward == lru)
+				BUGCHECK(213);	// msg 213 insufficient cache size
 
-		BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
+			BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
 
-		if (oldest->bdb_flags & BDB_lru_chained)
-			continue;
+			if (oldest->bdb_flags & BDB_lru_chained)
+				continue;
 
-		if (oldest->bdb_use_count || !oldest->addRefConditional(tdbb, SYNC_EXCLUSIVE))
-			continue;
+			if (oldest->bdb_use_count || !oldest->addRefConditional(tdbb, SYNC_EXCLUSIVE))
+				continue;
 
-		/*if (!writeable(oldest))
-		{
-			oldest->release(tdbb, true);
-			continue;
-		}*/
+			/*if (!writeable(oldest))
+			{
+				oldest->release(tdbb, true);
+				continue;
+			}*/
 
-		bdb = oldest;
-		if (!(bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) || !walk)
-			break;
+			bdb = oldest;
+			if (!(bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) || !walk)
+				break;
 
-		if (!(bcb->bcb_flags & BCB_cache_writer))
-			break;
+			if (!(bcb->bcb_flags & BCB_cache_writer))
+				break;
 
-		bcb->bcb_flags |= BCB_free_pending;
-		if (!(bcb->bcb_flags & BCB_writer_active))
-			bcb->bcb_writer_sem.release();
+			bcb->bcb_flags |= BCB_free_pending;
+			if (!(bcb->bcb_flags & BCB_writer_active))
+				bcb->bcb_writer_sem.release();
 
-		bdb->release(tdbb, true);
-		bdb = nullptr;
-		--walk;
+			bdb->release(tdbb, true);
+			bdb = nullptr;
+			--walk;
+		}
+
+		if (bdb)
+			break;
 	}
 
+	// Remember page evicted from probation que, 2Q will keep it longer if
+	// it's requested again soon. Pages of large scans are not worth it.
+
+	if (bdb && bdb->bdb_probation && !(bdb->bdb_flags & BDB_large_scan))
+		ghost_remember(bcb, bdb->bdb_page);
+
 	lruSync.unlock();
 
 	if (!bdb)
@@ -3738,7 +3815,7 @@ static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
 	// If the buffer is still in the dirty tree, remove it.
 	// In any case, release any lock it may have.
 
-	removeDirty(bcb, bdb);
+	removeDirty(bdb);
 
 	// Cleanup any residual precedence blocks.  Unless something is
 	// screwed up, the only precedence blocks that can still be hanging
@@ -3766,6 +3843,33 @@ static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
 }
 
 
+static ULONG get_partition_count(const Database* dbb, ULONG number, bool shared)
+{
+/**************************************
+ * Function description:
+ *       Choose number of page cache partitions. Classic uses private
+ *       cache and doesn't need partitions, shared cache is partitioned
+ *       by number of CPU cores unless configured explicitly.
+ **************************************/
+
+	if (!shared)
+		return 1;
+
+	ULONG wanted = dbb->dbb_config->getCachePartitions();
+	if (!wanted)
+		wanted = std::thread::hardware_concurrency();
+
+	ULONG partitions = 1;
+	while (partitions * 2 <= wanted && partitions * 2 <= MAX_CACHE_PARTITIONS &&
+		number / (partitions * 2) >= MIN_PARTITION_BUFFERS)
+	{
+		partitions *= 2;
+	}
+
+	return partitions;
+}
+
+
 static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType syncType, int wait)
 {
 /**************************************
@@ -3809,6 +3913,8 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				{
 					recentlyUsed(bdb);
 					tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
+					if (bdb->bdb_probation)
+						tdbb->bumpStats(RuntimeStatistics::PAGE_PROBATION_HITS);
 					return bdb;
 				}
 
@@ -3824,6 +3930,10 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 		}
 	}
 
+	// Page could live in its own cache partition only
+
+	BufferPartition* const partition = bcb->getPartition(page);
+
 	while (true)
 	{
 		BufferDesc* bdb = nullptr;
@@ -3833,9 +3943,9 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 			// try to get already existing buffer
 			{
 #ifndef HASH_USE_CDS_LIST
-				SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_SHARED, FB_FUNCTION);
+				SyncLockGuard bcbSync(&partition->bpt_syncHash, SYNC_SHARED, FB_FUNCTION);
 #endif
-				bdb = bcb->bcb_hashTable->find(page);
+				bdb = partition->bpt_hashTable->find(page);
 			}
 
 			if (bdb)
@@ -3852,6 +3962,8 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				{
 					recentlyUsed(bdb);
 					tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
+					if (bdb->bdb_probation)
+						tdbb->bumpStats(RuntimeStatistics::PAGE_PROBATION_HITS);
 					cacheBuffer(att, bdb);
 					return bdb;
 				}
@@ -3863,17 +3975,17 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 			}
 
 			// try empty list
-			if (QUE_NOT_EMPTY(bcb->bcb_empty))
+			if (QUE_NOT_EMPTY(partition->bpt_empty))
 			{
-				SyncLockGuard bcbSync(&bcb->bcb_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
-				if (QUE_NOT_EMPTY(bcb->bcb_empty))
+				SyncLockGuard bcbSync(&partition->bpt_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
+				if (QUE_NOT_EMPTY(partition->bpt_empty))
 				{
-					QUE que_inst = bcb->bcb_empty.que_forward;
+					QUE que_inst = partition->bpt_empty.que_forward;
 					QUE_DELETE(*que_inst);
 					QUE_INIT(*que_inst);
 					bdb = BLOCK(que_inst, BufferDesc, bdb_que);
 
-					bcb->bcb_inuse++;
+					partition->bpt_inuse++;
 					is_empty = true;
 				}
 			}
@@ -3882,7 +3994,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				bdb->addRef(tdbb, SYNC_EXCLUSIVE);
 			else
 			{
-				bdb = get_oldest_buffer(tdbb, bcb);
+				bdb = get_oldest_buffer(tdbb, partition);
 				if (!bdb)
 				{
 					Thread::yield();
@@ -3908,9 +4020,9 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 
 			{
 #ifndef HASH_USE_CDS_LIST
-				SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_EXCLUSIVE, FB_FUNCTION);
+				SyncLockGuard bcbSync(&partition->bpt_syncHash, SYNC_EXCLUSIVE, FB_FUNCTION);
 #endif
-				bdb2 = bcb->bcb_hashTable->emplace(bdb, page, !is_empty);
+				bdb2 = partition->bpt_hashTable->emplace(bdb, page, !is_empty);
 				if (!bdb2)
 				{
 					bdb->bdb_page = page;
@@ -3924,16 +4036,24 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 					bcbSync.unlock();
 #endif
 
-					if (!(bdb->bdb_flags & BDB_lru_chained))
+					// 2Q admits page into probation que unless it was evicted from there recently
+
+					bool probation = false;
+					if (bcb->bcb_policy == CACHE_POLICY_2Q)
 					{
-						Sync syncLRU(&bcb->bcb_syncLRU, FB_FUNCTION);
-						if (syncLRU.lockConditional(SYNC_EXCLUSIVE))
-						{
-							QUE_DELETE(bdb->bdb_in_use);
-							QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
-						}
+						if (ghost_check(bcb, page))
+							tdbb->bumpStats(RuntimeStatistics::PAGE_GHOST_HITS);
 						else
-							recentlyUsed(bdb);
+							probation = true;
+					}
+
+					Sync syncLRU(&partition->bpt_syncLRU, FB_FUNCTION);
+					if (!(bdb->bdb_flags & BDB_lru_chained) && syncLRU.lockConditional(SYNC_EXCLUSIVE))
+						lru_admit(partition, bdb, probation);
+					else
+					{
+						bdb->bdb_flags |= probation ? (BDB_lru_admit | BDB_lru_probation) : BDB_lru_admit;
+						recentlyUsed(bdb);
 					}
 					tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
 					cacheBuffer(att, bdb);
@@ -3954,6 +4074,8 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				}
 				recentlyUsed(bdb2);
 				tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
+				if (bdb2->bdb_probation)
+					tdbb->bumpStats(RuntimeStatistics::PAGE_PROBATION_HITS);
 				cacheBuffer(att, bdb2);
 			}
 			else
@@ -3962,9 +4084,9 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 			bdb->release(tdbb, true);
 			if (is_empty)
 			{
-				SyncLockGuard syncEmpty(&bcb->bcb_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
-				QUE_INSERT(bcb->bcb_empty, bdb->bdb_que);
-				bcb->bcb_inuse--;
+				SyncLockGuard syncEmpty(&partition->bpt_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
+				QUE_INSERT(partition->bpt_empty, bdb->bdb_que);
+				partition->bpt_inuse--;
 			}
 
 			if (!bdb2 && wait > 0)
@@ -4296,7 +4418,12 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 			fb_assert(memory_end >= memory + page_size * to_alloc);
 		}
 
-		tail = ::new(tail) BufferDesc(bcb);
+		// Spread buffers over partitions evenly
+
+		BufferPartition* const partition =
+			bcb->bcb_partitions[(bcb->bcb_count + buffers) & bcb->bcb_partition_mask];
+
+		tail = ::new(tail) BufferDesc(bcb, partition);
 
 		if (!(bcb->bcb_flags & BCB_exclusive))
 		{
@@ -4309,7 +4436,12 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 		tail->bdb_buffer = (pag*) memory;
 		memory += bcb->bcb_page_size;
 
-		QUE_INSERT(bcb->bcb_empty, tail->bdb_que);
+		{
+			SyncLockGuard syncEmpty(&partition->bpt_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
+			QUE_INSERT(partition->bpt_empty, tail->bdb_que);
+			partition->bpt_count++;
+			partition->bpt_free_minimum = (SSHORT) MIN(partition->bpt_count / 4, 128);
+		}
 		tail++;
 
 		buffers++;				// Allocated buffers
@@ -4390,9 +4522,8 @@ static void prefetch_epilogue(Prefetch* prefetch, FbStatusVector* status_vector)
  *
  * Functional description
  *	Stall on asynchronous I/O completion.
- *	Move data from prefetch buffer to database
- *	buffers, compute the checksum, and release
- *	the latch.
+ *	Decrypt pages read into database buffers,
+ *	make them valid and release the latches.
  *
  **************************************/
 	if (!(prefetch->prf_flags & PRF_active))
@@ -4400,48 +4531,75 @@ static void prefetch_epilogue(Prefetch* prefetch, FbStatusVector* status_vector)
 
 	thread_db* tdbb = prefetch->prf_tdbb;
 	Database* dbb = tdbb->getDatabase();
+	BufferControl* bcb = dbb->dbb_bcb;
 
-	prefetch->prf_piob.piob_wait = TRUE;
-	const bool async_status = PIO_status(dbb, &prefetch->prf_piob, status_vector);
-
-	// If there was an I/O error release all buffer latches acquired for the prefetch request.
+	// Crypto manager may need to re-read the page when encryption
+	// state of database is changed meanwhile
 
-	if (!async_status)
+	class PrefetchIO : public CryptoManager::IOCallback
 	{
-		BufferDesc** next_bdb = prefetch->prf_bdbs;
-		for (USHORT i = 0; i < prefetch->prf_max_prefetch; i++)
+	public:
+		PrefetchIO(jrd_file* f, BufferDesc* b)
+			: file(f), bdb(b), done(false)
+		{ }
+
+		bool callback(thread_db* tdbb, FbStatusVector* status, Ods::pag* page)
 		{
-			if (*next_bdb)
-				release_bdb(tdbb, *next_bdb, true, false, false);
+			if (!done)
+			{
+				done = true;
+				return true;
+			}
 
-			next_bdb++;
+			return PIO_read(tdbb, file, bdb, page, status);
 		}
-		prefetch->prf_flags &= ~PRF_active;
-		return;
-	}
+	private:
+		jrd_file* file;
+		BufferDesc* bdb;
+		bool done;
+	};
 
-	const SCHAR* next_buffer = prefetch->prf_io_buffer;
-	BufferDesc** next_bdb = prefetch->prf_bdbs;
+	phys_io_blk* const piob = &prefetch->prf_piob;
+	piob->piob_wait = TRUE;
 
-	for (USHORT i = 0; i < prefetch->prf_max_prefetch; i++)
+	// If there was an I/O error leave pages to be read by their users,
+	// they will report the error if it persists. Pages beyond the end
+	// of file are not read too.
+
+	ULONG pages = 0;
+	if (PIO_status(tdbb, piob, status_vector))
+		pages = (ULONG) (piob->piob_actual_length / dbb->dbb_page_size);
+	else
+		status_vector->init();
+
+	// Don't use pages read from the database file if physical backup
+	// started meanwhile
+
+	if (dbb->dbb_backup_manager->getState() != Ods::hdr_nbak_normal)
+		pages = 0;
+
+	for (USHORT i = 0; i < prefetch->prf_page_count; i++)
 	{
-		if (*next_bdb)
+		BufferDesc* const bdb = prefetch->prf_bdbs[i];
+		pag* const page = bdb->bdb_buffer;
+
+		if (i < pages)
 		{
-			pag* page = (*next_bdb)->bdb_buffer;
-			if (next_buffer != reinterpret_cast<char*>(page))
-				memcpy(page, next_buffer, (ULONG) dbb->dbb_page_size);
+			PrefetchIO io(piob->piob_file, bdb);
 
-			if (page->pag_pageno == (*next_bdb)->bdb_page.getPageNum())
+			if (dbb->dbb_crypto_manager->read(tdbb, status_vector, page, &io) &&
+				page->pag_pageno == bdb->bdb_page.getPageNum())
 			{
-				(*next_bdb)->bdb_flags &= ~(BDB_read_pending | BDB_not_valid);
-				(*next_bdb)->bdb_flags |= BDB_prefetch;
+				bdb->bdb_incarnation = ++bcb->bcb_page_incarnation;
+				bdb->bdb_flags &= ~(BDB_read_pending | BDB_not_valid);
+				bdb->bdb_flags |= BDB_prefetch;
+				tdbb->bumpStats(RuntimeStatistics::PAGE_READS);
 			}
-
-			release_bdb(tdbb, *next_bdb, true, false, false);
+			else
+				status_vector->init();
 		}
 
-		next_buffer += dbb->dbb_page_size;
-		next_bdb++;
+		bdb->release(tdbb, true);
 	}
 
 	prefetch->prf_flags &= ~PRF_active;
@@ -4458,18 +4616,13 @@ static void prefetch_init(Prefetch* prefetch, thread_db* tdbb)
  *
  * Functional description
  *	Initialize prefetch data structure.
- *	Most systems that allow access to "raw" I/O
- *	interfaces want the buffer address aligned.
  *
  **************************************/
-	Database* dbb = tdbb->getDatabase();
-
 	prefetch->prf_tdbb = tdbb;
 	prefetch->prf_flags = 0;
-	prefetch->prf_max_prefetch = PREFETCH_MAX_TRANSFER / dbb->dbb_page_size;
-	prefetch->prf_aligned_buffer =
-		(SCHAR*) (((U_IPTR) &prefetch->prf_unaligned_buffer + MIN_PAGE_SIZE - 1) &
-		~((U_IPTR) MIN_PAGE_SIZE - 1));
+	prefetch->prf_start_page = 0;
+	prefetch->prf_page_count = 0;
+	prefetch->prf_max_prefetch = PREFETCH_MAX_PAGES;
 }
 
 
@@ -4483,41 +4636,39 @@ static void prefetch_io(Prefetch* prefetch, FbStatusVector* status_vector)
  *
  * Functional description
  *	Queue an asynchronous I/O to read
- *	multiple pages into prefetch buffer.
+ *	multiple pages into latched buffers.
  *
  **************************************/
 	thread_db* tdbb = prefetch->prf_tdbb;
 	Database* dbb = tdbb->getDatabase();
 
 	if (!prefetch->prf_page_count)
+	{
 		prefetch->prf_flags &= ~PRF_active;
+		return;
+	}
+
+	PageSpace* const pageSpace = dbb->dbb_page_manager.findPageSpace(DB_PAGE_SPACE);
+	phys_io_blk* piob = &prefetch->prf_piob;
+
+	PIO_prepare_read(pageSpace->file, prefetch->prf_start_page, dbb->dbb_page_size,
+					 prefetch->prf_buffers, prefetch->prf_page_count, piob);
+
+	if (PIO_read_ahead(tdbb, &piob, 1, status_vector))
+		prefetch->prf_flags |= PRF_active;
 	else
 	{
-		// Get the cache reader working on our behalf too
+		status_vector->init();
 
-		if (!(dbb->dbb_bcb->bcb_flags & BCB_reader_active))
-			dbb->dbb_reader_sem.post();
+		for (USHORT i = 0; i < prefetch->prf_page_count; i++)
+			prefetch->prf_bdbs[i]->release(tdbb, true);
 
-		const bool async_status =
-			PIO_read_ahead(dbb, prefetch->prf_start_page, prefetch->prf_io_buffer,
-						   prefetch->prf_page_count, &prefetch->prf_piob, status_vector);
-		if (!async_status)
-		{
-			BufferDesc** next_bdb = prefetch->prf_bdbs;
-			for (USHORT i = 0; i < prefetch->prf_max_prefetch; i++)
-			{
-				if (*next_bdb)
-					release_bdb(tdbb, *next_bdb, true, false, false);
-
-				next_bdb++;
-			}
-			prefetch->prf_flags &= ~PRF_active;
-		}
+		prefetch->prf_flags &= ~PRF_active;
 	}
 }
 
 
-static void prefetch_prologue(Prefetch* prefetch, SLONG* start_page)
+static bool prefetch_prologue(Prefetch* prefetch)
 {
 /**************************************
  *
@@ -4526,49 +4677,177 @@ static void prefetch_prologue(Prefetch* prefetch, SLONG* start_page)
  **************************************
  *
  * Functional description
- *	Search for consecutive pages to be prefetched
- *	and latch them for I/O.
+ *	Search prefetch bitmap for consecutive pages
+ *	to be prefetched and latch them for I/O.
+ *	Return false if there is nothing to prefetch.
  *
  **************************************/
 	thread_db* tdbb = prefetch->prf_tdbb;
 	Database* dbb = tdbb->getDatabase();
 	BufferControl* bcb = dbb->dbb_bcb;
 
-	prefetch->prf_start_page = *start_page;
+	ULONG pages[PREFETCH_MAX_PAGES];
+	USHORT count = 0;
+
+	{	// scope
+		MutexLockGuard guard(bcb->bcb_prefetchMutex, FB_FUNCTION);
+		PageBitmap* const bitmap = bcb->bcb_prefetch;
+
+		if (!bitmap || !bitmap->getFirst())
+			return false;
+
+		do
+		{
+			const ULONG page = bitmap->current();
+			if (count && page != pages[count - 1] + 1)
+				break;
+
+			pages[count++] = page;
+		} while (count < prefetch->prf_max_prefetch && bitmap->getNext());
+
+		for (USHORT i = 0; i < count; i++)
+			bitmap->clear(pages[i]);
+	}
+
+	prefetch->prf_start_page = pages[0];
 	prefetch->prf_page_count = 0;
-	prefetch->prf_flags |= PRF_active;
 
-	BufferDesc** next_bdb = prefetch->prf_bdbs;
-	for (USHORT i = 0; i < prefetch->prf_max_prefetch; i++)
+	// While physical backup is in progress actual page image
+	// could be in the difference file, don't read ahead then
+
+	if (dbb->dbb_backup_manager->getState() != Ods::hdr_nbak_normal)
+		return true;
+
+	// Latch buffers for pages which are not in cache. Pages are read by
+	// single I/O, so the run ends at the first page which can't be read.
+
+	USHORT i = 0;
+	while (i < count)
 	{
-		*next_bdb = 0;
-		if (SBM_clear(bcb->bcb_prefetch, *start_page) &&
-			(*next_bdb = get_buffer(tdbb, *start_page, LATCH_shared, 0)))
+		const ULONG page = pages[i++];
+		BufferDesc* const bdb = get_buffer(tdbb, PageNumber(DB_PAGE_SPACE, page), SYNC_EXCLUSIVE, 0);
+
+		if (bdb && (bdb->bdb_flags & BDB_read_pending))
 		{
-			if ((*next_bdb)->bdb_flags & BDB_read_pending)
-				prefetch->prf_page_count = i + 1;
-			else
-			{
-				release_bdb(tdbb, *next_bdb, true, false, false);
-				*next_bdb = 0;
-			}
+			if (!prefetch->prf_page_count)
+				prefetch->prf_start_page = page;
+
+			prefetch->prf_bdbs[prefetch->prf_page_count] = bdb;
+			prefetch->prf_buffers[prefetch->prf_page_count++] = bdb->bdb_buffer;
+			continue;
 		}
 
-		next_bdb++;
-		(*start_page)++;
+		if (bdb)
+			bdb->release(tdbb, true);
+
+		if (prefetch->prf_page_count)
+			break;
 	}
 
-	// Optimize non-sequential list prefetching to transfer directly to database buffers.
+	// Return the rest of the pages to the bitmap for the next request
 
-	BufferDesc* bdb;
-	if (prefetch->prf_page_count == 1 && (bdb = prefetch->prf_bdbs[0]))
-		prefetch->prf_io_buffer = reinterpret_cast<char*>(bdb->bdb_buffer);
+	if (i < count)
+	{
+		MutexLockGuard guard(bcb->bcb_prefetchMutex, FB_FUNCTION);
+
+		while (i < count)
+			PBM_SET(bcb->bcb_bufferpool, &bcb->bcb_prefetch, pages[i++]);
+	}
+
+	return true;
+}
+
+
+static void prefetch_reference(thread_db* tdbb, BufferDesc* bdb, bool mustRead)
+{
+/**************************************
+ *
+ *	p r e f e t c h _ r e f e r e n c e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Account prefetch hits and misses and detect
+ *	sequential page access by the attachment.
+ *	When access is sequential request read-ahead
+ *	of the pages which follow, doubling the window
+ *	while the scan keeps consuming prefetched pages.
+ *
+ **************************************/
+	BufferControl* const bcb = bdb->bdb_bcb;
+
+	if (!(bcb->bcb_flags & BCB_cache_reader) || bdb->bdb_page.getPageSpaceID() != DB_PAGE_SPACE)
+		return;
+
+	const ULONG page = bdb->bdb_page.getPageNum();
+
+	if (mustRead)
+	{
+		// Page was read synchronously although read-ahead was requested for it
+
+		if (bcb->bcb_prefetch)
+		{
+			MutexLockGuard guard(bcb->bcb_prefetchMutex, FB_FUNCTION);
+
+			if (bcb->bcb_prefetch->clear(page))
+				tdbb->bumpStats(RuntimeStatistics::PAGE_PREFETCH_MISSES);
+		}
+	}
+	else if (bdb->bdb_flags & BDB_prefetch)
+	{
+		bdb->bdb_flags &= ~BDB_prefetch;
+		tdbb->bumpStats(RuntimeStatistics::PAGE_PREFETCH_HITS);
+	}
 	else
-		prefetch->prf_io_buffer = prefetch->prf_aligned_buffer;
+		return;
+
+	Attachment* const att = tdbb->getAttachment();
+	const ULONG maxWindow = tdbb->getDatabase()->dbb_config->getReadAhead();
+
+	if (!att || !maxWindow)
+		return;
+
+	if (page == att->att_prefetch_last + 1 ||
+		(page > att->att_prefetch_last && page < att->att_prefetch_next))
+	{
+		if (att->att_prefetch_run < MAX_USHORT)
+			att->att_prefetch_run++;
+	}
+	else
+	{
+		att->att_prefetch_run = 0;
+		att->att_prefetch_window = 0;
+		att->att_prefetch_next = 0;
+	}
+
+	att->att_prefetch_last = page;
+
+	// Request the next part of the window when the scan
+	// passes the middle of the part requested already
 
-	// Reset starting page for next bitmap walk
+	if (att->att_prefetch_run < PREFETCH_SEQUENTIAL ||
+		att->att_prefetch_next > page + att->att_prefetch_window / 2)
+	{
+		return;
+	}
+
+	const ULONG window = att->att_prefetch_window ?
+		MIN(att->att_prefetch_window * 2, maxWindow) : MIN(PREFETCH_MIN_WINDOW, maxWindow);
+	att->att_prefetch_window = (USHORT) window;
+
+	ULONG next = MAX(page + 1, att->att_prefetch_next);
+	const ULONG end = page + 1 + window;
+	att->att_prefetch_next = end;
+
+	ULONG pages[PREFETCH_MAX_PAGES];
+	while (next < end)
+	{
+		USHORT count = 0;
+		while (count < PREFETCH_MAX_PAGES && next < end)
+			pages[count++] = next++;
 
-	--(*start_page);
+		CCH_prefetch(tdbb, DB_PAGE_SPACE, pages, count);
+	}
 }
 #endif // CACHE_READER
 
@@ -5056,7 +5335,7 @@ static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const s
 		bdb->bdb_mark_transaction = 0;
 
 		if (!(bdb->bdb_bcb->bcb_flags & BCB_keep_pages))
-			removeDirty(bdb->bdb_bcb, bdb);
+			removeDirty(bdb);
 
 		bdb->bdb_flags &= ~(BDB_must_write | BDB_system_dirty);
 		clear_dirty_flag_and_nbak_state(tdbb, bdb);
@@ -5097,10 +5376,10 @@ void recentlyUsed(BufferDesc* bdb)
 	if (oldFlags & BDB_lru_chained)
 		return;
 
-	BufferControl* bcb = bdb->bdb_bcb;
+	BufferPartition* partition = bdb->bdb_partition;
 
 #ifdef DEV_BUILD
-	volatile BufferDesc* chain = bcb->bcb_lru_chain;
+	volatile BufferDesc* chain = partition->bpt_lru_chain;
 	for (; chain; chain = chain->bdb_lru_chain)
 	{
 		if (chain == bdb)
@@ -5109,14 +5388,14 @@ void recentlyUsed(BufferDesc* bdb)
 #endif
 	for (;;)
 	{
-		bdb->bdb_lru_chain = bcb->bcb_lru_chain;
-		if (bcb->bcb_lru_chain.compare_exchange_strong(bdb->bdb_lru_chain, bdb))
+		bdb->bdb_lru_chain = partition->bpt_lru_chain;
+		if (partition->bpt_lru_chain.compare_exchange_strong(bdb->bdb_lru_chain, bdb))
 			break;
 	}
 }
 
 
-void requeueRecentlyUsed(BufferControl* bcb)
+void requeueRecentlyUsed(BufferPartition* partition)
 {
 	BufferDesc* chain = NULL;
 
@@ -5124,8 +5403,8 @@ void requeueRecentlyUsed(BufferControl* bcb)
 
 	for (;;)
 	{
-		chain = bcb->bcb_lru_chain;
-		if (bcb->bcb_lru_chain.compare_exchange_strong(chain, NULL))
+		chain = partition->bpt_lru_chain;
+		if (partition->bpt_lru_chain.compare_exchange_strong(chain, NULL))
 			break;
 	}
 
@@ -5147,14 +5426,94 @@ void requeueRecentlyUsed(BufferControl* bcb)
 	while ((bdb = reversed) != NULL)
 	{
 		reversed = bdb->bdb_lru_chain;
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+
+		// Pages referenced once stay in probation que in FIFO order
+
+		if (bdb->bdb_flags & BDB_lru_admit)
+			lru_admit(partition, bdb, bdb->bdb_flags & BDB_lru_probation);
+		else if (!bdb->bdb_probation)
+		{
+			QUE_DELETE(bdb->bdb_in_use);
+			QUE_INSERT(partition->bpt_in_use, bdb->bdb_in_use);
+		}
 
 		bdb->bdb_lru_chain = NULL;
-		bdb->bdb_flags &= ~BDB_lru_chained;
+		bdb->bdb_flags &= ~BDB_lru_flags;
+	}
+
+	chain = partition->bpt_lru_chain;
+}
+
+
+void lru_admit(BufferPartition* partition, BufferDesc* bdb, bool probation)
+{
+	// Put buffer which got new page at the head of LRU que chosen
+	// by replacement policy. bpt_syncLRU must be locked exclusively.
+
+	lru_remove(partition, bdb);
+
+	if (probation)
+	{
+		QUE_INSERT(partition->bpt_probation, bdb->bdb_in_use);
+		bdb->bdb_probation = true;
+		partition->bpt_probation_count++;
+	}
+	else
+		QUE_INSERT(partition->bpt_in_use, bdb->bdb_in_use);
+}
+
+
+void lru_append(BufferPartition* partition, BufferDesc* bdb)
+{
+	// Make buffer the first candidate for reuse in its LRU que.
+	// bpt_syncLRU must be locked exclusively.
+
+	QUE_DELETE(bdb->bdb_in_use);
+	QUE_APPEND(bdb->bdb_probation ? partition->bpt_probation : partition->bpt_in_use, bdb->bdb_in_use);
+}
+
+
+void lru_remove(BufferPartition* partition, BufferDesc* bdb)
+{
+	// Unlink buffer from its LRU que, bpt_syncLRU must be locked exclusively
+
+	QUE_DELETE(bdb->bdb_in_use);
+	QUE_INIT(bdb->bdb_in_use);
+
+	if (bdb->bdb_probation)
+	{
+		bdb->bdb_probation = false;
+		partition->bpt_probation_count--;
 	}
+}
+
+
+// 2Q remembers pages evicted from probation que in a direct mapped table of
+// page numbers. Collisions just make it forget a page earlier, so the table
+// is accessed without locking and keeps the size it got in CCH_init.
 
-	chain = bcb->bcb_lru_chain;
+static inline ULONG* ghost_slot(BufferControl* bcb, const PageNumber& page)
+{
+	const FB_UINT64 hash = (FB_UINT64) page.getPageNum() * 2654435761u + page.getPageSpaceID();
+	return &bcb->bcb_ghosts[hash % bcb->bcb_ghosts.getCount()];
+}
+
+
+bool ghost_check(BufferControl* bcb, const PageNumber& page)
+{
+	ULONG* const slot = ghost_slot(bcb, page);
+
+	if (*slot != page.getPageNum() + 1)
+		return false;
+
+	*slot = 0;
+	return true;
+}
+
+
+void ghost_remember(BufferControl* bcb, const PageNumber& page)
+{
+	*ghost_slot(bcb, page) = page.getPageNum() + 1;
 }
 
 
@@ -5397,7 +5756,7 @@ inline BufferDesc* BCBHashTable::find(const PageNumber& page) const
 inline BufferDesc* BCBHashTable::emplace(BufferDesc* bdb, const PageNumber& page, bool remove)
 {
 #ifndef HASH_USE_CDS_LIST
-	// bcb_syncObject should be locked in EX mode
+	// bpt_syncHash should be locked in EX mode
 
 	BufferDesc* bdb2 = find(page);
 	if (!bdb2)
@@ -50,6 +50,14 @@ DEFINE_TRACE_ROUTINE(cch_trace);
 #define CCH_TRACEE_AST(message) // nothing
 #endif
 
+// Sequential read-ahead performed by the cache reader thread is built
+// on top of asynchronous PIO_read_ahead() which exists for POSIX only
+
+#ifdef UNIX
+#define CACHE_READER
+#include "../jrd/os/pio.h"
+#endif
+
 namespace Ods {
 	struct pag;
 }
@@ -73,6 +81,67 @@ const ULONG MAX_PAGE_BUFFERS = 131072;
 const ULONG MAX_PAGE_BUFFERS = MAX_SLONG - 1;
 #endif
 
+// Page cache partitioning constraints. Partitions count is a power of two
+// and every partition should hold reasonable number of buffers.
+
+const ULONG MAX_CACHE_PARTITIONS = 64;
+const ULONG MIN_PARTITION_BUFFERS = 512;
+
+// Page replacement policies
+
+const USHORT CACHE_POLICY_LRU	= 0;	// single LRU que
+const USHORT CACHE_POLICY_2Q	= 1;	// scan resistant 2Q, see BufferControl::bcb_policy
+
+// BufferPartition -- part of the page cache. Every buffer belongs to single
+// partition for its lifetime and holds only pages mapped to that partition
+// by page number (see BufferControl::getPartition), so page lookup, buffer
+// replacement and dirty pages tracking in different partitions never
+// contend with each other.
+
+class BufferPartition : public pool_alloc<type_bcb>
+{
+public:
+	explicit BufferPartition(ULONG number)
+		: bpt_number(number)
+	{
+		QUE_INIT(bpt_in_use);
+		QUE_INIT(bpt_probation);
+		QUE_INIT(bpt_empty);
+		QUE_INIT(bpt_dirty);
+		bpt_lru_chain = NULL;
+		bpt_probation_count = 0;
+		bpt_dirty_count = 0;
+		bpt_count = 0;
+		bpt_inuse = 0;
+		bpt_free_minimum = 0;
+		bpt_hashTable = nullptr;
+	}
+
+	const ULONG	bpt_number;			// index in BufferControl::bcb_partitions
+	BCBHashTable* bpt_hashTable;	// pages held by partition buffers
+
+	que			bpt_in_use;			// Que of buffers in use, main LRU que
+	que			bpt_probation;		// 2Q: FIFO que of buffers with pages referenced once
+	ULONG		bpt_probation_count;	// number of buffers in bpt_probation
+
+	// Recently used buffer put there without locking common LRU que (bpt_in_use).
+	// When bpt_syncLRU is locked this chain is merged into bpt_in_use. See also
+	// requeueRecentlyUsed() and recentlyUsed()
+	std::atomic<BufferDesc*>	bpt_lru_chain;
+
+	que			bpt_empty;			// Que of empty buffers
+	que			bpt_dirty;			// que of dirty buffers
+	SLONG		bpt_dirty_count;	// count of pages in bpt_dirty
+	ULONG		bpt_count;			// Number of buffers allocated
+	ULONG		bpt_inuse;			// Number of buffers in use
+	SSHORT		bpt_free_minimum;	// Clean buffers looked for before dirty one is written
+
+	ScratchBird::SyncObject	bpt_syncHash;	// protects bpt_hashTable unless it's lock-free
+	ScratchBird::SyncObject	bpt_syncLRU;
+	ScratchBird::SyncObject	bpt_syncEmpty;
+	ScratchBird::SyncObject	bpt_syncDirtyBdbs;
+};
+
 // BufferControl -- Buffer control block -- one per system
 
 class BufferControl : public pool_alloc<type_bcb>
@@ -81,25 +150,26 @@ class BufferControl : public pool_alloc<type_bcb>
 		: bcb_bufferpool(&p),
 		  bcb_memory_stats(&parentStats),
 		  bcb_memory(p),
+		  bcb_partitions(p),
+		  bcb_ghosts(p),
 		  bcb_writer_fini(p, cache_writer, THREAD_medium),
+#ifdef CACHE_READER
+		  bcb_reader_fini(p, cache_reader, THREAD_high),
+#endif
 		  bcb_bdbBlocks(p)
 	{
 		bcb_database = NULL;
-		QUE_INIT(bcb_in_use);
 		QUE_INIT(bcb_pending);
-		QUE_INIT(bcb_empty);
-		QUE_INIT(bcb_dirty);
-		bcb_dirty_count = 0;
+		bcb_partition_mask = 0;
 		bcb_free = NULL;
 		bcb_flags = 0;
 		bcb_free_minimum = 0;
 		bcb_count = 0;
-		bcb_inuse = 0;
 		bcb_prec_walk_mark = 0;
 		bcb_page_size = 0;
 		bcb_page_incarnation = 0;
-		bcb_hashTable = nullptr;
-#ifdef SUPERSERVER_V2
+		bcb_policy = CACHE_POLICY_LRU;
+#ifdef CACHE_READER
 		bcb_prefetch = NULL;
 #endif
 	}
@@ -109,38 +179,40 @@ public:
 	static BufferControl* create(Database* dbb);
 	static void destroy(BufferControl*);
 
+	BufferPartition* getPartition(const PageNumber& page) const
+	{
+		return bcb_partitions[page.getPageNum() & bcb_partition_mask];
+	}
+
 	Database*	bcb_database;
 
 	ScratchBird::MemoryPool* bcb_bufferpool;
 	ScratchBird::MemoryStats bcb_memory_stats;
 
 	UCharStack	bcb_memory;			// Large block partitioned into buffers
-	que			bcb_in_use;			// Que of buffers in use, main LRU que
 	que			bcb_pending;		// Que of buffers which are going to be freed and reassigned
-	que			bcb_empty;			// Que of empty buffers
 
-	// Recently used buffer put there without locking common LRU que (bcb_in_use).
-	// When bcb_syncLRU is locked this chain is merged into bcb_in_use. See also
-	// requeueRecentlyUsed() and recentlyUsed()
-	std::atomic<BufferDesc*>	bcb_lru_chain;
+	// Power of two number of cache partitions, page number selects one
+	ScratchBird::Array<BufferPartition*>	bcb_partitions;
+	ULONG		bcb_partition_mask;
 
-	que			bcb_dirty;			// que of dirty buffers
-	SLONG		bcb_dirty_count;	// count of pages in dirty page btree
+	// Page replacement policy, see CACHE_POLICY_XXX above. With 2Q buffers
+	// which got new page are admitted into bpt_probation and only pages
+	// referenced again after they were evicted from it (remembered in
+	// bcb_ghosts) go to bpt_in_use. All que's are protected by bpt_syncLRU.
+	USHORT		bcb_policy;
+	ScratchBird::Array<ULONG>	bcb_ghosts;	// pages recently evicted from bpt_probation
 
 	Precedence*	bcb_free;			// Free precedence blocks
 	ScratchBird::AtomicCounter	bcb_flags;	// see below
 	SSHORT		bcb_free_minimum;	// Threshold to activate cache writer
 	ULONG		bcb_count;			// Number of buffers allocated
-	ULONG		bcb_inuse;			// Number of buffers in use
 	ULONG		bcb_prec_walk_mark;	// mark value used in precedence graph walk
 	ULONG		bcb_page_size;		// Database page size in bytes
 	ULONG		bcb_page_incarnation;	// Cache page incarnation counter
 
 	ScratchBird::SyncObject	bcb_syncObject;
-	ScratchBird::SyncObject	bcb_syncDirtyBdbs;
-	ScratchBird::SyncObject	bcb_syncEmpty;
 	ScratchBird::SyncObject	bcb_syncPrecedence;
-	ScratchBird::SyncObject	bcb_syncLRU;
 
 	// If we make bcb_flags atomic this mutex will become unneeded: XCHG of bcb_flags is enough
 	ScratchBird::Mutex			bcb_threadStartup;
@@ -151,20 +223,18 @@ public:
 	ScratchBird::Semaphore bcb_writer_sem;		// Wake up cache writer
 	ScratchBird::Semaphore bcb_writer_init;	// Cache writer initialization
 	BcbThreadSync bcb_writer_fini;			// Cache writer finalization
-#ifdef SUPERSERVER_V2
+#ifdef CACHE_READER
 	static void cache_reader(BufferControl* bcb);
-	// the code in cch.cpp is not tested for semaphore instead event !!!
 	ScratchBird::Semaphore bcb_reader_sem;		// Wake up cache reader
 	ScratchBird::Semaphore bcb_reader_init;	// Cache reader initialization
 	BcbThreadSync bcb_reader_fini;			// Cache reader finalization
 
+	ScratchBird::Mutex bcb_prefetchMutex;	// Protects bcb_prefetch
 	PageBitmap*	bcb_prefetch;		// Bitmap of pages to prefetch
 #endif
 
 	void exceptionHandler(const ScratchBird::Exception& ex, BcbThreadSync::ThreadRoutine* routine);
 
-	BCBHashTable* bcb_hashTable;
-
 	// block of allocated BufferDesc's
 	struct BDBBlock
 	{
@@ -178,7 +248,7 @@ const int BCB_keep_pages	= 1;	// set during btc_flush(), pages not removed from
 const int BCB_cache_writer	= 2;	// cache writer thread has been started
 const int BCB_writer_start  = 4;    // cache writer thread is starting now
 const int BCB_writer_active	= 8;	// no need to post writer event count
-#ifdef SUPERSERVER_V2
+#ifdef CACHE_READER
 const int BCB_cache_reader	= 16;	// cache reader thread has been started
 const int BCB_reader_active	= 32;	// cache reader not blocked on event
 #endif
@@ -191,8 +261,10 @@ const int BCB_exclusive		= 128;	// there is only BCB in whole system
 class BufferDesc : public pool_alloc<type_bdb>
 {
 public:
-	explicit BufferDesc(BufferControl* bcb)
+	// Temporary descriptors used for I/O outside of the cache have no partition
+	explicit BufferDesc(BufferControl* bcb, BufferPartition* partition = nullptr)
 		: bdb_bcb(bcb),
+		  bdb_partition(partition),
 		  bdb_page(0, 0)
 	{
 		bdb_lock = NULL;
@@ -213,6 +285,7 @@ public:
 		bdb_scan_count = 0;
 		bdb_difference_page = 0;
 		bdb_prec_walk_mark = 0;
+		bdb_probation = false;
 	}
 
 	bool addRef(thread_db* tdbb, ScratchBird::SyncType syncType, int wait = 1);
@@ -239,9 +312,10 @@ public:
 	}
 
 	BufferControl*	bdb_bcb;
+	BufferPartition* const bdb_partition;	// cache partition buffer belongs to
 	ScratchBird::SyncObject	bdb_syncPage;
 	Lock*		bdb_lock;				// Lock block for buffer
-	que			bdb_que;				// Either mod que in hash table or bcb_empty que if never used
+	que			bdb_que;				// Either mod que in hash table or bpt_empty que if never used
 	que			bdb_in_use;				// queue of buffers in use
 	que			bdb_dirty;				// dirty pages LRU queue
 	BufferDesc*	bdb_lru_chain;			// pending LRU chain
@@ -267,6 +341,7 @@ public:
 	ScratchBird::AtomicCounter	bdb_scan_count;		// concurrent sequential scans
 	ULONG       bdb_difference_page;			// Number of page in difference file, NBAK
 	ULONG		bdb_prec_walk_mark;				// mark value used in precedence graph walk
+	bool		bdb_probation;					// buffer is in bpt_probation que, under bpt_syncLRU
 };
 
 // bdb_flags
@@ -291,6 +366,12 @@ const int BDB_prefetch			= 0x4000;	// page has been prefetched but not yet refer
 const int BDB_no_blocking_ast	= 0x8000;	// No blocking AST registered with page lock
 const int BDB_lru_chained		= 0x10000;	// buffer is in pending LRU chain
 const int BDB_nbak_state_lock	= 0x20000;	// nbak state lock should be released after buffer is written
+const int BDB_lru_admit			= 0x40000;	// buffer got new page and waits in pending LRU chain
+const int BDB_lru_probation		= 0x80000;	// admit buffer into probation que
+const int BDB_large_scan		= 0x100000;	// page was released by large scan, don't remember it on eviction
+
+// flags kept when buffer is reassigned to another page
+const int BDB_lru_flags			= BDB_lru_chained | BDB_lru_admit | BDB_lru_probation;
 
 // bdb_ast_flags
 
@@ -348,14 +429,20 @@ enum LATCH
 
 
 
-#ifdef SUPERSERVER_V2
-#include "../jrd/os/pio.h"
-
 // Constants used by prefetch mechanism
 
-const int PREFETCH_MAX_TRANSFER	= 16384;	// maximum block I/O transfer (bytes)
 // maximum pages allowed per prefetch request
-const int PREFETCH_MAX_PAGES	= (2 * PREFETCH_MAX_TRANSFER / MIN_PAGE_SIZE);
+const int PREFETCH_MAX_PAGES	= 64;
+// number of prefetch requests the cache reader keeps in progress
+const int PREFETCH_MAX_REQUESTS	= 4;
+// number of consecutive page reads which makes access sequential
+const int PREFETCH_SEQUENTIAL	= 3;
+// initial read-ahead window for sequential access, in pages
+const int PREFETCH_MIN_WINDOW	= 8;
+
+#ifdef CACHE_READER
+// Pages of prefetch request are read by a single vectored I/O
+static_assert(PREFETCH_MAX_PAGES <= PIOB_MAX_PAGES, "Prefetch request exceeds vectored I/O size");
 
 // Prefetch block
 
@@ -363,19 +450,17 @@ class Prefetch : public pool_alloc<type_prf>
 {
 public:
 	thread_db*	prf_tdbb;			// thread database context
-	SLONG		prf_start_page;		// starting page of multipage prefetch
+	ULONG		prf_start_page;		// starting page of multipage prefetch
 	USHORT		prf_max_prefetch;	// maximum no. of pages to prefetch
 	USHORT		prf_page_count;		// actual no. of pages being prefetched
 	phys_io_blk	prf_piob;			// physical I/O status block
-	SCHAR*		prf_aligned_buffer;	// buffer address aligned for raw (OS cache bypass) I/O
-	SCHAR*		prf_io_buffer;		// I/O buffer address
 	UCHAR		prf_flags;
-	BufferDesc*	prf_bdbs[PREFETCH_MAX_TRANSFER / MIN_PAGE_SIZE];
-	SCHAR		prf_unaligned_buffer[PREFETCH_MAX_TRANSFER + MIN_PAGE_SIZE];
+	BufferDesc*	prf_bdbs[PREFETCH_MAX_PAGES];
+	Ods::pag*	prf_buffers[PREFETCH_MAX_PAGES];
 };
 
 const int PRF_active	= 1;		// prefetch block currently in use
-#endif // SUPERSERVER_V2
+#endif // CACHE_READER
 
 typedef ScratchBird::SortedArray<SLONG, ScratchBird::InlineStorage<SLONG, 256>, SLONG> PagesArray;
 
@@ -63,10 +63,7 @@ void		CCH_must_write(Jrd::thread_db*, Jrd::win*);
 void		CCH_precedence(Jrd::thread_db*, Jrd::win*, ULONG);
 void		CCH_precedence(Jrd::thread_db*, Jrd::win*, Jrd::PageNumber);
 void		CCH_tra_precedence(Jrd::thread_db*, Jrd::win*, TraNumber traNum);
-#ifdef SUPERSERVER_V2
-void		CCH_prefetch(Jrd::thread_db*, SLONG*, SSHORT);
-bool		CCH_prefetch_pages(Jrd::thread_db*);
-#endif
+void		CCH_prefetch(Jrd::thread_db*, USHORT, const ULONG*, USHORT);
 void		CCH_release(Jrd::thread_db*, Jrd::win*, const bool);
 void		CCH_release_exclusive(Jrd::thread_db*);
 bool		CCH_rollover_to_shadow(Jrd::thread_db* tdbb, Jrd::Database* dbb, Jrd::jrd_file*, const bool);
@@ -134,12 +131,10 @@ inline void CCH_MARK_MUST_WRITE(Jrd::thread_db* tdbb, Jrd::win* window)
 	CCH_mark(tdbb, window, 0, 1);
 }
 
-#ifdef SUPERSERVER_V2
-inline void CCH_PREFETCH(Jrd::thread_db* tdbb, SLONG* pages, SSHORT count)
+inline void CCH_PREFETCH(Jrd::thread_db* tdbb, const Jrd::win* window, const ULONG* pages, USHORT count)
 {
-	CCH_prefetch (tdbb, pages, count);
+	CCH_prefetch (tdbb, window->win_page.getPageSpaceID(), pages, count);
 }
-#endif
 
 //#define CCH_FETCH(tdbb, window, lock, type)		  CCH_fetch (tdbb, window, lock, type, 1, true)
 //#define CCH_FETCH_NO_SHADOW(tdbb, window, lock, type)		  CCH_fetch (tdbb, window, lock, type, 1, false)
@@ -154,7 +149,7 @@ inline void CCH_PREFETCH(Jrd::thread_db* tdbb, SLONG* pages, SSHORT count)
 //#define CCH_HANDOFF_TIMEOUT(tdbb, window, page, lock, type, latch_wait)   CCH_handoff (tdbb, window, page, lock, type, latch_wait, false)
 //#define CCH_HANDOFF_TAIL(tdbb, window, page, lock, type)  CCH_handoff (tdbb, window, page, lock, type, 1, true)
 //#define CCH_MARK_MUST_WRITE(tdbb, window)                 CCH_mark_must_write (tdbb, window)
-//#define CCH_PREFETCH(tdbb, pages, count)            CCH_prefetch (tdbb, pages, count)
+//#define CCH_PREFETCH(tdbb, window, pages, count)    CCH_prefetch (tdbb, window->win_page.getPageSpaceID(), pages, count)
 
 // Flush flags
 
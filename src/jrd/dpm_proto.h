@@ -71,9 +71,7 @@ bool	DPM_get(Jrd::thread_db*, Jrd::record_param*, SSHORT);
 ULONG	DPM_get_blob(Jrd::thread_db*, Jrd::blb*, RecordNumber, bool, ULONG);
 bool	DPM_next(Jrd::thread_db*, Jrd::record_param*, USHORT, Jrd::FindNextRecordScope);
 void	DPM_pages(Jrd::thread_db*, SSHORT, int, ULONG, ULONG);
-#ifdef SUPERSERVER_V2
-SLONG	DPM_prefetch_bitmap(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::PageBitmap*, SLONG);
-#endif
+FB_UINT64	DPM_prefetch_bitmap(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::RecordBitmap*, FB_UINT64);
 ULONG	DPM_pointer_pages(Jrd::thread_db*, Jrd::jrd_rel*);
 void	DPM_scan_pages(Jrd::thread_db*);
 void	DPM_store(Jrd::thread_db*, Jrd::record_param*, Jrd::PageStack&, const Jrd::RecordStorageType type);
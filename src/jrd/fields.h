@@ -241,6 +241,7 @@
 	FIELD(fld_sch_path		, nam_sch_path		, dtype_varying	, 765						, dsc_text_type_metadata	, NULL		, true		, ODS_14_0)
 	FIELD(fld_sch_level		, nam_sch_level		, dtype_short	, sizeof(SSHORT)			, 0							, NULL		, true		, ODS_14_0)
 	FIELD(fld_text_max		, nam_text_max		, dtype_varying, 32765, dsc_text_type_metadata, NULL, true, ODS_14_0)
+	FIELD(fld_cache_policy	, nam_cache_policy	, dtype_short	, sizeof(SSHORT)			, 0							, NULL		, true		, ODS_14_3)
 
 	// SQL Dialect 4: SYNONYM fields
 	FIELD(fld_synonym_name	, nam_synonym_name	, dtype_text	, MAX_SQL_IDENTIFIER_LEN	, dsc_text_type_metadata	, NULL		, true		, ODS_14_0)
@@ -78,6 +78,7 @@ static bool duplicate_key(const UCHAR*, const UCHAR*, void*);
 static PageNumber get_root_page(thread_db*, jrd_rel*);
 static int index_block_flush(void*);
 static idx_e insert_key(thread_db*, jrd_rel*, Record*, jrd_tra*, WIN *, index_insertion*, IndexErrorContext&);
+static void refetch_index(thread_db*, jrd_rel*, WIN*, index_desc*);
 static void release_index_block(thread_db*, IndexBlock*);
 static void signal_index_deletion(thread_db*, jrd_rel*, USHORT);
 
@@ -684,22 +685,6 @@ bool IndexCreateTask::handler(WorkItem& _item)
 				context.raise(tdbb, result, record);
 			}
 
-			if (key->key_length > m_creation->key_length)
-			{
-				do {
-					if (record != gc_record)
-						delete record;
-				} while (stack.hasData() && (record = stack.pop()));
-
-				if (primary.getWindow(tdbb).win_flags & WIN_large_scan)
-					--relation->rel_scan_count;
-
-				context.raise(tdbb, idx_e_keytoobig, record);
-			}
-
-			UCHAR* p;
-			scb->put(tdbb, reinterpret_cast<ULONG**>(&p));
-
 			// try to catch duplicates early
 
 			if (m_creation->duplicates.value() > 0)
@@ -712,29 +697,51 @@ bool IndexCreateTask::handler(WorkItem& _item)
 				break;
 			}
 
-			if (m_creation->nullIndLen)
-				*p++ = (key->key_length == 0) ? 0 : 1;
+			// Multi-valued index puts every key of the record into the sort
 
-			if (key->key_length > 0)
+			do
 			{
-				memcpy(p, key->key_data, key->key_length);
-				p += key->key_length;
-			}
+				if (key->key_length > m_creation->key_length)
+				{
+					do {
+						if (record != gc_record)
+							delete record;
+					} while (stack.hasData() && (record = stack.pop()));
 
-			int l = int(m_creation->key_length) - m_creation->nullIndLen - key->key_length;	// must be signed
+					if (primary.getWindow(tdbb).win_flags & WIN_large_scan)
+						--relation->rel_scan_count;
 
-			if (l > 0)
-			{
-				memset(p, pad, l);
-				p += l;
-			}
+					context.raise(tdbb, idx_e_keytoobig, record);
+				}
+
+				UCHAR* p;
+				scb->put(tdbb, reinterpret_cast<ULONG**>(&p));
+
+				if (m_creation->nullIndLen)
+					*p++ = (key->key_length == 0) ? 0 : 1;
 
-			const bool key_is_null = (key->key_nulls == (1 << idx->idx_count) - 1);
+				if (key->key_length > 0)
+				{
+					memcpy(p, key->key_data, key->key_length);
+					p += key->key_length;
+				}
+
+				int l = int(m_creation->key_length) - m_creation->nullIndLen - key->key_length;	// must be signed
+
+				if (l > 0)
+				{
+					memset(p, pad, l);
+					p += l;
+				}
+
+				const bool key_is_null = (key->key_nulls == (1 << idx->idx_count) - 1);
+
+				index_sort_record* isr = (index_sort_record*) p;
+				isr->isr_record_number = primary.rpb_number.getValue();
+				isr->isr_key_length = key->key_length;
+				isr->isr_flags = ((stack.hasData() || deleted) ? ISR_secondary : 0) | (key_is_null ? ISR_null : 0);
+			} while (key.next());
 
-			index_sort_record* isr = (index_sort_record*) p;
-			isr->isr_record_number = primary.rpb_number.getValue();
-			isr->isr_key_length = key->key_length;
-			isr->isr_flags = ((stack.hasData() || deleted) ? ISR_secondary : 0) | (key_is_null ? ISR_null : 0);
 			if (record != gc_record)
 				delete record;
 		}
@@ -860,6 +867,14 @@ void IDX_create_index(thread_db* tdbb,
 				 Arg::Gds(isc_wish_list));
 	}
 
+	// Keys of the multi-valued index are not the values of the record,
+	// there is nothing to check the uniqueness of
+	if ((idx->idx_flags & idx_unique) && IndexExpression::isMultiValued(idx))
+	{
+		ERR_post(Arg::Gds(isc_no_meta_update) <<
+				 Arg::Gds(isc_wish_list));
+	}
+
 	get_root_page(tdbb, relation);
 
 	fb_assert(transaction);
@@ -1193,60 +1208,64 @@ void IDX_garbage_collect(thread_db* tdbb, record_param* rpb, RecordStack& going,
 					context.raise(tdbb, result, rec1);
 				}
 
-				// Cancel index if there are duplicates in the remaining records
+				// Every key of the multi-valued index is checked separately
 
-				RecordStack::iterator stack2(stack1);
-				for (++stack2; stack2.hasData(); ++stack2)
+				do
 				{
-					Record* const rec2 = stack2.object();
+					// Cancel index if there are duplicates in the remaining records
 
-					if (const auto result = key2.compose(rec2))
+					RecordStack::iterator stack2(stack1);
+					for (++stack2; stack2.hasData(); ++stack2)
 					{
-						if (result == idx_e_conversion)
-							continue;
+						Record* const rec2 = stack2.object();
 
-						CCH_RELEASE(tdbb, &window);
-						context.raise(tdbb, result, rec2);
-					}
+						if (const auto result = key2.compose(rec2))
+						{
+							if (result == idx_e_conversion)
+								continue;
 
-					if (key1 == key2)
-						break;
-				}
+							CCH_RELEASE(tdbb, &window);
+							context.raise(tdbb, result, rec2);
+						}
 
-				if (stack2.hasData())
-					continue;
+						if (key2.contains(key1))
+							break;
+					}
 
-				// Make sure the index doesn't exist in any record remaining
+					if (stack2.hasData())
+						continue;
 
-				RecordStack::iterator stack3(staying);
-				for (; stack3.hasData(); ++stack3)
-				{
-					Record* const rec3 = stack3.object();
+					// Make sure the index doesn't exist in any record remaining
 
-					if (const auto result = key2.compose(rec3))
+					RecordStack::iterator stack3(staying);
+					for (; stack3.hasData(); ++stack3)
 					{
-						if (result == idx_e_conversion)
-							continue;
+						Record* const rec3 = stack3.object();
 
-						CCH_RELEASE(tdbb, &window);
-						context.raise(tdbb, result, rec3);
-					}
+						if (const auto result = key2.compose(rec3))
+						{
+							if (result == idx_e_conversion)
+								continue;
 
-					if (key1 == key2)
-						break;
-				}
+							CCH_RELEASE(tdbb, &window);
+							context.raise(tdbb, result, rec3);
+						}
 
-				if (stack3.hasData())
-					continue;
+						if (key2.contains(key1))
+							break;
+					}
+
+					if (stack3.hasData())
+						continue;
 
-				// Get rid of index node
+					// Get rid of index node
 
-				insertion.iib_key = key1;
-				BTR_remove(tdbb, &window, &insertion);
-				root = (index_root_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_root);
+					insertion.iib_key = key1;
+					BTR_remove(tdbb, &window, &insertion);
+					root = (index_root_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_root);
 
-				if (stack1.hasMore(1))
 					BTR_description(tdbb, rpb->rpb_relation, root, &idx, i);
+				} while (key1.next());
 			}
 		}
 	}
@@ -1326,35 +1345,43 @@ void IDX_modify(thread_db* tdbb,
 
 		expression.reset();
 
-		if (newKey == orgKey)
+		// Multi-valued index gets the keys missing in the old record
+
+		do
 		{
-			// The new record satisfies index condition, check old record too:
-			// if it does not satisfies condition, key should be inserted into index.
-			// Note, condition.check() is always true for non-conditional indeces.
+			if (orgKey.contains(newKey))
+			{
+				// The new record satisfies index condition, check old record too:
+				// if it does not satisfies condition, key should be inserted into index.
+				// Note, condition.check() is always true for non-conditional indeces.
 
-			IndexCondition condition(tdbb, &idx);
-			const auto checkResult = condition.check(org_rpb->rpb_record, &error_code);
+				IndexCondition condition(tdbb, &idx);
+				const auto checkResult = condition.check(org_rpb->rpb_record, &error_code);
 
-			if (error_code)
-			{
-				CCH_RELEASE(tdbb, &window);
-				context.raise(tdbb, error_code, org_rpb->rpb_record);
+				if (error_code)
+				{
+					CCH_RELEASE(tdbb, &window);
+					context.raise(tdbb, error_code, org_rpb->rpb_record);
+				}
+
+				fb_assert(checkResult.isAssigned());
+				if (checkResult.asBool())
+					continue;
 			}
 
-			fb_assert(checkResult.isAssigned());
-			if (checkResult.asBool())
-				continue;
-		}
+			if (!window.win_bdb)
+				refetch_index(tdbb, new_rpb->rpb_relation, &window, &idx);
 
-		insertion.iib_key = newKey;
-		if ( (error_code = insert_key(tdbb, new_rpb->rpb_relation, new_rpb->rpb_record,
-										transaction, &window, &insertion, context)) )
-		{
-			context.raise(tdbb, error_code, new_rpb->rpb_record);
-		}
+			insertion.iib_key = newKey;
+			if ( (error_code = insert_key(tdbb, new_rpb->rpb_relation, new_rpb->rpb_record,
+											transaction, &window, &insertion, context)) )
+			{
+				context.raise(tdbb, error_code, new_rpb->rpb_record);
+			}
 
-		if (idx.idx_flags & (idx_primary | idx_unique))
-			new_rpb->rpb_runtime_flags |= RPB_uk_updated;
+			if (idx.idx_flags & (idx_primary | idx_unique))
+				new_rpb->rpb_runtime_flags |= RPB_uk_updated;
+		} while (newKey.next());
 	}
 }
 
@@ -1580,13 +1607,21 @@ void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 
 		expression.reset();
 
-		insertion.iib_key = key;
+		// Multi-valued index gets every key of the record
 
-		if ( (error_code = insert_key(tdbb, rpb->rpb_relation, rpb->rpb_record, transaction,
-									  &window, &insertion, context)) )
+		do
 		{
-			context.raise(tdbb, error_code, rpb->rpb_record);
-		}
+			if (!window.win_bdb)
+				refetch_index(tdbb, rpb->rpb_relation, &window, &idx);
+
+			insertion.iib_key = key;
+
+			if ( (error_code = insert_key(tdbb, rpb->rpb_relation, rpb->rpb_record, transaction,
+										  &window, &insertion, context)) )
+			{
+				context.raise(tdbb, error_code, rpb->rpb_record);
+			}
+		} while (key.next());
 	}
 }
 
@@ -2145,6 +2180,30 @@ static idx_e insert_key(thread_db* tdbb,
 }
 
 
+static void refetch_index(thread_db* tdbb, jrd_rel* relation, WIN* window, index_desc* idx)
+{
+/**************************************
+ *
+ *	r e f e t c h _ i n d e x
+ *
+ **************************************
+ *
+ * Functional description
+ *	BTR_insert releases the index root page. Get it back
+ *	along with the index description to insert the next
+ *	key of the multi-valued index.
+ *
+ **************************************/
+	index_root_page* const root = (index_root_page*) CCH_FETCH(tdbb, window, LCK_read, pag_root);
+
+	if (!BTR_description(tdbb, relation, root, idx, idx->idx_id))
+	{
+		CCH_RELEASE(tdbb, window);
+		BUGCHECK(173);	// msg 173 referenced index description not found
+	}
+}
+
+
 static void release_index_block(thread_db* tdbb, IndexBlock* index_block)
 {
 /**************************************
@@ -332,6 +332,8 @@ NAME("MON$PACKAGE_NAME", nam_mon_pkg_name)
 NAME("MON$PAGE_BUFFERS", nam_mon_page_bufs)
 NAME("MON$PAGE_FETCHES", nam_mon_page_fetches)
 NAME("MON$PAGE_MARKS", nam_mon_page_marks)
+NAME("MON$PAGE_PROBATION_HITS", nam_mon_page_probation_hits)
+NAME("MON$PAGE_GHOST_HITS", nam_mon_page_ghost_hits)
 NAME("MON$PAGE_READS", nam_mon_page_reads)
 NAME("MON$PAGE_WRITES", nam_mon_page_writes)
 NAME("MON$PAGES", nam_mon_pages)
@@ -350,6 +352,8 @@ NAME("MON$RECORD_STATS", nam_mon_rec_stats)
 NAME("MON$RECORD_UPDATES", nam_mon_rec_updates)
 NAME("MON$RECORD_WAITS", nam_mon_rec_waits)
 NAME("MON$RECORD_IMGC", nam_mon_rec_imgc)
+NAME("MON$RECORD_IMAGE_BYTES", nam_mon_rec_image_bytes)
+NAME("MON$RECORD_PACKED_BYTES", nam_mon_rec_packed_bytes)
 NAME("MON$REMOTE_ADDRESS", nam_mon_remote_addr)
 NAME("MON$REMOTE_HOST", nam_mon_remote_host)
 NAME("MON$REMOTE_OS_USER", nam_mon_remote_os_user)
@@ -447,6 +451,8 @@ NAME("MON$NEXT_ATTACHMENT", nam_mon_na)
 NAME("MON$NEXT_STATEMENT", nam_mon_ns)
 NAME("RDB$REPLICA_MODE", nam_repl_mode)
 NAME("MON$REPLICA_MODE", nam_mon_repl_mode)
+NAME("RDB$CACHE_POLICY", nam_cache_policy)
+NAME("MON$CACHE_POLICY", nam_mon_cache_policy)
 
 NAME("RDB$CONFIG", nam_config)
 NAME("RDB$CONFIG_ID", nam_cfg_id)
@@ -134,7 +134,9 @@ inline constexpr USHORT ODS_CURRENT13	= 1;
 
 inline constexpr USHORT ODS_CURRENT14_0	= 0;	// ScratchBird 6.0 features
 inline constexpr USHORT ODS_CURRENT14_1	= 1;	// ScratchBird 6.0 large row support (ULONG field lengths)
-inline constexpr USHORT ODS_CURRENT14	= 1;
+inline constexpr USHORT ODS_CURRENT14_2	= 2;	// ScratchBird 6.0 LZ4 record compression
+inline constexpr USHORT ODS_CURRENT14_3	= 3;	// ScratchBird 6.0 page cache policy and statistics in monitoring
+inline constexpr USHORT ODS_CURRENT14	= 3;
 
 // useful ODS macros. These are currently used to flag the version of the
 // system triggers and system indices in ini.e
@@ -158,6 +160,8 @@ inline constexpr USHORT ODS_13_0	= ENCODE_ODS(ODS_VERSION13, 0);
 inline constexpr USHORT ODS_13_1	= ENCODE_ODS(ODS_VERSION13, 1);
 inline constexpr USHORT ODS_14_0	= ENCODE_ODS(ODS_VERSION14, 0);
 inline constexpr USHORT ODS_14_1	= ENCODE_ODS(ODS_VERSION14, 1);
+inline constexpr USHORT ODS_14_2	= ENCODE_ODS(ODS_VERSION14, 2);
+inline constexpr USHORT ODS_14_3	= ENCODE_ODS(ODS_VERSION14, 3);
 
 inline constexpr USHORT ODS_FIREBIRD_FLAG = 0x8000;
 
@@ -882,6 +886,7 @@ inline constexpr USHORT rhd_gc_active		= 256;		// garbage collecting dead record
 inline constexpr USHORT rhd_uk_modified		= 512;		// record key field values are changed
 inline constexpr USHORT rhd_long_tranum		= 1024;		// transaction number is 64-bit
 inline constexpr USHORT rhd_not_packed		= 2048;		// record (or delta) is stored "as is"
+inline constexpr USHORT rhd_lz_packed		= 4096;		// record (or delta) is LZ4 compressed, see LzCompressor
 
 
 // This (not exact) copy of class DSC is used to store descriptors on disk.
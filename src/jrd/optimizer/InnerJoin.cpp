@@ -231,7 +231,7 @@ void InnerJoin::estimateCost(unsigned position,
 			// probing + copying cost
 			cardinality * (COST_FACTOR_HASHING + currentCardinality * COST_FACTOR_MEMCOPY);
 
-		if (hashCost <= loopCost && hashCardinality <= HashJoin::maxCapacity())
+		if (hashCost <= loopCost && hashCardinality <= HashJoin::maxCapacity(tdbb))
 		{
 			auto& equiMatches = joinedStreams[position].equiMatches;
 			fb_assert(!equiMatches.hasData());
@@ -578,9 +578,11 @@ River* InnerJoin::formRiver()
 				std::swap(keys[0], keys[1]);
 			}
 
-			// Create a hash join
+			// Create a hash join. If the sort node was utilized,
+			// the order of the prior streams must be preserved.
 			rsb = FB_NEW_POOL(getPool())
-				HashJoin(tdbb, csb, JoinType::INNER, 2, hashJoinRsbs, keys.begin(), stream.selectivity);
+				HashJoin(tdbb, csb, JoinType::INNER, 2, hashJoinRsbs, keys.begin(),
+						 stream.selectivity, sortUtilized);
 
 			// Clear priorly processed rsb's, as they're already incorporated into a hash join
 			rsbs.clear();
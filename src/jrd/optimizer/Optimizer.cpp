@@ -1032,6 +1032,10 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 		// Attempt to form joins in decreasing order of desirability
 		generateInnerJoin(joinStreams, rivers, &sort, rse->rse_plan);
 
+		// If the sort or aggregate was satisfied by the index navigation,
+		// hash joins built below must not reorder the leading river
+		const bool sortNavigated = (orgSortNode && sortCanBeUsed && !sort);
+
 		if (rivers.isEmpty() && dependentRivers.isEmpty())
 		{
 			// This case may look weird, but it's possible for recursive unions
@@ -1048,7 +1052,7 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 					river->activate(csb);
 
 				// If there are multiple rivers, try some hashing or sort/merging
-				while (generateEquiJoin(rivers, joinType))
+				while (generateEquiJoin(rivers, joinType, sortNavigated))
 					;
 
 				if (dependentRivers.hasData())
@@ -1102,6 +1106,26 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 		sort = nullptr;
 	}
 
+	// Groups may be aggregated by hash rather than sorted, unless the index
+	// navigation has been chosen or there are too many groups expected.
+	// Flag the fact to the calling routine by keeping rse_hash_groups.
+	if (rse->rse_hash_groups)
+	{
+		if (sort && !project && rsb)
+		{
+			double groups = rsb->getCardinality();
+			for (auto count = sort->expressions.getCount(); count; count--)
+				groups *= REDUCE_SELECTIVITY_FACTOR_EQUALITY;
+
+			if (groups <= rse->rse_hash_groups)
+				sort = nullptr;
+			else
+				rse->rse_hash_groups = 0;
+		}
+		else
+			rse->rse_hash_groups = 0;
+	}
+
 	// Check index usage in all the base streams to ensure
 	// that any user-specified access plan is followed
 
@@ -1856,6 +1880,7 @@ void Optimizer::checkSorts()
 			{
 				setDirection(project, group);
 				project = rse->rse_projection = nullptr;
+				aggregate->groupOrder = true;
 			}
 		}
 
@@ -1886,6 +1911,7 @@ void Optimizer::checkSorts()
 				setDirection(sort, group);
 				setPosition(sort, group, map);
 				sort = rse->rse_sorted = nullptr;
+				aggregate->groupOrder = true;
 			}
 		}
 	}
@@ -2372,7 +2398,7 @@ void Optimizer::formRivers(const StreamList& streams,
 // If the whole things is a moby no-op, return false.
 //
 
-bool Optimizer::generateEquiJoin(RiverList& rivers, JoinType joinType)
+bool Optimizer::generateEquiJoin(RiverList& rivers, JoinType joinType, bool preserveOrder)
 {
 	fb_assert(joinType != JoinType::OUTER);
 
@@ -2556,7 +2582,7 @@ bool Optimizer::generateEquiJoin(RiverList& rivers, JoinType joinType)
 			keys.back()->add(eq_class[position]);
 	}
 
-	const bool hashOverflow = (maxCardinality2 > HashJoin::maxCapacity());
+	const bool hashOverflow = (maxCardinality2 > HashJoin::maxCapacity(tdbb));
 
 	// If any of to-be-hashed rivers is too large to be hashed efficiently,
 	// then prefer a merge join instead of a hash join.
@@ -2614,7 +2640,8 @@ bool Optimizer::generateEquiJoin(RiverList& rivers, JoinType joinType)
 			rsbs.add(river->getRecordSource());
 
 		finalRsb = FB_NEW_POOL(getPool())
-			HashJoin(tdbb, csb, joinType, rsbs.getCount(), rsbs.begin(), keys.begin());
+			HashJoin(tdbb, csb, joinType, rsbs.getCount(), rsbs.begin(), keys.begin(),
+					 0, preserveOrder);
 	}
 
 	// Pick up any boolean that may apply
@@ -2848,6 +2875,9 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 		{
 			rsb = FB_NEW_POOL(getPool()) FullTableScan(csb, alias, stream, relation, dbkeyRanges);
 
+			if (dbkeyRanges.isEmpty() && GatherStream::isAllowed(tdbb, csb, stream, rse))
+				rsb = FB_NEW_POOL(getPool()) GatherStream(csb, stream, relation, rsb);
+
 			if (boolean)
 				csb->csb_rpt[stream].csb_flags |= csb_unmatched;
 		}
@@ -568,7 +568,7 @@ private:
 					RiverList& rivers,
 					SortNode** sortClause,
 					const PlanNode* planClause);
-	bool generateEquiJoin(RiverList& rivers, JoinType joinType);
+	bool generateEquiJoin(RiverList& rivers, JoinType joinType, bool preserveOrder = false);
 	void generateInnerJoin(StreamList& streams,
 						   RiverList& rivers,
 						   SortNode** sortClause,
@@ -735,6 +735,7 @@ protected:
 	InversionCandidate* makeInversion(InversionCandidateList& inversions) const;
 	bool matchBoolean(IndexScratch* indexScratch, BoolExprNode* boolean, unsigned scope) const;
 	InversionCandidate* matchDbKey(BoolExprNode* boolean) const;
+	bool matchMembership(IndexScratch* indexScratch, BoolExprNode* boolean, unsigned scope) const;
 	InversionCandidate* matchOnIndexes(IndexScratchList& indexScratches,
 		BoolExprNode* boolean, unsigned scope) const;
 	ValueExprNode* findDbKey(ValueExprNode* dbkey, SLONG* position) const;
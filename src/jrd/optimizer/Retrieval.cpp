@@ -30,6 +30,7 @@
 #include "../jrd/btr.h"
 #include "../jrd/intl.h"
 #include "../jrd/Collation.h"
+#include "../jrd/SysFunction.h"
 #include "../jrd/ods.h"
 #include "../jrd/RecordSourceNodes.h"
 #include "../jrd/recsrc/RecordSource.h"
@@ -504,10 +505,11 @@ void Retrieval::analyzeNavigation(const InversionCandidateList& inversions)
 		}
 
 		// only a single-column ORDER BY clause can be mapped to
-		// an expression index
+		// an expression index, multi-valued index is not ordered
+		// by the expression at all
 		if (idx->idx_flags & idx_expression)
 		{
-			if (sort->expressions.getCount() != 1)
+			if (sort->expressions.getCount() != 1 || IndexExpression::isMultiValued(idx))
 				continue;
 		}
 
@@ -1779,6 +1781,76 @@ InversionCandidate* Retrieval::makeInversion(InversionCandidateList& inversions)
 	return invCandidate;
 }
 
+bool Retrieval::matchMembership(IndexScratch* indexScratch, BoolExprNode* boolean,
+								unsigned scope) const
+{
+	// Multi-valued index over JSON_EXTRACT(<document>, <path>) has a key per
+	// value found at the path, so it's usable for the membership test
+	// JSON_CONTAINS(<document>, <path>, <value>) = TRUE only
+
+	const auto cmpNode = nodeAs<ComparativeBoolNode>(boolean);
+
+	if (!cmpNode || cmpNode->blrOp != blr_eql)
+		return false;
+
+	ValueExprNode* test = cmpNode->arg1;
+	ValueExprNode* truth = cmpNode->arg2;
+
+	if (!nodeIs<SysFuncCallNode>(test))
+		std::swap(test, truth);
+
+	const auto containsNode = nodeAs<SysFuncCallNode>(test);
+	const auto literal = nodeAs<LiteralNode>(truth);
+
+	if (!containsNode || !containsNode->function ||
+		strcmp(containsNode->function->name, "JSON_CONTAINS") ||
+		!literal || literal->litDesc.dsc_dtype != dtype_boolean ||
+		!*literal->litDesc.dsc_address)
+	{
+		return false;
+	}
+
+	const auto idx = indexScratch->index;
+	const auto extractNode = nodeAs<SysFuncCallNode>(idx->idx_expression);
+	fb_assert(extractNode);
+
+	const auto& extractArgs = extractNode->args->items;
+	auto& containsArgs = containsNode->args->items;
+
+	if (!extractArgs[0]->sameAs(containsArgs[0], true) ||
+		!extractArgs[1]->sameAs(containsArgs[1], true) ||
+		!idx->idx_expression->containsStream(0, true) ||
+		!containsArgs[0]->containsStream(stream, true))
+	{
+		return false;
+	}
+
+	ValueExprNode* const value = containsArgs[2];
+
+	if (!value->computable(csb, stream, false))
+		return false;
+
+	dsc valueDesc;
+	value->getDesc(tdbb, csb, &valueDesc);
+
+	if (!BTR_types_comparable(idx->idx_expression_desc, valueDesc))
+		return false;
+
+	const auto segment = &indexScratch->segments[0];
+	segment->matches.add(boolean);
+	segment->lowerValue = segment->upperValue = value;
+	segment->scanType = segmentScanEqual;
+	segment->excludeLower = false;
+	segment->excludeUpper = false;
+
+	if (segment->scope < scope)
+		segment->scope = scope;
+
+	indexScratch->candidate = true;
+
+	return true;
+}
+
 bool Retrieval::matchBoolean(IndexScratch* indexScratch,
 							 BoolExprNode* boolean,
 							 unsigned scope) const
@@ -1796,6 +1868,9 @@ bool Retrieval::matchBoolean(IndexScratch* indexScratch,
 			return false;
 	}
 
+	if (IndexExpression::isMultiValued(idx))
+		return matchMembership(indexScratch, boolean, scope);
+
 	const auto cmpNode = nodeAs<ComparativeBoolNode>(boolean);
 	const auto missingNode = nodeAs<MissingBoolNode>(boolean);
 	const auto listNode = nodeAs<InListBoolNode>(boolean);
@@ -0,0 +1,73 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		AsyncIO.h
+ *	DESCRIPTION:	Asynchronous page I/O engine
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the ScratchBird development team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2026 ScratchBird development team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef JRD_OS_ASYNC_IO_H
+#define JRD_OS_ASYNC_IO_H
+
+#include "../common/classes/alloc.h"
+
+namespace Jrd {
+
+struct phys_io_blk;
+
+// Asynchronous I/O engine used by PIO_read_ahead(). The engine is shared by
+// all databases in the process and is selected by the AsyncIO setting:
+//
+//	IoUring	- Linux io_uring, submissions are batched into a single system call,
+//			  thread pool if the kernel doesn't support it
+//	Threads	- small pool of threads performing preadv() on behalf of callers
+//	Auto	- io_uring if the kernel supports it, else thread pool
+//	None	- no engine, PIO_read_ahead() reads synchronously
+//
+// Every request passed to submit() is completed exactly once by posting
+// its piob_event after piob_actual_length and piob_errno have been set.
+
+class AsyncIOEngine
+{
+public:
+	virtual ~AsyncIOEngine()
+	{ }
+
+	// Queue a batch of vectored reads. Returns the number of requests
+	// accepted, the caller is responsible for the rest.
+	virtual unsigned submit(phys_io_blk* const* requests, unsigned count) = 0;
+
+	virtual const char* getName() const = 0;
+
+	// Returns configured engine or NULL if asynchronous I/O is disabled
+	static AsyncIOEngine* get();
+
+	// Perform the read in the calling thread and complete the request
+	static void execute(phys_io_blk* piob);
+
+protected:
+	static void complete(phys_io_blk* piob, SINT64 result, int error);
+};
+
+} // namespace Jrd
+
+#endif // JRD_OS_ASYNC_IO_H
@@ -34,6 +34,11 @@
 #include "../common/classes/array.h"
 #include "../common/classes/File.h"
 
+#ifdef UNIX
+#include <sys/uio.h>
+#include "../common/classes/semaphore.h"
+#endif
+
 namespace Jrd {
 
 #ifdef UNIX
@@ -47,6 +52,35 @@ public:
 	SCHAR fil_string[1];		// Expanded file name
 };
 
+// Maximum pages covered by a single asynchronous vectored read
+
+const USHORT PIOB_MAX_PAGES	= 64;
+
+// Physical I/O status block for asynchronous page reads. A single block
+// describes a run of contiguous database pages which may be scattered over
+// non-contiguous page buffers. Blocks are queued by PIO_read_ahead() and
+// completed by the asynchronous I/O engine (see os/AsyncIO.h).
+
+struct phys_io_blk
+{
+	jrd_file*		piob_file;				// File being read
+	FB_UINT64		piob_offset;			// Offset of the first page
+	ULONG			piob_io_length;			// Requested I/O transfer length
+	SINT64			piob_actual_length;		// Actual I/O transfer length
+	int				piob_errno;				// errno if I/O failed
+	USHORT			piob_wait;				// PIO_status should stall until completion
+	USHORT			piob_iov_count;			// Number of pages (buffers) in the request
+	UCHAR			piob_flags;
+	struct iovec	piob_iov[PIOB_MAX_PAGES];
+	ScratchBird::Semaphore	piob_event;		// Posted once by the I/O engine on completion
+	phys_io_blk*	piob_next;				// Link used by I/O engine queues
+};
+
+// piob_flags
+const UCHAR PIOB_error		= 1;	// I/O error occurred
+const UCHAR PIOB_success	= 2;	// I/O successfully completed
+const UCHAR PIOB_pending	= 4;	// Asynchronous I/O not yet completed
+
 #endif
 
 
@@ -91,7 +125,7 @@ const SSHORT trace_close	= 6;
 
 // Physical I/O status block, used only in SS v2 for Win32
 
-#ifdef SUPERSERVER_V2
+#if defined(SUPERSERVER_V2) && defined(WIN_NT)
 struct phys_io_blk
 {
 	jrd_file* piob_file;		// File being read/written
@@ -30,6 +30,7 @@ namespace Jrd {
 	class jrd_file;
 	class Database;
 	class BufferDesc;
+	struct phys_io_blk;
 }
 
 namespace Ods {
@@ -50,7 +51,12 @@ Jrd::jrd_file*	PIO_open(Jrd::thread_db*, const ScratchBird::PathName&,
 						 const ScratchBird::PathName&);
 bool	PIO_read(Jrd::thread_db*, Jrd::jrd_file*, Jrd::BufferDesc*, Ods::pag*, Jrd::FbStatusVector*);
 
-#ifdef SUPERSERVER_V2
+#ifdef UNIX
+void	PIO_prepare_read(Jrd::jrd_file*, ULONG, USHORT, Ods::pag* const*, USHORT, Jrd::phys_io_blk*);
+bool	PIO_read_ahead(Jrd::thread_db*, Jrd::phys_io_blk* const*, USHORT, Jrd::FbStatusVector*);
+bool	PIO_status(Jrd::thread_db*, Jrd::phys_io_blk*, Jrd::FbStatusVector*);
+const char*	PIO_async_engine();
+#elif defined(SUPERSERVER_V2)
 bool	PIO_read_ahead(Jrd::thread_db*, SLONG, SCHAR*, SLONG,
 				   struct Jrd::phys_io_blk*, Jrd::FbStatusVector*);
 bool	PIO_status(Jrd::thread_db*, struct Jrd::phys_io_blk*, Jrd::FbStatusVector*);
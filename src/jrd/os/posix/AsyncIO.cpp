@@ -0,0 +1,583 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		AsyncIO.cpp
+ *	DESCRIPTION:	Asynchronous page I/O engine (io_uring and thread pool)
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the ScratchBird development team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2026 ScratchBird development team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#if defined(LINUX) && defined(HAVE_LINUX_IO_URING_H)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#define USE_IO_URING
+#endif
+
+#include "../jrd/os/AsyncIO.h"
+#include "../jrd/os/pio.h"
+#include "../common/classes/array.h"
+#include "../common/classes/init.h"
+#include "../common/classes/locks.h"
+#include "../common/config/config.h"
+#include "../common/utils_proto.h"
+#include "../common/ThreadStart.h"
+#include "../yvalve/gds_proto.h"
+
+using namespace Jrd;
+using namespace ScratchBird;
+
+namespace {
+
+const int IO_RETRY = 20;
+
+#ifndef HAVE_PREADV
+ssize_t preadv(int fd, const struct iovec* iov, int iovcnt, off_t offset)
+{
+	// Emulate vectored read with a sequence of positioned reads
+
+	ssize_t total = 0;
+
+	for (int i = 0; i < iovcnt; i++)
+	{
+		const ssize_t bytes = pread(fd, iov[i].iov_base, iov[i].iov_len, offset + total);
+
+		if (bytes < 0)
+			return total ? total : bytes;
+
+		total += bytes;
+
+		if ((size_t) bytes < iov[i].iov_len)
+			break;
+	}
+
+	return total;
+}
+#endif
+
+
+// Pool of threads performing synchronous vectored reads on behalf of callers
+
+class ThreadPoolEngine : public AsyncIOEngine
+{
+public:
+	ThreadPoolEngine(MemoryPool& pool, unsigned threads)
+		: m_threads(pool),
+		  m_head(NULL),
+		  m_tail(NULL),
+		  m_shutdown(false)
+	{
+		for (unsigned i = 0; i < threads; i++)
+		{
+			Thread::Handle handle;
+			Thread::start(worker, this, THREAD_medium_high, &handle);
+			m_threads.add(handle);
+		}
+	}
+
+	~ThreadPoolEngine()
+	{
+		m_shutdown = true;
+		m_wakeup.release(m_threads.getCount());
+
+		for (auto& handle : m_threads)
+			Thread::waitForCompletion(handle);
+	}
+
+	unsigned submit(phys_io_blk* const* requests, unsigned count) override
+	{
+		{	// scope
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			for (unsigned i = 0; i < count; i++)
+			{
+				phys_io_blk* const piob = requests[i];
+				piob->piob_next = NULL;
+
+				if (m_tail)
+					m_tail->piob_next = piob;
+				else
+					m_head = piob;
+
+				m_tail = piob;
+			}
+		}
+
+		m_wakeup.release(count);
+		return count;
+	}
+
+	const char* getName() const override
+	{
+		return "Threads";
+	}
+
+private:
+	static THREAD_ENTRY_DECLARE worker(THREAD_ENTRY_PARAM arg)
+	{
+		static_cast<ThreadPoolEngine*>(arg)->run();
+		return 0;
+	}
+
+	void run()
+	{
+		while (true)
+		{
+			m_wakeup.enter();
+
+			phys_io_blk* piob;
+			{	// scope
+				MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+				if ((piob = m_head))
+				{
+					if (!(m_head = piob->piob_next))
+						m_tail = NULL;
+				}
+			}
+
+			// Queued requests are always served, even while shutting down
+
+			if (piob)
+				execute(piob);
+			else if (m_shutdown)
+				break;
+		}
+	}
+
+	HalfStaticArray<Thread::Handle, 16> m_threads;
+	Mutex m_mutex;
+	Semaphore m_wakeup;
+	phys_io_blk* m_head;
+	phys_io_blk* m_tail;
+	std::atomic<bool> m_shutdown;
+};
+
+
+#ifdef USE_IO_URING
+
+// Linux io_uring engine. Submission queue is filled under a mutex and flushed
+// with one io_uring_enter() per batch. Completions are reaped by a dedicated
+// thread which posts the requests' events.
+
+class UringEngine : public AsyncIOEngine
+{
+public:
+	explicit UringEngine(MemoryPool&)
+		: m_fd(-1),
+		  m_sqRing(MAP_FAILED),
+		  m_cqRing(MAP_FAILED),
+		  m_sqes(static_cast<io_uring_sqe*>(MAP_FAILED)),
+		  m_sqRingSize(0),
+		  m_cqRingSize(0),
+		  m_sqesSize(0),
+		  m_inFlight(0),
+		  m_reaper(0)
+	{ }
+
+	~UringEngine()
+	{
+		if (m_reaper)
+		{
+			// NOP with empty user data tells the reaper to stop
+
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			while (!queue(IORING_OP_NOP, NULL) || flush(1) != 1)
+				Thread::yield();
+		}
+
+		if (m_reaper)
+			Thread::waitForCompletion(m_reaper);
+
+		if (m_sqes != MAP_FAILED)
+			munmap(m_sqes, m_sqesSize);
+
+		if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing)
+			munmap(m_cqRing, m_cqRingSize);
+
+		if (m_sqRing != MAP_FAILED)
+			munmap(m_sqRing, m_sqRingSize);
+
+		if (m_fd >= 0)
+			close(m_fd);
+	}
+
+	bool init(unsigned depth)
+	{
+		io_uring_params params;
+		memset(&params, 0, sizeof(params));
+
+		m_fd = (int) syscall(__NR_io_uring_setup, depth, &params);
+		if (m_fd < 0)
+			return false;
+
+		m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+		const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (singleMap)
+			m_sqRingSize = m_cqRingSize = MAX(m_sqRingSize, m_cqRingSize);
+
+		m_sqRing = mmap(NULL, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			m_fd, IORING_OFF_SQ_RING);
+		if (m_sqRing == MAP_FAILED)
+			return false;
+
+		m_cqRing = singleMap ? m_sqRing :
+			mmap(NULL, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				m_fd, IORING_OFF_CQ_RING);
+		if (m_cqRing == MAP_FAILED)
+			return false;
+
+		m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		m_sqes = static_cast<io_uring_sqe*>(mmap(NULL, m_sqesSize, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES));
+		if (m_sqes == MAP_FAILED)
+			return false;
+
+		char* const sq = static_cast<char*>(m_sqRing);
+		m_sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+		m_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+		m_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+		m_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+		m_sqEntries = params.sq_entries;
+
+		char* const cq = static_cast<char*>(m_cqRing);
+		m_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+		m_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+		m_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+		m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+		m_cqEntries = params.cq_entries;
+
+		Thread::start(reaper, this, THREAD_high, &m_reaper);
+		return true;
+	}
+
+	unsigned submit(phys_io_blk* const* requests, unsigned count) override
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		// Never queue more than the completion ring is able to hold
+
+		unsigned queued = 0;
+		while (queued < count && m_inFlight + queued < m_cqEntries &&
+			queue(IORING_OP_READV, requests[queued]))
+		{
+			queued++;
+		}
+
+		if (!queued)
+			return 0;
+
+		// Account requests before the kernel sees them, reaper may complete them at once
+
+		m_inFlight += queued;
+		const unsigned submitted = flush(queued);
+		m_inFlight -= queued - submitted;
+		return submitted;
+	}
+
+	const char* getName() const override
+	{
+		return "IoUring";
+	}
+
+private:
+	// Put request into submission queue, caller must hold m_mutex
+	bool queue(UCHAR opcode, phys_io_blk* piob)
+	{
+		const unsigned head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+		const unsigned tail = *m_sqTail;
+
+		if (tail - head >= m_sqEntries)
+			return false;
+
+		const unsigned index = tail & m_sqMask;
+		io_uring_sqe* const sqe = &m_sqes[index];
+		memset(sqe, 0, sizeof(io_uring_sqe));
+
+		sqe->opcode = opcode;
+		sqe->fd = -1;
+		sqe->user_data = (U_IPTR) piob;
+
+		if (piob)
+		{
+			sqe->fd = piob->piob_file->fil_desc;
+			sqe->off = piob->piob_offset;
+			sqe->addr = (U_IPTR) piob->piob_iov;
+			sqe->len = piob->piob_iov_count;
+		}
+
+		m_sqArray[index] = index;
+		__atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+
+	// Pass queued entries to the kernel, caller must hold m_mutex.
+	// Entries not consumed by the kernel are withdrawn from the queue.
+	unsigned flush(unsigned queued)
+	{
+		int submitted = -1;
+
+		for (int i = 0; i < IO_RETRY && submitted < 0; i++)
+		{
+			submitted = (int) syscall(__NR_io_uring_enter, m_fd, queued, 0, 0, NULL, 0);
+
+			if (submitted < 0 && !SYSCALL_INTERRUPTED(errno) && errno != EAGAIN && errno != EBUSY)
+				break;
+		}
+
+		if (submitted < 0)
+			submitted = 0;
+
+		if ((unsigned) submitted < queued)
+		{
+			// Without SQPOLL the kernel reads submission queue inside io_uring_enter() only,
+			// therefore rest of entries could be safely taken back
+
+			const unsigned tail = *m_sqTail;
+			__atomic_store_n(m_sqTail, tail - (queued - submitted), __ATOMIC_RELEASE);
+		}
+
+		return submitted;
+	}
+
+	static THREAD_ENTRY_DECLARE reaper(THREAD_ENTRY_PARAM arg)
+	{
+		static_cast<UringEngine*>(arg)->reap();
+		return 0;
+	}
+
+	void reap()
+	{
+		bool stop = false;
+
+		while (!stop)
+		{
+			unsigned head = *m_cqHead;
+			const unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+
+			if (head == tail)
+			{
+				if (syscall(__NR_io_uring_enter, m_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 &&
+					!SYSCALL_INTERRUPTED(errno) && errno != EAGAIN && errno != EBUSY)
+				{
+					gds__log("AsyncIO: io_uring_enter() failed, errno %d", errno);
+					Thread::sleep(10);
+				}
+
+				continue;
+			}
+
+			for (; head != tail; head++)
+			{
+				const io_uring_cqe* const cqe = &m_cqes[head & m_cqMask];
+				phys_io_blk* const piob = (phys_io_blk*) (U_IPTR) cqe->user_data;
+
+				if (!piob)
+				{
+					stop = true;
+					continue;
+				}
+
+				--m_inFlight;
+
+				// Short read means end of file was reached, the caller
+				// checks piob_actual_length page by page
+
+				if (cqe->res < 0)
+					complete(piob, -1, -cqe->res);
+				else
+					complete(piob, cqe->res, 0);
+			}
+
+			__atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+		}
+	}
+
+	int m_fd;
+	void* m_sqRing;
+	void* m_cqRing;
+	io_uring_sqe* m_sqes;
+	size_t m_sqRingSize;
+	size_t m_cqRingSize;
+	size_t m_sqesSize;
+
+	unsigned* m_sqHead;
+	unsigned* m_sqTail;
+	unsigned* m_sqArray;
+	unsigned m_sqMask;
+	unsigned m_sqEntries;
+
+	unsigned* m_cqHead;
+	unsigned* m_cqTail;
+	io_uring_cqe* m_cqes;
+	unsigned m_cqMask;
+	unsigned m_cqEntries;
+
+	Mutex m_mutex;
+	std::atomic<unsigned> m_inFlight;
+	Thread::Handle m_reaper;
+};
+
+#endif // USE_IO_URING
+
+
+// Holds process-wide instance of configured engine
+
+class AsyncIOHolder
+{
+public:
+	explicit AsyncIOHolder(MemoryPool& pool)
+		: engine(NULL)
+	{
+		const char* const mode = Config::getAsyncIO();
+		const unsigned depth = Config::getAsyncIODepth();
+
+		if (!mode || fb_utils::stricmp(mode, "None") == 0)
+			return;
+
+		const bool uringMode = fb_utils::stricmp(mode, "IoUring") == 0;
+		bool autoMode = fb_utils::stricmp(mode, "Auto") == 0;
+
+		if (!autoMode && !uringMode && fb_utils::stricmp(mode, "Threads") != 0)
+		{
+			gds__log("AsyncIO: unknown engine \"%s\", using Auto", mode);
+			autoMode = true;
+		}
+
+#ifdef USE_IO_URING
+		if (autoMode || uringMode)
+		{
+			UringEngine* const uring = FB_NEW_POOL(pool) UringEngine(pool);
+
+			if (uring->init(depth))
+				engine = uring;
+			else
+				delete uring;
+		}
+#endif
+
+		if (uringMode && !engine)
+			gds__log("AsyncIO: io_uring is not supported, using Threads");
+
+		if (!engine)
+		{
+			const unsigned threads = MIN(MAX(depth / 8, 2), 16);
+			engine = FB_NEW_POOL(pool) ThreadPoolEngine(pool, threads);
+		}
+	}
+
+	~AsyncIOHolder()
+	{
+		delete engine;
+	}
+
+	AsyncIOEngine* engine;
+};
+
+InitInstance<AsyncIOHolder> asyncIO;
+
+} // anonymous namespace
+
+
+namespace Jrd {
+
+AsyncIOEngine* AsyncIOEngine::get()
+{
+	return asyncIO().engine;
+}
+
+
+void AsyncIOEngine::complete(phys_io_blk* piob, SINT64 result, int error)
+{
+	// Request may be reused by its owner as soon as event is posted
+
+	piob->piob_actual_length = result;
+	piob->piob_errno = error;
+	piob->piob_event.release();
+}
+
+
+void AsyncIOEngine::execute(phys_io_blk* piob)
+{
+	struct iovec iov[PIOB_MAX_PAGES];
+	memcpy(iov, piob->piob_iov, piob->piob_iov_count * sizeof(struct iovec));
+
+	struct iovec* next = iov;
+	int left = piob->piob_iov_count;
+	FB_UINT64 offset = piob->piob_offset;
+	SINT64 total = 0;
+	int error = 0;
+
+	for (int retry = 0; left && retry < IO_RETRY; )
+	{
+		const ssize_t bytes = preadv(piob->piob_file->fil_desc, next, left, LSEEK_OFFSET_CAST offset);
+
+		if (bytes < 0)
+		{
+			if (SYSCALL_INTERRUPTED(errno))
+			{
+				retry++;
+				continue;
+			}
+
+			error = errno;
+			break;
+		}
+
+		if (!bytes)
+			break;		// end of file
+
+		total += bytes;
+		offset += bytes;
+
+		// Skip fully read buffers and continue with the rest
+
+		size_t done = bytes;
+		while (left && done >= next->iov_len)
+		{
+			done -= next->iov_len;
+			next++;
+			left--;
+		}
+
+		if (left && done)
+		{
+			next->iov_base = static_cast<char*>(next->iov_base) + done;
+			next->iov_len -= done;
+		}
+	}
+
+	complete(piob, error ? -1 : total, error);
+}
+
+} // namespace Jrd
@@ -60,6 +60,7 @@
 
 #include "../jrd/jrd.h"
 #include "../jrd/os/pio.h"
+#include "../jrd/os/AsyncIO.h"
 #include "../jrd/ods.h"
 #include "../jrd/lck.h"
 #include "../jrd/cch.h"
@@ -150,6 +151,24 @@ static int	openFile(const ScratchBird::PathName&, const bool, const bool, const
 static void	maybeCloseFile(int&);
 
 
+const char* PIO_async_engine()
+{
+/**************************************
+ *
+ *	P I O _ a s y n c _ e n g i n e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return name of asynchronous I/O engine
+ *	or NULL if reads are performed synchronously.
+ *
+ **************************************/
+	const AsyncIOEngine* const engine = AsyncIOEngine::get();
+	return engine ? engine->getName() : NULL;
+}
+
+
 void PIO_close(jrd_file* file)
 {
 /**************************************
@@ -740,6 +759,39 @@ jrd_file* PIO_open(thread_db* tdbb,
 }
 
 
+void PIO_prepare_read(jrd_file* file, ULONG start_page, USHORT page_size,
+					  Ods::pag* const* buffers, USHORT pages, phys_io_blk* piob)
+{
+/**************************************
+ *
+ *	P I O _ p r e p a r e _ r e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Describe a read of a contiguous set of pages
+ *	into a set of (not necessary contiguous) buffers.
+ *
+ **************************************/
+	fb_assert(pages && pages <= PIOB_MAX_PAGES);
+
+	piob->piob_file = file;
+	piob->piob_offset = (FB_UINT64) start_page * page_size;
+	piob->piob_io_length = (ULONG) pages * page_size;
+	piob->piob_actual_length = 0;
+	piob->piob_errno = 0;
+	piob->piob_flags = 0;
+	piob->piob_iov_count = pages;
+	piob->piob_next = NULL;
+
+	for (USHORT i = 0; i < pages; i++)
+	{
+		piob->piob_iov[i].iov_base = buffers[i];
+		piob->piob_iov[i].iov_len = page_size;
+	}
+}
+
+
 bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page, FbStatusVector* status_vector)
 {
 /**************************************
@@ -792,6 +844,92 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_read_ahead(thread_db* tdbb, phys_io_blk* const* piobs, USHORT count,
+					FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ r e a d _ a h e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Queue a batch of prepared multi-page reads.
+ *	Requests not accepted by the asynchronous I/O
+ *	engine are performed synchronously, therefore
+ *	caller should always finish them with PIO_status.
+ *
+ **************************************/
+	// Validate the whole batch first, nothing is pending if a request is rejected
+
+	for (USHORT i = 0; i < count; i++)
+	{
+		phys_io_blk* const piob = piobs[i];
+
+		if (piob->piob_file->fil_desc == -1)
+			return unix_error("read", piob->piob_file, isc_io_read_err, status_vector);
+
+		if (piob->piob_offset != (FB_UINT64) LSEEK_OFFSET_CAST piob->piob_offset)
+			return unix_error("lseek", piob->piob_file, isc_io_32bit_exceeded_err, status_vector);
+	}
+
+	for (USHORT i = 0; i < count; i++)
+		piobs[i]->piob_flags = PIOB_pending;
+
+	AsyncIOEngine* const engine = AsyncIOEngine::get();
+	const unsigned queued = engine ? engine->submit(piobs, count) : 0;
+
+	if (queued < count)
+	{
+		EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
+
+		for (USHORT i = queued; i < count; i++)
+			AsyncIOEngine::execute(piobs[i]);
+	}
+
+	return true;
+}
+
+
+bool PIO_status(thread_db* tdbb, phys_io_blk* piob, FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ s t a t u s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check the status of an asynchronous I/O.
+ *	If piob_wait is not set and I/O is still in progress
+ *	return true leaving PIOB_pending in piob_flags.
+ *	Pages beyond piob_actual_length were not read
+ *	(end of file) and should not be used by caller.
+ *
+ **************************************/
+	if (piob->piob_flags & PIOB_pending)
+	{
+		if (piob->piob_wait)
+		{
+			EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
+			piob->piob_event.enter();
+		}
+		else if (!piob->piob_event.tryEnter(0, 0))
+			return true;
+
+		piob->piob_flags = (piob->piob_errno ? PIOB_error : PIOB_success);
+	}
+
+	if (piob->piob_flags & PIOB_error)
+	{
+		errno = piob->piob_errno;
+		return unix_error("read_ahead", piob->piob_file, isc_io_read_err, status_vector);
+	}
+
+	return true;
+}
+
+
 bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page, FbStatusVector* status_vector)
 {
 /**************************************
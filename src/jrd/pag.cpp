@@ -112,6 +112,19 @@ namespace
 			ERR_post(Arg::Gds(isc_read_only_database));
 	}
 
+	// LZ4 compressed records can't be read by engines supporting ODS below 14.2,
+	// so the configured method is used for databases of appropriate ODS only
+	void setRecordCompression(Database* dbb)
+	{
+		if (dbb->getEncodedOdsVersion() >= ODS_14_2 &&
+			NoCaseString(dbb->dbb_config->getRecordCompression()) == "LZ4")
+		{
+			dbb->dbb_flags |= DBB_lz_records;
+		}
+		else
+			dbb->dbb_flags &= ~DBB_lz_records;
+	}
+
 	class HeaderClumplet
 	{
 	public:
@@ -816,6 +829,7 @@ void PAG_format_header(thread_db* tdbb)
 
 	dbb->dbb_ods_version = header->hdr_ods_version & ~ODS_FIREBIRD_FLAG;
 	dbb->dbb_minor_version = header->hdr_ods_minor;
+	setRecordCompression(dbb);
 
 	dbb->dbb_guid.assign(header->hdr_guid);
 
@@ -1159,6 +1173,7 @@ void PAG_header_init(thread_db* tdbb)
 
 	dbb->dbb_ods_version = ods_version;
 	dbb->dbb_minor_version = header->hdr_ods_minor;
+	setRecordCompression(dbb);
 
 	dbb->dbb_page_size = header->hdr_page_size;
 	dbb->dbb_page_buffers = header->hdr_page_buffers;
@@ -1200,12 +1215,16 @@ void PAG_init(thread_db* tdbb)
 	dbb->dbb_max_records = Ods::maxRecsPerDP(dbb->dbb_page_size);
 	dbb->dbb_max_idx = Ods::maxIndices(dbb->dbb_page_size);
 
-	// Compute prefetch constants from database page size and maximum prefetch
-	// transfer size. Double pages per prefetch request so that cache reader
-	// can overlap prefetch I/O with database computation over previously prefetched pages.
-#ifdef SUPERSERVER_V2
-	dbb->dbb_prefetch_sequence = PREFETCH_MAX_TRANSFER / dbb->dbb_page_size;
-	dbb->dbb_prefetch_pages = dbb->dbb_prefetch_sequence * 2;
+	// Compute prefetch constants from configured read-ahead size. Double pages
+	// per prefetch request so that cache reader can overlap prefetch I/O with
+	// database computation over previously prefetched pages.
+#ifdef CACHE_READER
+	const USHORT readAhead = (USHORT) MIN(dbb->dbb_config->getReadAhead(), PREFETCH_MAX_PAGES);
+	dbb->dbb_prefetch_sequence = readAhead / 2;
+	dbb->dbb_prefetch_pages = dbb->dbb_prefetch_sequence ? readAhead : 0;
+#else
+	dbb->dbb_prefetch_sequence = 0;
+	dbb->dbb_prefetch_pages = 0;
 #endif
 }
 
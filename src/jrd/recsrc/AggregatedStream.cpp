@@ -371,6 +371,7 @@ bool BaseAggWinStream<ThisType, NextType>::getNextRecord(thread_db* tdbb, Reques
 
 // Export the template for WindowedStream::WindowStream.
 template class Jrd::BaseAggWinStream<WindowedStream::WindowStream, BaseBufferedStream>;
+template class Jrd::BaseAggWinStream<HashAggregateStream, RecordSource>;
 
 // ------------------------------
 
@@ -22,6 +22,7 @@
 #include "../jrd/btr.h"
 #include "../jrd/req.h"
 #include "../jrd/cmp_proto.h"
+#include "../jrd/dpm_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/rlck_proto.h"
@@ -54,6 +55,7 @@ void BitmapTableScan::internalOpen(thread_db* tdbb) const
 
 	impure->irsb_flags = irsb_open;
 	impure->irsb_bitmap = EVL_bitmap(tdbb, m_inversion, NULL);
+	impure->irsb_prefetch_number = 0;
 
 	record_param* const rpb = &request->req_rpb[m_stream];
 	RLCK_reserve_relation(tdbb, request->req_transaction, m_relation, false);
@@ -108,7 +110,13 @@ bool BitmapTableScan::internalGetRecord(thread_db* tdbb) const
 	{
 		do
 		{
-			rpb->rpb_number.setValue(bitmap->current());
+			const FB_UINT64 number = bitmap->current();
+			rpb->rpb_number.setValue(number);
+
+			// Get data pages of the records ahead read in background
+
+			if (number >= impure->irsb_prefetch_number)
+				impure->irsb_prefetch_number = DPM_prefetch_bitmap(tdbb, m_relation, bitmap, number);
 
 			if (VIO_get(tdbb, rpb, request->req_transaction, request->req_pool))
 			{
@@ -0,0 +1,766 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by Dmitry Yemanov
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2009 Dmitry Yemanov <dimitr@firebirdsql.org>
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/tra.h"
+#include "../jrd/dpm_proto.h"
+#include "../jrd/met_proto.h"
+#include "../jrd/tra_proto.h"
+#include "../jrd/vio_proto.h"
+#include "../jrd/rlck_proto.h"
+#include "../jrd/Attachment.h"
+#include "../jrd/WorkerAttachment.h"
+#include "../common/Task.h"
+
+#include "RecordSource.h"
+
+using namespace ScratchBird;
+using namespace Jrd;
+
+// ----------------------------------------
+// Data access: parallel table scan, gather
+// ----------------------------------------
+
+// The relation is scanned in rounds. Every round is split into units of
+// UNIT_PAGES data pages, up to UNITS_PER_WORKER units per worker. Workers copy
+// the visible records of their units into memory buffers, then the records
+// are returned unit by unit, thus in the same order as the serial scan does.
+static const ULONG UNIT_PAGES = 16;
+static const ULONG UNITS_PER_WORKER = 4;
+
+class GatherStream::ScanTask : public Task
+{
+	// Record image as copied by the worker
+	struct RecordHeader
+	{
+		SINT64 number;
+		TraNumber transaction;
+		ULONG length;
+		USHORT format;
+	};
+
+	static const ULONG HEADER_LENGTH = FB_ALIGN(sizeof(RecordHeader), FB_ALIGNMENT);
+
+	struct Unit
+	{
+		enum State { PENDING, ASSIGNED, DONE };
+
+		explicit Unit(MemoryPool& pool)
+			: data(pool)
+		{}
+
+		ULONG firstPage = 0;		// sequence of the first data page
+		ULONG lastPage = 0;			// sequence of the data page after the last one
+		State state = PENDING;
+		Array<UCHAR> data;
+		FB_SIZE_T offset = 0;
+	};
+
+public:
+	ScanTask(thread_db* tdbb, MemoryPool& pool, jrd_rel* relation, record_param* rpb,
+			 int workers, ULONG pages)
+		: Task(),
+		  m_pool(pool),
+		  m_dbb(tdbb->getDatabase()),
+		  m_relationId(relation->rel_id),
+		  m_streamFlags(rpb->rpb_stream_flags & RPB_s_no_data),
+		  m_largeScan(rpb->getWindow(tdbb).win_flags & WIN_large_scan),
+		  m_tpb(pool),
+		  m_items(pool),
+		  m_units(pool),
+		  m_coordinator(&pool),
+		  m_stop(false),
+		  m_lastPage(pages)
+	{
+		// Workers should see exactly what the transaction sees, so they start
+		// their transactions at its snapshot. A read committed transaction
+		// without read consistency has no snapshot, its workers are read
+		// committed as well.
+
+		Request* const request = tdbb->getRequest();
+		const jrd_tra* const transaction = request->req_transaction;
+
+		m_oldestActive = transaction->tra_oldest_active;
+
+		CommitNumber snapshot = 0;
+
+		if (!(transaction->tra_flags & TRA_read_committed))
+			snapshot = transaction->tra_snapshot_number;
+		else if (transaction->tra_flags & TRA_read_consistency)
+		{
+			const Request* const owner = request->req_snapshot.m_owner;
+			fb_assert(owner);
+			snapshot = owner->req_snapshot.m_number;
+		}
+
+		m_tpb.add(isc_tpb_version3);
+		m_tpb.add(isc_tpb_read);
+
+		if (snapshot)
+		{
+			m_tpb.add(isc_tpb_concurrency);
+			m_tpb.add(isc_tpb_at_snapshot_number);
+			m_tpb.add(sizeof(CommitNumber));
+
+			for (unsigned i = 0; i < sizeof(CommitNumber); i++)
+				m_tpb.add((UCHAR) (snapshot >> (i * 8)));
+		}
+		else
+		{
+			m_tpb.add(isc_tpb_read_committed);
+			m_tpb.add(isc_tpb_rec_version);
+		}
+
+		for (int i = 0; i < workers; i++)
+			m_items.add(FB_NEW_POOL(m_pool) Item(this));
+
+		for (ULONG i = 0; i < workers * UNITS_PER_WORKER; i++)
+			m_units.add(FB_NEW_POOL(m_pool) Unit(m_pool));
+
+		m_unitCount = m_current = 0;
+	}
+
+	virtual ~ScanTask()
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			delete *p;
+
+		for (Unit** p = m_units.begin(); p < m_units.end(); p++)
+			delete *p;
+	}
+
+	bool handler(WorkItem& _item);
+	bool getWorkItem(WorkItem** pItem);
+
+	bool getResult(IStatus* status)
+	{
+		if (status)
+		{
+			status->init();
+			status->setErrors(m_status.getErrors());
+		}
+
+		return m_status.isSuccess();
+	}
+
+	int getMaxWorkers()
+	{
+		return MIN(m_items.getCount(), m_unitCount);
+	}
+
+	bool nextRound(thread_db* tdbb);
+	bool getRecord(thread_db* tdbb, record_param* rpb, jrd_rel* relation);
+
+private:
+	class Item : public Task::WorkItem
+	{
+	public:
+		Item(ScanTask* task)
+			: Task::WorkItem(task),
+			  m_inuse(false),
+			  m_tra(NULL),
+			  m_relation(NULL),
+			  m_unit(NULL)
+		{}
+
+		virtual ~Item()
+		{
+			if (!m_attStable)
+				return;
+
+			Attachment* att = NULL;
+			{
+				AttSyncLockGuard guard(*m_attStable->getSync(), FB_FUNCTION);
+				att = m_attStable->getHandle();
+				if (!att)
+					return;
+				fb_assert(att->att_use_count > 0);
+			}
+
+			FbLocalStatus status;
+			if (m_tra)
+			{
+				BackgroundContextHolder tdbb(att->att_database, att, &status, FB_FUNCTION);
+				TRA_commit(tdbb, m_tra, false);
+			}
+			WorkerAttachment::releaseAttachment(&status, m_attStable);
+		}
+
+		ScanTask* getScanTask() const
+		{
+			return reinterpret_cast<ScanTask*> (m_task);
+		}
+
+		bool init(thread_db* tdbb)
+		{
+			FbStatusVector* status = tdbb->tdbb_status_vector;
+			ScanTask* const task = getScanTask();
+
+			Attachment* att = NULL;
+
+			if (!m_attStable.hasData())
+				m_attStable = WorkerAttachment::getAttachment(status, task->m_dbb);
+
+			if (m_attStable)
+				att = m_attStable->getHandle();
+
+			if (!att)
+				return false;
+
+			tdbb->setDatabase(att->att_database);
+			tdbb->setAttachment(att);
+
+			if (!m_tra)
+			{
+				try
+				{
+					WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+					m_tra = TRA_start(tdbb, task->m_tpb.getCount(), task->m_tpb.begin());
+
+					if (m_tra->tra_oldest_active > task->m_oldestActive)
+						m_tra->tra_oldest_active = task->m_oldestActive;
+
+					m_relation = MET_relation(tdbb, task->m_relationId);
+					if (!(m_relation->rel_flags & REL_scanned))
+						MET_scan_relation(tdbb, m_relation);
+				}
+				catch (const Exception& ex)
+				{
+					ex.stuffException(tdbb->tdbb_status_vector);
+					task->setError(tdbb->tdbb_status_vector, true);
+					return false;
+				}
+			}
+
+			tdbb->setTransaction(m_tra);
+
+			return true;
+		}
+
+		bool m_inuse;
+		RefPtr<StableAttachmentPart> m_attStable;
+		jrd_tra* m_tra;
+		jrd_rel* m_relation;
+		Unit* m_unit;
+	};
+
+	void setError(IStatus* status, bool stopTask)
+	{
+		const bool copyStatus = (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS);
+		if (!copyStatus && (!stopTask || m_stop))
+			return;
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		if (m_status.isSuccess() && copyStatus)
+			m_status.save(status);
+		if (stopTask)
+			m_stop = true;
+	}
+
+	MemoryPool& m_pool;
+	Database* const m_dbb;
+	const USHORT m_relationId;
+	const USHORT m_streamFlags;
+	const bool m_largeScan;
+
+	HalfStaticArray<UCHAR, 16> m_tpb;		// parameters of the worker transactions
+	TraNumber m_oldestActive;
+
+	Mutex m_mutex;
+	HalfStaticArray<Item*, 8> m_items;
+	HalfStaticArray<Unit*, 32> m_units;
+	Coordinator m_coordinator;
+	StatusHolder m_status;
+	volatile bool m_stop;
+
+	ULONG m_nextPage = 0;			// first data page of the next round
+	const ULONG m_lastPage;
+	FB_SIZE_T m_unitCount;			// units of the current round
+	FB_SIZE_T m_assigned = 0;		// units handed to the workers
+	FB_SIZE_T m_current;			// unit being returned
+	bool m_scanning = false;		// the current unit is scanned by the caller
+};
+
+
+bool GatherStream::ScanTask::handler(WorkItem& _item)
+{
+	Item* const item = reinterpret_cast<Item*>(&_item);
+	Unit* const unit = item->m_unit;
+
+	ThreadContextHolder tdbb(NULL);
+
+	if (!item->init(tdbb))
+	{
+		// No worker attachment is available, leave the unit to the others
+		// or to the caller
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		unit->state = Unit::PENDING;
+		item->m_inuse = false;
+		return false;
+	}
+
+	WorkerContextHolder wrkHolder(tdbb, FB_FUNCTION);
+
+	record_param rpb;
+	jrd_rel* const relation = item->m_relation;
+	bool large = false;
+
+	try
+	{
+		Attachment* const att = tdbb->getAttachment();
+		jrd_tra* const transaction = tdbb->getTransaction();
+
+		rpb.rpb_relation = relation;
+		rpb.rpb_record = NULL;
+		rpb.rpb_stream_flags = m_streamFlags;
+
+		if (m_largeScan)
+		{
+			rpb.getWindow(tdbb).win_flags = WIN_large_scan;
+			rpb.rpb_org_scans = relation->rel_scan_count++;
+			large = true;
+		}
+
+		rpb.rpb_number.setValue((SINT64) unit->firstPage * m_dbb->dbb_max_records - 1);
+
+		RecordNumber upper;
+		upper.setValue((SINT64) unit->lastPage * m_dbb->dbb_max_records - 1);
+
+		while (!m_stop &&
+			VIO_next_record(tdbb, &rpb, transaction, att->att_pool, DPM_next_all, &upper))
+		{
+			const Record* const record = rpb.rpb_record;
+			const ULONG length = (m_streamFlags & RPB_s_no_data) ? 0 : record->getLength();
+
+			RecordHeader header;
+			header.number = rpb.rpb_number.getValue();
+			header.transaction = rpb.rpb_transaction_nr;
+			header.length = length;
+			header.format = length ? record->getFormat()->fmt_version : 0;
+
+			const FB_SIZE_T offset = unit->data.getCount();
+			UCHAR* const ptr = unit->data.getBuffer(offset + FB_ALIGN(HEADER_LENGTH + length, FB_ALIGNMENT)) + offset;
+
+			memcpy(ptr, &header, sizeof(header));
+			if (length)
+				memcpy(ptr + HEADER_LENGTH, record->getData(), length);
+
+			JRD_reschedule(tdbb);
+		}
+
+		delete rpb.rpb_record;
+
+		if (large && relation->rel_scan_count)
+			--relation->rel_scan_count;
+
+		unit->state = Unit::DONE;
+		return !m_stop;
+	}
+	catch (const Exception& ex)
+	{
+		ex.stuffException(tdbb->tdbb_status_vector);
+
+		delete rpb.rpb_record;
+
+		if (large && relation->rel_scan_count)
+			--relation->rel_scan_count;
+	}
+
+	setError(tdbb->tdbb_status_vector, true);
+	return false;
+}
+
+bool GatherStream::ScanTask::getWorkItem(WorkItem** pItem)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	Item* item = reinterpret_cast<Item*> (*pItem);
+
+	if (item == NULL)
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		{
+			if (!(*p)->m_inuse)
+			{
+				(*p)->m_inuse = true;
+				*pItem = item = *p;
+				break;
+			}
+		}
+	}
+
+	if (!item)
+		return false;
+
+	if (!m_stop)
+	{
+		for (; m_assigned < m_unitCount; m_assigned++)
+		{
+			Unit* const unit = m_units[m_assigned];
+
+			if (unit->state == Unit::PENDING)
+			{
+				unit->state = Unit::ASSIGNED;
+				item->m_unit = unit;
+				m_assigned++;
+				return true;
+			}
+		}
+	}
+
+	item->m_inuse = false;
+	return false;
+}
+
+// Set up the next round and let the workers fetch it
+bool GatherStream::ScanTask::nextRound(thread_db* tdbb)
+{
+	if (m_nextPage >= m_lastPage)
+		return false;
+
+	for (m_unitCount = 0; m_unitCount < m_units.getCount() && m_nextPage < m_lastPage; m_unitCount++)
+	{
+		Unit* const unit = m_units[m_unitCount];
+		unit->firstPage = m_nextPage;
+		unit->lastPage = m_nextPage = MIN(m_nextPage + UNIT_PAGES, m_lastPage);
+		unit->state = Unit::PENDING;
+		unit->data.clear();
+		unit->offset = 0;
+	}
+
+	for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		(*p)->m_inuse = false;
+
+	m_assigned = m_current = 0;
+	m_scanning = false;
+
+	{	// scope
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+		m_coordinator.runSync(this);
+	}
+
+	FbLocalStatus status;
+	if (!getResult(&status))
+		status.raise();
+
+	return true;
+}
+
+// Return the next record of the current round
+bool GatherStream::ScanTask::getRecord(thread_db* tdbb, record_param* rpb, jrd_rel* relation)
+{
+	Request* const request = tdbb->getRequest();
+
+	for (; m_current < m_unitCount; m_current++)
+	{
+		Unit* const unit = m_units[m_current];
+
+		if (unit->state == Unit::PENDING)
+		{
+			// No worker took the unit, scan it here
+
+			if (!m_scanning)
+			{
+				rpb->rpb_number.setValue((SINT64) unit->firstPage * m_dbb->dbb_max_records - 1);
+				m_scanning = true;
+			}
+
+			RecordNumber upper;
+			upper.setValue((SINT64) unit->lastPage * m_dbb->dbb_max_records - 1);
+
+			if (VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all, &upper))
+				return true;
+
+			m_scanning = false;
+			continue;
+		}
+
+		fb_assert(unit->state == Unit::DONE);
+
+		if (unit->offset < unit->data.getCount())
+		{
+			const UCHAR* const ptr = unit->data.begin() + unit->offset;
+
+			RecordHeader header;
+			memcpy(&header, ptr, sizeof(header));
+
+			if (header.length)
+			{
+				const Format* const format = MET_format(tdbb, relation, header.format);
+				Record* const record = VIO_record(tdbb, rpb, format, request->req_pool);
+
+				fb_assert(record->getLength() == header.length);
+				memcpy(record->getData(), ptr + HEADER_LENGTH, header.length);
+				record->setTransactionNumber(header.transaction);
+			}
+
+			rpb->rpb_number.setValue(header.number);
+			rpb->rpb_transaction_nr = header.transaction;
+			rpb->rpb_format_number = header.format;
+
+			unit->offset += FB_ALIGN(HEADER_LENGTH + header.length, FB_ALIGNMENT);
+			return true;
+		}
+
+		unit->data.free();
+	}
+
+	return false;
+}
+
+
+GatherStream::GatherStream(CompilerScratch* csb, StreamType stream, jrd_rel* relation, RecordSource* next)
+	: RecordSource(csb),
+	  m_next(next),
+	  m_stream(stream),
+	  m_relation(relation)
+{
+	fb_assert(m_next);
+
+	m_impure = csb->allocImpure<Impure>();
+	m_cardinality = next->getCardinality();
+}
+
+// Check whether the scan of the stream may be done in parallel
+bool GatherStream::isAllowed(thread_db* tdbb, CompilerScratch* csb, StreamType stream, const RseNode* rse)
+{
+	const Attachment* const attachment = tdbb->getAttachment();
+	const auto tail = &csb->csb_rpt[stream];
+	const jrd_rel* const relation = tail->csb_relation;
+
+	// Workers can't see pages of temporary tables and records locked
+	// or modified by the scan must be fetched by the transaction itself
+
+	return attachment->att_parallel_workers > 1 &&
+		!relation->isSystem() && !relation->isTemporary() &&
+		!rse->hasWriteLock() &&
+		!(tail->csb_flags & (csb_update | csb_unstable | csb_skip_locked));
+}
+
+// Check at runtime whether the workers may see what the transaction sees
+bool GatherStream::canGather(thread_db* tdbb) const
+{
+	Database* const dbb = tdbb->getDatabase();
+	const Attachment* const attachment = tdbb->getAttachment();
+	Request* const request = tdbb->getRequest();
+	const jrd_tra* const transaction = request->req_transaction;
+	const record_param* const rpb = &request->req_rpb[m_stream];
+
+	if (m_recursive || attachment->att_parallel_workers <= 1)
+		return false;
+
+	// Classic in single-user shutdown mode can't create additional worker attachments
+	if (dbb->isShutdown(shut_mode_single) && !(dbb->dbb_flags & DBB_shared))
+		return false;
+
+	if (rpb->rpb_stream_flags & (RPB_s_update | RPB_s_unstable | RPB_s_skipLocked))
+		return false;
+
+	// Own changes are not visible to the workers
+
+	if (transaction->tra_flags & (TRA_system | TRA_write))
+		return false;
+
+	if (transaction->tra_commit_sub_trans)
+		return false;
+
+	if (transaction->tra_flags & TRA_read_committed)
+	{
+		if (transaction->tra_flags & TRA_read_consistency)
+		{
+			if (!request->req_snapshot.m_owner)
+				return false;
+		}
+		else if (!(transaction->tra_flags & TRA_rec_version))
+			return false;
+	}
+
+	return DPM_data_pages(tdbb, m_relation) > attachment->att_parallel_workers * UNIT_PAGES;
+}
+
+void GatherStream::internalOpen(thread_db* tdbb) const
+{
+	Database* const dbb = tdbb->getDatabase();
+	Attachment* const attachment = tdbb->getAttachment();
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	impure->irsb_flags = irsb_open;
+
+	delete impure->irsb_task;
+	impure->irsb_task = nullptr;
+
+	if (!canGather(tdbb))
+	{
+		m_next->open(tdbb);
+		return;
+	}
+
+	RLCK_reserve_relation(tdbb, request->req_transaction, m_relation, false);
+
+	record_param* const rpb = &request->req_rpb[m_stream];
+	rpb->getWindow(tdbb).win_flags = 0;
+
+	// Limit the cache flushing effect as FullTableScan does
+
+	if (attachment != dbb->dbb_attachments || attachment->att_next)
+	{
+		if (attachment->isGbak() || DPM_data_pages(tdbb, m_relation) > dbb->dbb_bcb->bcb_count)
+		{
+			rpb->getWindow(tdbb).win_flags = WIN_large_scan;
+			rpb->rpb_org_scans = m_relation->rel_scan_count++;
+		}
+	}
+
+	rpb->rpb_number.setValue(BOF_NUMBER);
+
+	const ULONG pages = DPM_pointer_pages(tdbb, m_relation) * dbb->dbb_dp_per_pp;
+
+	MemoryPool& pool = *request->req_pool;
+	impure->irsb_task = FB_NEW_POOL(pool) ScanTask(tdbb, pool, m_relation, rpb,
+		attachment->att_parallel_workers, pages);
+}
+
+void GatherStream::close(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+
+	invalidateRecords(request);
+
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (impure->irsb_flags & irsb_open)
+	{
+		impure->irsb_flags &= ~irsb_open;
+
+		if (impure->irsb_task)
+		{
+			// Worker transactions are committed and worker attachments are released
+
+			{	// scope
+				EngineCheckout cout(tdbb, FB_FUNCTION);
+				delete impure->irsb_task;
+				impure->irsb_task = nullptr;
+			}
+
+			record_param* const rpb = &request->req_rpb[m_stream];
+			if ((rpb->getWindow(tdbb).win_flags & WIN_large_scan) &&
+				m_relation->rel_scan_count)
+			{
+				m_relation->rel_scan_count--;
+			}
+		}
+		else
+			m_next->close(tdbb);
+	}
+}
+
+bool GatherStream::internalGetRecord(thread_db* tdbb) const
+{
+	JRD_reschedule(tdbb);
+
+	Request* const request = tdbb->getRequest();
+	record_param* const rpb = &request->req_rpb[m_stream];
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (!(impure->irsb_flags & irsb_open))
+	{
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
+	ScanTask* const task = impure->irsb_task;
+
+	if (!task)
+		return m_next->getRecord(tdbb);
+
+	do
+	{
+		if (task->getRecord(tdbb, rpb, m_relation))
+		{
+			rpb->rpb_number.setValid(true);
+			return true;
+		}
+	} while (task->nextRound(tdbb));
+
+	rpb->rpb_number.setValid(false);
+	return false;
+}
+
+bool GatherStream::refetchRecord(thread_db* tdbb) const
+{
+	return m_next->refetchRecord(tdbb);
+}
+
+WriteLockResult GatherStream::lockRecord(thread_db* tdbb) const
+{
+	return m_next->lockRecord(tdbb);
+}
+
+void GatherStream::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
+{
+	m_next->getLegacyPlan(tdbb, plan, level);
+}
+
+void GatherStream::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const
+{
+	planEntry.className = "GatherStream";
+
+	planEntry.lines.add().text = "Gather";
+	printOptInfo(planEntry.lines);
+
+	if (recurse)
+	{
+		++level;
+		m_next->getPlan(tdbb, planEntry.children.add(), level, recurse);
+	}
+}
+
+void GatherStream::markRecursive()
+{
+	m_recursive = true;
+	m_next->markRecursive();
+}
+
+void GatherStream::findUsedStreams(StreamList& streams, bool expandAll) const
+{
+	m_next->findUsedStreams(streams, expandAll);
+}
+
+bool GatherStream::isDependent(const StreamList& streams) const
+{
+	return m_next->isDependent(streams);
+}
+
+void GatherStream::invalidateRecords(Request* request) const
+{
+	m_next->invalidateRecords(request);
+}
+
+void GatherStream::nullRecords(thread_db* tdbb) const
+{
+	m_next->nullRecords(tdbb);
+}
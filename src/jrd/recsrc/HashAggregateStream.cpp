@@ -0,0 +1,873 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by Dmitry Yemanov
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2009 Dmitry Yemanov <dimitr@firebirdsql.org>
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../common/classes/Aligner.h"
+#include "../common/classes/Hash.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/intl.h"
+#include "../dsql/Nodes.h"
+#include "../dsql/ExprNodes.h"
+#include "../jrd/evl_proto.h"
+#include "../jrd/exe_proto.h"
+#include "../jrd/mov_proto.h"
+#include "../jrd/intl_proto.h"
+
+#include "RecordSource.h"
+
+using namespace ScratchBird;
+using namespace Jrd;
+
+static const char* const SCRATCH = "fb_group_";
+
+// -------------------------------
+// Data access: hashed aggregation
+// -------------------------------
+
+// If the groups exceed HashAggregateMemoryLimit, the values of the groups
+// not being in memory are split into partitions by hash and aggregated later,
+// one partition at a time. Every level of partitioning takes the next bits
+// of the hash value, so the last level can't spill anymore.
+static const ULONG PARTITION_BITS = 4;				// 16 partitions per level
+static const ULONG MAX_PARTITION_LEVEL = 32 / PARTITION_BITS;
+
+static const ULONG MIN_HASH_BITS = 6;
+static const ULONG GROUP_BLOCK_SIZE = 64 * 1024;
+static const ULONG SPILL_BLOCK_SIZE = 32 * 1024;
+
+namespace
+{
+	inline bool isNullValue(const UCHAR* values, USHORT id)
+	{
+		return (values[id >> 3] & (1 << (id & 7))) != 0;
+	}
+
+	inline void setNullValue(UCHAR* values, USHORT id)
+	{
+		values[id >> 3] |= (1 << (id & 7));
+	}
+} // namespace
+
+
+class HashAggregateStream::GroupTable : public PermanentStorage
+{
+	struct Group
+	{
+		Group* next;		// next group of the same bucket
+		ULONG hash;
+	};
+
+	// Rows of the values spilled to a partition: hash, key and values
+	class SpillList
+	{
+	public:
+		SpillList(MemoryPool& pool, ULONG rowLength, ULONG level)
+			: m_blocks(pool), m_tail(pool), m_buffer(pool),
+			  m_rowLength(rowLength), m_blockRows(MAX(SPILL_BLOCK_SIZE / rowLength, 1)),
+			  m_level(level)
+		{}
+
+		ULONG getLevel() const
+		{
+			return m_level;
+		}
+
+		bool isEmpty() const
+		{
+			return m_blocks.isEmpty() && m_tail.isEmpty();
+		}
+
+		void add(TempSpace* space, const UCHAR* row)
+		{
+			m_tail.add(row, m_rowLength);
+
+			const FB_SIZE_T blockLength = m_blockRows * m_rowLength;
+
+			if (m_tail.getCount() == blockLength)
+			{
+				const offset_t offset = space->allocateSpace(blockLength);
+				space->write(offset, m_tail.begin(), blockLength);
+				m_blocks.add(offset);
+				m_tail.clear();
+			}
+		}
+
+		const UCHAR* fetch(TempSpace* space)
+		{
+			const FB_SIZE_T block = m_fetched / m_blockRows;
+			const FB_SIZE_T index = m_fetched % m_blockRows;
+			const UCHAR* row;
+
+			if (block < m_blocks.getCount())
+			{
+				const FB_SIZE_T blockLength = m_blockRows * m_rowLength;
+
+				if (!index)
+					space->read(m_blocks[block], m_buffer.getBuffer(blockLength, false), blockLength);
+
+				row = m_buffer.begin() + index * m_rowLength;
+			}
+			else if (index * m_rowLength < m_tail.getCount())
+				row = m_tail.begin() + index * m_rowLength;
+			else
+				return nullptr;
+
+			m_fetched++;
+			return row;
+		}
+
+		void release(TempSpace* space)
+		{
+			const FB_SIZE_T blockLength = m_blockRows * m_rowLength;
+
+			for (const auto offset : m_blocks)
+				space->releaseSpace(offset, blockLength);
+
+			m_blocks.free();
+			m_tail.free();
+			m_buffer.free();
+			m_fetched = 0;
+		}
+
+	private:
+		Array<offset_t> m_blocks;
+		Array<UCHAR> m_tail;
+		Array<UCHAR> m_buffer;
+		const ULONG m_rowLength;
+		const ULONG m_blockRows;
+		const ULONG m_level;
+		ULONG m_fetched = 0;
+	};
+
+public:
+	static const ULONG HEADER_LENGTH = FB_ALIGN(sizeof(Group), FB_ALIGNMENT);
+
+	GroupTable(MemoryPool& pool, ULONG keyLength, ULONG aggCount, ULONG stateLength,
+			   ULONG valueLength, FB_UINT64 memoryLimit)
+		: PermanentStorage(pool), m_buckets(pool), m_groups(pool), m_blocks(pool),
+		  m_row(pool), m_spills(pool), m_pending(pool),
+		  m_keyLength(keyLength), m_aggCount(aggCount),
+		  m_groupLength(HEADER_LENGTH + FB_ALIGN(keyLength, FB_ALIGNMENT) + stateLength),
+		  m_memoryLimit(memoryLimit)
+	{
+		m_row.getBuffer(sizeof(ULONG) + keyLength + valueLength);
+		m_buckets.grow(1 << MIN_HASH_BITS);
+	}
+
+	~GroupTable()
+	{
+		clear();
+
+		for (auto list : m_spills)
+			delete list;
+
+		for (auto list : m_pending)
+			delete list;
+
+		delete m_input;
+		delete m_space;
+	}
+
+	UCHAR* getKey()
+	{
+		return m_row.begin() + sizeof(ULONG);
+	}
+
+	UCHAR* getValues()
+	{
+		return getKey() + m_keyLength;
+	}
+
+	bool isReplaying() const
+	{
+		return (m_input != nullptr);
+	}
+
+	UCHAR* find(ULONG hash)
+	{
+		const UCHAR* const key = getKey();
+
+		for (Group* group = m_buckets[hash & (m_buckets.getCount() - 1)]; group; group = group->next)
+		{
+			if (group->hash == hash && !memcmp(getKey(group), key, m_keyLength))
+				return getState(group);
+		}
+
+		return nullptr;
+	}
+
+	// Add the group of the current key, unless the memory is exhausted
+	UCHAR* add(ULONG hash)
+	{
+		if (m_groups.hasData() && m_level < MAX_PARTITION_LEVEL &&
+			m_memoryUsed + m_groupLength > m_memoryLimit)
+		{
+			return nullptr;
+		}
+
+		if (m_groups.getCount() >= m_buckets.getCount())
+			rehash();
+
+		if (m_blockUsed + m_groupLength > m_blockLength)
+		{
+			m_blockLength = MAX(GROUP_BLOCK_SIZE, m_groupLength);
+			m_blocks.add(FB_NEW_POOL(getPool()) UCHAR[m_blockLength]);
+			m_blockUsed = 0;
+		}
+
+		Group* const group = reinterpret_cast<Group*>(m_blocks.back() + m_blockUsed);
+		m_blockUsed += m_groupLength;
+		m_memoryUsed += m_groupLength;
+
+		Group*& bucket = m_buckets[hash & (m_buckets.getCount() - 1)];
+		group->next = bucket;
+		group->hash = hash;
+		bucket = group;
+
+		memcpy(getKey(group), getKey(), m_keyLength);
+		m_groups.add(group);
+
+		return getState(group);
+	}
+
+	// Put aside the values of the current row, its group is not in memory
+	void spill(ULONG hash)
+	{
+		fb_assert(m_level < MAX_PARTITION_LEVEL);
+
+		if (!m_space)
+			m_space = FB_NEW_POOL(getPool()) TempSpace(getPool(), SCRATCH);
+
+		if (m_spills.isEmpty())
+		{
+			for (ULONG i = 0; i < (1 << PARTITION_BITS); i++)
+				m_spills.add(FB_NEW_POOL(getPool()) SpillList(getPool(), m_row.getCount(), m_level + 1));
+		}
+
+		const ULONG shift = 32 - PARTITION_BITS * (m_level + 1);
+		const ULONG partition = (hash >> shift) & ((1 << PARTITION_BITS) - 1);
+
+		memcpy(m_row.begin(), &hash, sizeof(ULONG));
+		m_spills[partition]->add(m_space, m_row.begin());
+	}
+
+	// Read the next spilled row of the partition being aggregated
+	bool fetch(ULONG& hash)
+	{
+		fb_assert(m_input);
+
+		const UCHAR* const row = m_input->fetch(m_space);
+
+		if (!row)
+			return false;
+
+		memcpy(m_row.begin(), row, m_row.getCount());
+		memcpy(&hash, row, sizeof(ULONG));
+		return true;
+	}
+
+	// Iterate the groups of the current partition
+	const UCHAR* getNextGroup()
+	{
+		if (m_position < m_groups.getCount())
+			return getState(m_groups[m_position++]);
+
+		return nullptr;
+	}
+
+	// Forget the groups returned already and switch to the next partition, if any
+	bool nextPartition()
+	{
+		clear();
+
+		for (auto list : m_spills)
+		{
+			if (list->isEmpty())
+				delete list;
+			else
+				m_pending.add(list);
+		}
+
+		m_spills.clear();
+
+		if (m_input)
+		{
+			m_input->release(m_space);
+			delete m_input;
+			m_input = nullptr;
+		}
+
+		if (m_pending.isEmpty())
+			return false;
+
+		m_input = m_pending.pop();
+		m_level = m_input->getLevel();
+		return true;
+	}
+
+private:
+	UCHAR* getKey(Group* group) const
+	{
+		return reinterpret_cast<UCHAR*>(group) + HEADER_LENGTH;
+	}
+
+	UCHAR* getState(Group* group) const
+	{
+		return getKey(group) + FB_ALIGN(m_keyLength, FB_ALIGNMENT);
+	}
+
+	void rehash()
+	{
+		const FB_SIZE_T count = m_buckets.getCount() * 2;
+
+		m_memoryUsed += count * sizeof(Group*) / 2;
+
+		m_buckets.clear();
+		m_buckets.grow(count);
+
+		for (auto group : m_groups)
+		{
+			Group*& bucket = m_buckets[group->hash & (count - 1)];
+			group->next = bucket;
+			bucket = group;
+		}
+	}
+
+	void clear()
+	{
+		// Values of MIN/MAX may be allocated by the aggregates
+
+		for (auto group : m_groups)
+		{
+			impure_value_ex* const state = reinterpret_cast<impure_value_ex*>(getState(group));
+
+			for (ULONG i = 0; i < m_aggCount; i++)
+				delete state[i].vlu_string;
+		}
+
+		for (auto block : m_blocks)
+			delete[] block;
+
+		m_blocks.clear();
+		m_groups.clear();
+		m_buckets.clear();
+		m_buckets.grow(1 << MIN_HASH_BITS);
+
+		m_blockLength = m_blockUsed = 0;
+		m_memoryUsed = 0;
+		m_position = 0;
+	}
+
+	Array<Group*> m_buckets;
+	Array<Group*> m_groups;
+	Array<UCHAR*> m_blocks;
+	Array<UCHAR> m_row;
+	Array<SpillList*> m_spills;		// partitions being spilled by the current level
+	Array<SpillList*> m_pending;	// partitions waiting to be aggregated
+	SpillList* m_input = nullptr;	// partition being aggregated
+	TempSpace* m_space = nullptr;
+	const ULONG m_keyLength;
+	const ULONG m_aggCount;
+	const ULONG m_groupLength;
+	const FB_UINT64 m_memoryLimit;
+	FB_UINT64 m_memoryUsed = 0;
+	ULONG m_blockLength = 0;
+	ULONG m_blockUsed = 0;
+	ULONG m_level = 0;
+	FB_SIZE_T m_position = 0;
+};
+
+
+HashAggregateStream::HashAggregateStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+			NestValueArray* group, MapNode* map, RecordSource* next)
+	: BaseAggWinStream(tdbb, csb, stream, group, map, false, next),
+	  m_keyLengths(csb->csb_pool), m_items(csb->csb_pool),
+	  m_totalKeyLength(0), m_aggCount(0)
+{
+	fb_assert(group && map);
+
+	// Every key part is prefixed with its NULL flag
+
+	for (auto& node : *group)
+	{
+		const ULONG keyLength = getKeyLength(tdbb, csb, node);
+		m_keyLengths.add(keyLength);
+		m_totalKeyLength += 1 + keyLength;
+	}
+
+	// The values to be spilled are the arguments of the aggregate functions
+	// and the other mapped expressions. Literal map items are assigned by
+	// initGroup(), but literal arguments (SUM(1), SUM(NULL)) are stored like
+	// any other argument, so passValues() sees their value and NULL flag.
+
+	Array<dsc> fields;
+
+	for (auto& source : map->sourceList)
+	{
+		MapItem item;
+		item.aggNode = nodeAs<AggNode>(source);
+		item.value = item.aggNode ? item.aggNode->arg.getObject() : source.getObject();
+		item.valueId = MAX_USHORT;
+
+		if (item.aggNode)
+		{
+			fb_assert(!item.aggNode->distinct);
+			fb_assert(item.aggNode->getCapabilities() & AggNode::CAP_HASHABLE_STATE);
+			m_aggCount++;
+		}
+
+		if (item.value && (item.aggNode || !nodeIs<LiteralNode>(item.value)))
+		{
+			dsc desc;
+			const_cast<ValueExprNode*>(item.value)->getDesc(tdbb, csb, &desc);
+			item.valueId = (USHORT) fields.getCount();
+			fields.add(desc);
+		}
+
+		m_items.add(item);
+	}
+
+	const FB_SIZE_T count = fields.getCount();
+	Format* const format = Format::newFormat(csb->csb_pool, count);
+	format->fmt_length = FLAG_BYTES(count);
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		dsc& desc = format->fmt_desc[i] = fields[i];
+
+		if (desc.dsc_dtype >= dtype_aligned)
+			format->fmt_length = FB_ALIGN(format->fmt_length, type_alignments[desc.dsc_dtype]);
+
+		desc.dsc_address = (UCHAR*)(IPTR) format->fmt_length;
+		format->fmt_length += desc.dsc_length;
+	}
+
+	m_valueFormat = format;
+}
+
+bool HashAggregateStream::isHashable(thread_db* tdbb, CompilerScratch* csb,
+	NestValueArray* group, MapNode* map)
+{
+	for (const auto& source : map->sourceList)
+	{
+		const auto aggNode = nodeAs<AggNode>(source);
+
+		if (aggNode &&
+			(aggNode->distinct || !(aggNode->getCapabilities() & AggNode::CAP_HASHABLE_STATE)))
+		{
+			return false;
+		}
+	}
+
+	// Keys are compared in their binary form
+
+	for (auto& node : *group)
+	{
+		dsc desc;
+		node->getDesc(tdbb, csb, &desc);
+
+		if (!desc.dsc_dtype || desc.isBlob())
+			return false;
+	}
+
+	return true;
+}
+
+ULONG HashAggregateStream::getGroupLength(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+	NestValueArray* group, MapNode* map)
+{
+	ULONG length = GroupTable::HEADER_LENGTH + sizeof(void*);	// the header and the bucket
+
+	for (auto& node : *group)
+		length += 1 + getKeyLength(tdbb, csb, node);
+
+	for (const auto& source : map->sourceList)
+	{
+		if (nodeIs<AggNode>(source))
+			length += sizeof(impure_value_ex);
+	}
+
+	const Format* const format = csb->csb_rpt[stream].csb_format;
+	fb_assert(format);
+
+	return length + format->fmt_length;
+}
+
+ULONG HashAggregateStream::getKeyLength(thread_db* tdbb, CompilerScratch* csb, ValueExprNode* node)
+{
+	dsc desc;
+	node->getDesc(tdbb, csb, &desc);
+
+	ULONG keyLength = desc.isText() ? desc.getStringLength() : desc.dsc_length;
+
+	if (IS_INTL_DATA(&desc))
+		keyLength = INTL_key_length(tdbb, INTL_INDEX_TYPE(&desc), keyLength);
+	else if (desc.isTime())
+		keyLength = sizeof(ISC_TIME);
+	else if (desc.isTimeStamp())
+		keyLength = sizeof(ISC_TIMESTAMP);
+	else if (desc.dsc_dtype == dtype_dec64)
+		keyLength = Decimal64::getKeyLength();
+	else if (desc.dsc_dtype == dtype_dec128)
+		keyLength = Decimal128::getKeyLength();
+
+	return keyLength;
+}
+
+void HashAggregateStream::internalOpen(thread_db* tdbb) const
+{
+	BaseAggWinStream::internalOpen(tdbb);
+
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = getImpure(request);
+
+	FB_UINT64 memoryLimit = tdbb->getDatabase()->dbb_config->getHashAggregateMemoryLimit();
+
+	if (!memoryLimit)
+		memoryLimit = MAX_UINT64;
+
+	delete impure->irsb_groups;
+
+	MemoryPool& pool = *tdbb->getDefaultPool();
+	impure->irsb_groups = FB_NEW_POOL(pool) GroupTable(pool, m_totalKeyLength, m_aggCount,
+		m_aggCount * sizeof(impure_value_ex) + m_format->fmt_length,
+		m_valueFormat->fmt_length, memoryLimit);
+}
+
+void HashAggregateStream::close(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = getImpure(request);
+
+	if (impure->irsb_flags & irsb_open)
+	{
+		delete impure->irsb_groups;
+		impure->irsb_groups = nullptr;
+	}
+
+	BaseAggWinStream::close(tdbb);
+}
+
+void HashAggregateStream::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
+{
+	m_next->getLegacyPlan(tdbb, plan, level);
+}
+
+void HashAggregateStream::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const
+{
+	planEntry.className = "HashAggregateStream";
+
+	planEntry.lines.add().text = "Hash Aggregate";
+	printOptInfo(planEntry.lines);
+
+	if (recurse)
+	{
+		++level;
+		m_next->getPlan(tdbb, planEntry.children.add(), level, recurse);
+	}
+}
+
+bool HashAggregateStream::internalGetRecord(thread_db* tdbb) const
+{
+	JRD_reschedule(tdbb);
+
+	Request* const request = tdbb->getRequest();
+	record_param* const rpb = &request->req_rpb[m_stream];
+	Impure* const impure = getImpure(request);
+
+	if (!(impure->irsb_flags & irsb_open))
+	{
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
+	GroupTable* const groups = impure->irsb_groups;
+
+	// STATE_GROUPING means the input (or a spilled partition) is to be aggregated,
+	// STATE_FETCHED means the aggregated groups are being returned
+
+	while (impure->state != STATE_EOF)
+	{
+		if (impure->state == STATE_GROUPING)
+		{
+			aggregate(tdbb, request, groups);
+			impure->state = STATE_FETCHED;
+		}
+
+		const UCHAR* const state = groups->getNextGroup();
+
+		if (state)
+		{
+			restoreState(request, state);
+
+			Record* const record = rpb->rpb_record;
+			memcpy(record->getData(), state + m_aggCount * sizeof(impure_value_ex), record->getLength());
+
+			aggExecute(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+
+			rpb->rpb_number.setValid(true);
+			return true;
+		}
+
+		impure->state = groups->nextPartition() ? STATE_GROUPING : STATE_EOF;
+	}
+
+	rpb->rpb_number.setValid(false);
+	return false;
+}
+
+// Compute the binary comparable key of the group and return its hash value
+ULONG HashAggregateStream::computeKey(thread_db* tdbb, Request* request, UCHAR* keyBuffer) const
+{
+	memset(keyBuffer, 0, m_totalKeyLength);
+
+	UCHAR* keyPtr = keyBuffer;
+
+	for (FB_SIZE_T i = 0; i < m_group->getCount(); i++)
+	{
+		dsc* const desc = EVL_expr(tdbb, request, (*m_group)[i]);
+		const ULONG keyLength = m_keyLengths[i];
+
+		if (!desc || (request->req_flags & req_null))
+		{
+			*keyPtr = 1;
+			keyPtr += 1 + keyLength;
+			continue;
+		}
+
+		keyPtr++;
+
+		if (desc->isText())
+		{
+			dsc to;
+			to.makeText(keyLength, desc->getTextType(), keyPtr);
+
+			if (IS_INTL_DATA(desc))
+			{
+				// Convert the INTL string into the binary comparable form
+				INTL_string_to_key(tdbb, INTL_INDEX_TYPE(desc),
+								   desc, &to, INTL_KEY_UNIQUE);
+			}
+			else
+			{
+				// This call ensures that the padding bytes are appended
+				MOV_move(tdbb, desc, &to, true);
+			}
+		}
+		else
+		{
+			const auto data = desc->dsc_address;
+
+			if (desc->isDecFloat())
+			{
+				// Values inside our key buffer are not aligned,
+				// so ensure we satisfy our platform's alignment rules
+				OutAligner<ULONG, MAX_DEC_KEY_LONGS> key(keyPtr, keyLength);
+
+				if (desc->dsc_dtype == dtype_dec64)
+					((Decimal64*) data)->makeKey(key);
+				else if (desc->dsc_dtype == dtype_dec128)
+					((Decimal128*) data)->makeKey(key);
+				else
+					fb_assert(false);
+			}
+			else if (desc->dsc_dtype == dtype_real && *(float*) data == 0)
+			{
+				fb_assert(keyLength == sizeof(float));
+				memset(keyPtr, 0, keyLength); // positive zero in binary
+			}
+			else if (desc->dsc_dtype == dtype_double && *(double*) data == 0)
+			{
+				fb_assert(keyLength == sizeof(double));
+				memset(keyPtr, 0, keyLength); // positive zero in binary
+			}
+			else
+			{
+				// Note: for date/time with time zone, we copy only the UTC part.
+				fb_assert(keyLength <= desc->dsc_length);
+				memcpy(keyPtr, data, keyLength);
+			}
+		}
+
+		keyPtr += keyLength;
+	}
+
+	fb_assert(keyPtr - keyBuffer == m_totalKeyLength);
+
+	return InternalHash::hash(m_totalKeyLength, keyBuffer);
+}
+
+// Evaluate the mapped values of the current record, so they could be spilled
+void HashAggregateStream::storeValues(thread_db* tdbb, Request* request, UCHAR* values) const
+{
+	memset(values, 0, m_valueFormat->fmt_length);
+
+	for (const auto& item : m_items)
+	{
+		if (item.valueId == MAX_USHORT)
+			continue;
+
+		dsc* const desc = EVL_expr(tdbb, request, item.value);
+
+		if (!desc || (request->req_flags & req_null))
+			setNullValue(values, item.valueId);
+		else
+		{
+			dsc to = m_valueFormat->fmt_desc[item.valueId];
+			to.dsc_address = values + (IPTR) to.dsc_address;
+			MOV_move(tdbb, desc, &to);
+		}
+	}
+}
+
+// Aggregate the input stream or the spilled partition, whatever is current
+void HashAggregateStream::aggregate(thread_db* tdbb, Request* request, GroupTable* groups) const
+{
+	UCHAR* const key = groups->getKey();
+	UCHAR* const values = groups->getValues();
+
+	while (true)
+	{
+		ULONG hash;
+
+		if (groups->isReplaying())
+		{
+			JRD_reschedule(tdbb);
+
+			if (!groups->fetch(hash))
+				break;
+		}
+		else
+		{
+			if (!m_next->getRecord(tdbb))
+				break;
+
+			hash = computeKey(tdbb, request, key);
+			storeValues(tdbb, request, values);
+		}
+
+		UCHAR* state = groups->find(hash);
+
+		if (!state)
+		{
+			if (!(state = groups->add(hash)))
+			{
+				groups->spill(hash);
+				continue;
+			}
+
+			initGroup(tdbb, request, state, values);
+		}
+
+		passValues(tdbb, request, state, values);
+	}
+}
+
+// Set up the aggregates and the output record of the new group
+void HashAggregateStream::initGroup(thread_db* tdbb, Request* request, UCHAR* state,
+	const UCHAR* values) const
+{
+	Record* const record = request->req_rpb[m_stream].rpb_record;
+	record->nullify();
+
+	impure_value_ex* aggState = reinterpret_cast<impure_value_ex*>(state);
+	const NestConst<ValueExprNode>* target = m_groupMap->targetList.begin();
+	const NestConst<ValueExprNode>* source = m_groupMap->sourceList.begin();
+
+	for (const auto& item : m_items)
+	{
+		if (item.aggNode)
+		{
+			// The state of a previous group isn't owned by the impure anymore
+
+			impure_value_ex* const impure = request->getImpure<impure_value_ex>(item.aggNode->impureOffset);
+			memset(impure, 0, sizeof(impure_value_ex));
+			item.aggNode->aggInit(tdbb, request);
+			memcpy(aggState++, impure, sizeof(impure_value_ex));
+		}
+		else if (item.valueId == MAX_USHORT)
+			EXE_assignment(tdbb, *source, *target);
+		else
+		{
+			dsc desc = m_valueFormat->fmt_desc[item.valueId];
+			desc.dsc_address = const_cast<UCHAR*>(values) + (IPTR) desc.dsc_address;
+			EXE_assignment(tdbb, *target, &desc, isNullValue(values, item.valueId), nullptr, nullptr);
+		}
+
+		++source;
+		++target;
+	}
+
+	memcpy(state + m_aggCount * sizeof(impure_value_ex), record->getData(), record->getLength());
+}
+
+// Accumulate the values into the group aggregates
+void HashAggregateStream::passValues(thread_db* tdbb, Request* request, UCHAR* state,
+	const UCHAR* values) const
+{
+	impure_value_ex* aggState = reinterpret_cast<impure_value_ex*>(state);
+
+	for (const auto& item : m_items)
+	{
+		if (!item.aggNode)
+			continue;
+
+		if (item.valueId == MAX_USHORT || !isNullValue(values, item.valueId))
+		{
+			impure_value_ex* const impure = request->getImpure<impure_value_ex>(item.aggNode->impureOffset);
+			memcpy(impure, aggState, sizeof(impure_value_ex));
+
+			if (item.valueId == MAX_USHORT)
+			{
+				// Only an aggregate without an argument, i.e. COUNT(*)
+				fb_assert(!item.value);
+				item.aggNode->aggPass(tdbb, request, nullptr);
+			}
+			else
+			{
+				dsc desc = m_valueFormat->fmt_desc[item.valueId];
+				desc.dsc_address = const_cast<UCHAR*>(values) + (IPTR) desc.dsc_address;
+				item.aggNode->aggPass(tdbb, request, &desc);
+			}
+
+			memcpy(aggState, impure, sizeof(impure_value_ex));
+		}
+
+		aggState++;
+	}
+}
+
+// Put the group aggregates into the impure of the request, as aggExecute() expects
+void HashAggregateStream::restoreState(Request* request, const UCHAR* state) const
+{
+	const impure_value_ex* aggState = reinterpret_cast<const impure_value_ex*>(state);
+
+	for (const auto& item : m_items)
+	{
+		if (item.aggNode)
+		{
+			impure_value_ex* const impure = request->getImpure<impure_value_ex>(item.aggNode->impureOffset);
+			memcpy(impure, aggState++, sizeof(impure_value_ex));
+		}
+	}
+}
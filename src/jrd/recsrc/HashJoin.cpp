@@ -39,225 +39,512 @@ using namespace Jrd;
 
 //#define PRINT_HASH_TABLE
 
+static const char* const SCRATCH = "fb_hash_";
+
 // ----------------------
 // Data access: hash join
 // ----------------------
 
-// NS: FIXME - Why use static hash table here??? Hash table shall support dynamic resizing
-static const ULONG HASH_SIZE = 1009;
-static const ULONG BUCKET_PREALLOCATE_SIZE = 32;	// 256 bytes per bucket
+// The hash table is bucketized per inner stream and sized after the stream
+// is read, so it keeps about one row per bucket regardless of the row count.
+static const ULONG MIN_HASH_BITS = 4;
+static const ULONG MAX_HASH_BITS = 30;
+static const ULONG MAX_PREALLOCATE_SIZE = 1024 * 1024;	// 8MB of entries per stream
+static const ULONG MAX_HASH_CAPACITY = 16 * 1024 * 1024;
+
+// If the build side exceeds HashJoinMemoryLimit, both inputs are split into
+// partitions by hash and only one partition is kept in memory at a time
+static const ULONG MAX_PARTITION_BITS = 7;			// 128 partitions
+static const ULONG SPILL_BLOCK_ENTRIES = 512;		// 4KB per block
 
-unsigned HashJoin::maxCapacity()
+unsigned HashJoin::maxCapacity(thread_db* tdbb)
 {
-	// Binary search across 1000 collisions is computationally similar to
-	// linear search across 10 collisions. We use this number as a rough
-	// estimation of whether the lookup performance is likely to be acceptable.
-	return HASH_SIZE * 1000;
+	// The spilled hash join is limited only by the size of temporary space
+	// and by the number of positions addressable inside the buffered stream
+	if (tdbb->getDatabase()->dbb_config->getHashJoinMemoryLimit())
+		return MAX_ULONG;
+
+	// Lookup cost does not depend on the number of hashed rows, as the bucket
+	// count follows the row count. The limit protects the memory: every hashed
+	// row costs up to 16 bytes in the table and up to 24 bytes while it's built.
+	return MAX_HASH_CAPACITY;
 }
 
 
 class HashJoin::HashTable : public PermanentStorage
 {
-	class CollisionList
+	// The hash is stored next to the record position, so non-matching rows
+	// are skipped without touching the buffered records. Multi-column keys are
+	// hashed once as a whole, and the stored hash is used to place the entry
+	// when the buckets are built, so the keys are never rehashed.
+	struct Entry
 	{
-		static const FB_SIZE_T INVALID_ITERATOR = FB_SIZE_T(~0);
+		Entry()
+			: hash(0), position(0)
+		{}
 
-		struct Entry
-		{
-			Entry()
-				: hash(0), position(0)
-			{}
+		Entry(ULONG h, ULONG pos)
+			: hash(h), position(pos)
+		{}
 
-			Entry(ULONG h, ULONG pos)
-				: hash(h), position(pos)
-			{}
+		ULONG hash;
+		ULONG position;
+	};
 
-			static const ULONG generate(const Entry& item)
-			{
-				return item.hash;
-			}
+	class StreamTable
+	{
+	public:
+		explicit StreamTable(MemoryPool& pool)
+			: m_pending(pool), m_entries(pool), m_offsets(pool)
+		{}
 
-			ULONG hash;
-			ULONG position;
-		};
+		Array<Entry>& getPending()
+		{
+			fb_assert(!m_offsets.hasData());
+			return m_pending;
+		}
 
-	public:
-		CollisionList(MemoryPool& pool)
-			: m_collisions(pool, BUCKET_PREALLOCATE_SIZE),
-			  m_iterator(INVALID_ITERATOR)
+		void reserve(ULONG count)
 		{
-			m_collisions.setSortMode(FB_ARRAY_SORT_MANUAL);
+			m_pending.ensureCapacity(count);
 		}
 
-		void sort()
+		void add(ULONG hash, ULONG position)
 		{
-			m_collisions.sort();
+			fb_assert(!m_offsets.hasData());
+			m_pending.add(Entry(hash, position));
 		}
 
-		ULONG getCount() const
+		void clear()
 		{
-			return (ULONG) m_collisions.getCount();
+			m_pending.free();
+			m_entries.free();
+			m_offsets.free();
+			m_iterator = m_end = 0;
 		}
 
-		void add(ULONG hash, ULONG position)
+		void build()
 		{
-			m_collisions.add(Entry(hash, position));
+			const ULONG count = m_pending.getCount();
+
+			ULONG bits = MIN_HASH_BITS;
+			while (bits < MAX_HASH_BITS && (1U << bits) < count)
+				bits++;
+
+			m_shift = 32 - bits;
+			const ULONG size = 1U << bits;
+
+			// Lay out the entries bucket by bucket (counting sort by slot),
+			// bucket N occupies m_entries[m_offsets[N] .. m_offsets[N + 1]).
+			// Entries inside the bucket keep their original order, so the
+			// buffered stream is still read forward while iterating collisions.
+
+			ULONG* const offsets = m_offsets.getBuffer(size + 1, false);
+			memset(offsets, 0, (size + 1) * sizeof(ULONG));
+
+			const Entry* const pending = m_pending.begin();
+
+			for (ULONG i = 0; i < count; i++)
+				offsets[getSlot(pending[i].hash) + 1]++;
+
+			for (ULONG i = 0; i < size; i++)
+				offsets[i + 1] += offsets[i];
+
+			Entry* const entries = m_entries.getBuffer(count, false);
+
+			for (ULONG i = 0; i < count; i++)
+				entries[offsets[getSlot(pending[i].hash)]++] = pending[i];
+
+			// Every offset was moved to the start of the next bucket, restore them
+			memmove(offsets + 1, offsets, size * sizeof(ULONG));
+			offsets[0] = 0;
+
+			m_pending.free();
+
+#ifdef PRINT_HASH_TABLE
+			ULONG used = 0, max = 0;
+
+			for (ULONG i = 0; i < size; i++)
+			{
+				const ULONG cnt = offsets[i + 1] - offsets[i];
+
+				if (cnt)
+					used++;
+				if (cnt > max)
+					max = cnt;
+			}
+
+			printf("Hash table size %u, count %u, buckets %u, max %u\n",
+				   size, count, used, max);
+#endif
 		}
 
 		bool locate(ULONG hash)
 		{
-			if (m_collisions.find(hash, m_iterator))
-				return true;
+			const ULONG slot = getSlot(hash);
+			const Entry* const entries = m_entries.begin();
 
-			m_iterator = INVALID_ITERATOR;
-			return false;
+			m_iterator = m_offsets[slot];
+			m_end = m_offsets[slot + 1];
+
+			while (m_iterator < m_end && entries[m_iterator].hash != hash)
+				m_iterator++;
+
+			return (m_iterator < m_end);
 		}
 
 		bool iterate(ULONG hash, ULONG& position)
 		{
-			if (m_iterator >= m_collisions.getCount())
-				return false;
+			const Entry* const entries = m_entries.begin();
 
-			const Entry& collision = m_collisions[m_iterator++];
+			while (m_iterator < m_end)
+			{
+				const Entry& entry = entries[m_iterator++];
 
-			if (hash != collision.hash)
+				if (entry.hash == hash)
+				{
+					position = entry.position;
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+	private:
+		ULONG getSlot(ULONG hash) const
+		{
+			// Multiplicative hashing spreads poorly distributed hash values
+			// (e.g. produced by the non-CRC hash function) across the high bits
+			return (hash * 0x9E3779B1U) >> m_shift;
+		}
+
+		Array<Entry> m_pending;
+		Array<Entry> m_entries;
+		Array<ULONG> m_offsets;
+		ULONG m_shift = 32 - MIN_HASH_BITS;
+		ULONG m_iterator = 0;
+		ULONG m_end = 0;
+	};
+
+	// Entries of the partition which is not in memory. Full blocks are written
+	// into the temporary space, the last incomplete block is kept in memory.
+	class SpillList
+	{
+		static const FB_SIZE_T BLOCK_SIZE = SPILL_BLOCK_ENTRIES * sizeof(Entry);
+
+	public:
+		explicit SpillList(MemoryPool& pool)
+			: m_blocks(pool), m_tail(pool), m_buffer(pool)
+		{}
+
+		bool isEmpty() const
+		{
+			return m_blocks.isEmpty() && m_tail.isEmpty();
+		}
+
+		ULONG getCount() const
+		{
+			return m_blocks.getCount() * SPILL_BLOCK_ENTRIES + m_tail.getCount();
+		}
+
+		void add(TempSpace* space, const Entry& entry)
+		{
+			m_tail.add(entry);
+
+			if (m_tail.getCount() == SPILL_BLOCK_ENTRIES)
 			{
-				m_iterator = INVALID_ITERATOR;
-				return false;
+				const offset_t offset = space->getSize();
+				space->write(offset, m_tail.begin(), BLOCK_SIZE);
+				m_blocks.add(offset);
+				m_tail.clear();
 			}
+		}
+
+		bool fetch(TempSpace* space, Entry& entry)
+		{
+			const FB_SIZE_T block = m_fetched / SPILL_BLOCK_ENTRIES;
+			const FB_SIZE_T index = m_fetched % SPILL_BLOCK_ENTRIES;
+
+			if (block < m_blocks.getCount())
+			{
+				if (!index)
+				{
+					const auto buffer = m_buffer.getBuffer(SPILL_BLOCK_ENTRIES, false);
+					space->read(m_blocks[block], buffer, BLOCK_SIZE);
+				}
 
-			position = collision.position;
+				entry = m_buffer[index];
+			}
+			else if (index < m_tail.getCount())
+				entry = m_tail[index];
+			else
+				return false;
+
+			m_fetched++;
 			return true;
 		}
 
+		void release()
+		{
+			m_blocks.free();
+			m_tail.free();
+			m_buffer.free();
+			m_fetched = 0;
+		}
+
 	private:
-		SortedArray<Entry, EmptyStorage<Entry>, ULONG, Entry> m_collisions;
-		FB_SIZE_T m_iterator;
+		Array<offset_t> m_blocks;
+		Array<Entry> m_tail;
+		Array<Entry> m_buffer;
+		ULONG m_fetched = 0;
 	};
 
 public:
-	HashTable(MemoryPool& pool, ULONG streamCount, ULONG tableSize = HASH_SIZE)
-		: PermanentStorage(pool), m_streamCount(streamCount),
-		  m_tableSize(tableSize), m_slot(0)
+	HashTable(MemoryPool& pool, ULONG streamCount, FB_UINT64 memoryLimit)
+		: PermanentStorage(pool), m_streams(pool), m_rowLengths(pool),
+		  m_spilled(pool), m_memoryLimit(memoryLimit)
 	{
-		m_collisions = FB_NEW_POOL(pool) CollisionList*[streamCount * tableSize];
-		memset(m_collisions, 0, streamCount * tableSize * sizeof(CollisionList*));
+		for (ULONG i = 0; i < streamCount; i++)
+		{
+			m_streams.add();
+			m_rowLengths.add(sizeof(Entry));
+		}
 	}
 
-	~HashTable()
+	void reserve(ULONG stream, double cardinality, ULONG recordLength)
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
-			delete m_collisions[i];
+		fb_assert(stream < m_streams.getCount());
+
+		// Account the buffered record along with its hash table entry
+		m_rowLengths[stream] = sizeof(Entry) + recordLength;
+		m_expectedSize += (FB_UINT64) (cardinality * m_rowLengths[stream]);
+
+		// Preallocate from the optimizer estimation, but don't trust it too much
+		const ULONG count = (cardinality < MAX_PREALLOCATE_SIZE) ?
+			(ULONG) cardinality : MAX_PREALLOCATE_SIZE;
 
-		delete[] m_collisions;
+		m_streams[stream].reserve(count);
 	}
 
 	void put(ULONG stream, ULONG hash, ULONG position)
 	{
-		const ULONG slot = hash % m_tableSize;
+		fb_assert(stream < m_streams.getCount());
 
-		fb_assert(stream < m_streamCount);
-		fb_assert(slot < m_tableSize);
+		if (m_partitionBits)
+		{
+			const ULONG partition = getPartition(hash);
 
-		CollisionList* collisions = m_collisions[stream * m_tableSize + slot];
+			if (partition != m_partition)
+			{
+				getSpillList(partition, stream).add(m_space, Entry(hash, position));
+				return;
+			}
+		}
+
+		m_streams[stream].add(hash, position);
 
-		if (!collisions)
+		if (!m_partitionBits && m_memoryLimit)
 		{
-			collisions = FB_NEW_POOL(getPool()) CollisionList(getPool());
-			m_collisions[stream * m_tableSize + slot] = collisions;
+			m_memoryUsed += m_rowLengths[stream];
+
+			if (m_memoryUsed > m_memoryLimit)
+				spill();
 		}
+	}
 
-		collisions->add(hash, position);
+	void build()
+	{
+		for (auto& table : m_streams)
+			table.build();
 	}
 
-	bool setup(ULONG hash)
+	bool isSpilled() const
+	{
+		return (m_partitionBits != 0);
+	}
+
+	// Leading records are probed immediately only if their partition is in memory.
+	// Others are deferred and replayed after the whole leading stream is read.
+
+	bool isReplaying() const
+	{
+		return m_replaying;
+	}
+
+	bool isResident(ULONG hash) const
+	{
+		fb_assert(!m_replaying);
+		return (getPartition(hash) == m_partition);
+	}
+
+	void defer(ULONG hash, ULONG position)
 	{
-		const ULONG slot = hash % m_tableSize;
+		const ULONG leader = m_streams.getCount();
+		getSpillList(getPartition(hash), leader).add(m_space, Entry(hash, position));
+	}
 
-		for (ULONG i = 0; i < m_streamCount; i++)
+	bool fetchDeferred(ULONG& hash, ULONG& position)
+	{
+		fb_assert(isSpilled());
+
+		const ULONG leader = m_streams.getCount();
+		const ULONG partitionCount = 1U << m_partitionBits;
+
+		while (m_partition < partitionCount)
 		{
-			CollisionList* const collisions = m_collisions[i * m_tableSize + slot];
+			if (m_replaying)
+			{
+				SpillList& list = getSpillList(m_partition, leader);
 
-			if (!collisions)
-				return false;
+				Entry entry;
+				if (list.fetch(m_space, entry))
+				{
+					hash = entry.hash;
+					position = entry.position;
+					return true;
+				}
 
-			if (!collisions->locate(hash))
+				list.release();
+			}
+
+			m_replaying = true;
+
+			// Switch to the next partition having deferred leading records
+			while (++m_partition < partitionCount)
+			{
+				if (!getSpillList(m_partition, leader).isEmpty())
+				{
+					load(m_partition);
+					break;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	bool setup(ULONG hash)
+	{
+		for (auto& table : m_streams)
+		{
+			if (!table.locate(hash))
 				return false;
 		}
 
-		m_slot = slot;
 		return true;
 	}
 
 	void reset(ULONG stream, ULONG hash)
 	{
-		fb_assert(stream < m_streamCount);
-
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		collisions->locate(hash);
+		fb_assert(stream < m_streams.getCount());
+		m_streams[stream].locate(hash);
 	}
 
 	bool iterate(ULONG stream, ULONG hash, ULONG& position)
 	{
-		fb_assert(stream < m_streamCount);
+		fb_assert(stream < m_streams.getCount());
+		return m_streams[stream].iterate(hash, position);
+	}
 
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		return collisions->iterate(hash, position);
+private:
+	ULONG getPartition(ULONG hash) const
+	{
+		// Use another multiplier than StreamTable does, otherwise all entries
+		// of the partition would fall into the same range of buckets
+		return m_partitionBits ? (hash * 0x85EBCA6BU) >> (32 - m_partitionBits) : 0;
+	}
+
+	SpillList& getSpillList(ULONG partition, ULONG stream)
+	{
+		return m_spilled[partition * (m_streams.getCount() + 1) + stream];
 	}
 
-	void sort()
+	void spill()
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
+		// Estimate the final size, but don't trust the optimizer too much
+		const FB_UINT64 expectedSize = MAX(m_expectedSize, m_memoryUsed * 2);
+
+		ULONG bits = 1;
+		while (bits < MAX_PARTITION_BITS && (expectedSize >> bits) > m_memoryLimit)
+			bits++;
+
+		m_partitionBits = bits;
+		m_partition = 0;
+
+		const ULONG listCount = (1U << bits) * (m_streams.getCount() + 1);
+
+		for (ULONG i = 0; i < listCount; i++)
+			m_spilled.add();
+
+		m_space = FB_NEW_POOL(getPool()) TempSpace(getPool(), SCRATCH);
+
+		// Move the collected entries of other partitions out of memory
+
+		for (ULONG stream = 0; stream < m_streams.getCount(); stream++)
 		{
-			if (const auto collisions = m_collisions[i])
-				collisions->sort();
+			Array<Entry>& entries = m_streams[stream].getPending();
+			FB_SIZE_T count = 0;
+
+			for (const auto& entry : entries)
+			{
+				const ULONG partition = getPartition(entry.hash);
+
+				if (partition == m_partition)
+					entries[count++] = entry;
+				else
+					getSpillList(partition, stream).add(m_space, entry);
+			}
+
+			entries.shrink(count);
 		}
 
 #ifdef PRINT_HASH_TABLE
-		FB_UINT64 total = 0;
-		ULONG min = MAX_ULONG, max = 0, count = 0;
+		printf("Hash table spilled into %u partitions\n", 1U << bits);
+#endif
+	}
 
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
+	void load(ULONG partition)
+	{
+		for (ULONG stream = 0; stream < m_streams.getCount(); stream++)
 		{
-			CollisionList* const collisions = m_collisions[i];
-			if (!collisions)
-				continue;
-
-			const auto cnt = collisions->getCount();
-
-			if (cnt < min)
-				min = cnt;
-			if (cnt > max)
-				max = cnt;
-			total += cnt;
-			count++;
-		}
+			StreamTable& table = m_streams[stream];
+			SpillList& list = getSpillList(partition, stream);
 
-		if (count)
-		{
-			printf("Hash table size %u, count %u, buckets %u, min %u, max %u, avg %u\n",
-				   m_tableSize, (ULONG) total, count, min, max, (ULONG) (total / count));
+			table.clear();
+			table.reserve(list.getCount());
+
+			Entry entry;
+			while (list.fetch(m_space, entry))
+				table.add(entry.hash, entry.position);
+
+			list.release();
+			table.build();
 		}
-#endif
 	}
 
-private:
-	const ULONG m_streamCount;
-	const ULONG m_tableSize;
-	CollisionList** m_collisions;
-	ULONG m_slot;
+	ObjectsArray<StreamTable> m_streams;
+	Array<ULONG> m_rowLengths;
+	ObjectsArray<SpillList> m_spilled;
+	AutoPtr<TempSpace> m_space;
+	const FB_UINT64 m_memoryLimit;
+	FB_UINT64 m_memoryUsed = 0;
+	FB_UINT64 m_expectedSize = 0;
+	ULONG m_partitionBits = 0;
+	ULONG m_partition = 0;
+	bool m_replaying = false;
 };
 
 
 HashJoin::HashJoin(thread_db* tdbb, CompilerScratch* csb, JoinType joinType,
 				   FB_SIZE_T count, RecordSource* const* args, NestValueArray* const* keys,
-				   double selectivity)
+				   double selectivity, bool preserveOrder)
 	: Join(csb, count, joinType),
 	  m_subs(csb->csb_pool, count - 1)
 {
 	fb_assert(count >= 2);
 
-	init(tdbb, csb, count, args, keys, selectivity);
+	init(tdbb, csb, count, args, keys, selectivity, preserveOrder);
 }
 
 HashJoin::HashJoin(thread_db* tdbb, CompilerScratch* csb,
@@ -267,12 +554,12 @@ HashJoin::HashJoin(thread_db* tdbb, CompilerScratch* csb,
 	: Join(csb, 2, JoinType::OUTER, boolean),
 	  m_subs(csb->csb_pool, 1)
 {
-	init(tdbb, csb, 2, args, keys, selectivity);
+	init(tdbb, csb, 2, args, keys, selectivity, false);
 }
 
 void HashJoin::init(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 					RecordSource* const* args, NestValueArray* const* keys,
-					double selectivity)
+					double selectivity, bool preserveOrder)
 {
 	m_impure = csb->allocImpure<Impure>();
 
@@ -355,6 +642,12 @@ void HashJoin::init(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 		selectivity = pow(REDUCE_SELECTIVITY_FACTOR_EQUALITY, keyCount);
 
 	m_cardinality *= selectivity;
+
+	// Spilling replays the leading records partition by partition,
+	// so it's impossible if their order is expected to be preserved
+
+	if (!preserveOrder && tdbb->getDatabase()->dbb_config->getHashJoinMemoryLimit())
+		m_leaderBuffer = FB_NEW_POOL(csb->csb_pool) BufferedStream(csb, m_leader.source);
 }
 
 void HashJoin::internalOpen(thread_db* tdbb) const
@@ -370,7 +663,13 @@ void HashJoin::internalOpen(thread_db* tdbb) const
 	delete[] impure->irsb_leader_buffer;
 	impure->irsb_leader_buffer = nullptr;
 
-	m_leader.source->open(tdbb);
+	// If the join may spill, the leading stream is opened after the hash table
+	// is built, as only then we know whether its records are to be buffered
+
+	if (m_leaderBuffer)
+		m_leaderBuffer->close(tdbb);
+	else
+		m_leader.source->open(tdbb);
 }
 
 void HashJoin::close(thread_db* tdbb) const
@@ -386,6 +685,9 @@ void HashJoin::close(thread_db* tdbb) const
 
 		Join::close(tdbb);
 
+		if (m_leaderBuffer)
+			m_leaderBuffer->close(tdbb);
+
 		delete impure->irsb_hash_table;
 		impure->irsb_hash_table = nullptr;
 
@@ -410,12 +712,16 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 	{
 		if (impure->irsb_flags & irsb_mustread)
 		{
+			if (m_leaderBuffer && !impure->irsb_hash_table)
+				buildHashTable(tdbb, impure);
+
 			// Fetch the record from the leading stream
 
-			if (!m_leader.source->getRecord(tdbb))
+			bool matchable;
+			if (!fetchLeader(tdbb, impure, matchable))
 				return false;
 
-			if (m_boolean && !m_boolean->execute(tdbb, request))
+			if (!matchable)
 			{
 				// The boolean pertaining to the left sub-stream is false
 				// so just join sub-stream to a null valued right sub-stream
@@ -425,41 +731,18 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 
 			// We have something to join with, so ensure the hash table is initialized
 
-			if (!impure->irsb_hash_table && !impure->irsb_leader_buffer)
-			{
-				auto& pool = *tdbb->getDefaultPool();
-				const auto argCount = m_subs.getCount();
-
-				impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount);
-				impure->irsb_leader_buffer = FB_NEW_POOL(pool) UCHAR[m_leader.totalKeyLength];
-
-				UCharBuffer buffer(pool);
+			if (!impure->irsb_hash_table)
+				buildHashTable(tdbb, impure);
 
-				for (FB_SIZE_T i = 0; i < argCount; i++)
-				{
-					// Read and cache the inner streams. While doing that,
-					// hash the join condition values and populate hash tables.
-
-					m_subs[i].buffer->open(tdbb);
+			// Compute and hash the comparison keys, unless it was already done
+			// while distributing the leading records among partitions
 
-					ULONG counter = 0;
-					const auto keyBuffer = buffer.getBuffer(m_subs[i].totalKeyLength, false);
-
-					while (m_subs[i].buffer->getRecord(tdbb))
-					{
-						const auto hash = computeHash(tdbb, request, m_subs[i], keyBuffer);
-						impure->irsb_hash_table->put(i, hash, counter++);
-					}
-				}
-
-				impure->irsb_hash_table->sort();
+			if (!impure->irsb_hash_table->isSpilled())
+			{
+				impure->irsb_leader_hash =
+					computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
 			}
 
-			// Compute and hash the comparison keys
-
-			impure->irsb_leader_hash =
-				computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
-
 			// Ensure the every inner stream having matches for this hash slot.
 			// Setup the hash table for the iteration through collisions.
 
@@ -667,3 +950,109 @@ bool HashJoin::fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) co
 		}
 	}
 }
+
+void HashJoin::buildHashTable(thread_db* tdbb, Impure* impure) const
+{
+	Request* const request = tdbb->getRequest();
+
+	auto& pool = *tdbb->getDefaultPool();
+	const auto argCount = m_subs.getCount();
+
+	const FB_UINT64 memoryLimit = m_leaderBuffer ?
+		tdbb->getDatabase()->dbb_config->getHashJoinMemoryLimit() : 0;
+
+	impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount, memoryLimit);
+	impure->irsb_leader_buffer = FB_NEW_POOL(pool) UCHAR[m_leader.totalKeyLength];
+
+	UCharBuffer buffer(pool);
+
+	for (FB_SIZE_T i = 0; i < argCount; i++)
+	{
+		// Read and cache the inner streams. While doing that,
+		// hash the join condition values and populate hash tables.
+
+		const auto sub = m_subs[i].buffer;
+		sub->open(tdbb);
+
+		ULONG counter = 0;
+		const auto keyBuffer = buffer.getBuffer(m_subs[i].totalKeyLength, false);
+
+		impure->irsb_hash_table->reserve(i, sub->getCardinality(), sub->getRecordLength());
+
+		while (sub->getRecord(tdbb))
+		{
+			const auto hash = computeHash(tdbb, request, m_subs[i], keyBuffer);
+			impure->irsb_hash_table->put(i, hash, counter++);
+		}
+	}
+
+	impure->irsb_hash_table->build();
+
+	if (m_leaderBuffer)
+	{
+		// Leading records of the partitions not being in memory
+		// must be buffered to be processed later
+
+		if (impure->irsb_hash_table->isSpilled())
+			m_leaderBuffer->open(tdbb);
+		else
+			m_leader.source->open(tdbb);
+	}
+}
+
+bool HashJoin::fetchLeader(thread_db* tdbb, Impure* impure, bool& matchable) const
+{
+	Request* const request = tdbb->getRequest();
+	HashTable* const hashTable = impure->irsb_hash_table;
+
+	if (!hashTable || !hashTable->isSpilled())
+	{
+		if (!m_leader.source->getRecord(tdbb))
+			return false;
+
+		matchable = (!m_boolean || m_boolean->execute(tdbb, request));
+		return true;
+	}
+
+	// The join is spilled. Leading records of the partition being in memory
+	// are joined immediately, others are deferred until the leading stream
+	// is read completely and then replayed partition by partition.
+
+	ULONG hash, position;
+
+	while (!hashTable->isReplaying() && m_leaderBuffer->getRecord(tdbb))
+	{
+		if (m_boolean && !m_boolean->execute(tdbb, request))
+		{
+			matchable = false;
+			return true;
+		}
+
+		hash = computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+
+		if (hashTable->isResident(hash))
+		{
+			impure->irsb_leader_hash = hash;
+			matchable = true;
+			return true;
+		}
+
+		position = (ULONG) m_leaderBuffer->getPosition(request) - 1;
+		hashTable->defer(hash, position);
+	}
+
+	if (!hashTable->fetchDeferred(hash, position))
+		return false;
+
+	m_leaderBuffer->locate(tdbb, position);
+
+	if (!m_leaderBuffer->getRecord(tdbb))
+	{
+		fb_assert(false);
+		return false;
+	}
+
+	impure->irsb_leader_hash = hash;
+	matchable = true;
+	return true;
+}
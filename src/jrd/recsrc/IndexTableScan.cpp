@@ -252,6 +252,11 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 			{
 				page = (Ods::btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
 				nextPointer = page->btr_nodes + page->btr_jump_size;
+
+				// Read the next leaf page while this one is walked
+				if (page->btr_sibling)
+					CCH_PREFETCH(tdbb, &window, &page->btr_sibling, 1);
+
 				continue;
 			}
 
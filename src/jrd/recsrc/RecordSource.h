@@ -257,11 +257,57 @@ namespace Jrd
 		ScratchBird::Array<DbKeyRangeNode*> m_dbkeyRanges;
 	};
 
+	// Full table scan split into ranges of data pages, which are read by
+	// parallel worker attachments and gathered back in the natural order
+
+	class GatherStream final : public RecordSource
+	{
+		class ScanTask;
+
+		struct Impure : public RecordSource::Impure
+		{
+			ScanTask* irsb_task;
+		};
+
+	public:
+		GatherStream(CompilerScratch* csb, StreamType stream, jrd_rel* relation, RecordSource* next);
+
+		static bool isAllowed(thread_db* tdbb, CompilerScratch* csb, StreamType stream, const RseNode* rse);
+
+		void close(thread_db* tdbb) const override;
+
+		bool refetchRecord(thread_db* tdbb) const override;
+		WriteLockResult lockRecord(thread_db* tdbb) const override;
+
+		void getLegacyPlan(thread_db* tdbb, ScratchBird::string& plan, unsigned level) const override;
+
+		void markRecursive() override;
+		void invalidateRecords(Request* request) const override;
+
+		void findUsedStreams(StreamList& streams, bool expandAll = false) const override;
+		bool isDependent(const StreamList& streams) const override;
+		void nullRecords(thread_db* tdbb) const override;
+
+	protected:
+		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
+		void internalOpen(thread_db* tdbb) const override;
+		bool internalGetRecord(thread_db* tdbb) const override;
+
+	private:
+		bool canGather(thread_db* tdbb) const;
+
+		NestConst<RecordSource> m_next;
+		const StreamType m_stream;
+		jrd_rel* const m_relation;
+		bool m_recursive = false;
+	};
+
 	class BitmapTableScan final : public RecordStream
 	{
 		struct Impure : public RecordSource::Impure
 		{
 			RecordBitmap** irsb_bitmap;
+			FB_UINT64 irsb_prefetch_number;		// record to request next prefetch at
 		};
 
 	public:
@@ -949,6 +995,66 @@ namespace Jrd
 		bool internalGetRecord(thread_db* tdbb) const override;
 	};
 
+	// Aggregates the groups in a hash table instead of sorting the input,
+	// spilling the values of groups not fitting into memory to be aggregated
+	// later. The groups are returned in no particular order.
+	class HashAggregateStream final : public BaseAggWinStream<HashAggregateStream, RecordSource>
+	{
+		class GroupTable;
+
+	public:
+		struct Impure final : public BaseAggWinStream::Impure
+		{
+			GroupTable* irsb_groups;
+		};
+
+	public:
+		HashAggregateStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+			NestValueArray* group, MapNode* map, RecordSource* next);
+
+		static bool isHashable(thread_db* tdbb, CompilerScratch* csb, NestValueArray* group, MapNode* map);
+		static ULONG getGroupLength(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+			NestValueArray* group, MapNode* map);
+
+	public:
+		void close(thread_db* tdbb) const override;
+
+		void getLegacyPlan(thread_db* tdbb, ScratchBird::string& plan, unsigned level) const override;
+
+	protected:
+		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
+		void internalOpen(thread_db* tdbb) const override;
+		bool internalGetRecord(thread_db* tdbb) const override;
+
+		Impure* getImpure(Request* request) const
+		{
+			return request->getImpure<Impure>(m_impure);
+		}
+
+	private:
+		struct MapItem
+		{
+			const AggNode* aggNode;
+			const ValueExprNode* value;		// argument of the aggregate or the mapped value
+			USHORT valueId;					// field of m_valueFormat, or MAX_USHORT
+		};
+
+		static ULONG getKeyLength(thread_db* tdbb, CompilerScratch* csb, ValueExprNode* node);
+
+		ULONG computeKey(thread_db* tdbb, Request* request, UCHAR* key) const;
+		void storeValues(thread_db* tdbb, Request* request, UCHAR* values) const;
+		void aggregate(thread_db* tdbb, Request* request, GroupTable* groups) const;
+		void passValues(thread_db* tdbb, Request* request, UCHAR* state, const UCHAR* values) const;
+		void initGroup(thread_db* tdbb, Request* request, UCHAR* state, const UCHAR* values) const;
+		void restoreState(Request* request, const UCHAR* state) const;
+
+		ScratchBird::Array<ULONG> m_keyLengths;
+		ScratchBird::Array<MapItem> m_items;
+		ULONG m_totalKeyLength;
+		ULONG m_aggCount;
+		const Format* m_valueFormat;			// spilled values of the map items
+	};
+
 	class WindowedStream : public RecordSource
 	{
 	public:
@@ -1140,6 +1246,11 @@ namespace Jrd
 			return impure->irsb_position;
 		}
 
+		ULONG getRecordLength() const
+		{
+			return m_format->fmt_length;
+		}
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -1332,7 +1443,7 @@ namespace Jrd
 	public:
 		HashJoin(thread_db* tdbb, CompilerScratch* csb, JoinType joinType,
 				 FB_SIZE_T count, RecordSource* const* args, NestValueArray* const* keys,
-				 double selectivity = 0);
+				 double selectivity = 0, bool preserveOrder = false);
 		HashJoin(thread_db* tdbb, CompilerScratch* csb,
 				 BoolExprNode* boolean,
 				 RecordSource* const* args, NestValueArray* const* keys,
@@ -1341,7 +1452,7 @@ namespace Jrd
 		void close(thread_db* tdbb) const override;
 		void getLegacyPlan(thread_db* tdbb, ScratchBird::string& plan, unsigned level) const override;
 
-		static unsigned maxCapacity();
+		static unsigned maxCapacity(thread_db* tdbb);
 
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
@@ -1351,13 +1462,16 @@ namespace Jrd
 	private:
 		void init(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 				  RecordSource* const* args, NestValueArray* const* keys,
-				  double selectivity);
+				  double selectivity, bool preserveOrder);
 		ULONG computeHash(thread_db* tdbb, Request* request,
 						  const SubStream& sub, UCHAR* buffer) const;
+		void buildHashTable(thread_db* tdbb, Impure* impure) const;
+		bool fetchLeader(thread_db* tdbb, Impure* impure, bool& matchable) const;
 		bool fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) const;
 
 		SubStream m_leader;
 		ScratchBird::Array<SubStream> m_subs;
+		BufferedStream* m_leaderBuffer = nullptr;	// leading records of spilled partitions
 	};
 
 	class MergeJoin : public Join<SortedStream>
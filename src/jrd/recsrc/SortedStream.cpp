@@ -200,6 +200,13 @@ Sort* SortedStream::init(thread_db* tdbb) const
 			 m_map->keyItems.begin(),
 			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : nullptr), 0));
 
+	// Big sorts may have their buffers sorted by parallel workers
+
+	const Attachment* const attachment = tdbb->getAttachment();
+
+	if (attachment->att_parallel_workers > 1)
+		scb->setParallelWorkers(attachment->att_parallel_workers);
+
 	// Pump the input stream dry while pushing records into sort. For
 	// each record, map all fields into the sort record. The reverse
 	// mapping is done in get_sort().
@@ -541,6 +541,7 @@ RELATION(nam_mon_database, rel_mon_database, ODS_11_1, rel_virtual)
 	FIELD(f_mon_db_na, nam_mon_na, fld_att_id, 0, ODS_13_0)
 	FIELD(f_mon_db_ns, nam_mon_ns, fld_stmt_id, 0, ODS_13_0)
 	FIELD(f_mon_db_repl_mode, nam_mon_repl_mode, fld_repl_mode, 0, ODS_13_0)
+	FIELD(f_mon_db_cache_policy, nam_mon_cache_policy, fld_cache_policy, 0, ODS_14_3)
 END_RELATION
 
 // Relation 34 (MON$ATTACHMENTS)
@@ -633,6 +634,8 @@ RELATION(nam_mon_io_stats, rel_mon_io_stats, ODS_11_1, rel_virtual)
 	FIELD(f_mon_io_page_writes, nam_mon_page_writes, fld_counter, 0, ODS_11_1)
 	FIELD(f_mon_io_page_fetches, nam_mon_page_fetches, fld_counter, 0, ODS_11_1)
 	FIELD(f_mon_io_page_marks, nam_mon_page_marks, fld_counter, 0, ODS_11_1)
+	FIELD(f_mon_io_page_probation_hits, nam_mon_page_probation_hits, fld_counter, 0, ODS_14_3)
+	FIELD(f_mon_io_page_ghost_hits, nam_mon_page_ghost_hits, fld_counter, 0, ODS_14_3)
 END_RELATION
 
 // Relation 39 (MON$RECORD_STATS)
@@ -654,6 +657,8 @@ RELATION(nam_mon_rec_stats, rel_mon_rec_stats, ODS_11_1, rel_virtual)
 	FIELD(f_mon_rec_frg_reads, nam_mon_fragment_reads, fld_counter, 0, ODS_12_0)
 	FIELD(f_mon_rec_rpt_reads, nam_mon_rec_rpt_reads, fld_counter, 0, ODS_12_0)
 	FIELD(f_mon_rec_imgc, nam_mon_rec_imgc, fld_counter, 0, ODS_13_0)
+	FIELD(f_mon_rec_image_bytes, nam_mon_rec_image_bytes, fld_counter, 0, ODS_14_2)
+	FIELD(f_mon_rec_packed_bytes, nam_mon_rec_packed_bytes, fld_counter, 0, ODS_14_2)
 END_RELATION
 
 // Relation 40 (MON$CONTEXT_VARIABLES)
@@ -36,6 +36,7 @@
 #include "iberror.h"
 #include "../jrd/intl.h"
 #include "../common/TimeZoneUtil.h"
+#include "../common/Task.h"
 #include "../common/gdsassert.h"
 #include "../jrd/req.h"
 #include "../jrd/val.h"
@@ -150,6 +151,79 @@ namespace
 } // namespace
 
 
+// Sorts pointers of the filled buffers, one buffer per work item
+
+class Sort::SortTask : public Task
+{
+public:
+	SortTask(MemoryPool& pool, ULONG longs)
+		: m_pool(pool), m_items(pool), m_longs(longs), m_next(0)
+	{}
+
+	virtual ~SortTask()
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			delete *p;
+	}
+
+	void addBuffer(sort_record** first_pointer, sort_record** next_pointer)
+	{
+		m_items.add(FB_NEW_POOL(m_pool) Item(this, first_pointer, next_pointer));
+	}
+
+	bool handler(WorkItem& _item)
+	{
+		Item* item = static_cast<Item*>(&_item);
+		Sort::sortPointers(item->m_first_pointer, item->m_next_pointer, m_longs);
+		return true;
+	}
+
+	bool getWorkItem(WorkItem** pItem)
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (m_next >= m_items.getCount())
+			return false;
+
+		*pItem = m_items[m_next++];
+		return true;
+	}
+
+	bool getResult(IStatus* status)
+	{
+		if (status)
+			status->init();
+
+		return true;
+	}
+
+	int getMaxWorkers()
+	{
+		return m_items.getCount();
+	}
+
+private:
+	class Item : public Task::WorkItem
+	{
+	public:
+		Item(SortTask* task, sort_record** first_pointer, sort_record** next_pointer)
+			: Task::WorkItem(task),
+			  m_first_pointer(first_pointer),
+			  m_next_pointer(next_pointer)
+		{}
+
+		sort_record** const m_first_pointer;
+		sort_record** const m_next_pointer;
+	};
+
+	MemoryPool& m_pool;
+	Mutex m_mutex;
+	HalfStaticArray<Item*, 8> m_items;
+	const ULONG m_longs;
+	FB_SIZE_T m_next;
+};
+
+
 Sort::Sort(Database* dbb,
 		   SortOwner* owner,
 		   ULONG record_length,
@@ -163,7 +237,8 @@ Sort::Sort(Database* dbb,
 	  m_last_record(NULL), m_next_pointer(NULL), m_records(0),
 	  m_runs(NULL), m_merge(NULL), m_free_runs(NULL),
 	  m_flags(0), m_merge_pool(NULL),
-	  m_description(m_owner->getPool(), keys)
+	  m_description(m_owner->getPool(), keys),
+	  m_workers(1), m_coordinator(NULL), m_pending(m_owner->getPool()), m_worker_memory(0)
 {
 /**************************************
  *
@@ -263,14 +338,26 @@ Sort::~Sort()
 	// Unlink the sort
 	m_owner->unlinkSort(this);
 
+	// Stop the parallel workers
+	delete m_coordinator;
+
 	// Release the temporary space
 	delete m_space;
 
 	// If runs are allocated and not in the big block, release them.
-	// Then release the big block.
+	// Then release the big block and buffers not sorted yet.
 
 	releaseBuffer();
 
+	for (const PendingBuffer* buffer = m_pending.begin(); buffer < m_pending.end(); buffer++)
+	{
+		if (buffer->memory != m_memory)
+			releaseBuffer(*buffer);
+	}
+
+	if (m_worker_memory)
+		m_dbb->decTempCacheUsage(m_worker_memory);
+
 	// Clean up the runs that were used
 
 	run_control* run;
@@ -359,22 +446,17 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 		// Check that we are not at the beginning of the buffer in addition
 		// to checking for space for the record. This avoids the pointer
 		// record from underflowing in the second condition.
+		// Once the sort has spilled to the scratch file, parallel workers may
+		// sort a few buffers at once instead.
 		if ((UCHAR*) record < m_memory + m_longs ||
 			(UCHAR*) NEXT_RECORD(record) <= (UCHAR*) (m_next_pointer + 1))
 		{
-			putRun(tdbb);
-			while (true)
+			if (m_workers > 1 && m_runs)
+				queueBuffer(tdbb);
+			else
 			{
-				run_control* run = m_runs;
-				const USHORT depth = run->run_depth;
-				if (depth == MAX_MERGE_LEVEL)
-					break;
-				USHORT count = 1;
-				while ((run = run->run_next) && run->run_depth == depth)
-					count++;
-				if (count < RUN_GROUP)
-					break;
-				mergeRuns(count);
+				putRun(tdbb);
+				mergeRunGroups();
 			}
 			init();
 			record = m_last_record;
@@ -438,7 +520,10 @@ void Sort::sort(thread_db* tdbb)
 
 		// Write the last records as a run_control
 
-		putRun(tdbb);
+		if (m_pending.hasData())
+			queueBuffer(tdbb, true);
+		else
+			putRun(tdbb);
 
 		CHECK_FILE(NULL);
 
@@ -668,6 +753,18 @@ void Sort::releaseBuffer()
 }
 
 
+void Sort::releaseBuffer(const PendingBuffer& buffer)
+{
+	if (buffer.reusable)
+	{
+		fb_assert(buffer.size == MAX_SORT_BUFFER_SIZE);
+		m_owner->releaseBuffer(buffer.memory);
+	}
+	else
+		delete[] buffer.memory;
+}
+
+
 #ifdef WORDS_BIGENDIAN
 void Sort::diddleKey(UCHAR* record, bool direction, bool duplicateHandling)
 {
@@ -1729,6 +1826,30 @@ void Sort::mergeRuns(USHORT n)
 }
 
 
+void Sort::mergeRunGroups()
+{
+/**************************************
+ *
+ * A run was just written.  While there are enough runs of the
+ * same depth, merge them into a deeper one.
+ *
+ **************************************/
+	while (true)
+	{
+		run_control* run = m_runs;
+		const USHORT depth = run->run_depth;
+		if (depth == MAX_MERGE_LEVEL)
+			break;
+		USHORT count = 1;
+		while ((run = run->run_next) && run->run_depth == depth)
+			count++;
+		if (count < RUN_GROUP)
+			break;
+		mergeRuns(count);
+	}
+}
+
+
 void Sort::quick(SLONG size, SORTP** pointers, ULONG length)
 {
 /**************************************
@@ -2013,14 +2134,15 @@ void Sort::orderAndSave(thread_db* tdbb)
 }
 
 
-void Sort::putRun(thread_db* tdbb)
+void Sort::putRun(thread_db* tdbb, bool presorted)
 {
 /**************************************
  *
  * Memory has been exhausted.  Do a sort on what we have and write
  * it to the scratch file.  Keep in mind that since duplicate records
  * may disappear, the number of records in the run may be less than
- * were sorted.
+ * were sorted.  If the buffer was already sorted by parallel worker,
+ * only duplicates are to be handled.
  *
  **************************************/
 	run_control* run = m_free_runs;
@@ -2041,7 +2163,13 @@ void Sort::putRun(thread_db* tdbb)
 	// Do the in-core sort. The first phase a duplicate handling we be performed
 	// in "sort".
 
-	sortBuffer(tdbb);
+	if (!presorted)
+		sortBuffer(tdbb);
+	else if (m_dup_callback)
+	{
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+		removeDuplicates();
+	}
 
 	// Re-arrange records in physical order so they can be dumped in a single write
 	// operation
@@ -2050,33 +2178,175 @@ void Sort::putRun(thread_db* tdbb)
 }
 
 
+void Sort::queueBuffer(thread_db* tdbb, bool last)
+{
+/**************************************
+ *
+ * Memory has been exhausted (or no more records are coming).  Put
+ * the buffer aside to be sorted by parallel workers together with
+ * a few others and continue with a new buffer.  When there are
+ * enough buffers collected, sort them and write their runs.
+ *
+ **************************************/
+	PendingBuffer buffer;
+	buffer.memory = m_memory;
+	buffer.size = m_size_memory;
+	buffer.last_record = m_last_record;
+	buffer.next_pointer = m_next_pointer;
+	buffer.reusable = (m_flags & scb_reuse_buffer);
+	m_pending.add(buffer);
+
+	if (last || m_pending.getCount() >= m_workers)
+	{
+		flushBuffers(tdbb);
+		return;
+	}
+
+	// Runs are big already, thus allocate the buffer of the size init()
+	// grows it to for the big sorts. If there is no memory for it, just
+	// sort what we have.
+
+	const ULONG mem_size = m_max_alloc_size * RUN_GROUP;
+
+	// Buffers beyond the single one a serial sort works with are charged to
+	// the temporary cache of the database, which bounds the memory used by
+	// the runs. If the cache is exhausted, sort fewer buffers at once.
+
+	if (!m_dbb->incTempCacheUsage(mem_size))
+	{
+		flushBuffers(tdbb);
+		return;
+	}
+
+	try
+	{
+		m_memory = FB_NEW_POOL(m_owner->getPool()) UCHAR[mem_size];
+	}
+	catch (const BadAlloc&)
+	{
+		m_dbb->decTempCacheUsage(mem_size);
+		flushBuffers(tdbb);
+		return;
+	}
+
+	m_worker_memory += mem_size;
+	m_size_memory = mem_size;
+	m_flags &= ~scb_reuse_buffer;
+
+	m_end_memory = m_memory + m_size_memory;
+	m_first_pointer = (sort_record**) m_memory;
+}
+
+
+void Sort::flushBuffers(thread_db* tdbb)
+{
+/**************************************
+ *
+ * Sort the pending buffers by parallel workers, then write them to
+ * the scratch file as runs in the order they were filled.  The last
+ * buffer is kept as current one.
+ *
+ **************************************/
+	fb_assert(m_pending.hasData());
+
+	const bool presorted = (m_pending.getCount() > 1);
+
+	if (presorted)
+	{
+		SortTask task(m_owner->getPool(), m_longs);
+
+		for (const PendingBuffer* buffer = m_pending.begin(); buffer < m_pending.end(); buffer++)
+			task.addBuffer((sort_record**) buffer->memory, buffer->next_pointer);
+
+		if (!m_coordinator)
+			m_coordinator = FB_NEW_POOL(m_owner->getPool()) Coordinator(&m_owner->getPool());
+
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+		m_coordinator->runSync(&task);
+	}
+
+	while (m_pending.hasData())
+	{
+		// Buffer becomes current one, it will be released by destructor
+		// if the run can't be written
+
+		const PendingBuffer buffer = m_pending[0];
+		m_pending.remove((FB_SIZE_T) 0);
+
+		m_memory = buffer.memory;
+		m_size_memory = buffer.size;
+		if (buffer.reusable)
+			m_flags |= scb_reuse_buffer;
+		else
+			m_flags &= ~scb_reuse_buffer;
+
+		m_end_memory = m_memory + m_size_memory;
+		m_first_pointer = (sort_record**) m_memory;
+		m_last_record = buffer.last_record;
+		m_next_pointer = buffer.next_pointer;
+
+		putRun(tdbb, presorted);
+		mergeRunGroups();
+
+		if (m_pending.hasData())
+			releaseBuffer();
+	}
+
+	// Only one buffer is left, return the charge of the others
+
+	if (m_worker_memory)
+	{
+		m_dbb->decTempCacheUsage(m_worker_memory);
+		m_worker_memory = 0;
+	}
+}
+
+
 void Sort::sortBuffer(thread_db* tdbb)
 {
+/**************************************
+ *
+ * Sort the current buffer and, if duplicate handling has been
+ * requested, detect and handle them.
+ *
+ **************************************/
+	EngineCheckout cout(tdbb, FB_FUNCTION);
+
+	sortPointers(m_first_pointer, m_next_pointer, m_longs);
+
+	// If duplicate handling hasn't been requested, we're done
+
+	if (m_dup_callback)
+		removeDuplicates();
+}
+
+
+void Sort::sortPointers(sort_record** first_pointer, sort_record** next_pointer, ULONG longs)
+{
 /**************************************
  *
  * Set up for and call quick sort.  Quicksort, by design, doesn't
  * order partitions of length 2, so make a pass thru the data to
- * straighten out pairs.  While we at it, if duplicate handling has
- * been requested, detect and handle them.
+ * straighten out pairs.  Touches nothing but the given buffer,
+ * thus may be called by parallel workers.
  *
  **************************************/
-	EngineCheckout cout(tdbb, FB_FUNCTION);
 
 	// First, insert a pointer to the high key
 
-	*m_next_pointer = reinterpret_cast<sort_record*>(high_key);
+	*next_pointer = reinterpret_cast<sort_record*>(high_key);
 
 	// Next, call QuickSort. Keep in mind that the first pointer is the
 	// low key and not a record.
 
-	SORTP** j = (SORTP**) (m_first_pointer) + 1;
-	const ULONG n = (SORTP**) (m_next_pointer) - j;	// calculate # of records
+	SORTP** j = (SORTP**) (first_pointer) + 1;
+	const ULONG n = (SORTP**) (next_pointer) - j;	// calculate # of records
 
-	quick(n, j, m_longs);
+	quick(n, j, longs);
 
 	// Scream through and correct any out of order pairs
 	// hvlad: don't compare user keys against high_key
-	while (j < (SORTP**) m_next_pointer - 1)
+	while (j < (SORTP**) next_pointer - 1)
 	{
 		SORTP** i = j;
 		j++;
@@ -2084,7 +2354,7 @@ void Sort::sortBuffer(thread_db* tdbb)
 		{
 			const SORTP* p = *i;
 			const SORTP* q = *j;
-			ULONG tl = m_longs - 1;
+			ULONG tl = longs - 1;
 			while (tl && *p == *q)
 			{
 				p++;
@@ -2096,19 +2366,21 @@ void Sort::sortBuffer(thread_db* tdbb)
 			}
 		}
 	}
+}
 
-	// If duplicate handling hasn't been requested, we're done
-
-	if (!m_dup_callback)
-		return;
-
-	// Make another pass and eliminate duplicates. It's possible to do this
-	// in the same pass the final ordering, but the logic is complicated enough
-	// to screw up register optimizations. Better two fast passes than one
-	// slow pass, I suppose. Prove me wrong and win a trip for two to
-	// Cleveland, Ohio.
 
-	j = reinterpret_cast<SORTP**>(m_first_pointer + 1);
+void Sort::removeDuplicates()
+{
+/**************************************
+ *
+ * Make another pass over the sorted buffer and eliminate duplicates.
+ * It's possible to do this in the same pass the final ordering, but
+ * the logic is complicated enough to screw up register optimizations.
+ * Better two fast passes than one slow pass, I suppose. Prove me wrong
+ * and win a trip for two to Cleveland, Ohio.
+ *
+ **************************************/
+	SORTP** j = reinterpret_cast<SORTP**>(m_first_pointer + 1);
 
 	// hvlad: don't compare user keys against high_key
 	while (j < ((SORTP**) m_next_pointer) - 1)
@@ -29,6 +29,10 @@
 #include "../jrd/TempSpace.h"
 #include "../jrd/align.h"
 
+namespace ScratchBird {
+	class Coordinator;
+}
+
 namespace Jrd {
 
 // Forward declaration
@@ -294,6 +298,14 @@ public:
 		return m_flags & scb_sorted;
 	}
 
+	// Let up to given number of workers sort the memory buffers concurrently.
+	// Should be called before the first record is put into the sort.
+	void setParallelWorkers(unsigned workers)
+	{
+		fb_assert(!m_records);
+		m_workers = MAX(workers, 1);
+	}
+
 	static FB_UINT64 readBlock(TempSpace* space, FB_UINT64 seek, UCHAR* address, ULONG length)
 	{
 		const size_t bytes = space->read(seek, address, length);
@@ -309,8 +321,21 @@ public:
 	}
 
 private:
+	class SortTask;
+
+	// Filled sort buffer waiting for the parallel sorting
+	struct PendingBuffer
+	{
+		UCHAR* memory;
+		ULONG size;
+		SR* last_record;
+		sort_record** next_pointer;
+		bool reusable;
+	};
+
 	void allocateBuffer(MemoryPool&);
 	void releaseBuffer();
+	void releaseBuffer(const PendingBuffer&);
 
 	void diddleKey(UCHAR*, bool, bool);
 	sort_record* getMerge(merge_control*);
@@ -318,10 +343,14 @@ private:
 	ULONG allocate(ULONG, ULONG, bool);
 	void init();
 	void mergeRuns(USHORT);
+	void mergeRunGroups();
 	ULONG order();
 	void orderAndSave(Jrd::thread_db*);
-	void putRun(Jrd::thread_db*);
+	void putRun(Jrd::thread_db*, bool = false);
+	void queueBuffer(Jrd::thread_db*, bool = false);
+	void flushBuffers(Jrd::thread_db*);
 	void sortBuffer(Jrd::thread_db*);
+	void removeDuplicates();
 	void sortRunsBySeek(int);
 
 #ifdef DEV_BUILD
@@ -329,6 +358,7 @@ private:
 #endif
 
 	static void quick(SLONG, SORTP**, ULONG);
+	static void sortPointers(sort_record**, sort_record**, ULONG);
 
 	Database* m_dbb;							// Database
 	SortOwner* m_owner;							// Sort owner
@@ -356,6 +386,11 @@ private:
 	ULONG m_max_alloc_size;						// for the run buffer size
 
 	ScratchBird::Array<sort_key_def> m_description;
+
+	unsigned m_workers;							// Number of workers to sort buffers
+	ScratchBird::Coordinator* m_coordinator;	// ALLOC: Parallel workers, if any
+	ScratchBird::HalfStaticArray<PendingBuffer, 8> m_pending;	// Buffers to be sorted in parallel
+	FB_SIZE_T m_worker_memory;					// Memory of extra buffers charged to TempCacheLimit
 };
 
 
@@ -24,11 +24,35 @@
 #include "firebird.h"
 #include <string.h>
 #include "../jrd/sqz.h"
+#include "../common/Lz4Block.h"
 #include "../jrd/req.h"
 #include "../jrd/err_proto.h"
 #include "../yvalve/gds_proto.h"
 
+#include <atomic>
+
+// Vectorized scanning kernels are available on x86-64 only
+#if defined(_M_X64) || defined(__x86_64__)
+#define SQZ_X64
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include <immintrin.h>
+
+// AVX2 kernels are compiled using function attributes, no special compiler
+// flags are needed for this file
+#ifdef _MSC_VER
+#define SQZ_TARGET(isa)
+#else
+#define SQZ_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+#endif // SQZ_X64
+
 using namespace Jrd;
+using namespace ScratchBird;
 
 // Compression (run-length encoding aka RLE) scheme:
 //
@@ -63,8 +87,295 @@ namespace
 		return (length <= MAX_SHORT_RUN) ? 0 :
 			(length <= MAX_MEDIUM_RUN) ? sizeof(USHORT) : sizeof(ULONG);
 	}
+
+	// Byte scanning kernels:
+	//
+	// findRepeat - position of the first byte repeated three times in a row, or length if none
+	// countEqual - number of leading bytes equal to the given one
+	// countSame - length of the common prefix of two strings
+	//
+	// Scalar ones are always available, SSE2 is a baseline of x86-64 and
+	// AVX2 one is compiled using function attributes and chosen at runtime.
+
+	struct ScanKernels
+	{
+		size_t (*findRepeat)(const UCHAR* data, size_t length);
+		size_t (*countEqual)(const UCHAR* data, size_t length, UCHAR c);
+		size_t (*countSame)(const UCHAR* data1, const UCHAR* data2, size_t length);
+	};
+
+	size_t findRepeatScalar(const UCHAR* data, size_t length)
+	{
+		for (size_t i = 0; i + 2 < length; i++)
+		{
+			if (data[i] == data[i + 1] && data[i] == data[i + 2])
+				return i;
+		}
+
+		return length;
+	}
+
+	size_t countEqualScalar(const UCHAR* data, size_t length, UCHAR c)
+	{
+		size_t i = 0;
+		while (i < length && data[i] == c)
+			i++;
+
+		return i;
+	}
+
+	size_t countSameScalar(const UCHAR* data1, const UCHAR* data2, size_t length)
+	{
+		size_t i = 0;
+		while (i < length && data1[i] == data2[i])
+			i++;
+
+		return i;
+	}
+
+	const ScanKernels scalarKernels = {findRepeatScalar, countEqualScalar, countSameScalar};
+
+#ifdef SQZ_X64
+
+	inline unsigned firstBit(unsigned mask)
+	{
+		fb_assert(mask);
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return index;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	// SSE2 kernels
+
+	size_t findRepeatSse2(const UCHAR* data, size_t length)
+	{
+		size_t i = 0;
+
+		for (; i + 18 <= length; i += 16)
+		{
+			const __m128i v0 = _mm_loadu_si128((const __m128i*) (data + i));
+			const __m128i v1 = _mm_loadu_si128((const __m128i*) (data + i + 1));
+			const __m128i v2 = _mm_loadu_si128((const __m128i*) (data + i + 2));
+
+			const unsigned mask = _mm_movemask_epi8(
+				_mm_and_si128(_mm_cmpeq_epi8(v0, v1), _mm_cmpeq_epi8(v0, v2)));
+
+			if (mask)
+				return i + firstBit(mask);
+		}
+
+		return i + findRepeatScalar(data + i, length - i);
+	}
+
+	size_t countEqualSse2(const UCHAR* data, size_t length, UCHAR c)
+	{
+		const __m128i pattern = _mm_set1_epi8((char) c);
+		size_t i = 0;
+
+		for (; i + 16 <= length; i += 16)
+		{
+			const unsigned mask = _mm_movemask_epi8(
+				_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (data + i)), pattern));
+
+			if (mask != 0xFFFF)
+				return i + firstBit(~mask);
+		}
+
+		return i + countEqualScalar(data + i, length - i, c);
+	}
+
+	size_t countSameSse2(const UCHAR* data1, const UCHAR* data2, size_t length)
+	{
+		size_t i = 0;
+
+		for (; i + 16 <= length; i += 16)
+		{
+			const unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(
+				_mm_loadu_si128((const __m128i*) (data1 + i)),
+				_mm_loadu_si128((const __m128i*) (data2 + i))));
+
+			if (mask != 0xFFFF)
+				return i + firstBit(~mask);
+		}
+
+		return i + countSameScalar(data1 + i, data2 + i, length - i);
+	}
+
+	const ScanKernels sse2Kernels = {findRepeatSse2, countEqualSse2, countSameSse2};
+
+	// AVX2 kernels, tails shorter than vector are processed by SSE2 ones
+
+	SQZ_TARGET("avx2")
+	size_t findRepeatAvx2(const UCHAR* data, size_t length)
+	{
+		size_t i = 0;
+
+		for (; i + 34 <= length; i += 32)
+		{
+			const __m256i v0 = _mm256_loadu_si256((const __m256i*) (data + i));
+			const __m256i v1 = _mm256_loadu_si256((const __m256i*) (data + i + 1));
+			const __m256i v2 = _mm256_loadu_si256((const __m256i*) (data + i + 2));
+
+			const unsigned mask = (unsigned) _mm256_movemask_epi8(
+				_mm256_and_si256(_mm256_cmpeq_epi8(v0, v1), _mm256_cmpeq_epi8(v0, v2)));
+
+			if (mask)
+				return i + firstBit(mask);
+		}
+
+		return i + findRepeatSse2(data + i, length - i);
+	}
+
+	SQZ_TARGET("avx2")
+	size_t countEqualAvx2(const UCHAR* data, size_t length, UCHAR c)
+	{
+		const __m256i pattern = _mm256_set1_epi8((char) c);
+		size_t i = 0;
+
+		for (; i + 32 <= length; i += 32)
+		{
+			const unsigned mask = (unsigned) _mm256_movemask_epi8(
+				_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (data + i)), pattern));
+
+			if (mask != 0xFFFFFFFF)
+				return i + firstBit(~mask);
+		}
+
+		return i + countEqualSse2(data + i, length - i, c);
+	}
+
+	SQZ_TARGET("avx2")
+	size_t countSameAvx2(const UCHAR* data1, const UCHAR* data2, size_t length)
+	{
+		size_t i = 0;
+
+		for (; i + 32 <= length; i += 32)
+		{
+			const unsigned mask = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+				_mm256_loadu_si256((const __m256i*) (data1 + i)),
+				_mm256_loadu_si256((const __m256i*) (data2 + i))));
+
+			if (mask != 0xFFFFFFFF)
+				return i + firstBit(~mask);
+		}
+
+		return i + countSameSse2(data1 + i, data2 + i, length - i);
+	}
+
+	const ScanKernels avx2Kernels = {findRepeatAvx2, countEqualAvx2, countSameAvx2};
+
+	bool readAvx2Support()
+	{
+#ifdef _MSC_VER
+		// AVX2 instructions and OS support of YMM registers state
+		int flags[4];
+		__cpuid(flags, 1);
+		if (!(flags[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6)
+			return false;
+
+		__cpuidex(flags, 7, 0);
+		return (flags[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	// cpuid is slow, especially in virtual machines
+	bool avx2Supported()
+	{
+		static const bool supported = readAvx2Support();
+		return supported;
+	}
+
+#endif // SQZ_X64
+
+	const ScanKernels* const scanKernels[Compressor::SCAN_COUNT] =
+	{
+		&scalarKernels,
+#ifdef SQZ_X64
+		&sse2Kernels,
+		&avx2Kernels
+#else
+		&scalarKernels,
+		&scalarKernels
+#endif
+	};
+
+	const char* const scanKernelNames[Compressor::SCAN_COUNT] =
+	{
+		"scalar",
+		"sse2",
+		"avx2"
+	};
+
+	std::atomic<const ScanKernels*> currentKernels(nullptr);
+
+	// The best kernel is chosen on the first use, there is no dependency
+	// on initialization order of static objects
+	inline const ScanKernels* getKernels()
+	{
+		const ScanKernels* kernels = currentKernels.load(std::memory_order_relaxed);
+
+		if (!kernels)
+		{
+			kernels = scanKernels[Compressor::getScanKernel()];
+			currentKernels.store(kernels, std::memory_order_relaxed);
+		}
+
+		return kernels;
+	}
 };
 
+
+Compressor::ScanKernel Compressor::getScanKernel()
+{
+	if (isSupported(SCAN_AVX2))
+		return SCAN_AVX2;
+
+	if (isSupported(SCAN_SSE2))
+		return SCAN_SSE2;
+
+	return SCAN_SCALAR;
+}
+
+bool Compressor::isSupported(ScanKernel kernel)
+{
+	switch (kernel)
+	{
+	case SCAN_SCALAR:
+		return true;
+
+#ifdef SQZ_X64
+	case SCAN_SSE2:
+		return true;
+
+	case SCAN_AVX2:
+		return avx2Supported();
+#endif
+
+	default:
+		return false;
+	}
+}
+
+const char* Compressor::getScanKernelName(ScanKernel kernel)
+{
+	return (kernel < SCAN_COUNT) ? scanKernelNames[kernel] : "unknown";
+}
+
+void Compressor::setScanKernel(ScanKernel kernel)
+{
+	fb_assert(isSupported(kernel));
+
+	currentKernels.store(isSupported(kernel) ? scanKernels[kernel] : &scalarKernels,
+		std::memory_order_relaxed);
+}
+
 unsigned Compressor::nonCompressableRun(unsigned length)
 {
 	fb_assert(length && length <= MAX_NONCOMP_RUN);
@@ -108,7 +419,7 @@ Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked,
 	  m_allowUnpacked(allowUnpacked)
 {
 	const auto end = data + length;
-	const auto input = data;
+	const auto kernels = getKernels();
 
 	while (auto count = end - data)
 	{
@@ -117,21 +428,7 @@ Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked,
 		// Find length of non-compressable run
 
 		if (count >= MIN_COMPRESS_RUN)
-		{
-			auto max = count - 1;
-			fb_assert(max > 1);
-
-			do {
-				if (data[0] == data[1] && data[0] == data[2])
-				{
-					count = data - start;
-					break;
-				}
-
-				data++;
-
-			} while (--max > 1);
-		}
+			count = kernels->findRepeat(data, count);
 
 		data = start + count;
 
@@ -153,18 +450,8 @@ Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked,
 			continue;
 
 		start = data;
-		const auto c = *data;
-
-		do
-		{
-			if (*data != c)
-				break;
-
-			++data;
-
-		} while (--max);
-
-		count = data - start;
+		count = kernels->countEqual(data, max, *data);
+		data += count;
 
 		if (count < MIN_COMPRESS_RUN)
 		{
@@ -514,6 +801,61 @@ UCHAR* Compressor::unpack(ULONG inLength, const UCHAR* input,
 	return output;
 }
 
+// LzCompressor image is the LZ4 block (see Lz4Block) prefixed by the four-byte
+// length of original data.
+
+ULONG LzCompressor::pack(ULONG inLength, const UCHAR* input, ULONG outLength, UCHAR* output)
+{
+/**************************************
+ *
+ *	Compress a string using LZ4.
+ *	Return the image length or zero if it doesn't fit the output.
+ *
+ **************************************/
+	if (inLength < MIN_LENGTH || outLength <= HEADER_SIZE)
+		return 0;
+
+	put_long(output, inLength);
+
+	const ULONG length = Lz4Block::pack(inLength, input, outLength - HEADER_SIZE, output + HEADER_SIZE);
+
+	return length ? HEADER_SIZE + length : 0;
+}
+
+ULONG LzCompressor::getUnpackedLength(ULONG inLength, const UCHAR* input)
+{
+/**************************************
+ *
+ *	Get the unpacked length of the LZ4 image.
+ *
+ **************************************/
+	if (inLength < HEADER_SIZE)
+		return 0; // decompression error
+
+	return (ULONG) get_long(input);
+}
+
+UCHAR* LzCompressor::unpack(ULONG inLength, const UCHAR* input,
+							ULONG outLength, UCHAR* output)
+{
+/**************************************
+ *
+ *	Decompress LZ4 image into a buffer.
+ *	Return the address where the output stopped.
+ *	Anything after the image (zero fill) is ignored.
+ *
+ **************************************/
+	const ULONG length = getUnpackedLength(inLength, input);
+
+	if (!length || length > outLength ||
+		!Lz4Block::unpack(inLength - HEADER_SIZE, input + HEADER_SIZE, length, output))
+	{
+		BUGCHECK(179);	// msg 179 decompression overran buffer
+	}
+
+	return output + length;
+}
+
 ULONG Difference::apply(ULONG diffLength, ULONG outLength, UCHAR* const output)
 {
 /**************************************
@@ -614,6 +956,7 @@ ULONG Difference::make(ULONG length1, const UCHAR* rec1,
 	const auto end = output + MAX_DIFFERENCES;
 	const auto end1 = rec1 + MIN(length1, length2);
 	const auto end2 = rec2 + length2;
+	const auto kernels = getKernels();
 
 	while (end1 - rec1 > 2)
 	{
@@ -635,9 +978,9 @@ ULONG Difference::make(ULONG length1, const UCHAR* rec1,
 			continue;
 		}
 
-		unsigned count = 0;
-		while (rec1 < end1 && *rec1 == *rec2)
-			rec1++, rec2++, count++;
+		unsigned count = kernels->countSame(rec1, rec2, end1 - rec1);
+		rec1 += count;
+		rec2 += count;
 
 		while (count)
 		{
@@ -34,6 +34,24 @@ namespace Jrd
 	class Compressor
 	{
 	public:
+		// Kernels scanning the data for runs of equal bytes, used by both
+		// Compressor and Difference. All of them produce the same result,
+		// the best one supported by CPU is chosen at runtime.
+		enum ScanKernel
+		{
+			SCAN_SCALAR,
+			SCAN_SSE2,
+			SCAN_AVX2,
+			SCAN_COUNT
+		};
+
+		static ScanKernel getScanKernel();
+		static bool isSupported(ScanKernel kernel);
+		static const char* getScanKernelName(ScanKernel kernel);
+
+		// Force given kernel, for testing and benchmarking
+		static void setScanKernel(ScanKernel kernel);
+
 		Compressor(thread_db* tdbb, ULONG length, const UCHAR* data);
 		Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked, ULONG length, const UCHAR* data);
 
@@ -66,6 +84,25 @@ namespace Jrd
 		bool m_allowUnpacked = true;
 	};
 
+	// LZ4 block format compressor, used for records of databases configured
+	// with RecordCompression = LZ4 (ODS 14.2 and above). Its image starts with
+	// the length of original data, so the image is self-contained and may be
+	// followed by zero fill. The image is packed by Compressor after that as
+	// any other record, thus it's split into fragments the usual way.
+	class LzCompressor
+	{
+	public:
+		static const ULONG HEADER_SIZE = sizeof(ULONG);
+		static const ULONG MIN_LENGTH = 64;		// shorter records are not worth it
+
+		// Returns length of the image or zero if the image doesn't fit into outLength
+		static ULONG pack(ULONG inLength, const UCHAR* input, ULONG outLength, UCHAR* output);
+
+		static ULONG getUnpackedLength(ULONG inLength, const UCHAR* input);
+		static UCHAR* unpack(ULONG inLength, const UCHAR* input,
+							 ULONG outLength, UCHAR* output);
+	};
+
 	class Difference
 	{
 		// Max length of generated differences string between two records
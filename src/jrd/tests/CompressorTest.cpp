@@ -1,6 +1,8 @@
 #include "firebird.h"
 #include "boost/test/unit_test.hpp"
 #include "../jrd/sqz.h"
+#include <chrono>
+#include <vector>
 
 using namespace ScratchBird;
 using namespace Jrd;
@@ -8,6 +10,64 @@ using namespace Jrd;
 BOOST_AUTO_TEST_SUITE(EngineSuite)
 BOOST_AUTO_TEST_SUITE(CompressorSuite)
 
+// Record-like data: fixed fields of random bytes mixed with space padded
+// strings, zeroed fields and NULL's, long runs here and there
+static std::vector<UCHAR> testRecord(size_t length, unsigned int seed)
+{
+	std::vector<UCHAR> data(length);
+	size_t pos = 0;
+
+	while (pos < length)
+	{
+		seed = seed * 1103515245 + 12345;
+		const unsigned int kind = (seed >> 16) % 8;
+		seed = seed * 1103515245 + 12345;
+		const size_t fieldLength = MIN(length - pos, (size_t) 1 + (seed >> 16) % (kind == 7 ? 3000 : 40));
+
+		for (size_t i = 0; i < fieldLength; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			const UCHAR random = (UCHAR) (seed >> 16);
+
+			switch (kind)
+			{
+			case 0:
+			case 1:
+				data[pos + i] = random;
+				break;
+
+			case 2:
+			case 3:
+				data[pos + i] = (i < fieldLength / 3) ? 'A' + random % 26 : ' ';
+				break;
+
+			case 4:
+				data[pos + i] = random % 3;		// short runs
+				break;
+
+			default:
+				data[pos + i] = 0;
+				break;
+			}
+		}
+
+		pos += fieldLength;
+	}
+
+	return data;
+}
+
+static void pack(const Compressor& dcc, const std::vector<UCHAR>& data, Array<UCHAR>& packBuffer)
+{
+	packBuffer.clear();
+	dcc.pack(data.data(), packBuffer.getBuffer(dcc.getPackedLength(), false));
+}
+
+static void restoreKernel()
+{
+	Compressor::setScanKernel(Compressor::getScanKernel());
+}
+
 
 BOOST_AUTO_TEST_SUITE(CompressorTests)
 
@@ -33,8 +93,254 @@ BOOST_AUTO_TEST_CASE(PackAndUnpackTest)
 	BOOST_TEST(memcmp(data, unpackBuffer.begin(), dataLength) == 0);
 }
 
+BOOST_AUTO_TEST_CASE(ScanKernelsTest)
+{
+	// Every kernel should produce exactly the same RLE stream as scalar one
+	auto& pool = *getDefaultMemoryPool();
+	const size_t lengths[] = {0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 18, 33, 34, 35, 127, 128, 129, 1000, 65000, 70000};
+
+	for (const auto length : lengths)
+	{
+		for (unsigned int seed = 1; seed <= 8; seed++)
+		{
+			const auto data = testRecord(length, seed);
+
+			for (const bool legacy : {false, true})
+			{
+				Compressor::setScanKernel(Compressor::SCAN_SCALAR);
+				const Compressor expected(pool, !legacy, !legacy, length, data.data());
+
+				Array<UCHAR> expectedBuffer;
+				pack(expected, data, expectedBuffer);
+
+				for (int k = 0; k < Compressor::SCAN_COUNT; k++)
+				{
+					const auto kernel = static_cast<Compressor::ScanKernel>(k);
+					if (!Compressor::isSupported(kernel))
+						continue;
+
+					Compressor::setScanKernel(kernel);
+					const Compressor dcc(pool, !legacy, !legacy, length, data.data());
+
+					Array<UCHAR> packBuffer;
+					pack(dcc, data, packBuffer);
+					BOOST_TEST(packBuffer == expectedBuffer);
+
+					if (!dcc.isPacked())
+						continue;
+
+					std::vector<UCHAR> unpackBuffer(length + 1);
+					BOOST_TEST(Compressor::getUnpackedLength(packBuffer.getCount(), packBuffer.begin()) == length);
+					BOOST_TEST(Compressor::unpack(packBuffer.getCount(), packBuffer.begin(),
+						length, unpackBuffer.data()) == unpackBuffer.data() + length);
+					BOOST_TEST(memcmp(data.data(), unpackBuffer.data(), length) == 0);
+				}
+			}
+		}
+	}
+
+	restoreKernel();
+}
+
 BOOST_AUTO_TEST_SUITE_END()	// CompressorTests
 
 
+BOOST_AUTO_TEST_SUITE(LzCompressorTests)
+
+BOOST_AUTO_TEST_CASE(PackAndUnpackTest)
+{
+	const size_t lengths[] = {64, 65, 100, 127, 128, 300, 1000, 4096, 65000, 70000, 200000};
+
+	for (const auto length : lengths)
+	{
+		for (unsigned int seed = 1; seed <= 8; seed++)
+		{
+			const auto data = testRecord(length, seed);
+
+			std::vector<UCHAR> image(length);
+			const auto imageLength = LzCompressor::pack(length, data.data(), length, image.data());
+
+			if (!imageLength)
+				continue;
+
+			BOOST_TEST(imageLength < length);
+			BOOST_TEST(LzCompressor::getUnpackedLength(imageLength, image.data()) == length);
+
+			// Zero fill after the image should be ignored
+			image.resize(imageLength + 8);
+			std::fill(image.begin() + imageLength, image.end(), 0);
+
+			std::vector<UCHAR> unpackBuffer(length + 1);
+			BOOST_TEST(LzCompressor::unpack(image.size(), image.data(),
+				unpackBuffer.size(), unpackBuffer.data()) == unpackBuffer.data() + length);
+			BOOST_TEST(memcmp(data.data(), unpackBuffer.data(), length) == 0);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(RepetitiveTextTest)
+{
+	// Long repetitive strings are what LZ4 is used for, RLE doesn't help here
+	const char* const text = "{\"id\": 12345, \"name\": \"customer\", \"tags\": [\"a\", \"b\"]} ";
+	const size_t textLength = strlen(text);
+
+	std::vector<UCHAR> data(8000);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = text[i % textLength];
+
+	std::vector<UCHAR> image(data.size());
+	const auto imageLength = LzCompressor::pack(data.size(), data.data(), data.size() / 8, image.data());
+	BOOST_TEST(imageLength > 0u);
+
+	std::vector<UCHAR> unpackBuffer(data.size());
+	BOOST_TEST(LzCompressor::unpack(imageLength, image.data(),
+		unpackBuffer.size(), unpackBuffer.data()) == unpackBuffer.data() + data.size());
+	BOOST_TEST(unpackBuffer == data);
+}
+
+BOOST_AUTO_TEST_CASE(NotWorthItTest)
+{
+	std::vector<UCHAR> data(1000);
+	unsigned int seed = 1;
+
+	for (auto& c : data)
+	{
+		seed = seed * 1103515245 + 12345;
+		c = (UCHAR) (seed >> 16);
+	}
+
+	std::vector<UCHAR> image(data.size());
+
+	// Random data doesn't compress, too short data isn't tried
+	BOOST_TEST(LzCompressor::pack(data.size(), data.data(), data.size() - 1, image.data()) == 0u);
+	BOOST_TEST(LzCompressor::pack(LzCompressor::MIN_LENGTH - 1, data.data(), data.size(), image.data()) == 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// LzCompressorTests
+
+
+BOOST_AUTO_TEST_SUITE(DifferenceTests)
+
+BOOST_AUTO_TEST_CASE(MakeAndApplyTest)
+{
+	const size_t lengths[] = {1, 2, 3, 16, 17, 40, 100, 127, 128, 300, 1000};
+
+	for (const auto length : lengths)
+	{
+		for (unsigned int seed = 1; seed <= 8; seed++)
+		{
+			const auto oldRecord = testRecord(length, seed);
+
+			// Update a few fields of the record, sometimes shrinking or growing it
+			auto newRecord = oldRecord;
+			newRecord.resize(length + (seed % 3) * 5 - 5 * (seed % 2 && length > 5));
+
+			for (size_t pos = seed % 7; pos < newRecord.size(); pos += 37 + seed)
+				newRecord[pos] ^= 0x5A;
+
+			Compressor::setScanKernel(Compressor::SCAN_SCALAR);
+			Difference expected;
+			const auto expectedLength = expected.make(oldRecord.size(), oldRecord.data(),
+				newRecord.size(), newRecord.data());
+
+			for (int k = 0; k < Compressor::SCAN_COUNT; k++)
+			{
+				const auto kernel = static_cast<Compressor::ScanKernel>(k);
+				if (!Compressor::isSupported(kernel))
+					continue;
+
+				Compressor::setScanKernel(kernel);
+				Difference difference;
+				const auto diffLength = difference.make(oldRecord.size(), oldRecord.data(),
+					newRecord.size(), newRecord.data());
+
+				BOOST_TEST(diffLength == expectedLength);
+				BOOST_TEST(memcmp(difference.getData(), expected.getData(), diffLength) == 0);
+
+				if (!diffLength)
+					continue;
+
+				auto record = oldRecord;
+				record.resize(newRecord.size() + 1);
+				BOOST_TEST(difference.apply(diffLength, newRecord.size(), record.data()) == newRecord.size());
+				BOOST_TEST(memcmp(record.data(), newRecord.data(), newRecord.size()) == 0);
+			}
+		}
+	}
+
+	restoreKernel();
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// DifferenceTests
+
+
+// Throughput of every scan kernel supported by CPU, run explicitly:
+// libEngine*_test --run_test=EngineSuite/CompressorSuite/CompressorPerformanceTests
+BOOST_AUTO_TEST_SUITE(CompressorPerformanceTests, *boost::unit_test::disabled())
+
+BOOST_AUTO_TEST_CASE(ThroughputTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	const size_t sizes[] = {100, 1000, 8000, 64000};
+	const size_t TOTAL = 256 * 1024 * 1024;
+
+	for (const auto size : sizes)
+	{
+		const auto data = testRecord(size, 12345);
+
+		auto changed = data;
+		changed[size / 2] ^= 1;
+
+		std::vector<UCHAR> unpackBuffer(size);
+
+		for (int k = 0; k < Compressor::SCAN_COUNT; k++)
+		{
+			const auto kernel = static_cast<Compressor::ScanKernel>(k);
+			if (!Compressor::isSupported(kernel))
+				continue;
+
+			Compressor::setScanKernel(kernel);
+
+			Array<UCHAR> packBuffer;
+			ULONG packedLength = 0;
+			auto start = std::chrono::steady_clock::now();
+
+			for (size_t done = 0; done < TOTAL; done += size)
+			{
+				const Compressor dcc(pool, true, false, size, data.data());
+				pack(dcc, data, packBuffer);
+				packedLength = dcc.getPackedLength();
+			}
+
+			std::chrono::duration<double> pack = std::chrono::steady_clock::now() - start;
+			start = std::chrono::steady_clock::now();
+
+			for (size_t done = 0; done < TOTAL; done += size)
+				Compressor::unpack(packedLength, packBuffer.begin(), size, unpackBuffer.data());
+
+			std::chrono::duration<double> unpack = std::chrono::steady_clock::now() - start;
+			start = std::chrono::steady_clock::now();
+
+			Difference difference;
+			for (size_t done = 0; done < TOTAL; done += size)
+				difference.make(size, data.data(), size, changed.data());
+
+			std::chrono::duration<double> diff = std::chrono::steady_clock::now() - start;
+
+			BOOST_TEST(memcmp(data.data(), unpackBuffer.data(), size) == 0);
+
+			BOOST_TEST_MESSAGE(Compressor::getScanKernelName(kernel) << ", " << size << " bytes records: " <<
+				"pack " << (unsigned) (TOTAL / pack.count() / 1048576) << " MB/s, " <<
+				"unpack " << (unsigned) (TOTAL / unpack.count() / 1048576) << " MB/s, " <<
+				"difference " << (unsigned) (TOTAL / diff.count() / 1048576) << " MB/s");
+		}
+	}
+
+	restoreKernel();
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// CompressorPerformanceTests
+
+
 BOOST_AUTO_TEST_SUITE_END()	// CompressorSuite
 BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -209,3 +209,6 @@ TYPE("ENCRYPT IN PROGRESS", 3, nam_mon_crypt_state)
 TYPE("NONE", 0, nam_mon_repl_mode)
 TYPE("READ-ONLY", 1, nam_mon_repl_mode)
 TYPE("READ-WRITE", 2, nam_mon_repl_mode)
+
+TYPE("LRU", 0, nam_mon_cache_policy)
+TYPE("2Q", 1, nam_mon_cache_policy)
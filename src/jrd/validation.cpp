@@ -1443,6 +1443,7 @@ static void print_rhd(USHORT length, const rhd* header)
 		fprintf(stdout, "%s ", (header->rhd_flags & rhd_large) ? "LRG" : "   ");
 		fprintf(stdout, "%s ", (header->rhd_flags & rhd_damaged) ? "DAM" : "   ");
 		fprintf(stdout, "%s ", (header->rhd_flags & rhd_not_packed) ? "NPK" : "   ");
+		fprintf(stdout, "%s ", (header->rhd_flags & rhd_lz_packed) ? "LZ4" : "   ");
 		fprintf(stdout, "\n");
 	}
 }
@@ -2878,10 +2879,18 @@ Validation::RTN Validation::walk_record(jrd_rel* relation, const rhd* header, US
 		release_page(&window);
 	}
 
-	// Validate unpacked record length
+	// Validate unpacked record length. LZ4 image must be shorter than the record,
+	// its exact length is checked when the image is decompressed.
 
-	if (!delta_flag && remainingLength != 0)
-		return corrupt(VAL_REC_WRONG_LENGTH, relation, number.getValue());
+	if (!delta_flag)
+	{
+		const bool wrongLength = (header->rhd_flags & rhd_lz_packed) ?
+			(remainingLength == 0 || remainingLength > format->fmt_length) :
+			(remainingLength != 0);
+
+		if (wrongLength)
+			return corrupt(VAL_REC_WRONG_LENGTH, relation, number.getValue());
+	}
 
 	return rtn_ok;
 }
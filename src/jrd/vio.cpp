@@ -1843,6 +1843,21 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 
 	rpb->rpb_prior = (rpb->rpb_b_page && (rpb->rpb_flags & rpb_delta)) ? record : NULL;
 
+	// LZ4 image of the record is gathered from fragments into intermediate
+	// buffer, it can't be longer than the record itself
+
+	const bool lzPacked = (rpb->rpb_flags & rpb_lz_packed);
+	HalfStaticArray<UCHAR, 1024> lzImage(*tdbb->getDefaultPool());
+
+	UCHAR* const target = tail;
+	const UCHAR* const target_end = tail_end;
+
+	if (lzPacked)
+	{
+		tail = lzImage.getBuffer(target_end - target, false);
+		tail_end = tail + lzImage.getCount();
+	}
+
 	// Snarf data from record
 
 	tail = unpack(rpb, tail_end - tail, tail);
@@ -1873,6 +1888,9 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 
 	CCH_RELEASE(tdbb, &rpb->getWindow(tdbb));
 
+	if (lzPacked)
+		tail = LzCompressor::unpack(tail - lzImage.begin(), lzImage.begin(), target_end - target, target);
+
 	// If this is a delta version, apply changes
 	ULONG length;
 	if (prior)
@@ -0,0 +1,274 @@
+/*
+ *	PROGRAM:		JRD Lock Manager
+ *	MODULE:			bench.cpp
+ *	DESCRIPTION:	Lock manager stress benchmark
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by ScratchBird Development Team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2025 ScratchBird Development Team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): _______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../lock/lock_proto.h"
+#include "../jrd/lck.h"
+#include "../common/config/config.h"
+#include "../common/StatusHolder.h"
+#include "../common/ThreadStart.h"
+#include "../common/utils_proto.h"
+#include "../common/classes/array.h"
+#include "../yvalve/gds_proto.h"
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+using namespace ScratchBird;
+using namespace Jrd;
+
+namespace
+{
+	const char* const usage =
+		"ScratchBird lock manager benchmark.\n"
+		"Usage: fb_lock_bench [<parameters>]\n"
+		"\n"
+		"Valid parameters are:\n"
+		"  -t <number>  Number of threads, each one with its own lock owner (default 8)\n"
+		"  -k <number>  Number of distinct lock keys (default 10000)\n"
+		"  -n <number>  Number of lock cycles per thread (default 100000)\n"
+		"  -x <number>  Percent of cycles asking for exclusive locks (default 5)\n"
+		"  -?           Print this help\n"
+		"\n"
+		"Every cycle enqueues a lock, converts it and releases it, none of them waits.\n";
+
+	struct Worker
+	{
+		LockManager* lockMgr;
+		ULONG id;
+		ULONG keys;
+		ULONG cycles;
+		ULONG exclusive;
+
+		// Results
+		FB_UINT64 operations;
+		FB_UINT64 conflicts;
+		bool failed;
+		Thread::Handle handle;
+	};
+
+	// Cheap generator, the same sequence every run
+	inline ULONG nextRandom(ULONG& seed)
+	{
+		seed = seed * 1103515245 + 12345;
+		return seed >> 8;
+	}
+
+	THREAD_ENTRY_DECLARE workerThread(THREAD_ENTRY_PARAM arg)
+	{
+		Worker* const worker = static_cast<Worker*>(arg);
+		LockManager* const lockMgr = worker->lockMgr;
+
+		LocalStatus ls;
+		CheckStatusWrapper status(&ls);
+
+		SRQ_PTR owner = 0;
+		if (!lockMgr->initializeOwner(&status, worker->id, LCK_OWNER_attachment, &owner))
+		{
+			worker->failed = true;
+			return 0;
+		}
+
+		ULONG seed = worker->id;
+
+		for (ULONG i = 0; i < worker->cycles; i++)
+		{
+			// Keys of different series, like the engine locks pages, relations and so on
+
+			const ULONG key = nextRandom(seed) % worker->keys;
+			const USHORT series = 1 + key % (LCK_MAX_SERIES - 1);
+			const bool exclusive = nextRandom(seed) % 100 < worker->exclusive;
+
+			const SRQ_PTR request = lockMgr->enqueue(NULL, &status, 0, series,
+				reinterpret_cast<const UCHAR*>(&key), sizeof(key), exclusive ? LCK_EX : LCK_SR,
+				NULL, NULL, 0, LCK_NO_WAIT, owner);
+
+			worker->operations++;
+
+			if (!request)
+			{
+				worker->conflicts++;
+				continue;
+			}
+
+			if (!exclusive)
+			{
+				if (!lockMgr->convert(NULL, &status, request, LCK_PR, LCK_NO_WAIT, NULL, NULL))
+					worker->conflicts++;
+
+				worker->operations++;
+			}
+
+			lockMgr->dequeue(request);
+			worker->operations++;
+		}
+
+		lockMgr->shutdownOwner(NULL, &owner);
+
+		return 0;
+	}
+
+	bool getNumber(int& argc, char**& argv, ULONG& value)
+	{
+		if (argc < 2)
+			return false;
+
+		value = (ULONG) atol(*argv++);
+		--argc;
+
+		return value > 0;
+	}
+}
+
+
+int CLIB_ROUTINE main(int argc, char* argv[])
+{
+/**************************************
+ *
+ *      m a i n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Run the lock manager with a number of concurrent owners
+ *	and report the lock operations per second.
+ *
+ **************************************/
+	ULONG threads = 8;
+	ULONG keys = 10000;
+	ULONG cycles = 100000;
+	ULONG exclusive = 5;
+
+	argv++;
+
+	while (--argc)
+	{
+		const char* p = *argv++;
+		bool valid = (*p++ == '-') && p[0] && !p[1];
+
+		if (valid)
+		{
+			switch (*p)
+			{
+			case 't':
+				valid = getNumber(argc, argv, threads);
+				break;
+
+			case 'k':
+				valid = getNumber(argc, argv, keys);
+				break;
+
+			case 'n':
+				valid = getNumber(argc, argv, cycles);
+				break;
+
+			case 'x':
+				valid = getNumber(argc, argv, exclusive) || exclusive == 0;
+				break;
+
+			default:
+				valid = false;
+			}
+		}
+
+		if (!valid)
+		{
+			printf("%s", usage);
+			return FINI_OK;
+		}
+	}
+
+	try
+	{
+		// Own lock table, not shared with any database
+
+		string id;
+		id.printf("fb_lock_bench_%d", (int) getpid());
+
+		AutoPtr<LockManager> lockMgr(FB_NEW LockManager(id, Config::getDefaultConfig()));
+
+		HalfStaticArray<Worker, 64> workers;
+		workers.grow(threads);
+
+		for (ULONG i = 0; i < threads; i++)
+		{
+			Worker& worker = workers[i];
+			memset(&worker, 0, sizeof(worker));
+
+			worker.lockMgr = lockMgr;
+			worker.id = i + 1;
+			worker.keys = keys;
+			worker.cycles = cycles;
+			worker.exclusive = exclusive;
+		}
+
+		const SINT64 start = fb_utils::query_performance_counter();
+
+		for (auto& worker : workers)
+			Thread::start(workerThread, &worker, THREAD_medium, &worker.handle);
+
+		for (auto& worker : workers)
+			Thread::waitForCompletion(worker.handle);
+
+		const SINT64 elapsed = fb_utils::query_performance_counter() - start;
+		const double seconds = (double) elapsed / fb_utils::query_performance_frequency();
+
+		FB_UINT64 operations = 0, conflicts = 0;
+
+		for (const auto& worker : workers)
+		{
+			if (worker.failed)
+			{
+				printf("Unable to create lock owner for thread %" ULONGFORMAT"\n", worker.id);
+				return FINI_ERROR;
+			}
+
+			operations += worker.operations;
+			conflicts += worker.conflicts;
+		}
+
+		printf("Threads: %" ULONGFORMAT", Keys: %" ULONGFORMAT", Cycles: %" ULONGFORMAT
+			   ", Exclusive: %" ULONGFORMAT"%%\n", threads, keys, cycles, exclusive);
+		printf("Operations: %" UQUADFORMAT", Conflicts: %" UQUADFORMAT", Time: %.3f s\n",
+			   operations, conflicts, seconds);
+		printf("Operations/s: %.0f\n", seconds > 0 ? operations / seconds : 0.0);
+	}
+	catch (const Exception& ex)
+	{
+		StaticStatusVector st;
+		ex.stuffException(st);
+		gds__print_status(st.begin());
+
+		return FINI_ERROR;
+	}
+
+	return FINI_OK;
+}
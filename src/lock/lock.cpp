@@ -104,6 +104,7 @@
 
 #ifdef DEV_BUILD
 #define ASSERT_ACQUIRED fb_assert(m_sharedMemory->getHeader()->lhb_active_owner)
+#define ASSERT_PARTITION(p) fb_assert((p) ? (p)->lpt_active_owner : m_sharedMemory->getHeader()->lhb_active_owner)
 #ifdef HAVE_OBJECT_MAP
 #define LOCK_DEBUG_REMAP
 #define DEBUG_REMAP_INTERVAL 5000
@@ -112,6 +113,7 @@ static ULONG debug_remap_count = 0;
 #define CHECK(x)	do { if (!(x)) bug_assert ("consistency check", __LINE__); } while (false)
 #else // DEV_BUILD
 #define	ASSERT_ACQUIRED
+#define	ASSERT_PARTITION(p)
 #define CHECK(x)	do { } while (false)
 #endif // DEV_BUILD
 
@@ -171,6 +173,10 @@ LockManager::LockManager(const string& id, const Config* conf)
 	  m_bugcheck(false),
 	  m_process(NULL),
 	  m_processOffset(0),
+#ifdef USE_PARTITION_MUTEX
+	  m_partitionMutexes(NULL),
+#endif
+	  m_hashSlots(0),
 	  m_cleanupSync(getPool(), blocking_action_thread, THREAD_high),
 	  m_sharedMemory(NULL),
 	  m_blockage(false),
@@ -256,6 +262,14 @@ LockManager::~LockManager()
 		m_extents[i].unmapFile(&localStatus);
 	}
 #endif //USE_SHMEM_EXT
+
+#ifdef USE_PARTITION_MUTEX
+	if (m_partitionMutexes)
+	{
+		m_sharedMemory->SharedMemoryBase::unmapObject(&localStatus,
+			(UCHAR**) &m_partitionMutexes, sizeof(lpt) * LCK_PARTITIONS);
+	}
+#endif
 }
 
 
@@ -305,6 +319,8 @@ bool LockManager::init_shared_file(CheckStatusWrapper* statusVector)
 
 		const auto header = tmp->getHeader();
 		checkHeader(header);
+
+		m_hashSlots = header->lhb_hash_slots;
 	}
 	catch (const Exception& ex)
 	{
@@ -312,6 +328,22 @@ bool LockManager::init_shared_file(CheckStatusWrapper* statusVector)
 		return false;
 	}
 
+#ifdef USE_PARTITION_MUTEX
+	// Partition mutexes are used through their own mapping which stays
+	// in place when the lock table is remapped while they are held.
+	// lhb isn't a standard-layout type, so offsetof() can't be used.
+
+	const lhb* const lockHeader = m_sharedMemory->getHeader();
+	const ULONG partitionsOffset = (ULONG) ((const UCHAR*) &lockHeader->lhb_partitions -
+		(const UCHAR*) lockHeader);
+
+	m_partitionMutexes = (lpt*) m_sharedMemory->SharedMemoryBase::mapObject(statusVector,
+		partitionsOffset, sizeof(lpt) * LCK_PARTITIONS);
+
+	if (!m_partitionMutexes)
+		return false;
+#endif
+
 #ifdef USE_SHMEM_EXT
 	m_extents[0] = *this;
 #endif
@@ -423,7 +455,10 @@ void LockManager::shutdownOwner(thread_db* tdbb, SRQ_PTR* owner_handle)
 	// This assert expects that all the granted locks have been explicitly
 	// released before destroying the lock owner. This is not strictly required,
 	// but it enforces the proper object lifetime discipline through the codebase.
-	fb_assert(SRQ_EMPTY(owner->own_requests));
+#ifdef DEV_BUILD
+	for (USHORT i = 0; i < LCK_PARTITIONS; i++)
+		fb_assert(SRQ_EMPTY(owner->own_requests[i]));
+#endif
 
 	purge_owner(owner_offset, owner);
 
@@ -461,6 +496,17 @@ SRQ_PTR LockManager::enqueue(thread_db* tdbb,
 	if (!owner_offset)
 		return 0;
 
+#ifdef USE_PARTITION_MUTEX
+	if (!prior_request && !data)
+	{
+		const SRQ_PTR request_offset =
+			fast_enqueue(series, value, length, type, ast_routine, ast_argument, owner_offset);
+
+		if (request_offset)
+			return request_offset;
+	}
+#endif
+
 	LockTableGuard guard(this, FB_FUNCTION, owner_offset);
 
 	own* owner = (own*) SRQ_ABS_PTR(owner_offset);
@@ -478,24 +524,30 @@ SRQ_PTR LockManager::enqueue(thread_db* tdbb,
 	if (prior_request)
 		internal_dequeue(prior_request);
 
+	const USHORT hash_slot = get_hash_slot(series, value, length);
+	const USHORT partition = hash_slot % LCK_PARTITIONS;
+
 	// Allocate or reuse a lock request block
 
-	lrq* request;
+	lrq* request = alloc_request(partition);
 
-	ASSERT_ACQUIRED;
-	if (SRQ_EMPTY(m_sharedMemory->getHeader()->lhb_free_requests))
-	{
-		if (!(request = (lrq*) alloc(sizeof(lrq), statusVector)))
-			return 0;
-
-		owner = (own*) SRQ_ABS_PTR(owner_offset);
-	}
-	else
+	if (!request)
 	{
 		ASSERT_ACQUIRED;
-		request = (lrq*) ((UCHAR*) SRQ_NEXT(m_sharedMemory->getHeader()->lhb_free_requests) -
-						 offsetof(lrq, lrq_lbl_requests));
-		remove_que(&request->lrq_lbl_requests);
+		if (SRQ_EMPTY(m_sharedMemory->getHeader()->lhb_free_requests))
+		{
+			if (!(request = (lrq*) alloc(sizeof(lrq), statusVector)))
+				return 0;
+
+			owner = (own*) SRQ_ABS_PTR(owner_offset);
+		}
+		else
+		{
+			ASSERT_ACQUIRED;
+			request = (lrq*) ((UCHAR*) SRQ_NEXT(m_sharedMemory->getHeader()->lhb_free_requests) -
+							 offsetof(lrq, lrq_lbl_requests));
+			remove_que(&request->lrq_lbl_requests);
+		}
 	}
 
 	post_history(his_enq, owner_offset, (SRQ_PTR)0, SRQ_REL_PTR(request), true);
@@ -508,7 +560,7 @@ SRQ_PTR LockManager::enqueue(thread_db* tdbb,
 	request->lrq_owner = owner_offset;
 	request->lrq_ast_routine = ast_routine;
 	request->lrq_ast_argument = ast_argument;
-	insert_tail(&owner->own_requests, &request->lrq_own_requests);
+	insert_tail(&owner->own_requests[partition], &request->lrq_own_requests);
 	SRQ_INIT(request->lrq_own_blocks);
 	SRQ_INIT(request->lrq_own_pending);
 
@@ -516,8 +568,7 @@ SRQ_PTR LockManager::enqueue(thread_db* tdbb,
 
 	// See if the lock already exists
 
-	USHORT hash_slot;
-	lbl* lock = find_lock(series, value, length, &hash_slot);
+	lbl* lock = find_lock(series, value, length, hash_slot);
 	if (lock)
 	{
 		if (series < LCK_MAX_SERIES)
@@ -539,18 +590,21 @@ SRQ_PTR LockManager::enqueue(thread_db* tdbb,
 
 	// Lock doesn't exist. Allocate lock block and set it up.
 
-	if (!(lock = alloc_lock(length, statusVector)))
+	if (!(lock = alloc_lock(length, partition, statusVector)))
 	{
 		// lock table is exhausted: release request gracefully
+		request = (lrq*) SRQ_ABS_PTR(request_offset);
 		remove_que(&request->lrq_own_requests);
 		request->lrq_type = type_null;
-		insert_tail(&m_sharedMemory->getHeader()->lhb_free_requests, &request->lrq_lbl_requests);
+		insert_tail(&m_sharedMemory->getHeader()->lhb_partitions[partition].lpt_free_requests,
+			&request->lrq_lbl_requests);
 		return 0;
 	}
 
 	lock->lbl_state = type;
 	fb_assert(series <= MAX_UCHAR);
 	lock->lbl_series = (UCHAR)series;
+	lock->lbl_partition = (UCHAR) partition;
 
 	// Maintain lock series data queue
 
@@ -604,6 +658,12 @@ bool LockManager::convert(thread_db* tdbb,
  **************************************/
 	LOCK_TRACE(("LM::convert (%d, %d)\n", type, lck_wait));
 
+#ifdef USE_PARTITION_MUTEX
+	bool granted;
+	if (fast_convert(request_offset, type, ast_routine, ast_argument, &granted))
+		return granted;
+#endif
+
 	LockTableGuard guard(this, FB_FUNCTION, DUMMY_OWNER);
 
 	lrq* const request = get_request(request_offset);
@@ -647,6 +707,12 @@ UCHAR LockManager::downgrade(thread_db* tdbb,
  **************************************/
 	LOCK_TRACE(("LM::downgrade (%ld)\n", request_offset));
 
+#ifdef USE_PARTITION_MUTEX
+	UCHAR new_state;
+	if (fast_downgrade(request_offset, &new_state))
+		return new_state;
+#endif
+
 	LockTableGuard guard(this, FB_FUNCTION, DUMMY_OWNER);
 
 	lrq* const request = get_request(request_offset);
@@ -710,6 +776,12 @@ bool LockManager::dequeue(const SRQ_PTR request_offset)
  **************************************/
 	LOCK_TRACE(("LM::dequeue (%ld)\n", request_offset));
 
+#ifdef USE_PARTITION_MUTEX
+	bool result;
+	if (fast_dequeue(request_offset, &result))
+		return result;
+#endif
+
 	LockTableGuard guard(this, FB_FUNCTION, DUMMY_OWNER);
 
 	lrq* const request = get_request(request_offset);
@@ -983,8 +1055,7 @@ LOCK_DATA_T LockManager::readData2(USHORT series,
 	else
 		++(m_sharedMemory->getHeader()->lhb_operations[0]);
 
-	USHORT junk;
-	const lbl* const lock = find_lock(series, value, length, &junk);
+	const lbl* const lock = find_lock(series, value, length, get_hash_slot(series, value, length));
 
 	return lock ? lock->lbl_data : 0;
 }
@@ -1077,6 +1148,12 @@ void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 		m_blockage = false;
 
 		m_sharedMemory->mutexUnlock();
+
+#ifdef USE_PARTITION_MUTEX
+		m_sharedMemory->SharedMemoryBase::unmapObject(&localStatus,
+			(UCHAR**) &m_partitionMutexes, sizeof(lpt) * LCK_PARTITIONS);
+#endif
+
 		m_sharedMemory.reset();
 
 		Thread::yield();
@@ -1087,6 +1164,10 @@ void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 		m_sharedMemory->mutexLock();
 	}
 
+#ifdef USE_PARTITION_MUTEX
+	acquire_partitions();
+#endif
+
 	++(m_sharedMemory->getHeader()->lhb_acquires);
 	if (m_blockage)
 	{
@@ -1172,7 +1253,84 @@ void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 			recover->shb_insert_prior = 0;
 		}
 	}
+
+#ifdef USE_PARTITION_MUTEX
+	recover_partitions();
+#endif
+}
+
+
+#ifdef USE_PARTITION_MUTEX
+lpt* LockManager::acquire_partition(USHORT partition_id, SRQ_PTR owner_offset)
+{
+/**************************************
+ *
+ *	a c q u i r e _ p a r t i t i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Acquire a single partition of the lock table to work in it
+ *	without the lock table mutex.  If the table is being recovered,
+ *	deleted or has grown beyond our mapping, give it back and
+ *	return NULL, the caller should go the exclusive way then.
+ *
+ **************************************/
+	mtx* const mutex = &m_partitionMutexes[partition_id].lpt_mutex;
+	bool blocked = false;
+
+	if (!m_sharedMemory->mutexLockCond(mutex))
+	{
+		m_sharedMemory->mutexLock(mutex);
+		blocked = true;
+	}
+
+	lhb* const header = m_sharedMemory->getHeader();
+	lpt* const partition = &header->lhb_partitions[partition_id];
+
+	if (partition->lpt_active_owner || header->isDeleted() ||
+		header->lhb_length > m_sharedMemory->sh_mem_length_mapped)
+	{
+		m_sharedMemory->mutexUnlock(mutex);
+		return NULL;
+	}
+
+	++partition->lpt_acquires;
+	if (blocked)
+		++partition->lpt_acquire_blocks;
+
+	partition->lpt_active_owner = owner_offset;
+
+	return partition;
+}
+
+
+void LockManager::acquire_partitions()
+{
+/**************************************
+ *
+ *	a c q u i r e _ p a r t i t i o n s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Acquire all partitions of the lock table.  Called with the
+ *	lock table mutex held, so nobody else can wait for more than
+ *	one partition at a time.
+ *
+ **************************************/
+	for (USHORT i = 0; i < LCK_PARTITIONS; i++)
+	{
+		mtx* const mutex = &m_partitionMutexes[i].lpt_mutex;
+
+		if (!m_sharedMemory->mutexLockCond(mutex))
+		{
+			m_blockage = true;
+			m_sharedMemory->mutexLock(mutex);
+		}
+	}
 }
+#endif // USE_PARTITION_MUTEX
 
 
 #ifdef USE_SHMEM_EXT
@@ -1290,7 +1448,8 @@ UCHAR* LockManager::alloc(USHORT size, CheckStatusWrapper* statusVector)
 }
 
 
-lbl* LockManager::alloc_lock(USHORT length, CheckStatusWrapper* statusVector)
+lbl* LockManager::alloc_lock(USHORT length, USHORT partition, CheckStatusWrapper* statusVector,
+	lpt* recover)
 {
 /**************************************
  *
@@ -1300,15 +1459,15 @@ lbl* LockManager::alloc_lock(USHORT length, CheckStatusWrapper* statusVector)
  *
  * Functional description
  *	Allocate a lock for a key of a given length.  Look first to see
- *	if a spare of the right size is sitting around.  If not, allocate
- *	one.
+ *	if a spare of the right size is sitting around in the partition.
+ *	If not, allocate one, unless working in the partition alone.
  *
  **************************************/
 	length = FB_ALIGN(length, 8);
 
-	ASSERT_ACQUIRED;
+	ASSERT_PARTITION(recover);
 	srq* lock_srq;
-	SRQ_LOOP(m_sharedMemory->getHeader()->lhb_free_locks, lock_srq)
+	SRQ_LOOP(m_sharedMemory->getHeader()->lhb_partitions[partition].lpt_free_locks, lock_srq)
 	{
 		lbl* lock = (lbl*) ((UCHAR*) lock_srq - offsetof(lbl, lbl_lhb_hash));
 		// Here we use the "first fit" approach which costs us some memory,
@@ -1318,12 +1477,15 @@ lbl* LockManager::alloc_lock(USHORT length, CheckStatusWrapper* statusVector)
 		// to introduce yet another hash table for the free locks queue.
 		if (lock->lbl_size >= length)
 		{
-			remove_que(&lock->lbl_lhb_hash);
+			remove_que(&lock->lbl_lhb_hash, recover);
 			lock->lbl_type = type_lbl;
 			return lock;
 		}
 	}
 
+	if (recover)
+		return NULL;
+
 	lbl* lock = (lbl*) alloc(sizeof(lbl) + length, statusVector);
 	if (lock)
 	{
@@ -1340,6 +1502,32 @@ lbl* LockManager::alloc_lock(USHORT length, CheckStatusWrapper* statusVector)
 }
 
 
+lrq* LockManager::alloc_request(USHORT partition, lpt* recover)
+{
+/**************************************
+ *
+ *	a l l o c _ r e q u e s t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Reuse a free request block of the partition, if any.
+ *	The caller allocates a new one if needed.
+ *
+ **************************************/
+	ASSERT_PARTITION(recover);
+	srq& free_requests = m_sharedMemory->getHeader()->lhb_partitions[partition].lpt_free_requests;
+
+	if (SRQ_EMPTY(free_requests))
+		return NULL;
+
+	lrq* const request = (lrq*) ((UCHAR*) SRQ_NEXT(free_requests) - offsetof(lrq, lrq_lbl_requests));
+	remove_que(&request->lrq_lbl_requests, recover);
+
+	return request;
+}
+
+
 void LockManager::blocking_action(thread_db* tdbb, SRQ_PTR blocking_owner_offset)
 {
 /**************************************
@@ -2045,10 +2233,288 @@ void LockManager::debug_delay(ULONG lineno)
 }
 #endif
 
+
+#ifdef USE_PARTITION_MUTEX
+bool LockManager::fast_convert(SRQ_PTR request_offset,
+							   UCHAR type,
+							   lock_ast_t ast_routine,
+							   void* ast_argument,
+							   bool* granted)
+{
+/**************************************
+ *
+ *	f a s t _ c o n v e r t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Convert a lock working in its partition only.  This is done
+ *	if the conversion may be granted at once and nobody waits for
+ *	the lock.  Otherwise return false to do it the exclusive way.
+ *
+ **************************************/
+	USHORT partition_id;
+	SRQ_PTR owner_offset;
+
+	if (!find_partition(request_offset, &partition_id, &owner_offset))
+		return false;
+
+	lpt* const partition = acquire_partition(partition_id, owner_offset);
+	if (!partition)
+		return false;
+
+	lrq* const request = (lrq*) SRQ_ABS_PTR(request_offset);
+	lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	const own* const owner = (own*) SRQ_ABS_PTR(owner_offset);
+	bool done = false;
+
+	if (request->lrq_type == type_lrq && request->lrq_owner == owner_offset &&
+		lock->lbl_type == type_lbl && lock->lbl_partition == partition_id &&
+		owner->own_count && !request->lrq_data && !(request->lrq_flags & LRQ_pending) &&
+		!lock->lbl_pending_lrq_count)
+	{
+		// Compute the state of the lock without the request
+
+		--lock->lbl_counts[request->lrq_state];
+
+		if (compatibility[type][lock_state(lock)])
+		{
+			request->lrq_requested = type;
+			request->lrq_flags &= ~LRQ_blocking_seen;
+			request->lrq_ast_routine = ast_routine;
+			request->lrq_ast_argument = ast_argument;
+
+			++lock->lbl_counts[type];
+			request->lrq_state = type;
+			lock->lbl_state = lock_state(lock);
+
+			++partition->lpt_converts;
+			++partition->lpt_operations[lock->lbl_series < LCK_MAX_SERIES ? lock->lbl_series : 0];
+
+			*granted = done = true;
+		}
+		else
+			++lock->lbl_counts[request->lrq_state];
+	}
+
+	release_partition(partition_id);
+
+	return done;
+}
+
+
+bool LockManager::fast_dequeue(SRQ_PTR request_offset, bool* result)
+{
+/**************************************
+ *
+ *	f a s t _ d e q u e u e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Release a lock working in its partition only.  This is done
+ *	if nobody waits for the lock, the request is not blocking
+ *	and the lock keeps no data.  Otherwise return false to do it
+ *	the exclusive way.
+ *
+ **************************************/
+	USHORT partition_id;
+	SRQ_PTR owner_offset;
+
+	if (!find_partition(request_offset, &partition_id, &owner_offset))
+		return false;
+
+	lpt* const partition = acquire_partition(partition_id, owner_offset);
+	if (!partition)
+		return false;
+
+	lrq* const request = (lrq*) SRQ_ABS_PTR(request_offset);
+	lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	const own* const owner = (own*) SRQ_ABS_PTR(owner_offset);
+	bool done = false;
+
+	if (request->lrq_type == type_lrq && request->lrq_owner == owner_offset &&
+		lock->lbl_type == type_lbl && lock->lbl_partition == partition_id &&
+		owner->own_count && !(request->lrq_flags & (LRQ_blocking | LRQ_pending)) &&
+		!lock->lbl_pending_lrq_count && !lock->lbl_data)
+	{
+		++partition->lpt_deqs;
+		++partition->lpt_operations[lock->lbl_series < LCK_MAX_SERIES ? lock->lbl_series : 0];
+
+		request->lrq_ast_routine = NULL;
+		release_request(request, partition);
+
+		*result = done = true;
+	}
+
+	release_partition(partition_id);
+
+	return done;
+}
+
+
+bool LockManager::fast_downgrade(SRQ_PTR request_offset, UCHAR* new_state)
+{
+/**************************************
+ *
+ *	f a s t _ d o w n g r a d e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Downgrade a lock working in its partition only.  With no
+ *	pending requests the lock keeps its state, only null locks
+ *	are released.  Otherwise return false to do it the exclusive way.
+ *
+ **************************************/
+	USHORT partition_id;
+	SRQ_PTR owner_offset;
+
+	if (!find_partition(request_offset, &partition_id, &owner_offset))
+		return false;
+
+	lpt* const partition = acquire_partition(partition_id, owner_offset);
+	if (!partition)
+		return false;
+
+	lrq* const request = (lrq*) SRQ_ABS_PTR(request_offset);
+	lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	const own* const owner = (own*) SRQ_ABS_PTR(owner_offset);
+	bool done = false;
+
+	if (request->lrq_type == type_lrq && request->lrq_owner == owner_offset &&
+		lock->lbl_type == type_lbl && lock->lbl_partition == partition_id &&
+		owner->own_count && !request->lrq_data && !(request->lrq_flags & LRQ_pending) &&
+		!lock->lbl_pending_lrq_count)
+	{
+		const UCHAR state = request->lrq_state;
+
+		if (state > LCK_null)
+		{
+			request->lrq_requested = state;
+			request->lrq_flags &= ~LRQ_blocking_seen;
+
+			++partition->lpt_downgrades;
+
+			*new_state = state;
+			done = true;
+		}
+		else if (!(request->lrq_flags & LRQ_blocking) && !lock->lbl_data)
+		{
+			++partition->lpt_downgrades;
+
+			request->lrq_ast_routine = NULL;
+			release_request(request, partition);
+
+			*new_state = LCK_none;
+			done = true;
+		}
+	}
+
+	release_partition(partition_id);
+
+	return done;
+}
+
+
+SRQ_PTR LockManager::fast_enqueue(const USHORT series,
+								  const UCHAR* value,
+								  const USHORT length,
+								  UCHAR type,
+								  lock_ast_t ast_routine,
+								  void* ast_argument,
+								  SRQ_PTR owner_offset)
+{
+/**************************************
+ *
+ *	f a s t _ e n q u e u e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Enqueue on a lock working in its partition only.  This is done
+ *	if the request may be granted at once, nobody waits for the lock
+ *	and the partition has spare blocks for it.  Otherwise return
+ *	zero to do it the exclusive way.
+ *
+ **************************************/
+	const USHORT hash_slot = get_hash_slot(series, value, length);
+	const USHORT partition_id = hash_slot % LCK_PARTITIONS;
+
+	lpt* const partition = acquire_partition(partition_id, owner_offset);
+	if (!partition)
+		return 0;
+
+	own* const owner = (own*) SRQ_ABS_PTR(owner_offset);
+	lbl* lock = NULL;
+
+	if (owner->own_count && !SRQ_EMPTY(partition->lpt_free_requests))
+	{
+		lock = find_lock(series, value, length, hash_slot);
+
+		if (lock)
+		{
+			if (lock->lbl_pending_lrq_count || !compatibility[type][lock->lbl_state])
+				lock = NULL;
+		}
+		else if ( (lock = alloc_lock(length, partition_id, NULL, partition)) )
+		{
+			lock->lbl_state = type;
+			lock->lbl_series = (UCHAR) series;
+			lock->lbl_partition = (UCHAR) partition_id;
+			SRQ_INIT(lock->lbl_lhb_data);
+			lock->lbl_data = 0;
+			lock->lbl_flags = 0;
+			lock->lbl_pending_lrq_count = 0;
+			memset(lock->lbl_counts, 0, sizeof(lock->lbl_counts));
+			lock->lbl_length = length;
+			memcpy(lock->lbl_key, value, length);
+			SRQ_INIT(lock->lbl_requests);
+			insert_tail(&m_sharedMemory->getHeader()->lhb_hash[hash_slot], &lock->lbl_lhb_hash, partition);
+		}
+	}
+
+	SRQ_PTR request_offset = 0;
+
+	if (lock)
+	{
+		lrq* const request = alloc_request(partition_id, partition);
+		fb_assert(request);
+
+		request->lrq_type = type_lrq;
+		request->lrq_flags = 0;
+		request->lrq_requested = type;
+		request->lrq_data = 0;
+		request->lrq_owner = owner_offset;
+		request->lrq_ast_routine = ast_routine;
+		request->lrq_ast_argument = ast_argument;
+		request->lrq_lock = SRQ_REL_PTR(lock);
+		insert_tail(&owner->own_requests[partition_id], &request->lrq_own_requests, partition);
+		SRQ_INIT(request->lrq_own_blocks);
+		SRQ_INIT(request->lrq_own_pending);
+		insert_tail(&lock->lbl_requests, &request->lrq_lbl_requests, partition);
+
+		++lock->lbl_counts[type];
+		request->lrq_state = type;
+		lock->lbl_state = lock_state(lock);
+
+		++partition->lpt_enqs;
+		++partition->lpt_operations[series < LCK_MAX_SERIES ? series : 0];
+
+		request_offset = SRQ_REL_PTR(request);
+	}
+
+	release_partition(partition_id);
+
+	return request_offset;
+}
+#endif // USE_PARTITION_MUTEX
+
+
 lbl* LockManager::find_lock(USHORT series,
 							const UCHAR* value,
 							USHORT length,
-							USHORT* slot)
+							USHORT hash_slot)
 {
 /**************************************
  *
@@ -2058,18 +2524,14 @@ lbl* LockManager::find_lock(USHORT series,
  *
  * Functional description
  *	Find a lock block given a resource
- *	name. If it doesn't exist, the hash
- *	slot will be useful for enqueing a
- *	lock.
+ *	name and its hash slot. The caller
+ *	holds at least the partition of the
+ *	slot.
  *
  **************************************/
 
 	// See if the lock already exists
 
-	const USHORT hash_slot = *slot =
-		(USHORT) InternalHash::hash(length, value, m_sharedMemory->getHeader()->lhb_hash_slots);
-
-	ASSERT_ACQUIRED;
 	srq* const hash_header = &m_sharedMemory->getHeader()->lhb_hash[hash_slot];
 
 	for (srq* lock_srq = (SRQ) SRQ_ABS_PTR(hash_header->srq_forward);
@@ -2089,6 +2551,64 @@ lbl* LockManager::find_lock(USHORT series,
 }
 
 
+#ifdef USE_PARTITION_MUTEX
+bool LockManager::find_partition(SRQ_PTR request_offset, USHORT* partition_id, SRQ_PTR* owner_offset)
+{
+/**************************************
+ *
+ *	f i n d _ p a r t i t i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Find the partition and the owner of a granted request.
+ *	Nothing is locked yet, so the caller checks it again in
+ *	the partition.  Return false if the request doesn't look
+ *	valid, get_request() will complain about it.
+ *
+ **************************************/
+	if (request_offset <= 0)
+		return false;
+
+	// Don't let the mapping go away while looking at the request
+
+	ReadLockGuard guard(m_remapSync, FB_FUNCTION);
+
+	const lrq* const request = (lrq*) SRQ_ABS_PTR(request_offset);
+	if (request->lrq_type != type_lrq || request->lrq_lock <= 0)
+		return false;
+
+	const lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	if (lock->lbl_type != type_lbl || lock->lbl_partition >= LCK_PARTITIONS)
+		return false;
+
+	*partition_id = lock->lbl_partition;
+	*owner_offset = request->lrq_owner;
+
+	return *owner_offset > 0;
+}
+#endif // USE_PARTITION_MUTEX
+
+
+USHORT LockManager::get_hash_slot(USHORT series, const UCHAR* value, USHORT length) const
+{
+/**************************************
+ *
+ *	g e t _ h a s h _ s l o t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compute the hash slot of a resource name. The series is mixed
+ *	in, so equal keys of different series (say, relation and index
+ *	existence locks of the same id) go to different partitions.
+ *
+ **************************************/
+
+	return (USHORT) ((InternalHash::hash(length, value) + series) % m_hashSlots);
+}
+
+
 lrq* LockManager::get_request(SRQ_PTR offset)
 {
 /**************************************
@@ -2243,7 +2763,8 @@ bool LockManager::init_owner_block(CheckStatusWrapper* statusVector, own* owner,
 	owner->own_thread_id = 0;
 	SRQ_INIT(owner->own_lhb_owners);
 	SRQ_INIT(owner->own_prc_owners);
-	SRQ_INIT(owner->own_requests);
+	for (USHORT i = 0; i < LCK_PARTITIONS; i++)
+		SRQ_INIT(owner->own_requests[i]);
 	SRQ_INIT(owner->own_blocks);
 	SRQ_INIT(owner->own_pending);
 	owner->own_acquire_time = 0;
@@ -2303,9 +2824,18 @@ bool LockManager::initialize(SharedMemoryBase* sm, bool initializeMemory)
 	SRQ_INIT(hdr->lhb_owners);
 	SRQ_INIT(hdr->lhb_free_processes);
 	SRQ_INIT(hdr->lhb_free_owners);
-	SRQ_INIT(hdr->lhb_free_locks);
 	SRQ_INIT(hdr->lhb_free_requests);
 
+	for (USHORT i = 0; i < LCK_PARTITIONS; i++)
+	{
+		lpt* const partition = &hdr->lhb_partitions[i];
+#ifdef USE_PARTITION_MUTEX
+		sm->mutexInit(&partition->lpt_mutex);
+#endif
+		SRQ_INIT(partition->lpt_free_locks);
+		SRQ_INIT(partition->lpt_free_requests);
+	}
+
 	int hash_slots = m_config->getLockHashSlots();
 	if (hash_slots < HASH_MIN_SLOTS)
 		hash_slots = HASH_MIN_SLOTS;
@@ -2410,7 +2940,7 @@ void LockManager::insert_data_que(lbl* lock)
 }
 
 
-void LockManager::insert_tail(SRQ lock_srq, SRQ node)
+void LockManager::insert_tail(SRQ lock_srq, SRQ node, lpt* partition)
 {
 /**************************************
  *
@@ -2430,13 +2960,30 @@ void LockManager::insert_tail(SRQ lock_srq, SRQ node)
  *	eg: it will put the queue back to the state
  *	prior to the insertion being started.
  *
+ *	Working in a single partition, its own values
+ *	are set instead of the shb ones.
+ *
  **************************************/
-	ASSERT_ACQUIRED;
-	shb* const recover = (shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary);
+	ASSERT_PARTITION(partition);
+	SRQ_PTR* insert_que;
+	SRQ_PTR* insert_prior;
+
+	if (partition)
+	{
+		insert_que = &partition->lpt_insert_que;
+		insert_prior = &partition->lpt_insert_prior;
+	}
+	else
+	{
+		shb* const recover = (shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary);
+		insert_que = &recover->shb_insert_que;
+		insert_prior = &recover->shb_insert_prior;
+	}
+
 	DEBUG_DELAY;
-	recover->shb_insert_que = SRQ_REL_PTR(lock_srq);
+	*insert_que = SRQ_REL_PTR(lock_srq);
 	DEBUG_DELAY;
-	recover->shb_insert_prior = lock_srq->srq_backward;
+	*insert_prior = lock_srq->srq_backward;
 	DEBUG_DELAY;
 
 	node->srq_forward = SRQ_REL_PTR(lock_srq);
@@ -2451,9 +2998,9 @@ void LockManager::insert_tail(SRQ lock_srq, SRQ node)
 	lock_srq->srq_backward = SRQ_REL_PTR(node);
 	DEBUG_DELAY;
 
-	recover->shb_insert_que = 0;
+	*insert_que = 0;
 	DEBUG_DELAY;
-	recover->shb_insert_prior = 0;
+	*insert_prior = 0;
 	DEBUG_DELAY;
 }
 
@@ -2884,10 +3431,13 @@ void LockManager::purge_owner(SRQ_PTR purging_owner_offset, own* owner)
 	// Release any locks that are active
 
 	SRQ lock_srq;
-	while ((lock_srq = SRQ_NEXT(owner->own_requests)) != &owner->own_requests)
+	for (USHORT i = 0; i < LCK_PARTITIONS; i++)
 	{
-		lrq* request = (lrq*) ((UCHAR*) lock_srq - offsetof(lrq, lrq_own_requests));
-		release_request(request);
+		while ((lock_srq = SRQ_NEXT(owner->own_requests[i])) != &owner->own_requests[i])
+		{
+			lrq* request = (lrq*) ((UCHAR*) lock_srq - offsetof(lrq, lrq_own_requests));
+			release_request(request);
+		}
 	}
 
 	// Release any repost requests left dangling on blocking queue
@@ -2985,7 +3535,7 @@ void LockManager::remap_local_owners()
 }
 
 
-void LockManager::remove_que(SRQ node)
+void LockManager::remove_que(SRQ node, lpt* partition)
 {
 /**************************************
  *
@@ -3007,11 +3557,16 @@ void LockManager::remove_que(SRQ node)
  *	nodes may have changed prior to the crash, we need to redo the
  *	work only based on what is in <node>.
  *
+ *	Working in a single partition, its own value
+ *	is set instead of the shb one.
+ *
  **************************************/
-	ASSERT_ACQUIRED;
-	shb* recover = (shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary);
+	ASSERT_PARTITION(partition);
+	SRQ_PTR* const remove_node = partition ? &partition->lpt_remove_node :
+		&((shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary))->shb_remove_node;
+
 	DEBUG_DELAY;
-	recover->shb_remove_node = SRQ_REL_PTR(node);
+	*remove_node = SRQ_REL_PTR(node);
 	DEBUG_DELAY;
 
 	SRQ lock_srq = (SRQ) SRQ_ABS_PTR(node->srq_forward);
@@ -3036,7 +3591,7 @@ void LockManager::remove_que(SRQ node)
 	lock_srq->srq_forward = node->srq_forward;
 
 	DEBUG_DELAY;
-	recover->shb_remove_node = 0;
+	*remove_node = 0;
 	DEBUG_DELAY;
 
 	// To prevent trying to remove this entry a second time, which could occur
@@ -3083,13 +3638,107 @@ void LockManager::release_shmem(SRQ_PTR owner_offset)
 
 	m_sharedMemory->getHeader()->lhb_active_owner = 0;
 
+#ifdef USE_PARTITION_MUTEX
+	release_partitions();
+#endif
+
 	m_sharedMemory->mutexUnlock();
 
 	DEBUG_DELAY;
 }
 
 
-void LockManager::release_request(lrq* request)
+#ifdef USE_PARTITION_MUTEX
+void LockManager::recover_partitions()
+{
+/**************************************
+ *
+ *	r e c o v e r _ p a r t i t i o n s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Mark all partitions as owned by the lock table holder.  If
+ *	somebody died while working in a partition, finish up the
+ *	queue operation left in progress, like acquire_shmem() does
+ *	for the whole table.
+ *
+ **************************************/
+	lhb* const header = m_sharedMemory->getHeader();
+
+	for (USHORT i = 0; i < LCK_PARTITIONS; i++)
+	{
+		lpt* const partition = &header->lhb_partitions[i];
+		const SRQ_PTR prior_active = partition->lpt_active_owner;
+		partition->lpt_active_owner = DUMMY_OWNER;
+
+		if (prior_active > 0)
+		{
+			post_history(his_active, header->lhb_active_owner, prior_active, (SRQ_PTR) 0, false);
+
+			if (partition->lpt_remove_node)
+			{
+				// There was a remove_que operation in progress when the prior_owner died
+				remove_que((SRQ) SRQ_ABS_PTR(partition->lpt_remove_node), partition);
+			}
+			else if (partition->lpt_insert_que && partition->lpt_insert_prior)
+			{
+				// There was a insert_que operation in progress when the prior_owner died
+				SRQ lock_srq = (SRQ) SRQ_ABS_PTR(partition->lpt_insert_que);
+				lock_srq->srq_backward = partition->lpt_insert_prior;
+				lock_srq = (SRQ) SRQ_ABS_PTR(partition->lpt_insert_prior);
+				lock_srq->srq_forward = partition->lpt_insert_que;
+				partition->lpt_insert_que = 0;
+				partition->lpt_insert_prior = 0;
+			}
+		}
+	}
+}
+
+
+void LockManager::release_partition(USHORT partition_id)
+{
+/**************************************
+ *
+ *	r e l e a s e _ p a r t i t i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Release a partition acquired by acquire_partition().
+ *
+ **************************************/
+	DEBUG_DELAY;
+
+	m_sharedMemory->getHeader()->lhb_partitions[partition_id].lpt_active_owner = 0;
+	m_sharedMemory->mutexUnlock(&m_partitionMutexes[partition_id].lpt_mutex);
+}
+
+
+void LockManager::release_partitions()
+{
+/**************************************
+ *
+ *	r e l e a s e _ p a r t i t i o n s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Release all partitions before releasing the lock table.
+ *
+ **************************************/
+	lhb* const header = m_sharedMemory->getHeader();
+
+	for (USHORT i = 0; i < LCK_PARTITIONS; i++)
+	{
+		header->lhb_partitions[i].lpt_active_owner = 0;
+		m_sharedMemory->mutexUnlock(&m_partitionMutexes[i].lpt_mutex);
+	}
+}
+#endif // USE_PARTITION_MUTEX
+
+
+void LockManager::release_request(lrq* request, lpt* recover)
 {
 /**************************************
  *
@@ -3099,24 +3748,28 @@ void LockManager::release_request(lrq* request)
  *
  * Functional description
  *	Release a request.  This is called both by release lock
- *	and by the cleanup handler.
+ *	and by the cleanup handler.  The request and its lock (if
+ *	released too) return to the free blocks of the partition.
  *
  **************************************/
-	ASSERT_ACQUIRED;
+	ASSERT_PARTITION(recover);
 
 	// Start by disconnecting request from both lock and process
 
-	remove_que(&request->lrq_lbl_requests);
-	remove_que(&request->lrq_own_requests);
+	remove_que(&request->lrq_lbl_requests, recover);
+	remove_que(&request->lrq_own_requests, recover);
 
-	request->lrq_type = type_null;
-	insert_tail(&m_sharedMemory->getHeader()->lhb_free_requests, &request->lrq_lbl_requests);
 	lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	lpt* const partition = &m_sharedMemory->getHeader()->lhb_partitions[lock->lbl_partition];
+
+	request->lrq_type = type_null;
+	insert_tail(&partition->lpt_free_requests, &request->lrq_lbl_requests, recover);
 
 	// If the request is marked as blocking, clean it up
 
 	if (request->lrq_flags & LRQ_blocking)
 	{
+		fb_assert(!recover);
 		remove_que(&request->lrq_own_blocks);
 		request->lrq_flags &= ~LRQ_blocking;
 	}
@@ -3126,6 +3779,7 @@ void LockManager::release_request(lrq* request)
 
 	if (request->lrq_flags & LRQ_pending)
 	{
+		fb_assert(!recover);
 		remove_que(&request->lrq_own_pending);
 		request->lrq_flags &= ~LRQ_pending;
 		lock->lbl_pending_lrq_count--;
@@ -3139,11 +3793,11 @@ void LockManager::release_request(lrq* request)
 	{
 		CHECK(lock->lbl_pending_lrq_count == 0);
 
-		remove_que(&lock->lbl_lhb_hash);
-		remove_que(&lock->lbl_lhb_data);
+		remove_que(&lock->lbl_lhb_hash, recover);
+		remove_que(&lock->lbl_lhb_data, recover);
 		lock->lbl_type = type_null;
 
-		insert_tail(&m_sharedMemory->getHeader()->lhb_free_locks, &lock->lbl_lhb_hash);
+		insert_tail(&partition->lpt_free_locks, &lock->lbl_lhb_hash, recover);
 		return;
 	}
 
@@ -3306,14 +3960,29 @@ void LockManager::validate_lhb(const lhb* alhb)
 		validate_owner(SRQ_REL_PTR(owner), EXPECT_freed);
 	}
 
-	SRQ_LOOP(alhb->lhb_free_locks, lock_srq)
+	for (USHORT i = 0; i < LCK_PARTITIONS; i++)
 	{
-		// Validate that the next backpointer points back to us
-		const srq* const que_next = SRQ_NEXT((*lock_srq));
-		CHECK(que_next->srq_backward == SRQ_REL_PTR(lock_srq));
+		const lpt* const partition = &alhb->lhb_partitions[i];
 
-		const lbl* const lock = (lbl*) ((UCHAR*) lock_srq - offsetof(lbl, lbl_lhb_hash));
-		validate_lock(SRQ_REL_PTR(lock), EXPECT_freed, (SRQ_PTR) 0);
+		SRQ_LOOP(partition->lpt_free_locks, lock_srq)
+		{
+			// Validate that the next backpointer points back to us
+			const srq* const que_next = SRQ_NEXT((*lock_srq));
+			CHECK(que_next->srq_backward == SRQ_REL_PTR(lock_srq));
+
+			const lbl* const lock = (lbl*) ((UCHAR*) lock_srq - offsetof(lbl, lbl_lhb_hash));
+			validate_lock(SRQ_REL_PTR(lock), EXPECT_freed, (SRQ_PTR) 0);
+		}
+
+		SRQ_LOOP(partition->lpt_free_requests, lock_srq)
+		{
+			// Validate that the next backpointer points back to us
+			const srq* const que_next = SRQ_NEXT((*lock_srq));
+			CHECK(que_next->srq_backward == SRQ_REL_PTR(lock_srq));
+
+			const lrq* const request = (lrq*) ((UCHAR*) lock_srq - offsetof(lrq, lrq_lbl_requests));
+			validate_request(SRQ_REL_PTR(request), EXPECT_freed, RECURSE_not);
+		}
 	}
 
 	SRQ_LOOP(alhb->lhb_free_requests, lock_srq)
@@ -3462,84 +4131,88 @@ void LockManager::validate_owner(const SRQ_PTR own_ptr, USHORT freed)
 	CHECK(!(owner->own_flags & ~(OWN_scanned | OWN_wakeup | OWN_signaled)));
 
 	const srq* lock_srq;
-	SRQ_LOOP(owner->own_requests, lock_srq)
+	for (USHORT i = 0; i < LCK_PARTITIONS; i++)
 	{
-		// Validate that the next backpointer points back to us
-		const srq* const que_next = SRQ_NEXT((*lock_srq));
-		CHECK(que_next->srq_backward == SRQ_REL_PTR(lock_srq));
+		SRQ_LOOP(owner->own_requests[i], lock_srq)
+		{
+			// Validate that the next backpointer points back to us
+			const srq* const que_next = SRQ_NEXT((*lock_srq));
+			CHECK(que_next->srq_backward == SRQ_REL_PTR(lock_srq));
 
-		CHECK(freed == EXPECT_inuse);	// should not be in loop for freed owner
+			CHECK(freed == EXPECT_inuse);	// should not be in loop for freed owner
 
-		const lrq* const request = (lrq*) ((UCHAR*) lock_srq - offsetof(lrq, lrq_own_requests));
-		validate_request(SRQ_REL_PTR(request), EXPECT_inuse, RECURSE_not);
-		CHECK(request->lrq_owner == own_ptr);
+			const lrq* const request = (lrq*) ((UCHAR*) lock_srq - offsetof(lrq, lrq_own_requests));
+			validate_request(SRQ_REL_PTR(request), EXPECT_inuse, RECURSE_not);
+			CHECK(request->lrq_owner == own_ptr);
+			CHECK(((lbl*) SRQ_ABS_PTR(request->lrq_lock))->lbl_partition == i);
 
-		// Make sure that request marked as blocking also exists in the blocking list
+			// Make sure that request marked as blocking also exists in the blocking list
 
-		if (request->lrq_flags & LRQ_blocking)
-		{
-			ULONG found = 0;
-			const srq* que2;
-			SRQ_LOOP(owner->own_blocks, que2)
+			if (request->lrq_flags & LRQ_blocking)
 			{
-				// Validate that the next backpointer points back to us
-				const srq* const que2_next = SRQ_NEXT((*que2));
-				CHECK(que2_next->srq_backward == SRQ_REL_PTR(que2));
+				ULONG found = 0;
+				const srq* que2;
+				SRQ_LOOP(owner->own_blocks, que2)
+				{
+					// Validate that the next backpointer points back to us
+					const srq* const que2_next = SRQ_NEXT((*que2));
+					CHECK(que2_next->srq_backward == SRQ_REL_PTR(que2));
 
-				const lrq* const request2 = (lrq*) ((UCHAR*) que2 - offsetof(lrq, lrq_own_blocks));
-				CHECK(request2->lrq_owner == own_ptr);
+					const lrq* const request2 = (lrq*) ((UCHAR*) que2 - offsetof(lrq, lrq_own_blocks));
+					CHECK(request2->lrq_owner == own_ptr);
 
-				if (SRQ_REL_PTR(request2) == SRQ_REL_PTR(request))
-					found++;
+					if (SRQ_REL_PTR(request2) == SRQ_REL_PTR(request))
+						found++;
 
-				CHECK(found <= 1);	// watch for loops in queue
+					CHECK(found <= 1);	// watch for loops in queue
+				}
+				CHECK(found == 1);	// request marked as blocking must be in blocking queue
 			}
-			CHECK(found == 1);	// request marked as blocking must be in blocking queue
-		}
 
-		// Make sure that request marked as pending also exists in the pending list,
-		// as well as in the queue for the lock
+			// Make sure that request marked as pending also exists in the pending list,
+			// as well as in the queue for the lock
 
-		if (request->lrq_flags & LRQ_pending)
-		{
-			ULONG found = 0;
-			const srq* que2;
-			SRQ_LOOP(owner->own_pending, que2)
+			if (request->lrq_flags & LRQ_pending)
 			{
-				// Validate that the next backpointer points back to us
-				const srq* const que2_next = SRQ_NEXT((*que2));
-				CHECK(que2_next->srq_backward == SRQ_REL_PTR(que2));
+				ULONG found = 0;
+				const srq* que2;
+				SRQ_LOOP(owner->own_pending, que2)
+				{
+					// Validate that the next backpointer points back to us
+					const srq* const que2_next = SRQ_NEXT((*que2));
+					CHECK(que2_next->srq_backward == SRQ_REL_PTR(que2));
 
-				const lrq* const request2 = (lrq*) ((UCHAR*) que2 - offsetof(lrq, lrq_own_pending));
-				CHECK(request2->lrq_owner == own_ptr);
+					const lrq* const request2 = (lrq*) ((UCHAR*) que2 - offsetof(lrq, lrq_own_pending));
+					CHECK(request2->lrq_owner == own_ptr);
 
-				if (SRQ_REL_PTR(request2) == SRQ_REL_PTR(request))
-					found++;
+					if (SRQ_REL_PTR(request2) == SRQ_REL_PTR(request))
+						found++;
 
-				CHECK(found <= 1);	// watch for loops in queue
-			}
-			CHECK(found == 1);	// request marked as pending must be in pending queue
-
-			// Make sure the pending request is on the list of requests for the lock
+					CHECK(found <= 1);	// watch for loops in queue
+				}
+				CHECK(found == 1);	// request marked as pending must be in pending queue
 
-			const lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+				// Make sure the pending request is on the list of requests for the lock
 
-			bool found_pending = false;
-			const srq* que_of_lbl_requests;
-			SRQ_LOOP(lock->lbl_requests, que_of_lbl_requests)
-			{
-				const lrq* const pending =
-					(lrq*) ((UCHAR*) que_of_lbl_requests - offsetof(lrq, lrq_lbl_requests));
+				const lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
 
-				if (SRQ_REL_PTR(pending) == SRQ_REL_PTR(request))
+				bool found_pending = false;
+				const srq* que_of_lbl_requests;
+				SRQ_LOOP(lock->lbl_requests, que_of_lbl_requests)
 				{
-					found_pending = true;
-					break;
+					const lrq* const pending =
+						(lrq*) ((UCHAR*) que_of_lbl_requests - offsetof(lrq, lrq_lbl_requests));
+
+					if (SRQ_REL_PTR(pending) == SRQ_REL_PTR(request))
+					{
+						found_pending = true;
+						break;
+					}
 				}
-			}
 
-			// pending request must exist in the lock's request queue
-			CHECK(found_pending);
+				// pending request must exist in the lock's request queue
+				CHECK(found_pending);
+			}
 		}
 	}
 
@@ -3567,9 +4240,12 @@ void LockManager::validate_owner(const SRQ_PTR own_ptr, USHORT freed)
 
 		// Make sure that each block also exists in the request list
 
+		const srq& own_requests =
+			owner->own_requests[((lbl*) SRQ_ABS_PTR(request->lrq_lock))->lbl_partition];
+
 		ULONG found = 0;
 		const srq* que2;
-		SRQ_LOOP(owner->own_requests, que2)
+		SRQ_LOOP(own_requests, que2)
 		{
 			// Validate that the next backpointer points back to us
 			const srq* const que2_next = SRQ_NEXT((*que2));
@@ -3609,9 +4285,12 @@ void LockManager::validate_owner(const SRQ_PTR own_ptr, USHORT freed)
 
 		// Make sure that each pending request also exists in the request list
 
+		const srq& own_requests =
+			owner->own_requests[((lbl*) SRQ_ABS_PTR(request->lrq_lock))->lbl_partition];
+
 		ULONG found = 0;
 		const srq* que2;
-		SRQ_LOOP(owner->own_requests, que2)
+		SRQ_LOOP(own_requests, que2)
 		{
 			// Validate that the next backpointer points back to us
 			const srq* const que2_next = SRQ_NEXT((*que2));
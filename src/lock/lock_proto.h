@@ -93,7 +93,7 @@ const UCHAR type_lpr	= 7;
 
 // Version number of the lock table.
 // Must be increased every time the shmem layout is changed.
-const USHORT BASE_LHB_VERSION = 19;
+const USHORT BASE_LHB_VERSION = 20;
 const USHORT PLATFORM_LHB_VERSION = 128;	// 64-bit target
 
 #if SIZEOF_VOID_P == 8
@@ -103,6 +103,39 @@ const USHORT LHB_VERSION = BASE_LHB_VERSION;
 #endif
 
 
+// Lock table partitions. Every lock belongs to the partition of its hash slot,
+// the partition keeps the free blocks for its locks and requests. Where the
+// partitions have their own mutexes, the requests not interfering with other
+// owners are processed holding just the mutex of their partition. Everything
+// else (waits, blocking ASTs, deadlock scans, remaps) runs in the exclusive
+// mode holding the lock table mutex and the mutexes of all partitions.
+
+const USHORT LCK_PARTITIONS = 16;
+
+#if defined(HAVE_SHARED_MUTEX_SECTION) && defined(USE_MUTEX_MAP) && !defined(USE_SHMEM_EXT)
+#define USE_PARTITION_MUTEX
+#endif
+
+struct lpt
+{
+#ifdef USE_PARTITION_MUTEX
+	struct ScratchBird::mtx lpt_mutex;	// Partition mutex
+#endif
+	SRQ_PTR lpt_active_owner;		// Owner working in the partition, if any
+	SRQ_PTR lpt_remove_node;		// Node removing itself
+	SRQ_PTR lpt_insert_que;			// Queue inserting into
+	SRQ_PTR lpt_insert_prior;		// Prior of inserting queue
+	srq lpt_free_locks;				// Free lock blocks
+	srq lpt_free_requests;			// Free lock requests
+	FB_UINT64 lpt_acquires;
+	FB_UINT64 lpt_acquire_blocks;
+	FB_UINT64 lpt_enqs;
+	FB_UINT64 lpt_converts;
+	FB_UINT64 lpt_downgrades;
+	FB_UINT64 lpt_deqs;
+	FB_UINT64 lpt_operations[LCK_MAX_SERIES];
+};
+
 // Lock header block -- one per lock file, lives up front
 
 struct lhb : public ScratchBird::MemoryHeader
@@ -114,8 +147,7 @@ struct lhb : public ScratchBird::MemoryHeader
 	srq lhb_processes;				// Que of active processes
 	srq lhb_free_processes;			// Free process blocks
 	srq lhb_free_owners;			// Free owner blocks
-	srq lhb_free_locks;				// Free lock blocks
-	srq lhb_free_requests;			// Free lock requests
+	srq lhb_free_requests;			// Free repost requests
 	ULONG lhb_length;				// Size of lock table
 	ULONG lhb_used;					// Bytes of lock table in use
 	USHORT lhb_hash_slots;			// Number of hash slots allocated
@@ -143,6 +175,7 @@ struct lhb : public ScratchBird::MemoryHeader
 	FB_UINT64 lhb_scans;
 	FB_UINT64 lhb_deadlocks;
 	srq lhb_data[LCK_MAX_SERIES];
+	lpt lhb_partitions[LCK_PARTITIONS];
 	srq lhb_hash[1];			// Hash table
 };
 
@@ -172,6 +205,7 @@ struct lbl
 	LOCK_DATA_T lbl_data;			// User data
 	UCHAR lbl_series;				// Lock series
 	UCHAR lbl_flags;				// Unused. Misc flags
+	UCHAR lbl_partition;			// Lock table partition
 	USHORT lbl_pending_lrq_count;	// count of lbl_requests with LRQ_pending
 	USHORT lbl_counts[LCK_max];		// Counts of granted locks
 	UCHAR lbl_key[1];				// Key value
@@ -229,7 +263,7 @@ struct own
 	LOCK_OWNER_T own_owner_id;		// Owner ID
 	srq own_lhb_owners;				// Owner que (global)
 	srq own_prc_owners;				// Owner que (process wide)
-	srq own_requests;				// Lock requests granted
+	srq own_requests[LCK_PARTITIONS];	// Lock requests granted, by partition
 	srq own_blocks;					// Lock requests blocking
 	srq own_pending;				// Lock requests pending
 	SRQ_PTR own_process;			// Process we belong to
@@ -416,7 +450,8 @@ public:
 private:
 	void acquire_shmem(SRQ_PTR);
 	UCHAR* alloc(USHORT, ScratchBird::CheckStatusWrapper*);
-	lbl* alloc_lock(USHORT, ScratchBird::CheckStatusWrapper*);
+	lbl* alloc_lock(USHORT, USHORT, ScratchBird::CheckStatusWrapper*, lpt* = NULL);
+	lrq* alloc_request(USHORT, lpt* = NULL);
 	void blocking_action(thread_db*, SRQ_PTR);
 	void blocking_action_thread();
 	void bug(ScratchBird::CheckStatusWrapper*, const TEXT*);
@@ -427,13 +462,14 @@ private:
 	lrq* deadlock_scan(own*, lrq*);
 	lrq* deadlock_walk(lrq*, bool*);
 	void debug_delay(ULONG);
-	lbl* find_lock(USHORT, const UCHAR*, USHORT, USHORT*);
+	lbl* find_lock(USHORT, const UCHAR*, USHORT, USHORT);
+	USHORT get_hash_slot(USHORT, const UCHAR*, USHORT) const;
 	lrq* get_request(SRQ_PTR);
 	void grant(lrq*, lbl*);
 	bool grant_or_que(thread_db*, lrq*, lbl*, SSHORT);
 	bool init_owner_block(ScratchBird::CheckStatusWrapper*, own*, UCHAR, LOCK_OWNER_T);
 	void insert_data_que(lbl*);
-	void insert_tail(SRQ, SRQ);
+	void insert_tail(SRQ, SRQ, lpt* = NULL);
 	bool internal_convert(thread_db* database, ScratchBird::CheckStatusWrapper*, SRQ_PTR, UCHAR, SSHORT,
 		lock_ast_t, void*);
 	void internal_dequeue(SRQ_PTR);
@@ -446,9 +482,9 @@ private:
 	void purge_owner(SRQ_PTR, own*);
 	void purge_process(prc*);
 	void remap_local_owners();
-	void remove_que(SRQ);
+	void remove_que(SRQ, lpt* = NULL);
 	void release_shmem(SRQ_PTR);
-	void release_request(lrq*);
+	void release_request(lrq*, lpt* = NULL);
 	bool signal_owner(thread_db*, own*);
 
 	void validate_history(const SRQ_PTR history_header);
@@ -459,6 +495,20 @@ private:
 	void validate_shb(const SRQ_PTR);
 
 	void wait_for_request(thread_db*, lrq*, SSHORT);
+
+#ifdef USE_PARTITION_MUTEX
+	lpt* acquire_partition(USHORT, SRQ_PTR);
+	void release_partition(USHORT);
+	void acquire_partitions();
+	void recover_partitions();
+	void release_partitions();
+	bool find_partition(SRQ_PTR, USHORT*, SRQ_PTR*);
+
+	SRQ_PTR fast_enqueue(const USHORT, const UCHAR*, const USHORT, UCHAR, lock_ast_t, void*, SRQ_PTR);
+	bool fast_convert(SRQ_PTR, UCHAR, lock_ast_t, void*, bool*);
+	bool fast_downgrade(SRQ_PTR, UCHAR*);
+	bool fast_dequeue(SRQ_PTR, bool*);
+#endif
 	bool init_shared_file(ScratchBird::CheckStatusWrapper*);
 	void get_shared_file_name(ScratchBird::PathName&, ULONG extend = 0) const;
 
@@ -481,6 +531,10 @@ private:
 
 	ScratchBird::Mutex m_localMutex;
 	ScratchBird::RWLock m_remapSync;
+#ifdef USE_PARTITION_MUTEX
+	lpt* m_partitionMutexes;		// separate mapping of the partitions, used for mutexes only
+#endif
+	USHORT m_hashSlots;
 	ScratchBird::AtomicCounter m_waitingOwners;
 
 	ThreadFinishSync<LockManager*> m_cleanupSync;
@@ -171,6 +171,7 @@ namespace
 	};
 }
 
+static void get_totals(const lhb*, lhb&);
 static void prt_lock_activity(OUTFILE, const lhb*, USHORT, ULONG, ULONG);
 static void prt_history(OUTFILE, const lhb*, SRQ_PTR, const SCHAR*);
 static void prt_lock(OUTFILE, const lhb*, const lbl*, USHORT);
@@ -628,6 +629,12 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 
 		if (sw_consistency)
 		{
+#ifdef USE_PARTITION_MUTEX
+			// Some changes are made holding just a partition of the lock file
+			for (USHORT i = 0; i < LCK_PARTITIONS; i++)
+				shmem_data->shared_memory->mutexLock(&LOCK_header->lhb_partitions[i].lpt_mutex);
+#endif
+
 #ifndef USE_SHMEM_EXT
 			// To avoid changes in the lock file while we are dumping it - make
 			// a local buffer, lock the lock file, copy it, then unlock the
@@ -649,6 +656,12 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 			LOCK_header = (lhb*)(UCHAR*) buffer;
 #endif
 
+#ifdef USE_PARTITION_MUTEX
+			lhb* const header = (lhb*) (shmem_data->shared_memory->sh_mem_header);
+			for (USHORT i = 0; i < LCK_PARTITIONS; i++)
+				shmem_data->shared_memory->mutexUnlock(&header->lhb_partitions[i].lpt_mutex);
+#endif
+
 			shmem_data->shared_memory->mutexUnlock();
 		}
 	  }
@@ -804,11 +817,16 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 			(const TEXT*)HtmlLink(preOwn, LOCK_header->lhb_active_owner),
 			LOCK_header->lhb_length, LOCK_header->lhb_used);
 
+	// Operations made in a partition only are counted there
+
+	lhb totals;
+	get_totals(LOCK_header, totals);
+
 	FPRINTF(outfile,
 			"\tEnqs: %6" UQUADFORMAT", Converts: %6" UQUADFORMAT
 			", Rejects: %6" UQUADFORMAT", Blocks: %6" UQUADFORMAT"\n",
-			LOCK_header->lhb_enqs, LOCK_header->lhb_converts,
-			LOCK_header->lhb_denies, LOCK_header->lhb_blocks);
+			totals.lhb_enqs, totals.lhb_converts,
+			totals.lhb_denies, totals.lhb_blocks);
 
 	FPRINTF(outfile,
 			"\tDeadlock scans: %6" UQUADFORMAT", Deadlocks: %6" UQUADFORMAT
@@ -819,13 +837,13 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 	FPRINTF(outfile,
 			"\tAcquires: %6" UQUADFORMAT", Acquire blocks: %6" UQUADFORMAT
 			", Spin count: %3" ULONGFORMAT"\n",
-			LOCK_header->lhb_acquires, LOCK_header->lhb_acquire_blocks,
-			LOCK_header->lhb_acquire_spins);
+			totals.lhb_acquires, totals.lhb_acquire_blocks,
+			totals.lhb_acquire_spins);
 
-	if (LOCK_header->lhb_acquire_blocks)
+	if (totals.lhb_acquire_blocks)
 	{
 		const float bottleneck =
-			(float) ((100. * LOCK_header->lhb_acquire_blocks) / LOCK_header->lhb_acquires);
+			(float) ((100. * totals.lhb_acquire_blocks) / totals.lhb_acquires);
 		FPRINTF(outfile, "\tMutex wait: %3.1f%%\n", bottleneck);
 	}
 	else
@@ -884,11 +902,40 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 			offsetof(own, own_lhb_owners), preOwn);
 	prt_que(outfile, LOCK_header, "\tFree owners",
 			&LOCK_header->lhb_free_owners, offsetof(own, own_lhb_owners));
-	prt_que(outfile, LOCK_header, "\tFree locks",
-			&LOCK_header->lhb_free_locks, offsetof(lbl, lbl_lhb_hash));
 	prt_que(outfile, LOCK_header, "\tFree requests",
 			&LOCK_header->lhb_free_requests, offsetof(lrq, lrq_lbl_requests));
 
+	for (USHORT i = 0; i < LCK_PARTITIONS; i++)
+	{
+		const lpt* const partition = &LOCK_header->lhb_partitions[i];
+
+		FPRINTF(outfile,
+				"\tPartition %2d: Active owner: %s, Acquires: %6" UQUADFORMAT
+				", Acquire blocks: %6" UQUADFORMAT"\n",
+				i, (const TEXT*) HtmlLink(preOwn, partition->lpt_active_owner),
+				partition->lpt_acquires, partition->lpt_acquire_blocks);
+
+		FPRINTF(outfile,
+				"\t\tEnqs: %6" UQUADFORMAT", Converts: %6" UQUADFORMAT
+				", Downgrades: %6" UQUADFORMAT", Deqs: %6" UQUADFORMAT"\n",
+				partition->lpt_enqs, partition->lpt_converts,
+				partition->lpt_downgrades, partition->lpt_deqs);
+
+		if (partition->lpt_remove_node || partition->lpt_insert_que || partition->lpt_insert_prior)
+		{
+			FPRINTF(outfile,
+					"\t\tRemove node: %6" SLONGFORMAT", Insert queue: %6" SLONGFORMAT
+					", Insert prior: %6" SLONGFORMAT"\n",
+					partition->lpt_remove_node, partition->lpt_insert_que,
+					partition->lpt_insert_prior);
+		}
+
+		prt_que(outfile, LOCK_header, "\t\tFree locks",
+				&partition->lpt_free_locks, offsetof(lbl, lbl_lhb_hash));
+		prt_que(outfile, LOCK_header, "\t\tFree requests",
+				&partition->lpt_free_requests, offsetof(lrq, lrq_lbl_requests));
+	}
+
 	FPRINTF(outfile, "\n");
 
 	// Print known owners
@@ -933,6 +980,38 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 }
 
 
+static void get_totals(const lhb* LOCK_header, lhb& totals)
+{
+/**************************************
+ *
+ *	g e t _ t o t a l s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Copy the lock header adding the statistics
+ *	of its partitions.
+ *
+ **************************************/
+	totals = *LOCK_header;
+
+	for (USHORT i = 0; i < LCK_PARTITIONS; i++)
+	{
+		const lpt* const partition = &LOCK_header->lhb_partitions[i];
+
+		totals.lhb_acquires += partition->lpt_acquires;
+		totals.lhb_acquire_blocks += partition->lpt_acquire_blocks;
+		totals.lhb_enqs += partition->lpt_enqs;
+		totals.lhb_converts += partition->lpt_converts;
+		totals.lhb_downgrades += partition->lpt_downgrades;
+		totals.lhb_deqs += partition->lpt_deqs;
+
+		for (USHORT j = 0; j < LCK_MAX_SERIES; j++)
+			totals.lhb_operations[j] += partition->lpt_operations[j];
+	}
+}
+
+
 static void prt_lock_activity(OUTFILE outfile,
 							  const lhb* LOCK_header,
 							  USHORT flag,
@@ -968,8 +1047,13 @@ static void prt_lock_activity(OUTFILE outfile,
 
 	FPRINTF(outfile, "\n");
 
-	lhb base = *LOCK_header;
-	lhb prior = *LOCK_header;
+	// Operations made in a partition only are counted there
+
+	lhb current;
+	get_totals(LOCK_header, current);
+
+	lhb base = current;
+	lhb prior = current;
 
 	if (intervals == 0)
 	{
@@ -1000,6 +1084,8 @@ static void prt_lock_activity(OUTFILE outfile,
 			break;
 		}
 
+		get_totals(LOCK_header, current);
+
 		clock = time(NULL);
 		d = *localtime(&clock);
 
@@ -1009,20 +1095,20 @@ static void prt_lock_activity(OUTFILE outfile,
 		{
 			FPRINTF(outfile, "%9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT
 					" %9" UQUADFORMAT" %9" UQUADFORMAT" ",
-					(LOCK_header->lhb_acquires - prior.lhb_acquires) / seconds,
-					(LOCK_header->lhb_acquire_blocks - prior.lhb_acquire_blocks) / seconds,
-					(LOCK_header->lhb_acquires - prior.lhb_acquires) ?
-					 	(100 * (LOCK_header->lhb_acquire_blocks - prior.lhb_acquire_blocks)) /
-							(LOCK_header->lhb_acquires - prior.lhb_acquires) : 0,
-					(LOCK_header->lhb_acquire_retries -
+					(current.lhb_acquires - prior.lhb_acquires) / seconds,
+					(current.lhb_acquire_blocks - prior.lhb_acquire_blocks) / seconds,
+					(current.lhb_acquires - prior.lhb_acquires) ?
+					 	(100 * (current.lhb_acquire_blocks - prior.lhb_acquire_blocks)) /
+							(current.lhb_acquires - prior.lhb_acquires) : 0,
+					(current.lhb_acquire_retries -
 					 prior.lhb_acquire_retries) / seconds,
-					(LOCK_header->lhb_retry_success -
+					(current.lhb_retry_success -
 					 prior.lhb_retry_success) / seconds);
 
-			prior.lhb_acquires = LOCK_header->lhb_acquires;
-			prior.lhb_acquire_blocks = LOCK_header->lhb_acquire_blocks;
-			prior.lhb_acquire_retries = LOCK_header->lhb_acquire_retries;
-			prior.lhb_retry_success = LOCK_header->lhb_retry_success;
+			prior.lhb_acquires = current.lhb_acquires;
+			prior.lhb_acquire_blocks = current.lhb_acquire_blocks;
+			prior.lhb_acquire_retries = current.lhb_acquire_retries;
+			prior.lhb_retry_success = current.lhb_retry_success;
 		}
 
 		if (flag & SW_I_OPERATION)
@@ -1030,21 +1116,21 @@ static void prt_lock_activity(OUTFILE outfile,
 			FPRINTF(outfile, "%9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT
 					" %9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT
 					" %9" UQUADFORMAT" ",
-					(LOCK_header->lhb_enqs - prior.lhb_enqs) / seconds,
-					(LOCK_header->lhb_converts - prior.lhb_converts) / seconds,
-					(LOCK_header->lhb_downgrades - prior.lhb_downgrades) / seconds,
-					(LOCK_header->lhb_deqs - prior.lhb_deqs) / seconds,
-					(LOCK_header->lhb_read_data - prior.lhb_read_data) / seconds,
-					(LOCK_header->lhb_write_data - prior.lhb_write_data) / seconds,
-					(LOCK_header->lhb_query_data - prior.lhb_query_data) / seconds);
-
-			prior.lhb_enqs = LOCK_header->lhb_enqs;
-			prior.lhb_converts = LOCK_header->lhb_converts;
-			prior.lhb_downgrades = LOCK_header->lhb_downgrades;
-			prior.lhb_deqs = LOCK_header->lhb_deqs;
-			prior.lhb_read_data = LOCK_header->lhb_read_data;
-			prior.lhb_write_data = LOCK_header->lhb_write_data;
-			prior.lhb_query_data = LOCK_header->lhb_query_data;
+					(current.lhb_enqs - prior.lhb_enqs) / seconds,
+					(current.lhb_converts - prior.lhb_converts) / seconds,
+					(current.lhb_downgrades - prior.lhb_downgrades) / seconds,
+					(current.lhb_deqs - prior.lhb_deqs) / seconds,
+					(current.lhb_read_data - prior.lhb_read_data) / seconds,
+					(current.lhb_write_data - prior.lhb_write_data) / seconds,
+					(current.lhb_query_data - prior.lhb_query_data) / seconds);
+
+			prior.lhb_enqs = current.lhb_enqs;
+			prior.lhb_converts = current.lhb_converts;
+			prior.lhb_downgrades = current.lhb_downgrades;
+			prior.lhb_deqs = current.lhb_deqs;
+			prior.lhb_read_data = current.lhb_read_data;
+			prior.lhb_write_data = current.lhb_write_data;
+			prior.lhb_query_data = current.lhb_query_data;
 		}
 
 		if (flag & SW_I_TYPE)
@@ -1052,27 +1138,27 @@ static void prt_lock_activity(OUTFILE outfile,
 			FPRINTF(outfile, "%9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT
 					" %9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT
 					" %9" UQUADFORMAT" ",
-					(LOCK_header->lhb_operations[Jrd::LCK_database] -
+					(current.lhb_operations[Jrd::LCK_database] -
 					 	prior.lhb_operations[Jrd::LCK_database]) / seconds,
-					(LOCK_header->lhb_operations[Jrd::LCK_relation] -
+					(current.lhb_operations[Jrd::LCK_relation] -
 					 	prior.lhb_operations[Jrd::LCK_relation]) / seconds,
-					(LOCK_header->lhb_operations[Jrd::LCK_bdb] -
+					(current.lhb_operations[Jrd::LCK_bdb] -
 					 	prior.lhb_operations[Jrd::LCK_bdb]) / seconds,
-					(LOCK_header->lhb_operations[Jrd::LCK_tra] -
+					(current.lhb_operations[Jrd::LCK_tra] -
 					 	prior.lhb_operations[Jrd::LCK_tra]) / seconds,
-					(LOCK_header->lhb_operations[Jrd::LCK_rel_exist] -
+					(current.lhb_operations[Jrd::LCK_rel_exist] -
 					 	prior.lhb_operations[Jrd::LCK_rel_exist]) / seconds,
-					(LOCK_header->lhb_operations[Jrd::LCK_idx_exist] -
+					(current.lhb_operations[Jrd::LCK_idx_exist] -
 					 	prior.lhb_operations[Jrd::LCK_idx_exist]) / seconds,
-					(LOCK_header->lhb_operations[0] - prior.lhb_operations[0]) / seconds);
-
-			prior.lhb_operations[Jrd::LCK_database] = LOCK_header->lhb_operations[Jrd::LCK_database];
-			prior.lhb_operations[Jrd::LCK_relation] = LOCK_header->lhb_operations[Jrd::LCK_relation];
-			prior.lhb_operations[Jrd::LCK_bdb] = LOCK_header->lhb_operations[Jrd::LCK_bdb];
-			prior.lhb_operations[Jrd::LCK_tra] = LOCK_header->lhb_operations[Jrd::LCK_tra];
-			prior.lhb_operations[Jrd::LCK_rel_exist] = LOCK_header->lhb_operations[Jrd::LCK_rel_exist];
-			prior.lhb_operations[Jrd::LCK_idx_exist] = LOCK_header->lhb_operations[Jrd::LCK_idx_exist];
-			prior.lhb_operations[0] = LOCK_header->lhb_operations[0];
+					(current.lhb_operations[0] - prior.lhb_operations[0]) / seconds);
+
+			prior.lhb_operations[Jrd::LCK_database] = current.lhb_operations[Jrd::LCK_database];
+			prior.lhb_operations[Jrd::LCK_relation] = current.lhb_operations[Jrd::LCK_relation];
+			prior.lhb_operations[Jrd::LCK_bdb] = current.lhb_operations[Jrd::LCK_bdb];
+			prior.lhb_operations[Jrd::LCK_tra] = current.lhb_operations[Jrd::LCK_tra];
+			prior.lhb_operations[Jrd::LCK_rel_exist] = current.lhb_operations[Jrd::LCK_rel_exist];
+			prior.lhb_operations[Jrd::LCK_idx_exist] = current.lhb_operations[Jrd::LCK_idx_exist];
+			prior.lhb_operations[0] = current.lhb_operations[0];
 		}
 
 		if (flag & SW_I_WAIT)
@@ -1080,26 +1166,28 @@ static void prt_lock_activity(OUTFILE outfile,
 			FPRINTF(outfile, "%9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT
 					" %9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT
 					" %9" UQUADFORMAT" ",
-					(LOCK_header->lhb_waits - prior.lhb_waits) / seconds,
-					(LOCK_header->lhb_denies - prior.lhb_denies) / seconds,
-					(LOCK_header->lhb_timeouts - prior.lhb_timeouts) / seconds,
-					(LOCK_header->lhb_blocks - prior.lhb_blocks) / seconds,
-					(LOCK_header->lhb_wakeups - prior.lhb_wakeups) / seconds,
-					(LOCK_header->lhb_scans - prior.lhb_scans) / seconds,
-					(LOCK_header->lhb_deadlocks - prior.lhb_deadlocks) / seconds);
-
-			prior.lhb_waits = LOCK_header->lhb_waits;
-			prior.lhb_denies = LOCK_header->lhb_denies;
-			prior.lhb_timeouts = LOCK_header->lhb_timeouts;
-			prior.lhb_blocks = LOCK_header->lhb_blocks;
-			prior.lhb_wakeups = LOCK_header->lhb_wakeups;
-			prior.lhb_scans = LOCK_header->lhb_scans;
-			prior.lhb_deadlocks = LOCK_header->lhb_deadlocks;
+					(current.lhb_waits - prior.lhb_waits) / seconds,
+					(current.lhb_denies - prior.lhb_denies) / seconds,
+					(current.lhb_timeouts - prior.lhb_timeouts) / seconds,
+					(current.lhb_blocks - prior.lhb_blocks) / seconds,
+					(current.lhb_wakeups - prior.lhb_wakeups) / seconds,
+					(current.lhb_scans - prior.lhb_scans) / seconds,
+					(current.lhb_deadlocks - prior.lhb_deadlocks) / seconds);
+
+			prior.lhb_waits = current.lhb_waits;
+			prior.lhb_denies = current.lhb_denies;
+			prior.lhb_timeouts = current.lhb_timeouts;
+			prior.lhb_blocks = current.lhb_blocks;
+			prior.lhb_wakeups = current.lhb_wakeups;
+			prior.lhb_scans = current.lhb_scans;
+			prior.lhb_deadlocks = current.lhb_deadlocks;
 		}
 
 		FPRINTF(outfile, "\n");
 	}
 
+	get_totals(LOCK_header, current);
+
 	FB_UINT64 factor = seconds * intervals;
 
 	if (factor < 1)
@@ -1110,13 +1198,13 @@ static void prt_lock_activity(OUTFILE outfile,
 	{
 		FPRINTF(outfile, "%9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT
 				" %9" UQUADFORMAT" %9" UQUADFORMAT" ",
-				(LOCK_header->lhb_acquires - base.lhb_acquires) / factor,
-				(LOCK_header->lhb_acquire_blocks - base.lhb_acquire_blocks) / factor,
-				(LOCK_header->lhb_acquires - base.lhb_acquires) ?
-				 	(100 * (LOCK_header->lhb_acquire_blocks - base.lhb_acquire_blocks)) /
-						(LOCK_header->lhb_acquires - base.lhb_acquires) : 0,
-				(LOCK_header->lhb_acquire_retries - base.lhb_acquire_retries) / factor,
-				(LOCK_header->lhb_retry_success - base.lhb_retry_success) / factor);
+				(current.lhb_acquires - base.lhb_acquires) / factor,
+				(current.lhb_acquire_blocks - base.lhb_acquire_blocks) / factor,
+				(current.lhb_acquires - base.lhb_acquires) ?
+				 	(100 * (current.lhb_acquire_blocks - base.lhb_acquire_blocks)) /
+						(current.lhb_acquires - base.lhb_acquires) : 0,
+				(current.lhb_acquire_retries - base.lhb_acquire_retries) / factor,
+				(current.lhb_retry_success - base.lhb_retry_success) / factor);
 	}
 
 	if (flag & SW_I_OPERATION)
@@ -1124,13 +1212,13 @@ static void prt_lock_activity(OUTFILE outfile,
 		FPRINTF(outfile, "%9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT
 				" %9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT" %9"
 				UQUADFORMAT" ",
-				(LOCK_header->lhb_enqs - base.lhb_enqs) / factor,
-				(LOCK_header->lhb_converts - base.lhb_converts) / factor,
-				(LOCK_header->lhb_downgrades - base.lhb_downgrades) / factor,
-				(LOCK_header->lhb_deqs - base.lhb_deqs) / factor,
-				(LOCK_header->lhb_read_data - base.lhb_read_data) / factor,
-				(LOCK_header->lhb_write_data - base.lhb_write_data) / factor,
-				(LOCK_header->lhb_query_data - base.lhb_query_data) / factor);
+				(current.lhb_enqs - base.lhb_enqs) / factor,
+				(current.lhb_converts - base.lhb_converts) / factor,
+				(current.lhb_downgrades - base.lhb_downgrades) / factor,
+				(current.lhb_deqs - base.lhb_deqs) / factor,
+				(current.lhb_read_data - base.lhb_read_data) / factor,
+				(current.lhb_write_data - base.lhb_write_data) / factor,
+				(current.lhb_query_data - base.lhb_query_data) / factor);
 	}
 
 	if (flag & SW_I_TYPE)
@@ -1138,19 +1226,19 @@ static void prt_lock_activity(OUTFILE outfile,
 		FPRINTF(outfile, "%9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT
 				" %9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT
 				" %9" UQUADFORMAT" ",
-				(LOCK_header->lhb_operations[Jrd::LCK_database] -
+				(current.lhb_operations[Jrd::LCK_database] -
 				 	base.lhb_operations[Jrd::LCK_database]) / factor,
-				(LOCK_header->lhb_operations[Jrd::LCK_relation] -
+				(current.lhb_operations[Jrd::LCK_relation] -
 				 	base.lhb_operations[Jrd::LCK_relation]) / factor,
-				(LOCK_header->lhb_operations[Jrd::LCK_bdb] -
+				(current.lhb_operations[Jrd::LCK_bdb] -
 				 	base.lhb_operations[Jrd::LCK_bdb]) / factor,
-				(LOCK_header->lhb_operations[Jrd::LCK_tra] -
+				(current.lhb_operations[Jrd::LCK_tra] -
 				 	base.lhb_operations[Jrd::LCK_tra]) / factor,
-				(LOCK_header->lhb_operations[Jrd::LCK_rel_exist] -
+				(current.lhb_operations[Jrd::LCK_rel_exist] -
 				 	base.lhb_operations[Jrd::LCK_rel_exist]) / factor,
-				(LOCK_header->lhb_operations[Jrd::LCK_idx_exist] -
+				(current.lhb_operations[Jrd::LCK_idx_exist] -
 				 	base.lhb_operations[Jrd::LCK_idx_exist]) / factor,
-				(LOCK_header->lhb_operations[0] - base.lhb_operations[0]) / factor);
+				(current.lhb_operations[0] - base.lhb_operations[0]) / factor);
 	}
 
 	if (flag & SW_I_WAIT)
@@ -1158,13 +1246,13 @@ static void prt_lock_activity(OUTFILE outfile,
 		FPRINTF(outfile, "%9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT
 				" %9" UQUADFORMAT" %9" UQUADFORMAT" %9" UQUADFORMAT
 				" %9" UQUADFORMAT" ",
-				(LOCK_header->lhb_waits - base.lhb_waits) / factor,
-				(LOCK_header->lhb_denies - base.lhb_denies) / factor,
-				(LOCK_header->lhb_timeouts - base.lhb_timeouts) / factor,
-				(LOCK_header->lhb_blocks - base.lhb_blocks) / factor,
-				(LOCK_header->lhb_wakeups - base.lhb_wakeups) / factor,
-				(LOCK_header->lhb_scans - base.lhb_scans) / factor,
-				(LOCK_header->lhb_deadlocks - base.lhb_deadlocks) / factor);
+				(current.lhb_waits - base.lhb_waits) / factor,
+				(current.lhb_denies - base.lhb_denies) / factor,
+				(current.lhb_timeouts - base.lhb_timeouts) / factor,
+				(current.lhb_blocks - base.lhb_blocks) / factor,
+				(current.lhb_wakeups - base.lhb_wakeups) / factor,
+				(current.lhb_scans - base.lhb_scans) / factor,
+				(current.lhb_deadlocks - base.lhb_deadlocks) / factor);
 	}
 
 	FPRINTF(outfile, "\n");
@@ -1407,8 +1495,21 @@ static void prt_owner(OUTFILE outfile,
 	FPRINTF(outfile, " %s", (flags & OWN_signaled) ? "sgnl" : "    ");
 	FPRINTF(outfile, "\n");
 
-	prt_que(outfile, LOCK_header, "\tRequests", &owner->own_requests,
-			offsetof(lrq, lrq_own_requests), preRequest);
+	bool requests = false;
+	for (USHORT i = 0; i < LCK_PARTITIONS; i++)
+	{
+		if (!SRQ_EMPTY(owner->own_requests[i]))
+		{
+			TEXT name[BUFFER_TINY];
+			snprintf(name, sizeof(name), "\tRequests [%2d]", i);
+			prt_que(outfile, LOCK_header, name, &owner->own_requests[i],
+					offsetof(lrq, lrq_own_requests), preRequest);
+			requests = true;
+		}
+	}
+
+	if (!requests)
+		FPRINTF(outfile, "\tRequests: *empty*\n");
 	prt_que(outfile, LOCK_header, "\tBlocks", &owner->own_blocks,
 			offsetof(lrq, lrq_own_blocks), preRequest);
 	prt_que(outfile, LOCK_header, "\tPending", &owner->own_pending,
@@ -1434,10 +1535,13 @@ static void prt_owner(OUTFILE outfile,
 		}
 		else
 		{
-			const srq* que_inst;
-			SRQ_LOOP(owner->own_requests, que_inst)
-				prt_request(outfile, LOCK_header,
-							(lrq*) ((UCHAR*) que_inst - offsetof(lrq, lrq_own_requests)));
+			for (USHORT i = 0; i < LCK_PARTITIONS; i++)
+			{
+				const srq* que_inst;
+				SRQ_LOOP(owner->own_requests[i], que_inst)
+					prt_request(outfile, LOCK_header,
+								(lrq*) ((UCHAR*) que_inst - offsetof(lrq, lrq_own_requests)));
+			}
 		}
 	}
 }
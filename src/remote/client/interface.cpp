@@ -1123,6 +1123,7 @@ static rem_port* analyze(ClntAuthBlock& cBlock, PathName& attach_name, unsigned
 	ICryptKeyCallback* cryptCb);
 static void batch_gds_receive(rem_port*, struct rmtque *, USHORT);
 static void batch_dsql_fetch(rem_port*, struct rmtque *, USHORT);
+static bool receive_columnar(Rsr*, const P_SQLDATA*);
 static void clear_queue(rem_port*);
 static void clear_stmt_que(rem_port*, Rsr*);
 static void finalize(rem_port* port);
@@ -4894,6 +4895,7 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 
 		statement->rsr_flags.clear(Rsr::STREAM_END | Rsr::PAST_END | Rsr::STREAM_ERR);
 		statement->rsr_rows_pending = 0;
+		statement->rsr_fetch_ahead.restart();
 		statement->rsr_fetch_operation = operation;
 		statement->rsr_fetch_position = position;
 		statement->clearException();
@@ -4939,6 +4941,8 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 		}
 	}
 
+	statement->rsr_fetch_ahead.rowRequested();
+
 	// Parse the blr describing the message, if there is any.
 
 	if (blr_length)
@@ -5091,6 +5095,8 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 		(	// Low in inventory
 			(statement->rsr_rows_pending <= statement->rsr_reorder_level) &&
 			(statement->rsr_msgs_waiting <= statement->rsr_reorder_level) &&
+			// The previous request is answered already
+			!statement->rsr_fetch_ahead.isOutstanding() &&
 			// Pipelining causes both server & client to
 			// write at the same time. In XNET, writes
 			// block for the other end to read -  and so when both
@@ -5109,6 +5115,17 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 		PACKET* packet = &rdb->rdb_packet;
 		packet->p_operation = (operation == fetch_next) ? op_fetch : op_fetch_scroll;
 		P_SQLDATA* sqldata = &packet->p_sqldata;
+
+		// Peers of the same byte order take the batch stored by columns.
+		// It's compressed unless the whole stream is compressed already.
+
+		if (operation == fetch_next && statement->rsr_select_format &&
+			port->port_protocol >= PROTOCOL_FETCH_COLUMNAR && (port->port_flags & PORT_host_order))
+		{
+			packet->p_operation = op_fetch_columnar;
+			sqldata->p_sqldata_block_flags = (port->port_flags & PORT_compressed) ? 0 : FETCH_BLOCK_LZ4;
+		}
+
 		sqldata->p_sqldata_statement = statement->rsr_id;
 		sqldata->p_sqldata_blr.cstr_length = blr_length;
 		sqldata->p_sqldata_blr.cstr_address = const_cast<unsigned char*>(blr);
@@ -5123,6 +5140,15 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 			{
 				sqldata->p_sqldata_messages = REMOTE_compute_batch_size(
 					port, 0, op_fetch_response, statement->rsr_select_format);
+
+				// Adjust the batch to the round trip time and to the pace of the application
+
+				if (port->port_protocol >= PROTOCOL_VERSION13)
+				{
+					sqldata->p_sqldata_messages = statement->rsr_fetch_ahead.getBatchSize(
+						sqldata->p_sqldata_messages,
+						MAX_BATCH_CACHE_SIZE / statement->rsr_select_format->fmt_length);
+				}
 			}
 
 			// Reorder data when the local buffer is half empty
@@ -5152,6 +5178,9 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 
 		send_packet(port, packet);
 
+		if (sqldata->p_sqldata_messages > 1)
+			statement->rsr_fetch_ahead.batchRequested(sqldata->p_sqldata_messages);
+
 		statement->rsr_batch_count++;
 		statement->rsr_fetch_operation = operation;
 		statement->rsr_fetch_position = position;
@@ -5246,6 +5275,7 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 	}
 
 	message->msg_address = NULL;
+	statement->rsr_fetch_ahead.rowReturned();
 	return true;
 }
 
@@ -8182,6 +8212,9 @@ static void batch_dsql_fetch(rem_port*	port,
 			message->msg_next = new_msg;
 		}
 
+		// Whether the application waits for the rows of this statement
+		const bool waited = (id == statement->rsr_id && !statement->rsr_msgs_waiting);
+
 		try {
 			receive_packet_noqueue(port, packet);
 		}
@@ -8195,6 +8228,8 @@ static void batch_dsql_fetch(rem_port*	port,
 			throw;
 		}
 
+		statement->rsr_fetch_ahead.batchReceived(waited);
+
 		if (packet->p_operation == op_inline_blob)
 		{
 			fb_assert(!statement->rsr_rtr || statement->rsr_rtr->rtr_id == p_blob->p_tran_id);
@@ -8206,7 +8241,21 @@ static void batch_dsql_fetch(rem_port*	port,
 			continue;
 		}
 
-		if (packet->p_operation != op_fetch_response)
+		// The whole batch stored by columns comes in a single response
+
+		const bool columnar = (packet->p_operation == op_fetch_columnar_response);
+
+		if (columnar)
+		{
+			if (!receive_columnar(statement, &packet->p_sqldata))
+			{
+				statement->rsr_flags.set(Rsr::STREAM_ERR);
+				statement->saveException(status_exception(Arg::Gds(isc_net_read_err).value()), false);
+			}
+
+			packet->p_sqldata.p_sqldata_block.free();
+		}
+		else if (packet->p_operation != op_fetch_response)
 		{
 			statement->rsr_flags.set(Rsr::STREAM_ERR);
 
@@ -8230,7 +8279,7 @@ static void batch_dsql_fetch(rem_port*	port,
 
 		// See if we're at end of the batch
 
-		if (packet->p_sqldata.p_sqldata_status || !packet->p_sqldata.p_sqldata_messages)
+		if (columnar || packet->p_sqldata.p_sqldata_status || !packet->p_sqldata.p_sqldata_messages)
 		{
 			if (packet->p_sqldata.p_sqldata_status == 100)
 			{
@@ -8284,6 +8333,62 @@ static void batch_dsql_fetch(rem_port*	port,
 }
 
 
+static bool receive_columnar(Rsr* statement, const P_SQLDATA* sqldata)
+{
+/**************************************
+ *
+ *	r e c e i v e _ c o l u m n a r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Spread the rows of op_fetch_columnar_response over
+ *	the message buffers of the statement, allocating more
+ *	of them if needed.  Return false if the block is corrupt.
+ *
+ **************************************/
+
+	const CSTRING& block = sqldata->p_sqldata_block;
+	ColumnarDecoder* const decoder = statement->rsr_select_format->getColumnarDecoder();
+
+	if (!decoder->open(block.cstr_address, block.cstr_length) ||
+		decoder->getCount() != sqldata->p_sqldata_messages)
+	{
+		return false;
+	}
+
+	for (ULONG n = 0; n < decoder->getCount(); n++)
+	{
+		RMessage* message = statement->rsr_buffer;
+		if (message->msg_address)
+		{
+			RMessage* new_msg = FB_NEW RMessage(statement->rsr_fmt_length);
+			statement->rsr_buffer = new_msg;
+
+			new_msg->msg_next = message;
+
+			while (message->msg_next != new_msg->msg_next)
+				message = message->msg_next;
+
+			message->msg_next = new_msg;
+			message = new_msg;
+		}
+
+		if (!decoder->next(message->msg_buffer))
+			return false;
+
+		message->msg_address = message->msg_buffer;
+		statement->rsr_buffer = message->msg_next;
+
+		statement->rsr_msgs_waiting++;
+		if (statement->rsr_rows_pending)
+			statement->rsr_rows_pending--;
+	}
+
+	return true;
+}
+
+
 static void batch_gds_receive(rem_port*		port,
 							  rmtque*	que_inst,
 							  USHORT		id)
@@ -95,6 +95,11 @@
 #include <sys/select.h>
 #endif
 
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_EPOLL_CREATE1) && defined(HAVE_POLL)
+#include <sys/epoll.h>
+#define HAVE_EPOLL
+#endif
+
 #endif // !WIN_NT
 
 constexpr int INET_RETRY_CALL = 5;
@@ -249,6 +254,11 @@ private:
 	}
 #endif
 
+#ifdef HAVE_EPOLL
+	static constexpr int SEL_EPOLL_EVENTS = EPOLLIN | EPOLLRDHUP | EPOLLET;
+	static constexpr int SEL_MAX_EVENTS = 256;
+#endif
+
 public:
 #ifdef HAVE_POLL
 	Select()
@@ -273,6 +283,14 @@ public:
 	}
 #endif
 
+#ifdef HAVE_EPOLL
+	~Select()
+	{
+		if (slct_epoll >= 0)
+			close(slct_epoll);
+	}
+#endif
+
 	enum HandleState {SEL_BAD, SEL_DISCONNECTED, SEL_NO_DATA, SEL_READY};
 
 	// set first port to check for readiness
@@ -304,6 +322,11 @@ public:
 		}
 #endif
 
+#ifdef HAVE_EPOLL
+		if (slct_epoll >= 0)
+			return nextEvent(port);
+#endif
+
 		if (slct_port && slct_port->port_state == rem_port::DISCONNECTED)
 		{
 			// restart from main port
@@ -430,8 +453,135 @@ public:
 #endif
 	}
 
+	// Switch to the edge triggered epoll backend. Ports are watched since they are
+	// accepted and until disconnected, so the wait costs nothing for the idle ones.
+	// Returns false if the ports are polled.
+	bool useEvents()
+	{
+#ifdef HAVE_EPOLL
+		if (slct_epoll < 0 && !slct_noEvents)
+		{
+			slct_epoll = epoll_create1(EPOLL_CLOEXEC);
+			if (slct_epoll < 0)
+			{
+				gds__log("INET/select: epoll_create1 failed, errno = %d, using poll()", errno);
+				slct_noEvents = true;
+			}
+		}
+
+		return slct_epoll >= 0;
+#else
+		return false;
+#endif
+	}
+
+	bool hasWatched() const
+	{
+#ifdef HAVE_EPOLL
+		return slct_watched.hasData();
+#else
+		return false;
+#endif
+	}
+
+	// Start watching the port, does nothing without epoll backend
+	// assume port_mutex is locked
+	void watch(rem_port* port)
+	{
+#ifdef HAVE_EPOLL
+		const SOCKET handle = port->port_handle;
+		if (slct_epoll < 0 || handle == INVALID_SOCKET)
+			return;
+
+		FB_SIZE_T pos;
+		if (slct_watched.find(handle, pos))
+		{
+			if (slct_watched[pos].port == port)
+				return;
+
+			// Descriptor was closed without disconnect and reused by the new port
+			slct_watched[pos].port = port;
+			epoll_ctl(slct_epoll, EPOLL_CTL_DEL, handle, nullptr);
+		}
+		else
+		{
+			const WatchedPort item = {handle, port};
+			slct_watched.insert(pos, item);
+		}
+
+		epoll_event event {};
+		event.events = SEL_EPOLL_EVENTS;
+		event.data.fd = handle;
+
+		if (epoll_ctl(slct_epoll, EPOLL_CTL_ADD, handle, &event) != 0 && errno != EEXIST)
+		{
+			// this will lead to receive() which will break bad connection
+			gds__log("INET/select: failed to watch socket %" HANDLEFORMAT", errno = %d", handle, errno);
+			addDue(port, SEL_READY);
+		}
+#endif
+	}
+
+	// Stop watching the port, it's not valid after return
+	// assume port_mutex is locked
+	void forget(rem_port* port)
+	{
+#ifdef HAVE_EPOLL
+		if (slct_epoll < 0)
+			return;
+
+		const SOCKET handle = port->port_handle;
+		FB_SIZE_T pos;
+		if (handle != INVALID_SOCKET)
+		{
+			if (slct_watched.find(handle, pos) && slct_watched[pos].port == port)
+			{
+				slct_watched.remove(pos);
+				epoll_ctl(slct_epoll, EPOLL_CTL_DEL, handle, nullptr);
+			}
+		}
+		else
+		{
+			// Socket is closed already (and left epoll set), look for the port itself
+			for (pos = 0; pos < slct_watched.getCount(); pos++)
+			{
+				if (slct_watched[pos].port == port)
+				{
+					slct_watched.remove(pos);
+					break;
+				}
+			}
+		}
+
+		for (FB_SIZE_T i = 0; i < slct_due.getCount(); )
+		{
+			if (slct_due[i].port == port)
+				slct_due.remove(i);
+			else
+				i++;
+		}
+#endif
+	}
+
+	// Return the watched port from checkNext() even without data,
+	// used for the expired keepalive timers
+	// assume port_mutex is locked
+	void expire(rem_port* port)
+	{
+#ifdef HAVE_EPOLL
+		addDue(port, SEL_NO_DATA);
+#endif
+	}
+
 	void select(timeval* timeout)
 	{
+#ifdef HAVE_EPOLL
+		if (slct_epoll >= 0)
+		{
+			selectEvents(timeout);
+			return;
+		}
+#endif
 #ifdef HAVE_POLL
 		slct_ready.clear();
 		bool hasRequest = false;
@@ -479,6 +629,128 @@ public:
 	time_t	slct_time;
 
 private:
+#ifdef HAVE_EPOLL
+	struct WatchedPort
+	{
+		SOCKET handle;
+		rem_port* port;
+
+		static SOCKET generate(const WatchedPort& item) { return item.handle; }
+	};
+
+	struct DuePort
+	{
+		rem_port* port;
+		HandleState state;
+	};
+
+	void addDue(rem_port* port, HandleState state)
+	{
+		for (const auto& due : slct_due)
+		{
+			if (due.port == port)
+				return;
+		}
+
+		const DuePort item = {port, state};
+		slct_due.add(item);
+	}
+
+	void selectEvents(timeval* timeout)
+	{
+		slct_events.clear();
+		slct_event = 0;
+
+		// Edge triggered event is not repeated for the data left in the socket
+		// after the packet was read, so the ports returned as ready since the
+		// last call are checked for the remaining data without waiting
+
+		if (slct_drain.hasData())
+		{
+			HalfStaticArray<pollfd, 64> fds;
+			for (const auto handle : slct_drain)
+			{
+				pollfd& f = fds.add();
+				f.fd = handle;
+				f.events = POLLIN;
+				f.revents = 0;
+			}
+			slct_drain.clear();
+
+			if (::poll(fds.begin(), fds.getCount(), 0) > 0)
+			{
+				for (const auto& f : fds)
+				{
+					if (f.revents)
+						slct_events.add(f.fd);
+				}
+			}
+		}
+
+		const int milliseconds = slct_events.hasData() ? 0 :
+			timeout ? timeout->tv_sec * 1000 + timeout->tv_usec / 1000 : -1;
+
+		epoll_event events[SEL_MAX_EVENTS];
+		const int count = epoll_wait(slct_epoll, events, SEL_MAX_EVENTS, milliseconds);
+
+		if (count < 0 && slct_events.isEmpty())
+		{
+			slct_count = -1;
+			return;
+		}
+
+		// More events than fit into the buffer are left queued for the next call
+
+		for (int i = 0; i < count; i++)
+		{
+			const SOCKET handle = events[i].data.fd;
+			if (!slct_events.exist(handle))
+				slct_events.add(handle);
+		}
+
+		slct_count = (int) slct_events.getCount();
+	}
+
+	// assume port_mutex is locked
+	HandleState nextEvent(RemPortPtr& port)
+	{
+		while (slct_event < slct_events.getCount())
+		{
+			const SOCKET handle = slct_events[slct_event++];
+
+			// Port could be disconnected after the event
+			FB_SIZE_T pos;
+			if (!slct_watched.find(handle, pos))
+				continue;
+
+			port = slct_watched[pos].port;
+			if (port->port_state != rem_port::PENDING)
+				continue;
+
+			slct_drain.add(handle);
+			return SEL_READY;
+		}
+
+		if (slct_due.hasData())
+		{
+			const DuePort due = slct_due.pop();
+			port = due.port;
+			return due.state;
+		}
+
+		port = nullptr;
+		return SEL_NO_DATA;
+	}
+
+	int		slct_epoll = -1;			// epoll descriptor, -1 when ports are polled
+	bool	slct_noEvents = false;		// epoll is not available
+	// Watched ports by their handles, changed under port_mutex
+	SortedArray<WatchedPort, EmptyStorage<WatchedPort>, SOCKET, WatchedPort> slct_watched{*getDefaultMemoryPool()};
+	SortedArray<SOCKET> slct_events{*getDefaultMemoryPool()};	// reported by the last select()
+	FB_SIZE_T slct_event = 0;									// next of them to check
+	Array<SOCKET> slct_drain{*getDefaultMemoryPool()};			// returned as ready since the last select()
+	Array<DuePort> slct_due{*getDefaultMemoryPool()};			// to return without an event
+#endif
 	int		slct_count;
 #ifdef HAVE_POLL
 	class PollToFD
@@ -718,7 +990,8 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 		REMOTE_PROTOCOL(PROTOCOL_VERSION17, ptype_lazy_send, 8),
 		REMOTE_PROTOCOL(PROTOCOL_VERSION18, ptype_lazy_send, 9),
 		REMOTE_PROTOCOL(PROTOCOL_VERSION19, ptype_lazy_send, 10),
-		REMOTE_PROTOCOL(PROTOCOL_VERSION20, ptype_lazy_send, 11)
+		REMOTE_PROTOCOL(PROTOCOL_VERSION20, ptype_lazy_send, 11),
+		REMOTE_PROTOCOL(PROTOCOL_VERSION21, ptype_lazy_send, 12)
 	};
 	static_assert(FB_NELEM(protocols_to_try) <= MAX_CNCT_VERSIONS);
 
@@ -731,6 +1004,10 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 		{
 			cnct->p_cnct_versions[i].p_cnct_max_type |= pflag_compress;
 		}
+#ifndef WORDS_BIGENDIAN
+		if (cnct->p_cnct_versions[i].p_cnct_version >= PROTOCOL_VERSION13)
+			cnct->p_cnct_versions[i].p_cnct_max_type |= pflag_host_order;
+#endif
 	}
 
 	rem_port* port = inet_try_connect(packet, rdb, file_name, node_name, dpb, config, ref_db_name, af);
@@ -842,6 +1119,11 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 	}
 
 	const bool compress = accept->p_acpt_type & pflag_compress;
+
+	if (accept->p_acpt_type & pflag_host_order) {
+		port->port_flags |= PORT_host_order;
+	}
+
 	accept->p_acpt_type &= ptype_MASK;
 
 	if (accept->p_acpt_type != ptype_out_of_band) {
@@ -1534,6 +1816,12 @@ static rem_port* aux_connect(rem_port* port, PACKET* packet)
 		port->port_handle = n;
 		port->port_flags |= PORT_async;
 
+		{ // port_mutex scope
+			MutexLockGuard guard(port_mutex, FB_FUNCTION);
+			if (port->port_state == rem_port::PENDING)
+				INET_select->watch(port);
+		}
+
 		get_peer_info(port);
 
 		return port;
@@ -1788,6 +2076,7 @@ static void disconnect(rem_port* port)
 	// If this is a sub-port, unlink it from its parent
 	port->unlinkParent();
 
+	INET_select->forget(port);
 	inet_ports->unRegisterPort(port);
 
 	if (delayClose)
@@ -2184,6 +2473,11 @@ static rem_port* select_accept( rem_port* main_port)
 		return port;
 	}
 
+	{ // port_mutex scope
+		MutexLockGuard guard(port_mutex, FB_FUNCTION);
+		INET_select->watch(port);
+	}
+
 	return 0;
 }
 
@@ -2282,7 +2576,15 @@ static bool select_wait( rem_port* main_port, Select* selct)
 				SOCLOSE(s);
 			}
 
-			for (rem_port* port = main_port; port; port = port->port_next)
+			// With epoll the ports stay watched between the waits, walk them
+			// only when the keepalive timers are to be adjusted
+			const bool events = selct->useEvents();
+			const bool walk = !events || delta_time || !selct->hasWatched() || INET_shutting_down;
+
+			if (!walk)
+				found = true;
+
+			for (rem_port* port = walk ? main_port : nullptr; port; port = port->port_next)
 			{
 				if (port->port_state == rem_port::PENDING &&
 					// don't wait on still listening (not connected) async port
@@ -2332,10 +2634,21 @@ static bool select_wait( rem_port* main_port, Select* selct)
 					// if process is shuting down - don't listen on main port
 					if (!INET_shutting_down || port != main_port)
 					{
-						selct->set(port->port_handle);
+						if (events)
+						{
+							selct->watch(port);
+							if (port->port_dummy_timeout < 0)
+								selct->expire(port);
+						}
+						else
+							selct->set(port->port_handle);
+
 						found = true;
+						continue;
 					}
 				}
+
+				selct->forget(port);
 			}
 			checkPorts = false;
 		} // port_mutex scope
@@ -137,6 +137,16 @@ inline void fixupLength(const RemoteXdr* xdrs, ULONG& length)
 		length &= (ULONG) 0xFFFF;
 }
 
+inline XdrMessagePlan::ByteOrder getByteOrder(const RemoteXdr* xdrs)
+{
+	// Peers of the same byte order may agree to exchange the values as is
+
+	if (xdrs->x_public->port_flags & PORT_host_order)
+		return XdrMessagePlan::ORDER_RAW;
+
+	return xdrs->x_local ? XdrMessagePlan::ORDER_LOCAL : XdrMessagePlan::ORDER_XDR;
+}
+
 
 #ifdef DEBUG
 static ULONG xdr_save_size = 0;
@@ -724,6 +734,7 @@ bool_t xdr_protocol(RemoteXdr* xdrs, PACKET* p)
 
 	case op_fetch:
 	case op_fetch_scroll:
+	case op_fetch_columnar:
 		sqldata = &p->p_sqldata;
 		MAP(xdr_short, reinterpret_cast<SSHORT&>(sqldata->p_sqldata_statement));
 		if (!xdr_sql_blr(xdrs, (SLONG) sqldata->p_sqldata_statement,
@@ -738,6 +749,8 @@ bool_t xdr_protocol(RemoteXdr* xdrs, PACKET* p)
 			MAP(xdr_short, reinterpret_cast<SSHORT&>(sqldata->p_sqldata_fetch_op));
 			MAP(xdr_long, sqldata->p_sqldata_fetch_pos);
 		}
+		else if (p->p_operation == op_fetch_columnar)
+			MAP(xdr_short, reinterpret_cast<SSHORT&>(sqldata->p_sqldata_block_flags));
 		DEBUG_PRINTSIZE(xdrs, p->p_operation);
 		return P_TRUE(xdrs, p);
 
@@ -756,6 +769,14 @@ bool_t xdr_protocol(RemoteXdr* xdrs, PACKET* p)
 		DEBUG_PRINTSIZE(xdrs, p->p_operation);
 		return P_TRUE(xdrs, p);
 
+	case op_fetch_columnar_response:
+		sqldata = &p->p_sqldata;
+		MAP(xdr_long, reinterpret_cast<SLONG&>(sqldata->p_sqldata_status));
+		MAP(xdr_short, reinterpret_cast<SSHORT&>(sqldata->p_sqldata_messages));
+		MAP(xdr_cstring, sqldata->p_sqldata_block);
+		DEBUG_PRINTSIZE(xdrs, p->p_operation);
+		return P_TRUE(xdrs, p);
+
 	case op_free_statement:
 		free_stmt = &p->p_sqlfree;
 		MAP(xdr_short, reinterpret_cast<SSHORT&>(free_stmt->p_sqlfree_statement));
@@ -1591,6 +1612,20 @@ static bool_t xdr_message( RemoteXdr* xdrs, RMessage* message, const rem_fmt* fo
 	if (port->port_flags & PORT_symmetric)
 		return xdr_opaque(xdrs, reinterpret_cast<SCHAR*>(message->msg_address), format->fmt_length);
 
+	// Map the whole message with the format's plan when it's available
+
+	const XdrMessagePlan* const plan = format->getPlan(false);
+
+	if (plan)
+	{
+		const bool_t result = (xdrs->x_op == XDR_ENCODE) ?
+			plan->encode(xdrs, message->msg_address, NULL, getByteOrder(xdrs)) :
+			plan->decode(xdrs, message->msg_address, NULL, getByteOrder(xdrs));
+
+		DEBUG_PRINTSIZE(xdrs, op_void);
+		return result;
+	}
+
 	const dsc* desc = format->fmt_desc.begin();
 	for (const dsc* const end = format->fmt_desc.end(); desc < end; ++desc)
 	{
@@ -1661,6 +1696,8 @@ static bool_t xdr_packed_message( RemoteXdr* xdrs, RMessage* message, const rem_
 	const USHORT flagBytes = (format->fmt_desc.getCount() / 2 + 7) / 8;
 	NullBitmap nulls(flagBytes);
 
+	const XdrMessagePlan* const plan = format->getPlan(true);
+
 	if (xdrs->x_op == XDR_ENCODE)
 	{
 		// First pass (odd elements): track NULL indicators
@@ -1683,15 +1720,23 @@ static bool_t xdr_packed_message( RemoteXdr* xdrs, RMessage* message, const rem_
 
 		// Second pass (even elements): process non-NULL items
 
-		desc = format->fmt_desc.begin();
-		for (const dsc* const end = format->fmt_desc.end(); desc < end; desc += 2)
+		if (plan)
 		{
-			const USHORT index = (USHORT) (desc - format->fmt_desc.begin()) / 2;
-
-			if (!nulls.isNull(index))
+			if (!plan->encode(xdrs, message->msg_address, nulls.getData(), getByteOrder(xdrs)))
+				return FALSE;
+		}
+		else
+		{
+			desc = format->fmt_desc.begin();
+			for (const dsc* const end = format->fmt_desc.end(); desc < end; desc += 2)
 			{
-				if (!xdr_datum(xdrs, desc, message->msg_address))
-					return FALSE;
+				const USHORT index = (USHORT) (desc - format->fmt_desc.begin()) / 2;
+
+				if (!nulls.isNull(index))
+				{
+					if (!xdr_datum(xdrs, desc, message->msg_address))
+						return FALSE;
+				}
 			}
 		}
 	}
@@ -1719,15 +1764,23 @@ static bool_t xdr_packed_message( RemoteXdr* xdrs, RMessage* message, const rem_
 
 		// Second pass (even elements): process non-NULL items
 
-		desc = format->fmt_desc.begin();
-		for (const dsc* const end = format->fmt_desc.end(); desc < end; desc += 2)
+		if (plan)
 		{
-			const USHORT index = (USHORT) (desc - format->fmt_desc.begin()) / 2;
-
-			if (!nulls.isNull(index))
+			if (!plan->decode(xdrs, message->msg_address, nulls.getData(), getByteOrder(xdrs)))
+				return FALSE;
+		}
+		else
+		{
+			desc = format->fmt_desc.begin();
+			for (const dsc* const end = format->fmt_desc.end(); desc < end; desc += 2)
 			{
-				if (!xdr_datum(xdrs, desc, message->msg_address))
-					return FALSE;
+				const USHORT index = (USHORT) (desc - format->fmt_desc.begin()) / 2;
+
+				if (!nulls.isNull(index))
+				{
+					if (!xdr_datum(xdrs, desc, message->msg_address))
+						return FALSE;
+				}
 			}
 		}
 	}
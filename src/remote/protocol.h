@@ -119,6 +119,12 @@ constexpr USHORT PROTOCOL_INLINE_BLOB = PROTOCOL_VERSION19;
 constexpr USHORT PROTOCOL_VERSION20 = (FB_PROTOCOL_FLAG | 20);
 constexpr USHORT PROTOCOL_PREPARE_FLAG = PROTOCOL_VERSION20;
 
+// Protocol 21:
+//	- supports op_fetch_columnar
+
+constexpr USHORT PROTOCOL_VERSION21 = (FB_PROTOCOL_FLAG | 21);
+constexpr USHORT PROTOCOL_FETCH_COLUMNAR = PROTOCOL_VERSION21;
+
 // Architecture types
 
 enum P_ARCH
@@ -154,6 +160,7 @@ constexpr USHORT ptype_MASK			= 0xFF;	// Mask - up to 255 types of protocol
 // upper byte is used for protocol flags
 constexpr USHORT pflag_compress			= 0x100;	// Turn on compression if possible
 constexpr USHORT pflag_win_sspi_nego	= 0x200;	// Win_SSPI supports Negotiate security package
+constexpr USHORT pflag_host_order		= 0x400;	// Messages are sent in little endian host layout
 
 // Generic object id
 
@@ -337,6 +344,9 @@ enum P_OP
 
 	op_inline_blob			= 114,
 
+	op_fetch_columnar		= 115,
+	op_fetch_columnar_response	= 116,
+
 	op_max
 };
 
@@ -387,7 +397,7 @@ typedef struct p_malloc
 // Connect Block (Client to server)
 
 // Servers before FB6 (PROTOCOL_VERSION20) uses only first 10 elements of p_cnct_versions
-constexpr size_t MAX_CNCT_VERSIONS = 11;
+constexpr size_t MAX_CNCT_VERSIONS = 12;
 
 typedef struct p_cnct
 {
@@ -658,8 +668,13 @@ typedef struct p_sqldata
 	P_FETCH	p_sqldata_fetch_op;			// Fetch operation
 	SLONG	p_sqldata_fetch_pos;		// Fetch position
 	ULONG	p_sqldata_inline_blob_size;	// maximum size of inlined blob
+	USHORT	p_sqldata_block_flags;		// op_fetch_columnar: FETCH_BLOCK_xxx
+	CSTRING	p_sqldata_block;			// op_fetch_columnar_response: rows stored by columns
 } P_SQLDATA;
 
+// Flags of op_fetch_columnar
+constexpr USHORT FETCH_BLOCK_LZ4 = 0x1;		// compress the block
+
 typedef struct p_sqlfree
 {
     OBJCT	p_sqlfree_statement;	// statement object
@@ -1040,6 +1040,86 @@ void Rsr::saveException(const Exception& ex, bool overwrite)
 	}
 }
 
+
+// Rsr::FetchAhead
+
+namespace
+{
+	// Weight of the new sample in the smoothed values
+	const double FETCH_AHEAD_WEIGHT = 0.25;
+
+	inline double getSeconds(SINT64 from, SINT64 to)
+	{
+		return (double) (to - from) / fb_utils::query_performance_frequency();
+	}
+
+	inline void smooth(double& value, double sample)
+	{
+		value = value ? value + (sample - value) * FETCH_AHEAD_WEIGHT : sample;
+	}
+}
+
+void Rsr::FetchAhead::restart()
+{
+	// The estimations are kept for the next executions of the statement
+	requested = returned = 0;
+}
+
+void Rsr::FetchAhead::rowRequested()
+{
+	if (returned)
+	{
+		smooth(rowTime, getSeconds(returned, fb_utils::query_performance_counter()));
+		returned = 0;
+	}
+}
+
+void Rsr::FetchAhead::rowReturned()
+{
+	returned = fb_utils::query_performance_counter();
+}
+
+void Rsr::FetchAhead::batchRequested(USHORT count)
+{
+	requested = fb_utils::query_performance_counter();
+	rows = count;
+}
+
+void Rsr::FetchAhead::batchReceived(bool waited)
+{
+	if (!requested)
+		return;
+
+	const double sample = getSeconds(requested, fb_utils::query_performance_counter());
+	requested = 0;
+
+	// If the application had rows to take, the response could wait to be read
+	// and the time is just the upper bound of the round trip
+
+	if (waited || !rtt || sample < rtt)
+		smooth(rtt, sample);
+}
+
+USHORT Rsr::FetchAhead::getBatchSize(USHORT baseline, ULONG limit) const
+{
+	// Nothing is measured yet
+
+	if (!rtt || !rows)
+		return baseline;
+
+	// Rows the application takes during two round trips. The size changes
+	// twice at most at once to not follow every hiccup of the network.
+
+	const double target = rowTime ? 2 * rtt / rowTime : limit;
+	ULONG count = (target < limit) ? (ULONG) target : limit;
+
+	count = MIN(count, rows * 2);
+	count = MAX(count, rows / 2);
+	count = MAX(count, MIN_ROWS_PER_BATCH);
+
+	return (USHORT) MIN(count, MAX_USHORT);
+}
+
 string rem_port::getRemoteId() const
 {
 	fb_assert(port_protocol_id.hasData());
@@ -479,6 +479,8 @@ struct rem_str : public pool_alloc_rpt<SCHAR>
 // Include definition of descriptor
 
 #include "../common/dsc.h"
+#include "../common/XdrMessage.h"
+#include "../common/ColumnarBlock.h"
 
 // Note, currently the only routine that created and changed rem_fmt is
 // parse_format() in parse.cpp
@@ -503,6 +505,49 @@ public:
 	{
 		return fmt_blob_idx.hasData();
 	}
+
+	// Codec plan of the message, built at first use when the format is complete
+	const ScratchBird::XdrMessagePlan* getPlan(bool packed) const
+	{
+		ScratchBird::AutoPtr<ScratchBird::XdrMessagePlan>& plan = packed ? fmt_packed_plan : fmt_plan;
+
+		if (!plan)
+		{
+			plan = FB_NEW_POOL(getPool()) ScratchBird::XdrMessagePlan(getPool(),
+				fmt_desc.begin(), fmt_desc.getCount(), packed ? 2 : 1);
+		}
+
+		return plan->isValid() ? plan.get() : NULL;
+	}
+
+	// Codecs of the batches stored by columns (op_fetch_columnar), the DSQL formats only
+	ScratchBird::ColumnarEncoder* getColumnarEncoder() const
+	{
+		if (!fmt_encoder)
+		{
+			fmt_encoder = FB_NEW_POOL(getPool()) ScratchBird::ColumnarEncoder(getPool(),
+				fmt_desc.begin(), fmt_desc.getCount());
+		}
+
+		return fmt_encoder;
+	}
+
+	ScratchBird::ColumnarDecoder* getColumnarDecoder() const
+	{
+		if (!fmt_decoder)
+		{
+			fmt_decoder = FB_NEW_POOL(getPool()) ScratchBird::ColumnarDecoder(getPool(),
+				fmt_desc.begin(), fmt_desc.getCount());
+		}
+
+		return fmt_decoder;
+	}
+
+private:
+	mutable ScratchBird::AutoPtr<ScratchBird::XdrMessagePlan> fmt_plan;
+	mutable ScratchBird::AutoPtr<ScratchBird::XdrMessagePlan> fmt_packed_plan;
+	mutable ScratchBird::AutoPtr<ScratchBird::ColumnarEncoder> fmt_encoder;
+	mutable ScratchBird::AutoPtr<ScratchBird::ColumnarDecoder> fmt_decoder;
 };
 
 // Windows declares a msg structure, so rename the structure
@@ -683,6 +728,42 @@ struct Rsr : public ScratchBird::GlobalStorage, public TypedHandle<rem_type_rsr>
 	SLONG			rsr_fetch_position;		// and position
 	unsigned int	rsr_inline_blob_size;	// max size of blob that can be transferred inline
 
+	// Client side sizing of the fetch-ahead batches. The batch covers two round
+	// trips at the pace the application takes the rows, and the next one is asked
+	// for when a half is left, so it comes before the rows run out. Only one
+	// request is outstanding at a time.
+	struct FetchAhead
+	{
+		FetchAhead()
+			: requested(0), returned(0), rtt(0), rowTime(0), rows(0)
+		{ }
+
+		void restart();
+
+		// Application asks for the row / gets it
+		void rowRequested();
+		void rowReturned();
+
+		// op_fetch is sent / the first response to it is received
+		void batchRequested(USHORT count);
+		void batchReceived(bool waited);
+
+		bool isOutstanding() const
+		{
+			return requested != 0;
+		}
+
+		USHORT getBatchSize(USHORT baseline, ULONG limit) const;
+
+	private:
+		SINT64 requested;	// when op_fetch was sent, zero after its response
+		SINT64 returned;	// when the application got the previous row
+		double rtt;			// smoothed round trip of op_fetch, seconds
+		double rowTime;		// smoothed time the application spends on a row, seconds
+		ULONG rows;			// size of the last batch asked for
+	};
+	FetchAhead		rsr_fetch_ahead;
+
 	struct BatchStream
 	{
 		BatchStream()
@@ -1254,6 +1335,7 @@ constexpr USHORT PORT_connecting	= 0x0400;	// Aux connection waits for a channel
 //constexpr USHORT PORT_z_data		= 0x0800;	// Zlib incoming buffer has data left after decompression
 constexpr USHORT PORT_compressed	= 0x1000;	// Compress outgoing stream (does not affect incoming)
 constexpr USHORT PORT_released		= 0x2000;	// release(), complementary to the first addRef() in constructor, was called
+constexpr USHORT PORT_host_order	= 0x4000;	// Message data is in the host layout of both peers
 
 // forward decl
 class RemotePortGuard;
@@ -1694,7 +1776,7 @@ public:
 	ISC_STATUS	end_transaction(P_OP, P_RLSE*, PACKET*);
 	ISC_STATUS	execute_immediate(P_OP, P_SQLST*, PACKET*);
 	ISC_STATUS	execute_statement(P_OP, P_SQLDATA*, PACKET*);
-	ISC_STATUS	fetch(P_SQLDATA*, PACKET*, bool);
+	ISC_STATUS	fetch(P_SQLDATA*, PACKET*, P_OP);
 	ISC_STATUS	get_segment(P_SGMT*, PACKET*);
 	ISC_STATUS	get_slice(P_SLC*, PACKET*);
 	void		info(P_OP, P_INFO*, PACKET*);
@@ -1321,6 +1321,7 @@ class Worker
 public:
 	static const int MAX_THREADS = MAX_SLONG;
 	static const int IDLE_TIMEOUT = 60;
+	static const unsigned SHARDS = 8;
 
 	Worker();
 	~Worker();
@@ -1331,15 +1332,35 @@ public:
 	void setState(const bool active);
 	static void start(USHORT flags);
 
-	static int getCount() { return m_cntAll; }
+	static int getCount() { return (int) m_cntAll.value(); }
 
 	static bool isShuttingDown() { return shutting_down; }
 
 	static void shutdown();
 
 private:
+	// Workers are spread over the shards, each one with its own lists and mutex.
+	// A worker going idle or busy locks its shard only, and the dispatcher looks
+	// for an idle worker starting from the next shard in turn.
+	struct Shard
+	{
+		Mutex mutex;
+		Worker* activeWorkers = NULL;
+		Worker* idleWorkers = NULL;
+		AtomicCounter cntIdle;		// changed under the mutex, read without it
+	};
+
+	struct Shards
+	{
+		explicit Shards(MemoryPool&)
+		{ }
+
+		Shard items[SHARDS];
+	};
+
 	Worker* m_next;
 	Worker* m_prev;
+	Shard* m_shard;
 	Semaphore m_sem;
 	bool	m_active;
 	bool	m_going;		// thread was timedout and going to be deleted
@@ -1351,21 +1372,19 @@ private:
 	void insert(const bool active);
 	static void wakeUpAll();
 
-	static Worker* m_activeWorkers;
-	static Worker* m_idleWorkers;
-	static GlobalPtr<Mutex> m_mutex;
-	static int m_cntAll;
-	static int m_cntIdle;
-	static int m_cntGoing;
+	static GlobalPtr<Shards> m_shards;
+	static GlobalPtr<Mutex> m_shutdownMutex;
+	static AtomicCounter m_nextShard;
+	static AtomicCounter m_cntAll;
+	static AtomicCounter m_cntGoing;
 	static bool shutting_down;
 };
 
-Worker* Worker::m_activeWorkers = NULL;
-Worker* Worker::m_idleWorkers = NULL;
-GlobalPtr<Mutex> Worker::m_mutex;
-int Worker::m_cntAll = 0;
-int Worker::m_cntIdle = 0;
-int Worker::m_cntGoing = 0;
+GlobalPtr<Worker::Shards> Worker::m_shards;
+GlobalPtr<Mutex> Worker::m_shutdownMutex;
+AtomicCounter Worker::m_nextShard;
+AtomicCounter Worker::m_cntAll;
+AtomicCounter Worker::m_cntGoing;
 bool Worker::shutting_down = false;
 
 
@@ -2010,6 +2029,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 	USHORT version = 0;
 	USHORT type = 0;
 	bool compress = false;
+	bool hostOrder = false;
 	bool accepted = false;
 	USHORT weight = 0;
 	const p_cnct::p_cnct_repeat* protocol = connect->p_cnct_versions;
@@ -2019,7 +2039,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 	{
 		if ((protocol->p_cnct_version == PROTOCOL_VERSION10 ||
 			 (protocol->p_cnct_version >= PROTOCOL_VERSION11 &&
-			  protocol->p_cnct_version <= PROTOCOL_VERSION20)) &&
+			  protocol->p_cnct_version <= PROTOCOL_VERSION21)) &&
 			 (protocol->p_cnct_architecture == arch_generic ||
 			  protocol->p_cnct_architecture == ARCHITECTURE) &&
 			protocol->p_cnct_weight >= weight)
@@ -2030,6 +2050,9 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 			architecture = protocol->p_cnct_architecture;
 			type = MIN(protocol->p_cnct_max_type & ptype_MASK, ptype_lazy_send);
 			compress = protocol->p_cnct_max_type & pflag_compress;
+#ifndef WORDS_BIGENDIAN
+			hostOrder = protocol->p_cnct_max_type & pflag_host_order;
+#endif
 		}
 	}
 
@@ -2038,7 +2061,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 
 	send->p_acpd.p_acpt_version = port->port_protocol = version;
 	send->p_acpd.p_acpt_architecture = architecture;
-	send->p_acpd.p_acpt_type = type | (compress ? pflag_compress : 0);
+	send->p_acpd.p_acpt_type = type | (compress ? pflag_compress : 0) | (hostOrder ? pflag_host_order : 0);
 #ifdef TRUSTED_AUTH
 	send->p_acpd.p_acpt_type |= pflag_win_sspi_nego;
 #endif
@@ -2046,7 +2069,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 
 	send->p_acpt.p_acpt_version = port->port_protocol = version;
 	send->p_acpt.p_acpt_architecture = architecture;
-	send->p_acpt.p_acpt_type = type | (compress ? pflag_compress : 0);
+	send->p_acpt.p_acpt_type = type | (compress ? pflag_compress : 0) | (hostOrder ? pflag_host_order : 0);
 
 	// modify the version string to reflect the chosen protocol
 	string buffer;
@@ -2060,6 +2083,8 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 		port->port_flags |= PORT_no_oob;
 	if (type == ptype_lazy_send)
 		port->port_flags |= PORT_lazy;
+	if (hostOrder)
+		port->port_flags |= PORT_host_order;
 
 	port->port_client_arch = connect->p_cnct_client;
 
@@ -4047,7 +4072,7 @@ ISC_STATUS rem_port::execute_statement(P_OP op, P_SQLDATA* sqldata, PACKET* send
 }
 
 
-ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, bool scroll)
+ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, P_OP op)
 {
 /*****************************************
  *
@@ -4064,6 +4089,8 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, bool scroll)
 	Rsr* statement;
 	getHandle(statement, sqldata->p_sqldata_statement);
 
+	const bool scroll = (op == op_fetch_scroll);
+
 	// The default (and legacy) scrolling option is FETCH NEXT
 	const auto operation = scroll ? sqldata->p_sqldata_fetch_op : fetch_next;
 	const auto position = scroll ? sqldata->p_sqldata_fetch_pos : 0;
@@ -4204,6 +4231,19 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, bool scroll)
 	response->p_sqldata_messages = 1;
 	RMessage* message = NULL;
 
+	// The client of the same byte order may ask for the whole batch stored
+	// by columns in a single response instead of a packet per row
+
+	ColumnarEncoder* encoder = NULL;
+	UCharBuffer block;
+
+	if (op == op_fetch_columnar && prefetch && statement->rsr_format &&
+		(this->port_flags & PORT_host_order))
+	{
+		encoder = statement->rsr_format->getColumnarEncoder();
+		encoder->clear();
+	}
+
 	// Check to see if any messages are already sitting around
 
 	const FB_UINT64 org_packets = this->port_snd_packets;
@@ -4247,6 +4287,11 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, bool scroll)
 
 			if (statement->rsr_flags.test(Rsr::STREAM_ERR))
 			{
+				// The rows already stored go first, the next fetch reports the error
+
+				if (encoder && encoder->getCount())
+					break;
+
 				fb_assert(statement->rsr_status);
 				statement->rsr_flags.clear(Rsr::STREAM_ERR);
 				return this->send_response(sendL, 0, 0, statement->rsr_status->value(), false);
@@ -4298,7 +4343,16 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, bool scroll)
 			statement->rsr_flags.set(Rsr::FETCHED);
 
 			if (status_vector.getState() & IStatus::STATE_ERRORS)
+			{
+				if (encoder && encoder->getCount())
+				{
+					statement->rsr_flags.set(Rsr::STREAM_ERR);
+					statement->saveException(&status_vector, true);
+					break;
+				}
+
 				return this->send_response(sendL, 0, 0, &status_vector, false);
+			}
 
 			success = (rc == IStatus::RESULT_OK);
 
@@ -4323,9 +4377,15 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, bool scroll)
 				statement->rsr_select_format, statement->rsr_inline_blob_size);
 		}
 
-		// There's a buffer waiting -- send it
+		// There's a buffer waiting -- send it or store it into the block
 
-		this->send_partial(sendL);
+		if (encoder)
+		{
+			encoder->add(message->msg_address);
+			statement->rsr_buffer = message->msg_next;
+		}
+		else
+			this->send_partial(sendL);
 
 		message->msg_address = NULL;
 
@@ -4335,11 +4395,27 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, bool scroll)
 
 		if (packets >= MAX_PACKETS_PER_BATCH && count >= MIN_ROWS_PER_BATCH)
 			break;
+
+		if (encoder && encoder->getLength() >= MAX_BATCH_CACHE_SIZE)
+		{
+			count++;
+			break;
+		}
 	}
 
 	response->p_sqldata_status = success ? 0 : 100;
 	response->p_sqldata_messages = 0;
 
+	if (encoder)
+	{
+		sendL->p_operation = op_fetch_columnar_response;
+		response->p_sqldata_messages = (USHORT) encoder->getCount();
+
+		encoder->build(block, sqldata->p_sqldata_block_flags & FETCH_BLOCK_LZ4);
+		response->p_sqldata_block.cstr_length = block.getCount();
+		response->p_sqldata_block.cstr_address = block.begin();
+	}
+
 	// hvlad: message->msg_address not used in xdr_protocol because of
 	// response->p_sqldata_messages set to zero above.
 	// It is important to not zero message->msg_address after send because
@@ -4353,6 +4429,9 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, bool scroll)
 
 	this->send(sendL);
 
+	response->p_sqldata_block.cstr_length = 0;
+	response->p_sqldata_block.cstr_address = NULL;
+
 	// Since we have a little time on our hands while this packet is sent
 	// and processed, get the next batch of records.  Start by finding the
 	// next free buffer.
@@ -4363,7 +4442,7 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, bool scroll)
 	while (message->msg_address && message->msg_next != statement->rsr_buffer)
 		message = message->msg_next;
 
-	USHORT prefetch_count = (success && prefetch) ? count : 0;
+	USHORT prefetch_count = (success && prefetch && !statement->rsr_flags.test(Rsr::STREAM_ERR)) ? count : 0;
 
 	for (; prefetch_count; --prefetch_count)
 	{
@@ -5276,7 +5355,8 @@ static bool process_packet(rem_port* port, PACKET* sendL, PACKET* receive, rem_p
 
 		case op_fetch:
 		case op_fetch_scroll:
-			port->fetch(&receive->p_sqldata, sendL, op == op_fetch_scroll);
+		case op_fetch_columnar:
+			port->fetch(&receive->p_sqldata, sendL, op);
 			break;
 
 		case op_free_statement:
@@ -7286,21 +7366,25 @@ Worker::Worker()
 	m_active = false;
 	m_going = false;
 	m_next = m_prev = NULL;
+	m_shard = &m_shards->items[(ULONG) m_nextShard.exchangeAdd(1) % SHARDS];
 #ifdef DEV_BUILD
 	m_tid = getThreadId();
 #endif
 
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	MutexLockGuard guard(m_shard->mutex, FB_FUNCTION);
 	insert(m_active);
 }
 
 Worker::~Worker()
 {
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
-	remove();
-	--m_cntAll;
+	{ // scope
+		MutexLockGuard guard(m_shard->mutex, FB_FUNCTION);
+		remove();
+	}
+
 	if (m_going)
 		--m_cntGoing;
+	--m_cntAll;
 }
 
 
@@ -7309,17 +7393,19 @@ bool Worker::wait(int timeout)
 	if (m_sem.tryEnter(timeout))
 		return true;
 
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	MutexLockGuard guard(m_shard->mutex, FB_FUNCTION);
 	if (m_sem.tryEnter(0))
 		return true;
 
 	// don't exit last worker until server shutdown
-	if ((m_cntAll - m_cntGoing == 1) && !isShuttingDown())
+	if ((m_cntAll.value() - ++m_cntGoing < 1) && !isShuttingDown())
+	{
+		--m_cntGoing;
 		return true;
+	}
 
 	remove();
 	m_going = true;
-	m_cntGoing++;
 
 	return false;
 }
@@ -7329,7 +7415,7 @@ void Worker::setState(const bool active)
 	if (m_active == active)
 		return;
 
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	MutexLockGuard guard(m_shard->mutex, FB_FUNCTION);
 	remove();
 	insert(active);
 }
@@ -7353,40 +7439,57 @@ bool Worker::wakeUp()
 	if (!ports_pending)
 		return true;
 
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	// Shards without idle workers are skipped without locking them
+
+	const ULONG first = (ULONG) m_nextShard.exchangeAdd(1);
 
-	if (m_idleWorkers)
+	for (ULONG i = 0; i < SHARDS; i++)
 	{
-		Worker* idle = m_idleWorkers;
-		idle->setState(true);
-		idle->m_sem.release();
-		return true;
+		Shard& shard = m_shards->items[(first + i) % SHARDS];
+
+		if (!shard.cntIdle.value())
+			continue;
+
+		MutexLockGuard guard(shard.mutex, FB_FUNCTION);
+
+		if (Worker* const idle = shard.idleWorkers)
+		{
+			idle->remove();
+			idle->insert(true);
+			idle->m_sem.release();
+			return true;
+		}
 	}
 
-	if (m_cntAll - m_cntGoing >= ports_active + ports_pending)
+	const int cnt = getCount() - (int) m_cntGoing.value();
+
+	if (cnt >= ports_active + ports_pending)
 		return true;
 
-	return (m_cntAll - m_cntGoing >= MAX_THREADS);
+	return (cnt >= MAX_THREADS);
 }
 
 void Worker::wakeUpAll()
 {
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
-	for (Worker* thd = m_idleWorkers; thd; thd = thd->m_next)
-		thd->m_sem.release();
+	for (Shard& shard : m_shards->items)
+	{
+		MutexLockGuard guard(shard.mutex, FB_FUNCTION);
+		for (Worker* thd = shard.idleWorkers; thd; thd = thd->m_next)
+			thd->m_sem.release();
+	}
 }
 
 void Worker::remove()
 {
-	if (!m_active && (m_next || m_prev || m_idleWorkers == this)) {
-		m_cntIdle--;
+	if (!m_active && (m_next || m_prev || m_shard->idleWorkers == this)) {
+		--m_shard->cntIdle;
 	}
 
-	if (m_idleWorkers == this) {
-		m_idleWorkers = this->m_next;
+	if (m_shard->idleWorkers == this) {
+		m_shard->idleWorkers = this->m_next;
 	}
-	if (m_activeWorkers == this) {
-		m_activeWorkers = this->m_next;
+	if (m_shard->activeWorkers == this) {
+		m_shard->activeWorkers = this->m_next;
 	}
 	if (m_next) {
 		m_next->m_prev = this->m_prev;
@@ -7401,10 +7504,10 @@ void Worker::insert(const bool active)
 {
 	fb_assert(!m_next);
 	fb_assert(!m_prev);
-	fb_assert(m_idleWorkers != this);
-	fb_assert(m_activeWorkers != this);
+	fb_assert(m_shard->idleWorkers != this);
+	fb_assert(m_shard->activeWorkers != this);
 
-	Worker** list = active ? &m_activeWorkers : &m_idleWorkers;
+	Worker** list = active ? &m_shard->activeWorkers : &m_shard->idleWorkers;
 	m_next = *list;
 	if (*list) {
 		(*list)->m_prev = this;
@@ -7413,11 +7516,11 @@ void Worker::insert(const bool active)
 	m_active = active;
 	if (!m_active)
 	{
-		m_cntIdle++;
-		fb_assert(m_idleWorkers == this);
+		++m_shard->cntIdle;
+		fb_assert(m_shard->idleWorkers == this);
 	}
 	else
-		fb_assert(m_activeWorkers == this);
+		fb_assert(m_shard->activeWorkers == this);
 }
 
 void Worker::start(USHORT flags)
@@ -7427,15 +7530,16 @@ void Worker::start(USHORT flags)
 		if (isShuttingDown())
 			return;
 
-		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		// Count the thread before it starts, it decrements the counter when exits
+		++m_cntAll;
+
 		try
 		{
 			Thread::start(loopThread, (void*)(IPTR) flags, THREAD_medium);
-			++m_cntAll;
 		}
 		catch (const Exception&)
 		{
-			if (!m_cntAll)
+			if (!--m_cntAll)
 			{
 				Arg::Gds(isc_no_threads).raise();
 			}
@@ -7445,7 +7549,7 @@ void Worker::start(USHORT flags)
 
 void Worker::shutdown()
 {
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	MutexLockGuard guard(m_shutdownMutex, FB_FUNCTION);
 	if (shutting_down)
 	{
 		return;
@@ -7456,17 +7560,7 @@ void Worker::shutdown()
 	while (getCount())
 	{
 		wakeUpAll();
-		m_mutex->leave();	// we need CheckoutGuard here
-		try
-		{
-			Thread::sleep(100);
-		}
-		catch (const Exception&)
-		{
-			m_mutex->enter(FB_FUNCTION);
-			throw;
-		}
-		m_mutex->enter(FB_FUNCTION);
+		Thread::sleep(100);
 	}
 }
 
@@ -660,6 +660,30 @@ void TracePluginImpl::appendGlobalCounts(const PerformanceInfo* info)
 		record.append(temp);
 	}
 
+	if ((cnt = info->pin_counters[PerformanceInfo::PREFETCH_HITS]) != 0)
+	{
+		temp.printf(", %" QUADFORMAT"d prefetch hit(s)", cnt);
+		record.append(temp);
+	}
+
+	if ((cnt = info->pin_counters[PerformanceInfo::PREFETCH_MISSES]) != 0)
+	{
+		temp.printf(", %" QUADFORMAT"d prefetch miss(es)", cnt);
+		record.append(temp);
+	}
+
+	if ((cnt = info->pin_counters[PerformanceInfo::PROBATION_HITS]) != 0)
+	{
+		temp.printf(", %" QUADFORMAT"d probation hit(s)", cnt);
+		record.append(temp);
+	}
+
+	if ((cnt = info->pin_counters[PerformanceInfo::GHOST_HITS]) != 0)
+	{
+		temp.printf(", %" QUADFORMAT"d ghost hit(s)", cnt);
+		record.append(temp);
+	}
+
 	record.append(NEWLINE);
 }
 
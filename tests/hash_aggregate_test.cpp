@@ -0,0 +1,265 @@
+/*
+ *	PROGRAM:	ScratchBird regression tests
+ *	MODULE:		hash_aggregate_test.cpp
+ *	DESCRIPTION:	Literal and NULL aggregate arguments under hash aggregation.
+ *
+ *	A GROUP BY over an unindexed column is aggregated by hash. The
+ *	aggregate functions take literal arguments (SUM(1), AVG(2), MAX('x'))
+ *	and NULL arguments, which must be accumulated the same way they are
+ *	when the groups are sorted: literals count once per row and NULLs are
+ *	skipped.
+ *
+ *	Usage: hash_aggregate_test <database>
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by ScratchBird Development Team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2025 ScratchBird Development Team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include <firebird/Interface.h>
+
+using namespace ScratchBird;
+
+static IMaster* master = fb_get_master_interface();
+
+static const int TABLE_ROWS = 1000;
+static const int GROUPS = 10;
+
+static const char* const CREATE_SQL = "create table hash_agg (id integer not null, grp integer not null)";
+
+static const std::string FILL_SQL =
+	"execute block as declare i integer = 0; begin "
+	"while (i < " + std::to_string(TABLE_ROWS) + ") do begin "
+	"insert into hash_agg (id, grp) values (:i, mod(:i, " + std::to_string(GROUPS) + ")); "
+	"i = i + 1; end end";
+
+// Every column but the first one is expected to be NULL or to have the same value in each group
+
+static const char* const QUERY =
+	"select grp, "
+	"cast(sum(1) as bigint), "
+	"cast(avg(2) as bigint), "
+	"iif(max('x') = 'x', 1, 0), "
+	"cast(min(1.5) * 2 as bigint), "
+	"cast(sum(cast(null as integer)) as bigint), "
+	"cast(max(cast(null as varchar(10))) as bigint), "
+	"cast(count(cast(null as integer)) as bigint), "
+	"cast(count(*) as bigint), "
+	"7 "
+	"from hash_agg group by grp";
+
+static const int ROWS_PER_GROUP = TABLE_ROWS / GROUPS;
+
+static const struct
+{
+	bool null;
+	ISC_INT64 value;
+} EXPECTED[] =
+{
+	{false, ROWS_PER_GROUP},	// SUM(1)
+	{false, 2},					// AVG(2)
+	{false, 1},					// MAX('x')
+	{false, 3},					// MIN(1.5) * 2
+	{true, 0},					// SUM(NULL)
+	{true, 0},					// MAX(NULL)
+	{false, 0},					// COUNT(NULL)
+	{false, ROWS_PER_GROUP},	// COUNT(*)
+	{false, 7}					// literal map item
+};
+
+
+static IAttachment* attach(ThrowStatusWrapper* status, const char* database, bool create)
+{
+	IUtil* const utl = master->getUtilInterface();
+	IXpbBuilder* const dpb = utl->getXpbBuilder(status, IXpbBuilder::DPB, NULL, 0);
+
+	dpb->insertString(status, isc_dpb_user_name, "sysdba");
+
+	if (create)
+		dpb->insertInt(status, isc_dpb_page_size, 8192);
+
+	IProvider* const provider = master->getDispatcher();
+
+	IAttachment* const att = create ?
+		provider->createDatabase(status, database, dpb->getBufferLength(status), dpb->getBuffer(status)) :
+		provider->attachDatabase(status, database, dpb->getBufferLength(status), dpb->getBuffer(status));
+
+	dpb->dispose();
+	return att;
+}
+
+static void setup(ThrowStatusWrapper* status, const char* database)
+{
+	IAttachment* const att = attach(status, database, true);
+
+	for (const char* const sql : {CREATE_SQL, FILL_SQL.c_str()})
+	{
+		ITransaction* const tra = att->startTransaction(status, 0, NULL);
+		att->execute(status, tra, 0, sql, SQL_DIALECT_V6, NULL, NULL, NULL, NULL);
+		tra->commit(status);
+	}
+
+	att->detach(status);
+}
+
+static bool getValue(ThrowStatusWrapper* status, IMessageMetadata* meta, const unsigned char* buffer,
+	unsigned field, ISC_INT64* value)
+{
+	if (*(const short*) (buffer + meta->getNullOffset(status, field)))
+		return false;
+
+	const unsigned char* const data = buffer + meta->getOffset(status, field);
+
+	switch (meta->getType(status, field) & ~1)
+	{
+		case SQL_SHORT:
+			*value = *(const short*) data;
+			break;
+
+		case SQL_LONG:
+			*value = *(const int*) data;
+			break;
+
+		default:
+			*value = *(const ISC_INT64*) data;
+			break;
+	}
+
+	return true;
+}
+
+// Returns the number of wrong values, -1 if the groups aren't aggregated by hash
+
+static int checkGroups(ThrowStatusWrapper* status, IAttachment* att, ITransaction* tra)
+{
+	IStatement* const stmt = att->prepare(status, tra, 0, QUERY, SQL_DIALECT_V6,
+		IStatement::PREPARE_PREFETCH_DETAILED_PLAN);
+
+	const char* const plan = stmt->getPlan(status, true);
+	printf("%s\n%s\n", QUERY, plan ? plan : "");
+
+	if (!plan || !strstr(plan, "Hash Aggregate"))
+	{
+		stmt->free(status);
+		return -1;
+	}
+
+	IMessageMetadata* const meta = stmt->getOutputMetadata(status);
+	std::vector<unsigned char> buffer(meta->getMessageLength(status));
+
+	IResultSet* const rs = stmt->openCursor(status, tra, NULL, NULL, meta, 0);
+
+	int errors = 0, groups = 0;
+
+	while (rs->fetchNext(status, buffer.data()) == IStatus::RESULT_OK)
+	{
+		ISC_INT64 group = 0;
+		getValue(status, meta, buffer.data(), 0, &group);
+		groups++;
+
+		for (unsigned i = 0; i < sizeof(EXPECTED) / sizeof(EXPECTED[0]); i++)
+		{
+			ISC_INT64 value = 0;
+			const bool notNull = getValue(status, meta, buffer.data(), i + 1, &value);
+
+			if (notNull == EXPECTED[i].null || (notNull && value != EXPECTED[i].value))
+			{
+				printf("FAILED: group %d, column %u is %s%lld\n", (int) group, i + 2,
+					notNull ? "" : "NULL", notNull ? (long long) value : 0LL);
+				errors++;
+			}
+		}
+	}
+
+	rs->close(status);
+	meta->release();
+	stmt->free(status);
+
+	if (groups != GROUPS)
+	{
+		printf("FAILED: %d groups instead of %d\n", groups, GROUPS);
+		errors++;
+	}
+
+	return errors;
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <database>\n", argv[0]);
+		return 1;
+	}
+
+	setenv("ISC_USER", "sysdba", 0);
+
+	const char* const database = argv[1];
+	ThrowStatusWrapper status(master->getStatus());
+	IAttachment* att = NULL;
+	int rc = 0;
+
+	remove(database);
+
+	try
+	{
+		setup(&status, database);
+
+		att = attach(&status, database, false);
+		ITransaction* const tra = att->startTransaction(&status, 0, NULL);
+
+		const int errors = checkGroups(&status, att, tra);
+
+		if (errors < 0)
+		{
+			printf("FAILED: groups are not aggregated by hash\n\n");
+			rc = 1;
+		}
+		else if (errors)
+			rc = 1;
+		else
+			printf("OK: %d groups aggregated\n\n", GROUPS);
+
+		tra->commit(&status);
+
+		att->dropDatabase(&status);
+		att = NULL;
+	}
+	catch (const FbException& error)
+	{
+		char buffer[512];
+		master->getUtilInterface()->formatStatus(buffer, sizeof(buffer), error.getStatus());
+		fprintf(stderr, "Hash aggregate test failed:\n%s\n", buffer);
+		rc = 1;
+	}
+
+	if (att)
+		att->release();
+
+	status.dispose();
+	return rc;
+}
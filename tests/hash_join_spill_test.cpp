@@ -0,0 +1,221 @@
+/*
+ *	PROGRAM:	ScratchBird regression tests
+ *	MODULE:		hash_join_spill_test.cpp
+ *	DESCRIPTION:	Order of spilled hash joins under ORDER BY.
+ *
+ *	The database is opened with a tiny HashJoinMemoryLimit (passed in the
+ *	DPB), so every hash join that is allowed to spill does so. An EXISTS
+ *	and a NOT EXISTS sub-query over an unindexed column become hash semi
+ *	and anti joins, while ORDER BY and GROUP BY on the primary key of the
+ *	outer table are satisfied by the index navigation. The rows must still
+ *	come back in key order: a hash join must not replay navigated leading
+ *	rows partition by partition.
+ *
+ *	Usage: hash_join_spill_test <database>
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by ScratchBird Development Team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2025 ScratchBird Development Team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <string>
+
+#include <firebird/Interface.h>
+
+using namespace ScratchBird;
+
+static IMaster* master = fb_get_master_interface();
+
+static const int TABLE_ROWS = 20000;
+
+static const char* const CREATE_SQL[] =
+{
+	"create table spill_outer (id integer not null primary key, grp integer not null)",
+	"create table spill_inner (grp integer not null, payload varchar(200))"
+};
+
+// Every second group of the outer table has matching inner rows
+
+static const std::string FILL_SQL =
+	"execute block as declare i integer = 1; begin "
+	"while (i <= " + std::to_string(TABLE_ROWS) + ") do begin "
+	"insert into spill_outer (id, grp) values (:i, mod(:i * 7919, " + std::to_string(TABLE_ROWS) + ")); "
+	"if (mod(:i, 2) = 0) then "
+	"insert into spill_inner (grp, payload) values (:i, lpad('', 200, 'x')); "
+	"i = i + 1; end end";
+
+static const char* const QUERIES[] =
+{
+	"select o.id from spill_outer o "
+	"where exists (select * from spill_inner i where i.grp = o.grp) "
+	"order by o.id optimize for first rows",
+
+	"select o.id from spill_outer o "
+	"where not exists (select * from spill_inner i where i.grp = o.grp) "
+	"order by o.id optimize for first rows",
+
+	"select o.id from spill_outer o "
+	"where exists (select * from spill_inner i where i.grp = o.grp) "
+	"group by o.id optimize for first rows"
+};
+
+
+static IAttachment* attach(ThrowStatusWrapper* status, const char* database, bool create)
+{
+	IUtil* const utl = master->getUtilInterface();
+	IXpbBuilder* const dpb = utl->getXpbBuilder(status, IXpbBuilder::DPB, NULL, 0);
+
+	dpb->insertString(status, isc_dpb_user_name, "sysdba");
+
+	if (create)
+		dpb->insertInt(status, isc_dpb_page_size, 8192);
+	else
+		dpb->insertString(status, isc_dpb_config, "HashJoinMemoryLimit = 1");
+
+	IProvider* const provider = master->getDispatcher();
+
+	IAttachment* const att = create ?
+		provider->createDatabase(status, database, dpb->getBufferLength(status), dpb->getBuffer(status)) :
+		provider->attachDatabase(status, database, dpb->getBufferLength(status), dpb->getBuffer(status));
+
+	dpb->dispose();
+	return att;
+}
+
+static void setup(ThrowStatusWrapper* status, const char* database)
+{
+	IAttachment* const att = attach(status, database, true);
+
+	for (const char* const sql : {CREATE_SQL[0], CREATE_SQL[1], FILL_SQL.c_str()})
+	{
+		ITransaction* const tra = att->startTransaction(status, 0, NULL);
+		att->execute(status, tra, 0, sql, SQL_DIALECT_V6, NULL, NULL, NULL, NULL);
+		tra->commit(status);
+	}
+
+	att->detach(status);
+}
+
+// Returns the number of fetched rows, -1 if they are out of order
+
+static int checkOrder(ThrowStatusWrapper* status, IAttachment* att, ITransaction* tra, const char* sql)
+{
+	IStatement* const stmt = att->prepare(status, tra, 0, sql, SQL_DIALECT_V6,
+		IStatement::PREPARE_PREFETCH_DETAILED_PLAN);
+
+	const char* const plan = stmt->getPlan(status, true);
+	printf("%s\n%s\n", sql, plan ? plan : "");
+
+	struct
+	{
+		int id;
+		short null;
+	} message;
+
+	IMetadataBuilder* const builder = master->getMetadataBuilder(status, 1);
+	builder->setType(status, 0, SQL_LONG + 1);
+	builder->setLength(status, 0, sizeof(int));
+	IMessageMetadata* const meta = builder->getMetadata(status);
+	builder->release();
+
+	IResultSet* const rs = stmt->openCursor(status, tra, NULL, NULL, meta, 0);
+	meta->release();
+
+	int count = 0, last = 0;
+	bool ordered = true;
+
+	while (rs->fetchNext(status, &message) == IStatus::RESULT_OK)
+	{
+		if (count++ && message.id <= last)
+			ordered = false;
+
+		last = message.id;
+	}
+
+	rs->close(status);
+	stmt->free(status);
+
+	return ordered ? count : -1;
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <database>\n", argv[0]);
+		return 1;
+	}
+
+	setenv("ISC_USER", "sysdba", 0);
+
+	const char* const database = argv[1];
+	ThrowStatusWrapper status(master->getStatus());
+	IAttachment* att = NULL;
+	int rc = 0;
+
+	remove(database);
+
+	try
+	{
+		setup(&status, database);
+
+		att = attach(&status, database, false);
+		ITransaction* const tra = att->startTransaction(&status, 0, NULL);
+
+		for (const char* const sql : QUERIES)
+		{
+			const int count = checkOrder(&status, att, tra, sql);
+
+			if (count < 0)
+			{
+				printf("FAILED: rows are out of order\n\n");
+				rc = 1;
+			}
+			else if (count == 0)
+			{
+				printf("FAILED: no rows returned\n\n");
+				rc = 1;
+			}
+			else
+				printf("OK: %d rows in order\n\n", count);
+		}
+
+		tra->commit(&status);
+
+		att->dropDatabase(&status);
+		att = NULL;
+	}
+	catch (const FbException& error)
+	{
+		char buffer[512];
+		master->getUtilInterface()->formatStatus(buffer, sizeof(buffer), error.getStatus());
+		fprintf(stderr, "Hash join spill test failed:\n%s\n", buffer);
+		rc = 1;
+	}
+
+	if (att)
+		att->release();
+
+	status.dispose();
+	return rc;
+}
@@ -0,0 +1,418 @@
+/*
+ *	PROGRAM:	ScratchBird performance tests
+ *	MODULE:		page_cache_benchmark.cpp
+ *	DESCRIPTION:	Page cache (CCH_fetch) contention microbenchmark.
+ *
+ *	Every worker thread has its own attachment to the same database opened
+ *	by the embedded engine, so all of them share one page cache. A worker
+ *	runs a single EXECUTE BLOCK doing primary key lookups over a table that
+ *	fits into the cache: the time is spent fetching and releasing cached
+ *	index and data pages, with no I/O and no client round trips.
+ *
+ *	The run is repeated for every combination of the CachePartitions setting
+ *	(passed in the DPB, so it applies when the database is opened by the
+ *	first worker) and the number of threads. Page fetches are taken from
+ *	MON$IO_STATS of every attachment, the result is page fetches per second.
+ *
+ *	Usage: page_cache_benchmark <database> [lookups per thread]
+ *				[partitions list] [threads list]
+ *	Lists are comma separated, e.g. page_cache_benchmark /tmp/cache.fdb
+ *	200000 1,2,4,8,16 1,2,4,8,16
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by ScratchBird Development Team
+ *  for the ScratchBird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2025 ScratchBird Development Team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <firebird/Interface.h>
+
+using namespace ScratchBird;
+
+static IMaster* master = fb_get_master_interface();
+
+static const int TABLE_ROWS = 100000;
+static const int CACHE_BUFFERS = 65536;		// every partition keeps at least 512 buffers
+
+static const char* const CREATE_SQL =
+	"create table cache_test (id integer not null primary key, name varchar(100), val double precision)";
+
+static const std::string FILL_SQL =
+	"execute block as declare i integer = 1; begin "
+	"while (i <= " + std::to_string(TABLE_ROWS) + ") do begin "
+	"insert into cache_test (id, name, val) values (:i, 'Cache test ' || :i, :i * 1.5); "
+	"i = i + 1; end end";
+
+// Lookups run inside the engine, keys are scattered over the whole table
+
+static const std::string LOOKUP_SQL =
+	"execute block (n integer = ?, seed integer = ?) returns (total double precision) as "
+	"declare i integer = 0; declare k integer; declare v double precision; begin "
+	"total = 0; "
+	"while (i < n) do begin "
+	"k = mod(seed + i * 7919, " + std::to_string(TABLE_ROWS) + ") + 1; "
+	"select val from cache_test where id = :k into :v; "
+	"total = total + v; i = i + 1; end end";
+
+static const char* const FETCHES_SQL =
+	"select io.mon$page_fetches from mon$attachments a "
+	"join mon$io_stats io on io.mon$stat_id = a.mon$stat_id "
+	"where a.mon$attachment_id = current_connection";
+
+
+// Start barrier of the worker threads
+
+class Barrier
+{
+public:
+	explicit Barrier(unsigned aCount)
+		: count(aCount)
+	{ }
+
+	void wait()
+	{
+		std::unique_lock<std::mutex> guard(mutex);
+
+		if (--count == 0)
+			cond.notify_all();
+		else
+			cond.wait(guard, [this] { return count == 0; });
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable cond;
+	unsigned count;
+};
+
+
+static IAttachment* attach(ThrowStatusWrapper* status, const char* database, unsigned partitions)
+{
+	IUtil* const utl = master->getUtilInterface();
+	IXpbBuilder* const dpb = utl->getXpbBuilder(status, IXpbBuilder::DPB, NULL, 0);
+
+	const std::string config = "CachePartitions = " + std::to_string(partitions);
+
+	dpb->insertString(status, isc_dpb_user_name, "sysdba");
+	dpb->insertInt(status, isc_dpb_num_buffers, CACHE_BUFFERS);
+	dpb->insertString(status, isc_dpb_config, config.c_str());
+
+	IAttachment* const att = master->getDispatcher()->attachDatabase(status, database,
+		dpb->getBufferLength(status), dpb->getBuffer(status));
+
+	dpb->dispose();
+	return att;
+}
+
+static ISC_INT64 getFetches(ThrowStatusWrapper* status, IAttachment* att)
+{
+	// Every transaction sees its own monitoring snapshot
+
+	ITransaction* const tra = att->startTransaction(status, 0, NULL);
+
+	struct
+	{
+		ISC_INT64 fetches;
+		short null;
+	} message;
+
+	IMetadataBuilder* const builder = master->getMetadataBuilder(status, 1);
+	builder->setType(status, 0, SQL_INT64 + 1);
+	builder->setLength(status, 0, sizeof(ISC_INT64));
+	IMessageMetadata* const meta = builder->getMetadata(status);
+	builder->release();
+
+	att->execute(status, tra, 0, FETCHES_SQL, SQL_DIALECT_V6, NULL, NULL, meta, &message);
+	meta->release();
+
+	tra->commit(status);
+
+	return message.null ? 0 : message.fetches;
+}
+
+
+struct WorkerResult
+{
+	ISC_INT64 fetches = 0;
+	double seconds = 0;
+	std::string error;
+};
+
+static void worker(const char* database, unsigned partitions, int lookups, int seed,
+	Barrier* attached, Barrier* finished, WorkerResult* result)
+{
+	ThrowStatusWrapper status(master->getStatus());
+	IAttachment* att = NULL;
+	IStatement* stmt = NULL;
+	ITransaction* tra = NULL;
+	bool waited = false;
+
+	try
+	{
+		att = attach(&status, database, partitions);
+
+		tra = att->startTransaction(&status, 0, NULL);
+		stmt = att->prepare(&status, tra, 0, LOOKUP_SQL.c_str(), SQL_DIALECT_V6, 0);
+
+		struct
+		{
+			int n;
+			short nNull;
+			int seed;
+			short seedNull;
+		} input = {lookups, 0, seed, 0};
+
+		struct
+		{
+			double total;
+			short totalNull;
+		} output;
+
+		IMessageMetadata* const inMeta = stmt->getInputMetadata(&status);
+		IMessageMetadata* const outMeta = stmt->getOutputMetadata(&status);
+
+		const ISC_INT64 before = getFetches(&status, att);
+
+		// All attachments exist and share the cache, start lookups together
+
+		attached->wait();
+		waited = true;
+
+		const auto start = std::chrono::steady_clock::now();
+		stmt->execute(&status, tra, inMeta, &input, outMeta, &output);
+		result->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		inMeta->release();
+		outMeta->release();
+
+		stmt->free(&status);
+		stmt = NULL;
+		tra->commit(&status);
+		tra = NULL;
+
+		result->fetches = getFetches(&status, att) - before;
+	}
+	catch (const FbException& error)
+	{
+		char buffer[512];
+		master->getUtilInterface()->formatStatus(buffer, sizeof(buffer), error.getStatus());
+		result->error = buffer;
+
+		if (!waited)
+			attached->wait();
+	}
+
+	// Keep the database open until every worker is done
+
+	finished->wait();
+
+	if (stmt)
+		stmt->release();
+	if (tra)
+		tra->release();
+
+	if (att)
+	{
+		try
+		{
+			att->detach(&status);
+		}
+		catch (const FbException&)
+		{
+			att->release();
+		}
+	}
+
+	status.dispose();
+}
+
+
+static bool setup(const char* database)
+{
+	ThrowStatusWrapper status(master->getStatus());
+	IAttachment* att = NULL;
+	bool ok = true;
+
+	try
+	{
+		IUtil* const utl = master->getUtilInterface();
+		IXpbBuilder* const dpb = utl->getXpbBuilder(&status, IXpbBuilder::DPB, NULL, 0);
+		dpb->insertString(&status, isc_dpb_user_name, "sysdba");
+		dpb->insertInt(&status, isc_dpb_page_size, 8192);
+
+		att = master->getDispatcher()->createDatabase(&status, database,
+			dpb->getBufferLength(&status), dpb->getBuffer(&status));
+		dpb->dispose();
+
+		for (const char* const sql : {CREATE_SQL, FILL_SQL.c_str()})
+		{
+			ITransaction* const tra = att->startTransaction(&status, 0, NULL);
+			att->execute(&status, tra, 0, sql, SQL_DIALECT_V6, NULL, NULL, NULL, NULL);
+			tra->commit(&status);
+		}
+
+		att->detach(&status);
+		att = NULL;
+	}
+	catch (const FbException& error)
+	{
+		char buffer[512];
+		master->getUtilInterface()->formatStatus(buffer, sizeof(buffer), error.getStatus());
+		fprintf(stderr, "Setup of %s failed:\n%s\n", database, buffer);
+		ok = false;
+	}
+
+	if (att)
+		att->release();
+
+	status.dispose();
+	return ok;
+}
+
+static std::vector<unsigned> parseList(const char* text)
+{
+	std::vector<unsigned> list;
+
+	for (const char* p = text; *p; )
+	{
+		char* end;
+		const unsigned long value = strtoul(p, &end, 10);
+
+		if (end == p)
+			break;
+
+		if (value)
+			list.push_back((unsigned) value);
+
+		p = (*end == ',') ? end + 1 : end;
+	}
+
+	return list;
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <database> [lookups per thread] [partitions list] [threads list]\n",
+			argv[0]);
+		return 1;
+	}
+
+	setenv("ISC_USER", "sysdba", 0);
+
+	const char* const database = argv[1];
+	const int lookups = argc > 2 ? atoi(argv[2]) : 200000;
+	const std::vector<unsigned> partitionsList = parseList(argc > 3 ? argv[3] : "1,2,4,8,16");
+	const std::vector<unsigned> threadsList = parseList(argc > 4 ? argv[4] : "1,2,4,8,16");
+
+	if (lookups <= 0 || partitionsList.empty() || threadsList.empty())
+	{
+		fprintf(stderr, "Invalid arguments\n");
+		return 1;
+	}
+
+	remove(database);
+
+	if (!setup(database))
+		return 1;
+
+	printf("Page cache benchmark: %d rows, %d lookups per thread, %d buffers\n",
+		TABLE_ROWS, lookups, CACHE_BUFFERS);
+	printf("%10s %8s %14s %10s %16s\n", "Partitions", "Threads", "Page fetches", "Seconds", "Fetches/second");
+
+	int rc = 0;
+
+	for (const unsigned partitions : partitionsList)
+	{
+		for (const unsigned threads : threadsList)
+		{
+			Barrier attached(threads);
+			Barrier finished(threads);
+			std::vector<WorkerResult> results(threads);
+			std::vector<std::thread> workers;
+
+			for (unsigned i = 0; i < threads; i++)
+			{
+				workers.emplace_back(worker, database, partitions, lookups, (int) (i * TABLE_ROWS / threads),
+					&attached, &finished, &results[i]);
+			}
+
+			for (auto& thread : workers)
+				thread.join();
+
+			ISC_INT64 fetches = 0;
+			double seconds = 0;
+			bool failed = false;
+
+			for (const auto& result : results)
+			{
+				if (!result.error.empty())
+				{
+					fprintf(stderr, "Worker failed:\n%s\n", result.error.c_str());
+					failed = true;
+				}
+
+				fetches += result.fetches;
+				seconds = result.seconds > seconds ? result.seconds : seconds;
+			}
+
+			if (failed)
+			{
+				rc = 1;
+				continue;
+			}
+
+			// Elapsed time of the slowest worker, all of them started together
+
+			printf("%10u %8u %14lld %10.3f %16.0f\n", partitions, threads, (long long) fetches, seconds,
+				seconds > 0 ? fetches / seconds : 0.0);
+			fflush(stdout);
+		}
+	}
+
+	// Drop the database
+
+	{
+		ThrowStatusWrapper status(master->getStatus());
+
+		try
+		{
+			IAttachment* const att = attach(&status, database, 1);
+			att->dropDatabase(&status);
+		}
+		catch (const FbException&)
+		{}
+
+		status.dispose();
+	}
+
+	return rc;
+}
@@ -52,6 +52,9 @@ declare -A TEST_CATEGORIES=(
     ["performance_benchmarks"]="test_performance_benchmarks.sh"
     ["regression_tests"]="test_regression_tests.sh"
     ["stress_tests"]="test_stress_tests.sh"
+    ["page_cache_scalability"]="test_page_cache_scalability.sh"
+    ["hash_join_spill"]="test_hash_join_spill.sh"
+    ["hash_aggregate"]="test_hash_aggregate.sh"
 )
 
 # Function to print colored output
@@ -94,6 +97,8 @@ show_usage() {
     echo "  6. Performance Benchmark Tests"
     echo "  7. Regression Tests"
     echo "  8. Stress Tests"
+    echo "  9. Page Cache Scalability Benchmark"
+    echo "  10. Hash Join Spill Order Test"
     echo ""
     echo "Output: test_results.txt"
     echo ""
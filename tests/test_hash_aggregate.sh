@@ -0,0 +1,56 @@
+#!/bin/bash
+
+#
+# ScratchBird v0.5.0 - Hash Aggregate Argument Test
+#
+# This script builds and runs hash_aggregate_test.cpp. A GROUP BY aggregated
+# by hash is checked to accumulate literal aggregate arguments once per row
+# and to skip NULL arguments, the same way the sorted aggregation does.
+#
+# Copyright (c) 2025 ScratchBird Development Team
+# All Rights Reserved.
+#
+
+# Configuration
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TEST_DB_DIR="$SCRIPT_DIR/test_databases"
+TEST_DB="$TEST_DB_DIR/hash_aggregate_test.fdb"
+SB_HOME="$SCRIPT_DIR/../gen/Release/scratchbird"
+OUTPUT_FILE="$SCRIPT_DIR/test_results.txt"
+TEST_PROGRAM="$TEST_DB_DIR/hash_aggregate_test"
+
+# Create test database directory
+mkdir -p "$TEST_DB_DIR"
+
+echo "Testing hash aggregate arguments..." >> "$OUTPUT_FILE"
+
+# Build the test against the client library of the build
+if ! ${CXX:-c++} -O2 -std=c++11 -I"$SB_HOME/include" \
+    "$SCRIPT_DIR/hash_aggregate_test.cpp" -o "$TEST_PROGRAM" \
+    -L"$SB_HOME/lib" -lfbclient >> "$OUTPUT_FILE" 2>&1; then
+    echo "Failed to build hash aggregate test" >> "$OUTPUT_FILE"
+    exit 1
+fi
+
+# Embedded access, the engine is loaded by the test process itself
+export SCRATCHBIRD="$SB_HOME"
+export LD_LIBRARY_PATH="$SB_HOME/lib${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}"
+
+echo "=========================================" >> "$OUTPUT_FILE"
+echo "Test: Hash Aggregate Arguments" >> "$OUTPUT_FILE"
+echo "Expected: Literal and NULL aggregate arguments give the same results as without hashing" >> "$OUTPUT_FILE"
+echo "Command: $TEST_PROGRAM $TEST_DB" >> "$OUTPUT_FILE"
+echo "=========================================" >> "$OUTPUT_FILE"
+
+"$TEST_PROGRAM" "$TEST_DB" >> "$OUTPUT_FILE" 2>&1
+exit_code=$?
+
+echo "" >> "$OUTPUT_FILE"
+
+if [[ $exit_code -ne 0 ]]; then
+    echo "Hash aggregate test failed with exit code $exit_code" >> "$OUTPUT_FILE"
+    exit $exit_code
+fi
+
+echo "Hash aggregate argument test completed successfully"
+exit 0
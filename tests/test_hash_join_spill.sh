@@ -0,0 +1,58 @@
+#!/bin/bash
+
+#
+# ScratchBird v0.5.0 - Hash Join Spill Order Test
+#
+# This script builds and runs hash_join_spill_test.cpp. The test database is
+# opened with a tiny HashJoinMemoryLimit (passed in the DPB), so hash joins
+# spill to temporary space, and sub-queries converted into hash semi and
+# anti joins are checked to return their rows in ORDER BY / GROUP BY order
+# when that order comes from the index navigation.
+#
+# Copyright (c) 2025 ScratchBird Development Team
+# All Rights Reserved.
+#
+
+# Configuration
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TEST_DB_DIR="$SCRIPT_DIR/test_databases"
+TEST_DB="$TEST_DB_DIR/hash_join_spill_test.fdb"
+SB_HOME="$SCRIPT_DIR/../gen/Release/scratchbird"
+OUTPUT_FILE="$SCRIPT_DIR/test_results.txt"
+TEST_PROGRAM="$TEST_DB_DIR/hash_join_spill_test"
+
+# Create test database directory
+mkdir -p "$TEST_DB_DIR"
+
+echo "Testing hash join spill order..." >> "$OUTPUT_FILE"
+
+# Build the test against the client library of the build
+if ! ${CXX:-c++} -O2 -std=c++11 -I"$SB_HOME/include" \
+    "$SCRIPT_DIR/hash_join_spill_test.cpp" -o "$TEST_PROGRAM" \
+    -L"$SB_HOME/lib" -lfbclient >> "$OUTPUT_FILE" 2>&1; then
+    echo "Failed to build hash join spill test" >> "$OUTPUT_FILE"
+    exit 1
+fi
+
+# Embedded access, the engine is loaded by the test process itself
+export SCRATCHBIRD="$SB_HOME"
+export LD_LIBRARY_PATH="$SB_HOME/lib${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}"
+
+echo "=========================================" >> "$OUTPUT_FILE"
+echo "Test: Hash Join Spill Order" >> "$OUTPUT_FILE"
+echo "Expected: Navigated ORDER BY and GROUP BY order is kept by hash semi and anti joins" >> "$OUTPUT_FILE"
+echo "Command: $TEST_PROGRAM $TEST_DB" >> "$OUTPUT_FILE"
+echo "=========================================" >> "$OUTPUT_FILE"
+
+"$TEST_PROGRAM" "$TEST_DB" >> "$OUTPUT_FILE" 2>&1
+exit_code=$?
+
+echo "" >> "$OUTPUT_FILE"
+
+if [[ $exit_code -ne 0 ]]; then
+    echo "Hash join spill test failed with exit code $exit_code" >> "$OUTPUT_FILE"
+    exit $exit_code
+fi
+
+echo "Hash join spill order test completed successfully"
+exit 0
@@ -0,0 +1,70 @@
+#!/bin/bash
+
+#
+# ScratchBird v0.5.0 - Page Cache Scalability Benchmark
+#
+# This script builds and runs page_cache_benchmark.cpp, a multi-threaded
+# microbenchmark of page fetches from the shared page cache. Every thread
+# has its own embedded attachment to the same database and performs
+# primary key lookups over a cached table inside a single EXECUTE BLOCK.
+#
+# The benchmark is repeated for every number of cache partitions
+# (CachePartitions setting, passed in the DPB) and every number of threads,
+# page fetches per second are reported for each combination.
+#
+# Environment:
+#   CACHE_BENCH_LOOKUPS     lookups per thread (default 200000)
+#   CACHE_BENCH_PARTITIONS  partition counts to sweep (default 1,2,4,8,16)
+#   CACHE_BENCH_THREADS     thread counts to sweep (default 1,2,4,8,16)
+#
+# Copyright (c) 2025 ScratchBird Development Team
+# All Rights Reserved.
+#
+
+# Configuration
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TEST_DB_DIR="$SCRIPT_DIR/test_databases"
+TEST_DB="$TEST_DB_DIR/page_cache_benchmark.fdb"
+SB_HOME="$SCRIPT_DIR/../gen/Release/scratchbird"
+OUTPUT_FILE="$SCRIPT_DIR/test_results.txt"
+BENCHMARK="$TEST_DB_DIR/page_cache_benchmark"
+
+LOOKUPS="${CACHE_BENCH_LOOKUPS:-200000}"
+PARTITIONS="${CACHE_BENCH_PARTITIONS:-1,2,4,8,16}"
+THREADS="${CACHE_BENCH_THREADS:-1,2,4,8,16}"
+
+# Create test database directory
+mkdir -p "$TEST_DB_DIR"
+
+echo "Testing page cache scalability..." >> "$OUTPUT_FILE"
+
+# Build the benchmark against the client library of the build
+if ! ${CXX:-c++} -O2 -std=c++11 -pthread -I"$SB_HOME/include" \
+    "$SCRIPT_DIR/page_cache_benchmark.cpp" -o "$BENCHMARK" \
+    -L"$SB_HOME/lib" -lfbclient >> "$OUTPUT_FILE" 2>&1; then
+    echo "Failed to build page cache benchmark" >> "$OUTPUT_FILE"
+    exit 1
+fi
+
+# Embedded access, the engine is loaded by the benchmark process itself
+export SCRATCHBIRD="$SB_HOME"
+export LD_LIBRARY_PATH="$SB_HOME/lib${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}"
+
+echo "=========================================" >> "$OUTPUT_FILE"
+echo "Test: Page Cache Scalability" >> "$OUTPUT_FILE"
+echo "Expected: Page fetches per second grow with the number of threads and partitions" >> "$OUTPUT_FILE"
+echo "Command: $BENCHMARK $TEST_DB $LOOKUPS $PARTITIONS $THREADS" >> "$OUTPUT_FILE"
+echo "=========================================" >> "$OUTPUT_FILE"
+
+"$BENCHMARK" "$TEST_DB" "$LOOKUPS" "$PARTITIONS" "$THREADS" >> "$OUTPUT_FILE" 2>&1
+exit_code=$?
+
+echo "" >> "$OUTPUT_FILE"
+
+if [[ $exit_code -ne 0 ]]; then
+    echo "Page cache benchmark failed with exit code $exit_code" >> "$OUTPUT_FILE"
+    exit $exit_code
+fi
+
+echo "Page cache scalability benchmark completed successfully"
+exit 0